@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ApngWriter.h"
+#include "fpng.h"
+#include "ImageFileWriters.h"
+#include "WorkerPool.h"
+#include <bit>
+#include <emmintrin.h>
+
+namespace
+{
+	constexpr uint8_t PngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	// the acTL chunk follows the signature and the IHDR chunk (13 bytes of data), so it's at a fixed offset. It's rewritten in close().
+	constexpr long AnimationControlChunkOffset = 8 + 12 + 13;
+	constexpr uint8_t ColorTypeRgba = 6;
+	constexpr uint8_t DisposeOpNone = 0;
+	constexpr uint8_t BlendOpSource = 0;
+	constexpr uint8_t BlendOpOver = 1;
+
+	/// <summary>
+	/// The part of a frame which is stored in the file, in pixels.
+	/// </summary>
+	struct FrameRectangle
+	{
+		int left = 0;
+		int top = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+
+	struct EncodedFrame
+	{
+		FrameRectangle rectangle;
+		bool isDelta = false;					// true if the pixels outside the changed pixels are transparent, so the frame is blended over the previous one
+		std::vector<uint8_t> compressedData;	// zlib stream of the filtered scanlines, as stored in IDAT / fdAT chunks
+		bool isEncoded = false;
+	};
+
+
+	void appendBigEndian32(std::vector<uint8_t>& destination, uint32_t value)
+	{
+		destination.push_back((uint8_t)(value >> 24));
+		destination.push_back((uint8_t)(value >> 16));
+		destination.push_back((uint8_t)(value >> 8));
+		destination.push_back((uint8_t)value);
+	}
+
+
+	void appendBigEndian16(std::vector<uint8_t>& destination, uint16_t value)
+	{
+		destination.push_back((uint8_t)(value >> 8));
+		destination.push_back((uint8_t)value);
+	}
+
+
+	uint32_t readBigEndian32(const uint8_t* source)
+	{
+		return ((uint32_t)source[0] << 24) | ((uint32_t)source[1] << 16) | ((uint32_t)source[2] << 8) | (uint32_t)source[3];
+	}
+
+
+	/// <summary>
+	/// Returns the index of the first byte which differs between a and b, or -1 if they're equal. Compares 16 bytes at a time.
+	/// </summary>
+	int findFirstDifferentByte(const uint8_t* a, const uint8_t* b, int size)
+	{
+		int i = 0;
+		for(; i + 16 <= size; i += 16)
+		{
+			const __m128i equalBytes = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+			const uint32_t differentBytesMask = ~(uint32_t)_mm_movemask_epi8(equalBytes) & 0xFFFF;
+			if(0 != differentBytesMask)
+			{
+				return i + std::countr_zero(differentBytesMask);
+			}
+		}
+		for(; i < size; i++)
+		{
+			if(a[i] != b[i])
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+
+	/// <summary>
+	/// Returns the index of the last byte which differs between a and b, or -1 if they're equal. Compares 16 bytes at a time, from the end.
+	/// </summary>
+	int findLastDifferentByte(const uint8_t* a, const uint8_t* b, int size)
+	{
+		int end = size;
+		for(; end >= 16; end -= 16)
+		{
+			const __m128i equalBytes = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + end - 16)), _mm_loadu_si128((const __m128i*)(b + end - 16)));
+			const uint32_t differentBytesMask = ~(uint32_t)_mm_movemask_epi8(equalBytes) & 0xFFFF;
+			if(0 != differentBytesMask)
+			{
+				return end - 16 + (31 - std::countl_zero(differentBytesMask));
+			}
+		}
+		for(int i = end - 1; i >= 0; i--)
+		{
+			if(a[i] != b[i])
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+
+	/// <summary>
+	/// Returns the smallest rectangle which contains all pixels which differ between the two RGB frames specified. Has a width of 0 if the frames are equal.
+	/// </summary>
+	FrameRectangle findChangedRectangle(const uint8_t* frame, const uint8_t* previousFrame, int width, int height)
+	{
+		const int rowSizeInBytes = width * 3;
+		int left = width;
+		int right = -1;
+		int top = -1;
+		int bottom = -1;
+		for(int y = 0; y < height; y++)
+		{
+			const uint8_t* row = frame + (size_t)y * rowSizeInBytes;
+			const uint8_t* previousRow = previousFrame + (size_t)y * rowSizeInBytes;
+			const int firstDifferentByte = findFirstDifferentByte(row, previousRow, rowSizeInBytes);
+			if(firstDifferentByte < 0)
+			{
+				continue;
+			}
+			left = (std::min)(left, firstDifferentByte / 3);
+			// only the part right of the current right edge can move the edge.
+			const int searchStart = (std::max)(right + 1, firstDifferentByte / 3) * 3;
+			const int lastDifferentByte = findLastDifferentByte(row + searchStart, previousRow + searchStart, rowSizeInBytes - searchStart);
+			if(lastDifferentByte >= 0)
+			{
+				right = (searchStart + lastDifferentByte) / 3;
+			}
+			top = top < 0 ? y : top;
+			bottom = y;
+		}
+		FrameRectangle rectangle;
+		if(top >= 0)
+		{
+			rectangle.left = left;
+			rectangle.top = top;
+			rectangle.width = right - left + 1;
+			rectangle.height = bottom - top + 1;
+		}
+		return rectangle;
+	}
+
+
+	/// <summary>
+	/// Copies the rectangle specified of the RGB frame to destination as RGBA. If a previous frame is specified, the pixels which are equal to the previous
+	/// frame are made fully transparent, otherwise all pixels are opaque. 4 pixels are processed at a time.
+	/// </summary>
+	void createRgbaFrame(const uint8_t* frame, const uint8_t* previousFrame, int width, int height, const FrameRectangle& rectangle, 
+						 std::vector<uint8_t>& destination)
+	{
+		destination.resize((size_t)rectangle.width * rectangle.height * 4);
+		const size_t frameSizeInBytes = (size_t)width * height * 3;
+		const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+		for(int y = 0; y < rectangle.height; y++)
+		{
+			const size_t rowStart = ((size_t)(rectangle.top + y) * width + rectangle.left) * 3;
+			const uint8_t* source = frame + rowStart;
+			const uint8_t* previousSource = nullptr == previousFrame ? nullptr : previousFrame + rowStart;
+			uint8_t* destinationRow = destination.data() + (size_t)y * rectangle.width * 4;
+			int x = 0;
+			// a pixel is read as 4 bytes, so the last pixel of the frame has to be done in the scalar loop below.
+			for(; x + 4 <= rectangle.width && rowStart + (size_t)(x + 3) * 3 + 4 <= frameSizeInBytes; x += 4)
+			{
+				uint32_t pixels[4];
+				for(int i = 0; i < 4; i++)
+				{
+					memcpy(&pixels[i], source + (x + i) * 3, 4);
+				}
+				const __m128i rgb = _mm_and_si128(_mm_loadu_si128((const __m128i*)pixels), rgbMask);
+				__m128i rgba = _mm_or_si128(rgb, alphaMask);
+				if(nullptr != previousSource)
+				{
+					for(int i = 0; i < 4; i++)
+					{
+						memcpy(&pixels[i], previousSource + (x + i) * 3, 4);
+					}
+					const __m128i previousRgb = _mm_and_si128(_mm_loadu_si128((const __m128i*)pixels), rgbMask);
+					rgba = _mm_andnot_si128(_mm_cmpeq_epi32(rgb, previousRgb), rgba);
+				}
+				_mm_storeu_si128((__m128i*)(destinationRow + x * 4), rgba);
+			}
+			for(; x < rectangle.width; x++)
+			{
+				const uint8_t* pixel = source + x * 3;
+				const bool isUnchanged = nullptr != previousSource && 0 == memcmp(pixel, previousSource + x * 3, 3);
+				uint8_t* destinationPixel = destinationRow + x * 4;
+				destinationPixel[0] = isUnchanged ? 0 : pixel[0];
+				destinationPixel[1] = isUnchanged ? 0 : pixel[1];
+				destinationPixel[2] = isUnchanged ? 0 : pixel[2];
+				destinationPixel[3] = isUnchanged ? 0 : 0xFF;
+			}
+		}
+	}
+
+
+	/// <summary>
+	/// Copies the data of all IDAT chunks of the PNG file in memory specified to destination, which is the compressed image data.
+	/// </summary>
+	bool extractImageData(const std::vector<uint8_t>& pngFile, std::vector<uint8_t>& destination)
+	{
+		destination.clear();
+		size_t offset = sizeof(PngSignature);
+		while(offset + 12 <= pngFile.size())
+		{
+			const uint32_t length = readBigEndian32(pngFile.data() + offset);
+			const uint8_t* type = pngFile.data() + offset + 4;
+			if(offset + 12 + length > pngFile.size())
+			{
+				return false;
+			}
+			if(0 == memcmp(type, "IDAT", 4))
+			{
+				destination.insert(destination.end(), pngFile.data() + offset + 8, pngFile.data() + offset + 8 + length);
+			}
+			offset += 12 + length;
+		}
+		return destination.size() > 0;
+	}
+
+
+	EncodedFrame encodeFrame(const uint8_t* frame, const uint8_t* previousFrame, int width, int height)
+	{
+		EncodedFrame encodedFrame;
+		if(nullptr == previousFrame)
+		{
+			encodedFrame.rectangle.width = width;
+			encodedFrame.rectangle.height = height;
+		}
+		else
+		{
+			encodedFrame.isDelta = true;
+			encodedFrame.rectangle = findChangedRectangle(frame, previousFrame, width, height);
+			if(encodedFrame.rectangle.width <= 0)
+			{
+				// nothing changed, but a frame has at least 1 pixel. As it's equal to the previous frame, it becomes transparent.
+				encodedFrame.rectangle.width = 1;
+				encodedFrame.rectangle.height = 1;
+			}
+		}
+		std::vector<uint8_t> rgbaFrame;
+		createRgbaFrame(frame, previousFrame, width, height, encodedFrame.rectangle, rgbaFrame);
+		std::vector<uint8_t> pngFile;
+		encodedFrame.isEncoded = fpng::fpng_encode_image_to_memory(rgbaFrame.data(), encodedFrame.rectangle.width, encodedFrame.rectangle.height, 4, pngFile) &&
+								 extractImageData(pngFile, encodedFrame.compressedData);
+		return encodedFrame;
+	}
+}
+
+
+ApngWriter::~ApngWriter()
+{
+	close();
+}
+
+
+bool ApngWriter::open(const std::string& filename, int width, int height, uint16_t delayNumerator, uint16_t delayDenominator, uint32_t numberOfPlays)
+{
+	close();
+	if(width <= 0 || height <= 0 || fopen_s(&_file, filename.c_str(), "wb") != 0 || nullptr == _file)
+	{
+		_file = nullptr;
+		return false;
+	}
+	_width = width;
+	_height = height;
+	_delayNumerator = delayNumerator;
+	_delayDenominator = delayDenominator;
+	_numberOfPlays = numberOfPlays;
+	_numberOfFrames = 0;
+	_sequenceNumber = 0;
+	_previousFrame.clear();
+	fwrite(PngSignature, sizeof(PngSignature), 1, _file);
+	_numberOfBytesWritten = sizeof(PngSignature);
+	// all frames are RGBA so unchanged pixels of a delta frame can be transparent.
+	std::vector<uint8_t> headerData;
+	appendBigEndian32(headerData, width);
+	appendBigEndian32(headerData, height);
+	headerData.insert(headerData.end(), { 8, ColorTypeRgba, 0, 0, 0 });
+	writeChunk("IHDR", headerData);
+	writeChunk("acTL", createAnimationControlData());
+	return true;
+}
+
+
+bool ApngWriter::addFrames(const std::vector<const uint8_t*>& frames)
+{
+	if(!isOpen())
+	{
+		return false;
+	}
+	// every frame is a delta against its predecessor in the original frames, so the frames can be encoded independently of each other.
+	std::vector<EncodedFrame> encodedFrames(frames.size());
+	IGCS::WorkerPool::parallelFor((int)frames.size(), [&](int frameIndex)
+	{
+		const uint8_t* previousFrame = frameIndex > 0 ? frames[frameIndex - 1] : (_previousFrame.size() > 0 ? _previousFrame.data() : nullptr);
+		encodedFrames[frameIndex] = encodeFrame(frames[frameIndex], previousFrame, _width, _height);
+	});
+	for(const EncodedFrame& encodedFrame : encodedFrames)
+	{
+		if(!encodedFrame.isEncoded)
+		{
+			return false;
+		}
+		std::vector<uint8_t> frameControlData;
+		appendBigEndian32(frameControlData, _sequenceNumber++);
+		appendBigEndian32(frameControlData, encodedFrame.rectangle.width);
+		appendBigEndian32(frameControlData, encodedFrame.rectangle.height);
+		appendBigEndian32(frameControlData, encodedFrame.rectangle.left);
+		appendBigEndian32(frameControlData, encodedFrame.rectangle.top);
+		appendBigEndian16(frameControlData, _delayNumerator);
+		appendBigEndian16(frameControlData, _delayDenominator);
+		frameControlData.push_back(DisposeOpNone);
+		frameControlData.push_back(encodedFrame.isDelta ? BlendOpOver : BlendOpSource);
+		writeChunk("fcTL", frameControlData);
+		if(0 == _numberOfFrames)
+		{
+			// the first frame is the default image as well.
+			writeChunk("IDAT", encodedFrame.compressedData);
+		}
+		else
+		{
+			std::vector<uint8_t> frameData;
+			frameData.reserve(encodedFrame.compressedData.size() + 4);
+			appendBigEndian32(frameData, _sequenceNumber++);
+			frameData.insert(frameData.end(), encodedFrame.compressedData.begin(), encodedFrame.compressedData.end());
+			writeChunk("fdAT", frameData);
+		}
+		_numberOfFrames++;
+	}
+	if(frames.size() > 0)
+	{
+		_previousFrame.assign(frames.back(), frames.back() + (size_t)_width * _height * 3);
+	}
+	return true;
+}
+
+
+bool ApngWriter::close()
+{
+	if(!isOpen())
+	{
+		return false;
+	}
+	writeChunk("IEND", {});
+	// now the number of frames is known.
+	fseek(_file, AnimationControlChunkOffset, SEEK_SET);
+	const std::vector<uint8_t> animationControlData = createAnimationControlData();
+	IGCS::ImageFileWriters::writePngChunk(_file, "acTL", animationControlData.data(), (uint32_t)animationControlData.size());
+	const bool isValid = ferror(_file) == 0 && _numberOfFrames > 0;
+	fclose(_file);
+	_file = nullptr;
+	_previousFrame.clear();
+	return isValid;
+}
+
+
+void ApngWriter::writeChunk(const char* type, const std::vector<uint8_t>& data)
+{
+	IGCS::ImageFileWriters::writePngChunk(_file, type, data.data(), (uint32_t)data.size());
+	_numberOfBytesWritten += 12 + data.size();
+}
+
+
+std::vector<uint8_t> ApngWriter::createAnimationControlData()
+{
+	std::vector<uint8_t> animationControlData;
+	appendBigEndian32(animationControlData, _numberOfFrames);
+	appendBigEndian32(animationControlData, _numberOfPlays);
+	return animationControlData;
+}
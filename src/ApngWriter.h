@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Writes an animated PNG (APNG) from a sequence of 8 bit RGB frames. Frames are written as delta against the previous frame: only the rectangle which 
+/// changed is stored, and the pixels in it which didn't change are made transparent so they compress to almost nothing. The frames of a batch are 
+/// compressed in parallel with fpng and written in order. Viewers which don't support APNG show the first frame.
+/// </summary>
+class ApngWriter
+{
+public:
+	ApngWriter() = default;
+	~ApngWriter();
+
+	/// <summary>
+	/// Creates the file specified and writes the header. Every frame is shown for delayNumerator / delayDenominator seconds.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="delayNumerator"></param>
+	/// <param name="delayDenominator"></param>
+	/// <param name="numberOfPlays">the number of times the animation is played, 0 means it loops forever</param>
+	/// <returns>true if the file was created, false otherwise</returns>
+	bool open(const std::string& filename, int width, int height, uint16_t delayNumerator, uint16_t delayDenominator, uint32_t numberOfPlays);
+	/// <summary>
+	/// Appends the frames specified, which are RGB, 3 bytes per pixel, of the size passed to open. The frames are compressed in parallel.
+	/// </summary>
+	/// <returns>true if the frames were written, false otherwise</returns>
+	bool addFrames(const std::vector<const uint8_t*>& frames);
+	/// <summary>
+	/// Writes the number of frames in the header and closes the file. 
+	/// </summary>
+	/// <returns>true if the file is a valid animation, false otherwise, e.g. if no frames were added</returns>
+	bool close();
+
+	bool isOpen() { return nullptr != _file; }
+	int numberOfFrames() { return _numberOfFrames; }
+	uint64_t numberOfBytesWritten() { return _numberOfBytesWritten; }
+
+private:
+	void writeChunk(const char* type, const std::vector<uint8_t>& data);
+	std::vector<uint8_t> createAnimationControlData();
+
+	FILE* _file = nullptr;
+	int _width = 0;
+	int _height = 0;
+	uint16_t _delayNumerator = 1;
+	uint16_t _delayDenominator = 30;
+	uint32_t _numberOfPlays = 0;
+	int _numberOfFrames = 0;
+	uint32_t _sequenceNumber = 0;				// the fcTL and fdAT chunks share one sequence
+	uint64_t _numberOfBytesWritten = 0;
+	std::vector<uint8_t> _previousFrame;		// the last frame written, to compute the delta of the next frame against
+};
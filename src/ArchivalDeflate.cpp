@@ -0,0 +1,794 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ArchivalDeflate.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+namespace IGCS::ArchivalDeflate
+{
+	namespace
+	{
+		// the chunks compressed in parallel. Smaller chunks spread better over the cores, but every chunk boundary costs a little compression.
+		constexpr size_t ChunkSizeInBytes = 512 * 1024;
+		constexpr int WindowSize = 32768;
+		constexpr int MinimumMatchLength = 3;
+		constexpr int MaximumMatchLength = 258;
+		// the number of earlier positions with the same hash which are compared per position. Higher finds longer and closer matches, but is slower.
+		constexpr int MaximumChainLength = 128;
+		constexpr int HashBits = 15;
+		// the symbols of a chunk are written in blocks of at most this many symbols, each with its own huffman codes, so the codes follow the data.
+		constexpr size_t MaximumSymbolsPerBlock = 16384;
+		// the first parse uses the costs of the fixed huffman codes, every next parse the costs of the symbols chosen by the previous one.
+		constexpr int NumberOfParses = 2;
+		constexpr int NumberOfLiteralLengthSymbols = 286;
+		constexpr int NumberOfDistanceSymbols = 30;
+		constexpr int NumberOfCodeLengthSymbols = 19;
+		constexpr int EndOfBlockSymbol = 256;
+		constexpr int MaximumCodeLength = 15;
+		constexpr int MaximumCodeLengthCodeLength = 7;
+		constexpr size_t MaximumStoredBlockLength = 65535;
+
+		constexpr int LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		constexpr int LengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		constexpr int DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 
+										   8193, 12289, 16385, 24577 };
+		constexpr int DistanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		constexpr int CodeLengthOrder[NumberOfCodeLengthSymbols] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+		/// <summary>
+		/// The index in LengthBase and DistanceBase per match length and distance, computed once.
+		/// </summary>
+		struct CodeTables
+		{
+			std::array<uint8_t, MaximumMatchLength + 1> lengthCode {};
+			std::array<uint8_t, WindowSize + 1> distanceCode {};
+
+			CodeTables()
+			{
+				for(int code = 0; code < 29; code++)
+				{
+					const int end = (code < 28) ? LengthBase[code + 1] : MaximumMatchLength + 1;
+					for(int length = LengthBase[code]; length < end; length++)
+					{
+						lengthCode[length] = (uint8_t)code;
+					}
+				}
+				for(int code = 0; code < NumberOfDistanceSymbols; code++)
+				{
+					const int end = (code < NumberOfDistanceSymbols - 1) ? DistanceBase[code + 1] : WindowSize + 1;
+					for(int distance = DistanceBase[code]; distance < end; distance++)
+					{
+						distanceCode[distance] = (uint8_t)code;
+					}
+				}
+			}
+		};
+
+
+		const CodeTables& codeTables()
+		{
+			static const CodeTables tables;
+			return tables;
+		}
+
+
+		/// <summary>
+		/// A literal (distance 0) or a match of length lengthOrLiteral at the distance specified.
+		/// </summary>
+		struct Symbol
+		{
+			uint16_t lengthOrLiteral;
+			uint16_t distance;
+		};
+
+
+		/// <summary>
+		/// Writes bits least significant bit first, as deflate stores them.
+		/// </summary>
+		struct BitWriter
+		{
+			std::vector<uint8_t>& output;
+			uint64_t bits = 0;
+			int numberOfBits = 0;
+
+			explicit BitWriter(std::vector<uint8_t>& destination) : output(destination) {}
+
+			void write(uint32_t value, int count)
+			{
+				bits |= (uint64_t)value << numberOfBits;
+				numberOfBits += count;
+				while(numberOfBits >= 8)
+				{
+					output.push_back((uint8_t)bits);
+					bits >>= 8;
+					numberOfBits -= 8;
+				}
+			}
+
+			void alignToByte()
+			{
+				if(numberOfBits > 0)
+				{
+					output.push_back((uint8_t)bits);
+				}
+				bits = 0;
+				numberOfBits = 0;
+			}
+		};
+
+
+		/// <summary>
+		/// Computes huffman code lengths of at most maximumLength bits for the frequencies specified. If the lengths get too long, the frequencies are
+		/// flattened and the tree is built again, which costs a fraction of a percent compared to an optimal length limited code.
+		/// </summary>
+		void buildCodeLengths(const uint32_t* frequencies, int numberOfSymbols, int maximumLength, uint8_t* lengths)
+		{
+			std::vector<uint32_t> adjustedFrequencies(frequencies, frequencies + numberOfSymbols);
+			// a code with a single symbol is incomplete, which not every decoder accepts, so there are always at least two.
+			int numberOfUsedSymbols = (int)std::count_if(adjustedFrequencies.begin(), adjustedFrequencies.end(), [](uint32_t frequency) { return frequency > 0; });
+			for(int i = 0; numberOfUsedSymbols < 2 && i < numberOfSymbols; i++)
+			{
+				if(0 == adjustedFrequencies[i])
+				{
+					adjustedFrequencies[i] = 1;
+					numberOfUsedSymbols++;
+				}
+			}
+			using QueueEntry = std::pair<uint64_t, int>;
+			for(;;)
+			{
+				// the leaves come first, every internal node is added after its children, so its parent always has a higher index.
+				std::vector<int> leafSymbols;
+				std::vector<int> parents;
+				std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+				for(int symbol = 0; symbol < numberOfSymbols; symbol++)
+				{
+					if(adjustedFrequencies[symbol] > 0)
+					{
+						queue.push({ adjustedFrequencies[symbol], (int)leafSymbols.size() });
+						leafSymbols.push_back(symbol);
+						parents.push_back(-1);
+					}
+				}
+				while(queue.size() > 1)
+				{
+					const QueueEntry first = queue.top();
+					queue.pop();
+					const QueueEntry second = queue.top();
+					queue.pop();
+					const int node = (int)parents.size();
+					parents.push_back(-1);
+					parents[first.second] = node;
+					parents[second.second] = node;
+					queue.push({ first.first + second.first, node });
+				}
+				std::vector<int> depths(parents.size(), 0);
+				for(int node = (int)parents.size() - 2; node >= 0; node--)
+				{
+					depths[node] = depths[parents[node]] + 1;
+				}
+				const int largestDepth = *std::max_element(depths.begin(), depths.begin() + leafSymbols.size());
+				if(largestDepth <= maximumLength)
+				{
+					std::fill(lengths, lengths + numberOfSymbols, (uint8_t)0);
+					for(size_t leaf = 0; leaf < leafSymbols.size(); leaf++)
+					{
+						lengths[leafSymbols[leaf]] = (uint8_t)depths[leaf];
+					}
+					return;
+				}
+				for(uint32_t& frequency : adjustedFrequencies)
+				{
+					frequency = (frequency + 1) / 2;
+				}
+			}
+		}
+
+
+		/// <summary>
+		/// Computes the canonical codes for the code lengths specified, bit reversed so they can be written least significant bit first.
+		/// </summary>
+		void buildCodes(const uint8_t* lengths, int numberOfSymbols, uint16_t* codes)
+		{
+			int numberOfCodesPerLength[MaximumCodeLength + 1] = {};
+			for(int symbol = 0; symbol < numberOfSymbols; symbol++)
+			{
+				numberOfCodesPerLength[lengths[symbol]]++;
+			}
+			numberOfCodesPerLength[0] = 0;
+			int nextCode[MaximumCodeLength + 1] = {};
+			int code = 0;
+			for(int length = 1; length <= MaximumCodeLength; length++)
+			{
+				code = (code + numberOfCodesPerLength[length - 1]) << 1;
+				nextCode[length] = code;
+			}
+			for(int symbol = 0; symbol < numberOfSymbols; symbol++)
+			{
+				const int length = lengths[symbol];
+				if(0 == length)
+				{
+					codes[symbol] = 0;
+					continue;
+				}
+				const int symbolCode = nextCode[length]++;
+				int reversedCode = 0;
+				for(int bit = 0; bit < length; bit++)
+				{
+					reversedCode |= ((symbolCode >> bit) & 1) << (length - 1 - bit);
+				}
+				codes[symbol] = (uint16_t)reversedCode;
+			}
+		}
+
+
+		/// <summary>
+		/// The bit cost of every literal, match length and distance code, used by the shortest path search of the parse.
+		/// </summary>
+		struct SymbolCosts
+		{
+			float literalCost[256];
+			float lengthCost[MaximumMatchLength + 1];		// including the extra bits
+			float distanceCodeCost[NumberOfDistanceSymbols];	// including the extra bits
+
+			float matchCost(int length, int distance) const
+			{
+				return lengthCost[length] + distanceCodeCost[codeTables().distanceCode[distance]];
+			}
+		};
+
+
+		void setLengthCosts(SymbolCosts& costs, const float* literalLengthSymbolCost, const float* distanceSymbolCost)
+		{
+			const CodeTables& tables = codeTables();
+			for(int literal = 0; literal < 256; literal++)
+			{
+				costs.literalCost[literal] = literalLengthSymbolCost[literal];
+			}
+			for(int length = MinimumMatchLength; length <= MaximumMatchLength; length++)
+			{
+				const int code = tables.lengthCode[length];
+				costs.lengthCost[length] = literalLengthSymbolCost[257 + code] + (float)LengthExtraBits[code];
+			}
+			for(int code = 0; code < NumberOfDistanceSymbols; code++)
+			{
+				costs.distanceCodeCost[code] = distanceSymbolCost[code] + (float)DistanceExtraBits[code];
+			}
+		}
+
+
+		SymbolCosts fixedCodeCosts()
+		{
+			float literalLengthSymbolCost[288];
+			for(int symbol = 0; symbol < 288; symbol++)
+			{
+				literalLengthSymbolCost[symbol] = (symbol < 144) ? 8.0f : (symbol < 256) ? 9.0f : (symbol < 280) ? 7.0f : 8.0f;
+			}
+			float distanceSymbolCost[NumberOfDistanceSymbols];
+			std::fill(distanceSymbolCost, distanceSymbolCost + NumberOfDistanceSymbols, 5.0f);
+			SymbolCosts costs;
+			setLengthCosts(costs, literalLengthSymbolCost, distanceSymbolCost);
+			return costs;
+		}
+
+
+		/// <summary>
+		/// The cost of a symbol is the number of bits an ideal entropy coder spends on it given the symbols of a previous parse. Symbols which weren't used
+		/// get the cost of a symbol used once.
+		/// </summary>
+		SymbolCosts statisticalCosts(const std::vector<Symbol>& symbols)
+		{
+			const CodeTables& tables = codeTables();
+			uint32_t literalLengthFrequencies[NumberOfLiteralLengthSymbols] = {};
+			uint32_t distanceFrequencies[NumberOfDistanceSymbols] = {};
+			for(const Symbol& symbol : symbols)
+			{
+				if(0 == symbol.distance)
+				{
+					literalLengthFrequencies[symbol.lengthOrLiteral]++;
+				}
+				else
+				{
+					literalLengthFrequencies[257 + tables.lengthCode[symbol.lengthOrLiteral]]++;
+					distanceFrequencies[tables.distanceCode[symbol.distance]]++;
+				}
+			}
+			literalLengthFrequencies[EndOfBlockSymbol]++;
+			auto toCosts = [](const uint32_t* frequencies, int numberOfSymbols, float* costs)
+			{
+				uint64_t total = 0;
+				for(int symbol = 0; symbol < numberOfSymbols; symbol++)
+				{
+					total += frequencies[symbol];
+				}
+				const double logTotal = std::log2((double)(std::max)(total, (uint64_t)1));
+				for(int symbol = 0; symbol < numberOfSymbols; symbol++)
+				{
+					costs[symbol] = (float)(logTotal - std::log2((double)(std::max)(frequencies[symbol], 1u)));
+				}
+			};
+			float literalLengthSymbolCost[NumberOfLiteralLengthSymbols];
+			float distanceSymbolCost[NumberOfDistanceSymbols];
+			toCosts(literalLengthFrequencies, NumberOfLiteralLengthSymbols, literalLengthSymbolCost);
+			toCosts(distanceFrequencies, NumberOfDistanceSymbols, distanceSymbolCost);
+			SymbolCosts costs;
+			setLengthCosts(costs, literalLengthSymbolCost, distanceSymbolCost);
+			return costs;
+		}
+
+
+		/// <summary>
+		/// Finds matches with hash chains over the window before the current position, which can reach back into the data before the chunk.
+		/// </summary>
+		class MatchFinder
+		{
+		public:
+			MatchFinder(const uint8_t* data, size_t windowStart, size_t end) : _data(data), _windowStart(windowStart), _end(end), 
+																			   _head((size_t)1 << HashBits, -1), _previous(end - windowStart, -1)
+			{
+			}
+
+			/// <summary>
+			/// Adds the position specified to the hash chains. Positions have to be inserted in order.
+			/// </summary>
+			void insert(size_t position)
+			{
+				if(position + MinimumMatchLength > _end)
+				{
+					return;
+				}
+				const uint32_t hash = hashAt(position);
+				_previous[position - _windowStart] = _head[hash];
+				_head[hash] = (int32_t)(position - _windowStart);
+			}
+
+			/// <summary>
+			/// Returns the length of the longest match at the position specified, which has to be inserted already. For every length up to it, the shortest
+			/// distance with a match at least that long is stored in distancePerLength.
+			/// </summary>
+			int findMatches(size_t position, int maximumLength, uint16_t* distancePerLength)
+			{
+				if(maximumLength < MinimumMatchLength)
+				{
+					return 0;
+				}
+				const uint8_t* current = _data + position;
+				int longestLength = MinimumMatchLength - 1;
+				int candidate = _previous[position - _windowStart];
+				for(int chainLength = 0; candidate >= 0 && chainLength < MaximumChainLength; chainLength++)
+				{
+					const size_t candidatePosition = _windowStart + (size_t)candidate;
+					const size_t distance = position - candidatePosition;
+					if(distance > WindowSize)
+					{
+						break;
+					}
+					const uint8_t* earlier = _data + candidatePosition;
+					// the chain is walked from the closest position on, so only a longer match is worth more.
+					if(earlier[longestLength] == current[longestLength])
+					{
+						int length = 0;
+						while(length < maximumLength && earlier[length] == current[length])
+						{
+							length++;
+						}
+						if(length > longestLength)
+						{
+							for(int shorterLength = longestLength + 1; shorterLength <= length; shorterLength++)
+							{
+								distancePerLength[shorterLength] = (uint16_t)distance;
+							}
+							longestLength = length;
+							if(length >= maximumLength)
+							{
+								break;
+							}
+						}
+					}
+					candidate = _previous[candidate];
+				}
+				return (longestLength >= MinimumMatchLength) ? longestLength : 0;
+			}
+
+		private:
+			uint32_t hashAt(size_t position)
+			{
+				const uint32_t value = (uint32_t)_data[position] << 16 | (uint32_t)_data[position + 1] << 8 | _data[position + 2];
+				return (value * 2654435761u) >> (32 - HashBits);
+			}
+
+			const uint8_t* _data;
+			size_t _windowStart;
+			size_t _end;
+			std::vector<int32_t> _head;
+			std::vector<int32_t> _previous;		// per position since the window start, the previous position with the same hash
+		};
+
+
+		/// <summary>
+		/// Parses the chunk [start, end) into the cheapest sequence of literals and matches given the symbol costs, with a shortest path search in which
+		/// every byte position is a node.
+		/// </summary>
+		void parseChunk(const uint8_t* data, size_t start, size_t end, const SymbolCosts& costs, std::vector<Symbol>& symbols)
+		{
+			const size_t windowStart = (start > (size_t)WindowSize) ? start - WindowSize : 0;
+			MatchFinder matchFinder(data, windowStart, end);
+			for(size_t position = windowStart; position < start; position++)
+			{
+				matchFinder.insert(position);
+			}
+			const size_t chunkSize = end - start;
+			std::vector<float> pathCosts(chunkSize + 1, FLT_MAX);
+			std::vector<Symbol> cheapestSymbolTo(chunkSize + 1);
+			pathCosts[0] = 0.0f;
+			uint16_t distancePerLength[MaximumMatchLength + 1];
+			size_t offset = 0;
+			while(offset < chunkSize)
+			{
+				const size_t position = start + offset;
+				matchFinder.insert(position);
+				const float costHere = pathCosts[offset];
+				const uint8_t literal = data[position];
+				if(costHere + costs.literalCost[literal] < pathCosts[offset + 1])
+				{
+					pathCosts[offset + 1] = costHere + costs.literalCost[literal];
+					cheapestSymbolTo[offset + 1] = { literal, 0 };
+				}
+				const int maximumLength = (int)(std::min)((size_t)MaximumMatchLength, chunkSize - offset);
+				const int longestLength = matchFinder.findMatches(position, maximumLength, distancePerLength);
+				if(longestLength == MaximumMatchLength)
+				{
+					// a long repetition, like a flat area of an image. Taking the longest match is as good as it gets, and searching the positions inside
+					// it would cost a lot of time for nothing.
+					const float cost = costHere + costs.matchCost(longestLength, distancePerLength[longestLength]);
+					if(cost < pathCosts[offset + longestLength])
+					{
+						pathCosts[offset + longestLength] = cost;
+						cheapestSymbolTo[offset + longestLength] = { (uint16_t)longestLength, distancePerLength[longestLength] };
+					}
+					for(int skipped = 1; skipped < longestLength; skipped++)
+					{
+						matchFinder.insert(position + skipped);
+					}
+					offset += longestLength;
+					continue;
+				}
+				for(int length = MinimumMatchLength; length <= longestLength; length++)
+				{
+					const float cost = costHere + costs.matchCost(length, distancePerLength[length]);
+					if(cost < pathCosts[offset + length])
+					{
+						pathCosts[offset + length] = cost;
+						cheapestSymbolTo[offset + length] = { (uint16_t)length, distancePerLength[length] };
+					}
+				}
+				offset++;
+			}
+			// walk the cheapest path back from the end.
+			symbols.clear();
+			size_t pathPosition = chunkSize;
+			while(pathPosition > 0)
+			{
+				const Symbol& symbol = cheapestSymbolTo[pathPosition];
+				symbols.push_back(symbol);
+				pathPosition -= (0 == symbol.distance) ? 1 : symbol.lengthOrLiteral;
+			}
+			std::reverse(symbols.begin(), symbols.end());
+		}
+
+
+		void writeStoredBlocks(BitWriter& writer, const uint8_t* data, size_t size, bool isFinal)
+		{
+			size_t offset = 0;
+			do
+			{
+				const size_t length = (std::min)(size - offset, MaximumStoredBlockLength);
+				const bool isLast = offset + length >= size;
+				writer.write((isFinal && isLast) ? 1 : 0, 1);
+				writer.write(0, 2);
+				writer.alignToByte();
+				const uint8_t header[4] = { (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)~length, (uint8_t)(~length >> 8) };
+				writer.output.insert(writer.output.end(), header, header + 4);
+				writer.output.insert(writer.output.end(), data + offset, data + offset + length);
+				offset += length;
+			} while(offset < size);
+		}
+
+
+		/// <summary>
+		/// Writes the symbols specified as one block with dynamic huffman codes, or as stored blocks if the data doesn't compress.
+		/// </summary>
+		/// <param name="writer"></param>
+		/// <param name="symbols"></param>
+		/// <param name="numberOfSymbols"></param>
+		/// <param name="data">the bytes the symbols encode, for the stored blocks</param>
+		/// <param name="size">the number of bytes the symbols encode</param>
+		/// <param name="isFinal">true if this is the last block of the stream</param>
+		void writeBlock(BitWriter& writer, const Symbol* symbols, size_t numberOfSymbols, const uint8_t* data, size_t size, bool isFinal)
+		{
+			const CodeTables& tables = codeTables();
+			uint32_t literalLengthFrequencies[NumberOfLiteralLengthSymbols] = {};
+			uint32_t distanceFrequencies[NumberOfDistanceSymbols] = {};
+			for(size_t i = 0; i < numberOfSymbols; i++)
+			{
+				if(0 == symbols[i].distance)
+				{
+					literalLengthFrequencies[symbols[i].lengthOrLiteral]++;
+				}
+				else
+				{
+					literalLengthFrequencies[257 + tables.lengthCode[symbols[i].lengthOrLiteral]]++;
+					distanceFrequencies[tables.distanceCode[symbols[i].distance]]++;
+				}
+			}
+			literalLengthFrequencies[EndOfBlockSymbol] = 1;
+			uint8_t literalLengthLengths[NumberOfLiteralLengthSymbols];
+			uint8_t distanceLengths[NumberOfDistanceSymbols];
+			buildCodeLengths(literalLengthFrequencies, NumberOfLiteralLengthSymbols, MaximumCodeLength, literalLengthLengths);
+			buildCodeLengths(distanceFrequencies, NumberOfDistanceSymbols, MaximumCodeLength, distanceLengths);
+			int numberOfLiteralLengthCodes = NumberOfLiteralLengthSymbols;
+			while(numberOfLiteralLengthCodes > 257 && 0 == literalLengthLengths[numberOfLiteralLengthCodes - 1])
+			{
+				numberOfLiteralLengthCodes--;
+			}
+			int numberOfDistanceCodes = NumberOfDistanceSymbols;
+			while(numberOfDistanceCodes > 1 && 0 == distanceLengths[numberOfDistanceCodes - 1])
+			{
+				numberOfDistanceCodes--;
+			}
+
+			// the code lengths of both codes are run length encoded with the code length symbols: 16 repeats the previous length 3-6 times, 17 repeats
+			// zero 3-10 times, 18 repeats zero 11-138 times.
+			std::vector<uint8_t> allLengths(literalLengthLengths, literalLengthLengths + numberOfLiteralLengthCodes);
+			allLengths.insert(allLengths.end(), distanceLengths, distanceLengths + numberOfDistanceCodes);
+			std::vector<std::pair<uint8_t, uint8_t>> codeLengthSymbols;		// symbol, extra bits value
+			for(size_t i = 0; i < allLengths.size();)
+			{
+				const uint8_t length = allLengths[i];
+				size_t runLength = 1;
+				while(i + runLength < allLengths.size() && allLengths[i + runLength] == length)
+				{
+					runLength++;
+				}
+				i += runLength;
+				if(0 == length)
+				{
+					while(runLength >= 11)
+					{
+						const size_t repeat = (std::min)(runLength, (size_t)138);
+						codeLengthSymbols.push_back({ 18, (uint8_t)(repeat - 11) });
+						runLength -= repeat;
+					}
+					if(runLength >= 3)
+					{
+						codeLengthSymbols.push_back({ 17, (uint8_t)(runLength - 3) });
+						runLength = 0;
+					}
+				}
+				else
+				{
+					codeLengthSymbols.push_back({ length, 0 });
+					runLength--;
+					while(runLength >= 3)
+					{
+						const size_t repeat = (std::min)(runLength, (size_t)6);
+						codeLengthSymbols.push_back({ 16, (uint8_t)(repeat - 3) });
+						runLength -= repeat;
+					}
+				}
+				for(; runLength > 0; runLength--)
+				{
+					codeLengthSymbols.push_back({ length, 0 });
+				}
+			}
+			uint32_t codeLengthFrequencies[NumberOfCodeLengthSymbols] = {};
+			for(const auto& codeLengthSymbol : codeLengthSymbols)
+			{
+				codeLengthFrequencies[codeLengthSymbol.first]++;
+			}
+			uint8_t codeLengthLengths[NumberOfCodeLengthSymbols];
+			buildCodeLengths(codeLengthFrequencies, NumberOfCodeLengthSymbols, MaximumCodeLengthCodeLength, codeLengthLengths);
+			int numberOfCodeLengthCodes = NumberOfCodeLengthSymbols;
+			while(numberOfCodeLengthCodes > 4 && 0 == codeLengthLengths[CodeLengthOrder[numberOfCodeLengthCodes - 1]])
+			{
+				numberOfCodeLengthCodes--;
+			}
+
+			// fall back to stored blocks if they're smaller, which is the case for noise.
+			uint64_t numberOfBits = 3 + 5 + 5 + 4 + 3 * (uint64_t)numberOfCodeLengthCodes;
+			for(const auto& codeLengthSymbol : codeLengthSymbols)
+			{
+				const int symbol = codeLengthSymbol.first;
+				numberOfBits += codeLengthLengths[symbol] + ((16 == symbol) ? 2 : (17 == symbol) ? 3 : (18 == symbol) ? 7 : 0);
+			}
+			for(int symbol = 0; symbol < NumberOfLiteralLengthSymbols; symbol++)
+			{
+				numberOfBits += (uint64_t)literalLengthFrequencies[symbol] * (literalLengthLengths[symbol] + ((symbol > 256) ? LengthExtraBits[symbol - 257] : 0));
+			}
+			for(int symbol = 0; symbol < NumberOfDistanceSymbols; symbol++)
+			{
+				numberOfBits += (uint64_t)distanceFrequencies[symbol] * (distanceLengths[symbol] + DistanceExtraBits[symbol]);
+			}
+			const uint64_t numberOfStoredBits = (size / MaximumStoredBlockLength + 1) * 40 + (uint64_t)size * 8;
+			if(numberOfStoredBits < numberOfBits)
+			{
+				writeStoredBlocks(writer, data, size, isFinal);
+				return;
+			}
+
+			uint16_t literalLengthCodes[NumberOfLiteralLengthSymbols];
+			uint16_t distanceCodes[NumberOfDistanceSymbols];
+			uint16_t codeLengthCodes[NumberOfCodeLengthSymbols];
+			buildCodes(literalLengthLengths, NumberOfLiteralLengthSymbols, literalLengthCodes);
+			buildCodes(distanceLengths, NumberOfDistanceSymbols, distanceCodes);
+			buildCodes(codeLengthLengths, NumberOfCodeLengthSymbols, codeLengthCodes);
+			writer.write(isFinal ? 1 : 0, 1);
+			writer.write(2, 2);		// dynamic huffman codes
+			writer.write(numberOfLiteralLengthCodes - 257, 5);
+			writer.write(numberOfDistanceCodes - 1, 5);
+			writer.write(numberOfCodeLengthCodes - 4, 4);
+			for(int i = 0; i < numberOfCodeLengthCodes; i++)
+			{
+				writer.write(codeLengthLengths[CodeLengthOrder[i]], 3);
+			}
+			for(const auto& codeLengthSymbol : codeLengthSymbols)
+			{
+				const int symbol = codeLengthSymbol.first;
+				writer.write(codeLengthCodes[symbol], codeLengthLengths[symbol]);
+				if(symbol >= 16)
+				{
+					writer.write(codeLengthSymbol.second, (16 == symbol) ? 2 : (17 == symbol) ? 3 : 7);
+				}
+			}
+			for(size_t i = 0; i < numberOfSymbols; i++)
+			{
+				const Symbol& symbol = symbols[i];
+				if(0 == symbol.distance)
+				{
+					writer.write(literalLengthCodes[symbol.lengthOrLiteral], literalLengthLengths[symbol.lengthOrLiteral]);
+					continue;
+				}
+				const int lengthCode = tables.lengthCode[symbol.lengthOrLiteral];
+				writer.write(literalLengthCodes[257 + lengthCode], literalLengthLengths[257 + lengthCode]);
+				writer.write(symbol.lengthOrLiteral - LengthBase[lengthCode], LengthExtraBits[lengthCode]);
+				const int distanceCode = tables.distanceCode[symbol.distance];
+				writer.write(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+				writer.write(symbol.distance - DistanceBase[distanceCode], DistanceExtraBits[distanceCode]);
+			}
+			writer.write(literalLengthCodes[EndOfBlockSymbol], literalLengthLengths[EndOfBlockSymbol]);
+		}
+
+
+		/// <summary>
+		/// Compresses the chunk [start, end) into a sequence of deflate blocks which ends on a byte boundary, so the chunks can be concatenated.
+		/// </summary>
+		void compressChunk(const uint8_t* data, size_t start, size_t end, bool isLastChunk, std::vector<uint8_t>& compressedChunk)
+		{
+			std::vector<Symbol> symbols;
+			SymbolCosts costs = fixedCodeCosts();
+			for(int parse = 0; parse < NumberOfParses; parse++)
+			{
+				if(parse > 0)
+				{
+					costs = statisticalCosts(symbols);
+				}
+				parseChunk(data, start, end, costs, symbols);
+			}
+			BitWriter writer(compressedChunk);
+			size_t blockDataStart = start;
+			for(size_t blockStart = 0; blockStart < symbols.size(); blockStart += MaximumSymbolsPerBlock)
+			{
+				const size_t numberOfSymbols = (std::min)(MaximumSymbolsPerBlock, symbols.size() - blockStart);
+				size_t blockSize = 0;
+				for(size_t i = blockStart; i < blockStart + numberOfSymbols; i++)
+				{
+					blockSize += (0 == symbols[i].distance) ? 1 : symbols[i].lengthOrLiteral;
+				}
+				const bool isLastBlock = blockStart + numberOfSymbols >= symbols.size();
+				writeBlock(writer, symbols.data() + blockStart, numberOfSymbols, data + blockDataStart, blockSize, isLastChunk && isLastBlock);
+				blockDataStart += blockSize;
+			}
+			if(!isLastChunk)
+			{
+				// an empty stored block aligns the chunk to a byte boundary without ending the stream.
+				writeStoredBlocks(writer, data, 0, false);
+			}
+			writer.alignToByte();
+		}
+
+
+		uint32_t adler32(const uint8_t* data, size_t size)
+		{
+			// the largest number of bytes after which the sums can't overflow yet.
+			constexpr size_t MaximumBytesPerModulo = 5552;
+			uint32_t a = 1;
+			uint32_t b = 0;
+			while(size > 0)
+			{
+				const size_t length = (std::min)(size, MaximumBytesPerModulo);
+				for(size_t i = 0; i < length; i++)
+				{
+					a += data[i];
+					b += a;
+				}
+				a %= 65521;
+				b %= 65521;
+				data += length;
+				size -= length;
+			}
+			return (b << 16) | a;
+		}
+	}
+
+
+	void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& zlibStream)
+	{
+		zlibStream.clear();
+		// deflate with a 32KB window and the highest compression level.
+		zlibStream.push_back(0x78);
+		zlibStream.push_back(0xda);
+		if(0 == size)
+		{
+			// a final block with the fixed codes which only holds the end of block symbol.
+			zlibStream.push_back(0x03);
+			zlibStream.push_back(0x00);
+		}
+		else
+		{
+			const int numberOfChunks = (int)((size + ChunkSizeInBytes - 1) / ChunkSizeInBytes);
+			std::vector<std::vector<uint8_t>> compressedChunks(numberOfChunks);
+			IGCS::WorkerPool::parallelFor(numberOfChunks, [&](int chunkIndex)
+				{
+					const size_t start = (size_t)chunkIndex * ChunkSizeInBytes;
+					const size_t end = (std::min)(start + ChunkSizeInBytes, size);
+					compressChunk(data, start, end, chunkIndex == numberOfChunks - 1, compressedChunks[chunkIndex]);
+				});
+			for(const std::vector<uint8_t>& compressedChunk : compressedChunks)
+			{
+				zlibStream.insert(zlibStream.end(), compressedChunk.begin(), compressedChunk.end());
+			}
+		}
+		const uint32_t checksum = adler32(data, size);
+		zlibStream.push_back((uint8_t)(checksum >> 24));
+		zlibStream.push_back((uint8_t)(checksum >> 16));
+		zlibStream.push_back((uint8_t)(checksum >> 8));
+		zlibStream.push_back((uint8_t)checksum);
+	}
+}
@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ArchivalRecompressor.h"
+#include "ImageFileWriters.h"
+#include "fpng.h"
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace
+{
+	bool readFile(const std::string& filename, std::vector<uint8_t>& contents)
+	{
+		FILE* file = nullptr;
+		if(fopen_s(&file, filename.c_str(), "rb") != 0 || nullptr == file)
+		{
+			return false;
+		}
+		contents.clear();
+		uint8_t buffer[64 * 1024];
+		for(size_t numberOfBytesRead = fread(buffer, 1, sizeof(buffer), file); numberOfBytesRead > 0; numberOfBytesRead = fread(buffer, 1, sizeof(buffer), file))
+		{
+			contents.insert(contents.end(), buffer, buffer + numberOfBytesRead);
+		}
+		fclose(file);
+		return true;
+	}
+}
+
+
+ArchivalRecompressor::~ArchivalRecompressor()
+{
+	// this runs under the loader lock when the addon is unloaded, so the thread isn't joined here. It has been stopped when the last effect runtime was
+	// destroyed, so there's normally nothing left to wait for.
+	cancel();
+	if(_recompressThread.joinable())
+	{
+		_recompressThread.detach();
+	}
+}
+
+
+void ArchivalRecompressor::enqueueFolder(const std::string& folder, const std::string& sessionTypeDescription)
+{
+	std::vector<QueuedFile> filenames;
+	std::error_code errorCode;
+	for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(folder, errorCode))
+	{
+		if(entry.is_regular_file(errorCode) && entry.path().extension() == ".png")
+		{
+			filenames.push_back({ entry.path().string(), sessionTypeDescription });
+		}
+	}
+	if(filenames.empty())
+	{
+		return;
+	}
+	std::scoped_lock lock(_mutex);
+	if(_isStopping)
+	{
+		return;
+	}
+	if(!_isRecompressing)
+	{
+		// the previous thread has finished or was never started.
+		if(_recompressThread.joinable())
+		{
+			_recompressThread.join();
+		}
+		_numberOfFilesQueued = 0;
+		_numberOfFilesDone = 0;
+		_numberOfBytesBefore = 0;
+		_numberOfBytesAfter = 0;
+	}
+	_files.insert(_files.end(), filenames.begin(), filenames.end());
+	_numberOfFilesQueued += (int)filenames.size();
+	if(!_isRecompressing)
+	{
+		_isRecompressing = true;
+		_recompressThread = std::thread(&ArchivalRecompressor::recompressFiles, this);
+	}
+}
+
+
+void ArchivalRecompressor::cancel()
+{
+	std::scoped_lock lock(_mutex);
+	_numberOfFilesQueued -= (int)_files.size();
+	_files.clear();
+}
+
+
+void ArchivalRecompressor::stop()
+{
+	{
+		std::scoped_lock lock(_mutex);
+		_isStopping = true;
+		_numberOfFilesQueued -= (int)_files.size();
+		_files.clear();
+	}
+	// enqueueFolder can't start a new thread while stopping, so the thread can be joined outside the lock, which the thread needs to finish.
+	if(_recompressThread.joinable())
+	{
+		_recompressThread.join();
+	}
+	std::scoped_lock lock(_mutex);
+	_isStopping = false;
+}
+
+
+bool ArchivalRecompressor::isBusy()
+{
+	std::scoped_lock lock(_mutex);
+	return _isRecompressing;
+}
+
+
+void ArchivalRecompressor::recompressFiles()
+{
+	// the manifest of the folder of the files being recompressed. It's kept open for all files of the folder, so its JSON file is written once.
+	SessionManifest manifest;
+	std::string manifestFolder;
+	for(;;)
+	{
+		QueuedFile file;
+		{
+			std::scoped_lock lock(_mutex);
+			if(_files.empty() && !manifest.isOpen())
+			{
+				_isRecompressing = false;
+				return;
+			}
+			if(!_files.empty())
+			{
+				file = std::move(_files.front());
+				_files.pop_front();
+			}
+		}
+		const std::string folder = std::filesystem::path(file.filename).parent_path().string();
+		if(file.filename.empty() || folder != manifestFolder)
+		{
+			// done with the previous folder. It's closed outside the lock, as writing its JSON file takes a while for a large session.
+			manifest.close();
+			manifestFolder.clear();
+			if(file.filename.empty())
+			{
+				continue;
+			}
+			manifestFolder = folder;
+			// keeps all shots. A session without a manifest just isn't updated.
+			manifest.reopen(folder, file.sessionTypeDescription, INT_MAX);
+		}
+		recompressFile(file.filename, manifest);
+		_numberOfFilesDone++;
+	}
+}
+
+
+bool ArchivalRecompressor::recompressFile(const std::string& filename, SessionManifest& manifest)
+{
+	std::vector<uint8_t> fileContents;
+	if(!readFile(filename, fileContents))
+	{
+		return false;
+	}
+
+	// fpng only decodes the files it wrote itself, which are exactly the files which benefit from being recompressed.
+	std::vector<uint8_t> pixels;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t numberOfChannels = 0;
+	if(fpng::fpng_decode_memory(fileContents.data(), (uint32_t)fileContents.size(), pixels, width, height, numberOfChannels, 3) != fpng::FPNG_DECODE_SUCCESS 
+	   || numberOfChannels != 3)
+	{
+		return false;
+	}
+	const std::string temporaryFilename = filename + ".tmp";
+	if(!IGCS::ImageFileWriters::writeArchivalPng(temporaryFilename, pixels.data(), (int)width, (int)height))
+	{
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+	std::vector<uint8_t> recompressedContents;
+	if(!readFile(temporaryFilename, recompressedContents) || recompressedContents.size() >= fileContents.size())
+	{
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryFilename, filename, errorCode);
+	if(errorCode)
+	{
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+	// the manifest lists the size and hash of the file as it is on disk, so a check against it doesn't flag the recompressed file as damaged.
+	manifest.updateShotFile(std::filesystem::path(filename).filename().string(), (uint32_t)recompressedContents.size(),
+							fpng::fpng_crc32(recompressedContents.data(), recompressedContents.size()));
+	_numberOfBytesBefore += fileContents.size();
+	_numberOfBytesAfter += recompressedContents.size();
+	return true;
+}
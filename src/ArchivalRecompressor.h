@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "SessionManifest.h"
+
+/// <summary>
+/// Recompresses the PNG files of finished sessions with ImageFileWriters::writeArchivalPng on a background thread, which uses all cores. Shots are
+/// written with fpng first, so a session isn't slowed down, and are replaced afterwards by the smaller archival PNGs. Only files written by fpng are
+/// recompressed, which skips 16 bit depth maps, animated PNGs and files which have been recompressed already. A file is only replaced if the result is
+/// smaller, and is never left half written: the new file is written next to it and renamed over it. The size and hash of a replaced file are updated in
+/// the manifest of its session, if it has one.
+/// </summary>
+class ArchivalRecompressor
+{
+public:
+	ArchivalRecompressor() = default;
+	~ArchivalRecompressor();
+
+	/// <summary>
+	/// Queues the PNG files in the folder specified (not in its subfolders) and starts recompressing them if that's not already happening. Returns immediately.
+	/// sessionTypeDescription is the type of the session, which is written in the manifest of the session when it's updated.
+	/// </summary>
+	void enqueueFolder(const std::string& folder, const std::string& sessionTypeDescription);
+	/// <summary>
+	/// Throws away the files which haven't been recompressed yet. The file being recompressed is finished first. Doesn't block.
+	/// </summary>
+	void cancel();
+	/// <summary>
+	/// Cancels and waits for the file being recompressed to be finished. Blocks, so it's called when the last effect runtime is destroyed and not from
+	/// DllMain, where joining the thread deadlocks on the loader lock. Folders can be queued again afterwards.
+	/// </summary>
+	void stop();
+
+	bool isBusy();
+	int numberOfFilesQueued() { return _numberOfFilesQueued; }
+	int numberOfFilesDone() { return _numberOfFilesDone; }
+	uint64_t numberOfBytesBefore() { return _numberOfBytesBefore; }
+	uint64_t numberOfBytesAfter() { return _numberOfBytesAfter; }
+
+private:
+	void recompressFiles();
+	/// <summary>
+	/// Recompresses the file specified and updates it in the manifest specified. Returns false if it isn't a PNG written by fpng or couldn't be replaced,
+	/// in which case it's left as it was.
+	/// </summary>
+	bool recompressFile(const std::string& filename, SessionManifest& manifest);
+
+	struct QueuedFile
+	{
+		std::string filename;
+		std::string sessionTypeDescription;
+	};
+
+	std::mutex _mutex;
+	std::deque<QueuedFile> _files;					// guarded by _mutex
+	bool _isRecompressing = false;					// guarded by _mutex
+	bool _isStopping = false;						// guarded by _mutex
+	std::thread _recompressThread;
+	std::atomic<int> _numberOfFilesQueued = 0;		// since the recompressor was last idle, as is the rest
+	std::atomic<int> _numberOfFilesDone = 0;
+	std::atomic<uint64_t> _numberOfBytesBefore = 0;
+	std::atomic<uint64_t> _numberOfBytesAfter = 0;
+};
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "AsyncReadbackRing.h"
+
+bool AsyncReadbackRing::initialize(std::unique_ptr<ReadbackDevice> device, int numberOfSlots)
+{
+	release();
+	if(nullptr == device || numberOfSlots <= 0 || !device->createSlots(numberOfSlots))
+	{
+		return false;
+	}
+	_device = std::move(device);
+	_shotPerSlot.resize(numberOfSlots);
+	for(int i = numberOfSlots - 1; i >= 0; i--)
+	{
+		_freeSlots.push_back(i);
+	}
+	return true;
+}
+
+
+bool AsyncReadbackRing::requestReadback(GrabbedFrame shotWithoutData)
+{
+	if(!isInitialized() || _freeSlots.size() <= 0)
+	{
+		return false;
+	}
+	const int slot = _freeSlots.back();
+	_freeSlots.pop_back();
+	_device->copyBackbufferToSlot(slot);
+	_shotPerSlot[slot] = std::move(shotWithoutData);
+	_slotsInFlight.push_back(slot);
+	return true;
+}
+
+
+void AsyncReadbackRing::collectCompletedReadbacks(std::vector<GrabbedFrame>& completedShots)
+{
+	if(!isInitialized())
+	{
+		return;
+	}
+	while(isOldestReadbackComplete())
+	{
+		GrabbedFrame shot;
+		std::vector<uint8_t> data((size_t)width() * height() * 3);
+		if(readOldestReadback(shot, data.data()))
+		{
+			shot.data = std::move(data);
+		}
+		// otherwise the shot is handed out without data, so the receiver knows it failed.
+		completedShots.push_back(std::move(shot));
+	}
+}
+
+
+bool AsyncReadbackRing::isOldestReadbackComplete()
+{
+	// only the oldest readback is checked, so shots are handed out in order even if the gpu completes them out of order.
+	return isInitialized() && _slotsInFlight.size() > 0 && _device->isCopyComplete(_slotsInFlight.front());
+}
+
+
+bool AsyncReadbackRing::readOldestReadback(GrabbedFrame& shot, uint8_t* destination)
+{
+	const int slot = _slotsInFlight.front();
+	_slotsInFlight.pop_front();
+	shot = std::move(_shotPerSlot[slot]);
+	const bool isRead = nullptr != destination && _device->readSlot(slot, destination);
+	if(isRead)
+	{
+		_device->readDepthSlot(slot, shot.depth);
+	}
+	_shotPerSlot[slot] = GrabbedFrame();
+	_freeSlots.push_back(slot);
+	return isRead;
+}
+
+
+void AsyncReadbackRing::release()
+{
+	if(nullptr != _device)
+	{
+		_device->destroySlots();
+		_device.reset();
+	}
+	_shotPerSlot.clear();
+	_freeSlots.clear();
+	_slotsInFlight.clear();
+}
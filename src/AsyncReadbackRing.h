@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "GrabbedFrame.h"
+
+/// <summary>
+/// The gpu side of an AsyncReadbackRing: copies the backbuffer into one of a fixed number of readback slots and reads a slot once the gpu has completed the
+/// copy. Abstract so the ring doesn't depend on a graphics api, and so AsyncReadbackRingTest can drive the ring with a fake device.
+/// </summary>
+class ReadbackDevice
+{
+public:
+	virtual ~ReadbackDevice() = default;
+
+	/// <summary>
+	/// Creates the resources for the number of slots specified, matching the current backbuffer. Returns false if the backbuffer can't be read this way.
+	/// </summary>
+	virtual bool createSlots(int numberOfSlots) = 0;
+	virtual void destroySlots() = 0;
+	/// <summary>
+	/// Records a copy of the current backbuffer into the slot specified and submits it, without waiting for the gpu.
+	/// </summary>
+	virtual void copyBackbufferToSlot(int slot) = 0;
+	/// <summary>
+	/// Returns true if the gpu has completed the last copy into the slot specified.
+	/// </summary>
+	virtual bool isCopyComplete(int slot) = 0;
+	/// <summary>
+	/// Reads the slot specified as RGB, 3 bytes per pixel, into destination, which has to be at least width * height * 3 bytes. Only valid after 
+	/// isCopyComplete returned true.
+	/// </summary>
+	virtual bool readSlot(int slot, uint8_t* destination) = 0;
+	/// <summary>
+	/// Reads the depth copied along with the slot specified as raw depth, 1 float per pixel. Returns false if the device doesn't copy depth or the depth 
+	/// couldn't be copied for this slot.
+	/// </summary>
+	virtual bool readDepthSlot(int slot, std::vector<float>& rawDepth) { return false; }
+	virtual int width() = 0;
+	virtual int height() = 0;
+};
+
+
+/// <summary>
+/// Reads shots from the backbuffer without stalling the render thread: a shot is copied into a free slot and read a frame or more later, once the gpu has
+/// completed the copy. Shots are handed out in the order they were requested. 
+/// </summary>
+class AsyncReadbackRing
+{
+public:
+	AsyncReadbackRing() = default;
+	~AsyncReadbackRing() = default;
+
+	/// <summary>
+	/// Creates the slots on the device specified. Returns false if the device can't create them, in which case the ring isn't initialized.
+	/// </summary>
+	bool initialize(std::unique_ptr<ReadbackDevice> device, int numberOfSlots);
+	/// <summary>
+	/// Starts the readback of the current backbuffer for the shot specified, which contains everything but the pixel data. Returns false if all slots are 
+	/// in flight, in which case the shot has to be requested again in a later frame.
+	/// </summary>
+	bool requestReadback(GrabbedFrame shotWithoutData);
+	/// <summary>
+	/// Appends the shots of which the readback has been completed to completedShots, in the order they were requested, and frees their slots.
+	/// </summary>
+	void collectCompletedReadbacks(std::vector<GrabbedFrame>& completedShots);
+	/// <summary>
+	/// Returns true if the readback of the oldest shot in flight has been completed.
+	/// </summary>
+	bool isOldestReadbackComplete();
+	/// <summary>
+	/// Reads the pixel data of the oldest shot in flight, which has to be complete, into destination, so it can be read straight into memory owned by 
+	/// someone else. destination has to be at least width() * height() * 3 bytes. If it's nullptr the pixel data is dropped. The slot is freed and shot 
+	/// receives everything but the pixel data, plus the depth if the device copies it.
+	/// </summary>
+	/// <returns>true if the pixel data was read, false if it was dropped or couldn't be read</returns>
+	bool readOldestReadback(GrabbedFrame& shot, uint8_t* destination);
+	/// <summary>
+	/// Destroys the slots and drops the readbacks in flight.
+	/// </summary>
+	void release();
+
+	bool isInitialized() { return nullptr != _device; }
+	bool hasPendingReadbacks() { return _slotsInFlight.size() > 0; }
+	int width() { return isInitialized() ? _device->width() : 0; }
+	int height() { return isInitialized() ? _device->height() : 0; }
+
+private:
+	std::unique_ptr<ReadbackDevice> _device;
+	std::vector<GrabbedFrame> _shotPerSlot;
+	std::vector<int> _freeSlots;
+	std::deque<int> _slotsInFlight;			// in the order the readbacks were requested
+};
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// AsyncReadbackRingTest: drives AsyncReadbackRing with a fake ReadbackDevice, which completes the copies in the order the test says and fails the reads
+// the test says, so the ordering of the ring and its handling of full and failed slots are checked without a gpu.
+//
+// Usage: AsyncReadbackRingTest
+// Returns 0 if the ring behaves as specified, 1 otherwise.
+#include "stdafx.h"
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <vector>
+#include "AsyncReadbackRing.h"
+
+namespace
+{
+	constexpr int FrameWidth = 8;
+	constexpr int FrameHeight = 4;
+	constexpr int NumberOfSlots = 3;
+
+	/// <summary>
+	/// A readback device without a gpu. Every copy gets an id, in the order the copies are made, and the pixels of a slot are that id, so a shot can be
+	/// matched with the copy made for it. A copy is only complete once the test completes it, and the reads of the copies the test fails fail.
+	/// </summary>
+	class FakeReadbackDevice : public ReadbackDevice
+	{
+	public:
+		bool createSlots(int numberOfSlots) override
+		{
+			_copyIdPerSlot.assign(numberOfSlots, -1);
+			return true;
+		}
+
+		void destroySlots() override { _copyIdPerSlot.clear(); }
+
+		void copyBackbufferToSlot(int slot) override { _copyIdPerSlot[slot] = _numberOfCopies++; }
+
+		bool isCopyComplete(int slot) override { return _completedCopies.count(_copyIdPerSlot[slot]) > 0; }
+
+		bool readSlot(int slot, uint8_t* destination) override
+		{
+			if(_failedCopies.count(_copyIdPerSlot[slot]) > 0)
+			{
+				return false;
+			}
+			for(int i = 0; i < FrameWidth * FrameHeight * 3; i++)
+			{
+				destination[i] = (uint8_t)_copyIdPerSlot[slot];
+			}
+			return true;
+		}
+
+		bool readDepthSlot(int slot, std::vector<float>& rawDepth) override
+		{
+			rawDepth.assign(FrameWidth * FrameHeight, (float)_copyIdPerSlot[slot]);
+			return true;
+		}
+
+		int width() override { return FrameWidth; }
+		int height() override { return FrameHeight; }
+
+		void completeCopy(int copyId) { _completedCopies.insert(copyId); }
+		void failCopy(int copyId) { _failedCopies.insert(copyId); }
+
+	private:
+		std::vector<int> _copyIdPerSlot;
+		std::set<int> _completedCopies;
+		std::set<int> _failedCopies;
+		int _numberOfCopies = 0;
+	};
+
+
+	bool check(bool condition, const char* description)
+	{
+		if(!condition)
+		{
+			printf("FAILED: %s\n", description);
+		}
+		return condition;
+	}
+
+
+	bool requestShot(AsyncReadbackRing& ring, int shotIndex)
+	{
+		GrabbedFrame shot;
+		shot.shotIndex = shotIndex;
+		return ring.requestReadback(shot);
+	}
+
+
+	/// <summary>
+	/// Checks the shots specified are the shots with the indices specified, in that order, with the pixels and depth of the copy made for them, or without
+	/// data if their read failed. The copies are made in the order the shots are requested, so the copy of a shot has the id of its shot index.
+	/// </summary>
+	bool checkShots(const std::vector<GrabbedFrame>& shots, const std::vector<int>& expectedShotIndices, const std::set<int>& failedShotIndices)
+	{
+		if(!check(shots.size() == expectedShotIndices.size(), "the wrong number of shots was completed"))
+		{
+			return false;
+		}
+		bool isMatch = true;
+		for(size_t i = 0; i < shots.size(); i++)
+		{
+			const GrabbedFrame& shot = shots[i];
+			isMatch &= check(shot.shotIndex == expectedShotIndices[i], "a shot was completed out of the order it was requested in");
+			if(failedShotIndices.count(shot.shotIndex) > 0)
+			{
+				isMatch &= check(shot.data.empty() && shot.depth.empty(), "a shot of which the read failed has data");
+				continue;
+			}
+			isMatch &= check(shot.data.size() == (size_t)FrameWidth * FrameHeight * 3 && shot.data[0] == (uint8_t)shot.shotIndex && 
+							 shot.data.back() == (uint8_t)shot.shotIndex, "a shot has the pixels of another shot's copy");
+			isMatch &= check(shot.depth.size() == (size_t)FrameWidth * FrameHeight && shot.depth[0] == (float)shot.shotIndex, "a shot has the wrong depth");
+		}
+		return isMatch;
+	}
+}
+
+
+int main()
+{
+	AsyncReadbackRing ring;
+	auto ownedDevice = std::make_unique<FakeReadbackDevice>();
+	FakeReadbackDevice* device = ownedDevice.get();
+	bool isMatch = check(ring.initialize(std::move(ownedDevice), NumberOfSlots), "the ring can't be initialized");
+
+	// all slots in flight: the next request has to wait.
+	for(int i = 0; i < NumberOfSlots; i++)
+	{
+		isMatch &= check(requestShot(ring, i), "a readback was refused while a slot was free");
+	}
+	isMatch &= check(!requestShot(ring, NumberOfSlots), "a readback was accepted while every slot was in flight");
+
+	// the gpu completes the newer copies first: nothing is handed out until the oldest is complete too.
+	std::vector<GrabbedFrame> completedShots;
+	device->completeCopy(2);
+	device->completeCopy(1);
+	ring.collectCompletedReadbacks(completedShots);
+	isMatch &= check(completedShots.empty(), "a shot was handed out before the shots requested before it");
+	device->failCopy(1);
+	device->completeCopy(0);
+	ring.collectCompletedReadbacks(completedShots);
+	isMatch &= checkShots(completedShots, { 0, 1, 2 }, { 1 });
+	isMatch &= check(!ring.hasPendingReadbacks(), "slots are still in flight after all copies were collected");
+
+	// the slots are free again. The oldest is completed last once more, with a failed read in the middle.
+	completedShots.clear();
+	for(int i = 3; i < 3 + NumberOfSlots; i++)
+	{
+		isMatch &= check(requestShot(ring, i), "a freed slot can't be used again");
+	}
+	isMatch &= check(!requestShot(ring, 3 + NumberOfSlots), "a readback was accepted while every slot was in flight");
+	device->completeCopy(3);
+	device->completeCopy(5);
+	ring.collectCompletedReadbacks(completedShots);
+	isMatch &= checkShots(completedShots, { 3 }, {});
+	completedShots.clear();
+	device->failCopy(4);
+	device->completeCopy(4);
+	ring.collectCompletedReadbacks(completedShots);
+	isMatch &= checkShots(completedShots, { 4, 5 }, { 4 });
+
+	ring.release();
+	isMatch &= check(!ring.isInitialized() && !requestShot(ring, 6), "the ring accepts readbacks after it has been released");
+	printf("%s\n", isMatch ? "OK" : "FAILED");
+	return isMatch ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "BackbufferReader.h"
+#include "DepthBufferReader.h"
+#include <cstring>
+
+using namespace reshade::api;
+
+namespace
+{
+	/// <summary>
+	/// Returns the box in the backbuffer for the capture region specified. 
+	/// </summary>
+	subresource_box toSubresourceBox(const CaptureRegion& region)
+	{
+		subresource_box box = {};
+		box.left = region.left;
+		box.top = region.top;
+		box.right = region.left + region.width;
+		box.bottom = region.top + region.height;
+		box.back = 1;
+		return box;
+	}
+}
+
+
+namespace IGCS::BackbufferReader
+{
+	HighBitDepthPixelFormat getBackbufferPixelFormat(effect_runtime* runtime)
+	{
+		const resource_desc backbufferDescription = runtime->get_device()->get_resource_desc(runtime->get_current_back_buffer());
+		switch(format_to_typeless(backbufferDescription.texture.format))
+		{
+		case format::r10g10b10a2_typeless:
+			return HighBitDepthPixelFormat::R10G10B10A2;
+		case format::b10g10r10a2_typeless:
+			return HighBitDepthPixelFormat::B10G10R10A2;
+		case format::r16g16b16a16_typeless:
+			return HighBitDepthPixelFormat::R16G16B16A16Float;
+		}
+		return HighBitDepthPixelFormat::Unsupported;
+	}
+
+
+	bool readBackbuffer(effect_runtime* runtime, const CaptureRegion& region, BackbufferData& destination)
+	{
+		const HighBitDepthPixelFormat pixelFormat = getBackbufferPixelFormat(runtime);
+		if(HighBitDepthPixelFormat::Unsupported == pixelFormat)
+		{
+			return false;
+		}
+		device* const device = runtime->get_device();
+		command_queue* const queue = runtime->get_command_queue();
+		const resource backbuffer = runtime->get_current_back_buffer();
+		const resource_desc backbufferDescription = device->get_resource_desc(backbuffer);
+
+		// copy the region of the backbuffer to a texture the cpu can read, the same way ReShade takes its own screenshots.
+		const format stagingFormat = format_to_default_typed(backbufferDescription.texture.format, 0);
+		const subresource_box sourceBox = toSubresourceBox(region);
+		resource stagingTexture = {};
+		if(!device->create_resource(resource_desc(region.width, region.height, 1, 1, stagingFormat, 1, memory_heap::gpu_to_cpu, resource_usage::copy_dest), nullptr, 
+									resource_usage::copy_dest, &stagingTexture))
+		{
+			return false;
+		}
+		command_list* const commandList = queue->get_immediate_command_list();
+		commandList->barrier(backbuffer, resource_usage::present, resource_usage::copy_source);
+		commandList->copy_texture_region(backbuffer, 0, &sourceBox, stagingTexture, 0, nullptr);
+		commandList->barrier(backbuffer, resource_usage::copy_source, resource_usage::present);
+		queue->flush_immediate_command_list();
+		queue->wait_idle();
+
+		subresource_data mappedData = {};
+		const bool isMapped = device->map_texture_region(stagingTexture, 0, nullptr, map_access::read_only, &mappedData);
+		if(isMapped)
+		{
+			// the row pitch of the mapped texture can be larger than a row, so the rows are copied tightly packed.
+			const uint32_t bytesPerPixel = HighBitDepthPixelFormat::R16G16B16A16Float == pixelFormat ? 8 : 4;
+			destination.width = region.width;
+			destination.height = region.height;
+			destination.rowPitch = destination.width * bytesPerPixel;
+			destination.pixelFormat = pixelFormat;
+			destination.data.resize((size_t)destination.rowPitch * destination.height);
+			for(int y = 0; y < destination.height; y++)
+			{
+				memcpy(destination.data.data() + (size_t)y * destination.rowPitch, (const uint8_t*)mappedData.data + (size_t)y * mappedData.row_pitch, destination.rowPitch);
+			}
+			device->unmap_texture_region(stagingTexture, 0);
+		}
+		device->destroy_resource(stagingTexture);
+		return isMapped;
+	}
+}
+
+
+ReshadeReadbackDevice::ReshadeReadbackDevice(effect_runtime* runtime, const CaptureRegion& region, bool captureDepth) : _runtime(runtime), 
+																	_sourceBox(toSubresourceBox(region)), _region(region), _width(region.width), _height(region.height), _captureDepth(captureDepth)
+{
+}
+
+
+ReshadeReadbackDevice::~ReshadeReadbackDevice()
+{
+	destroySlots();
+}
+
+
+bool ReshadeReadbackDevice::createSlots(int numberOfSlots)
+{
+	destroySlots();
+	device* const device = _runtime->get_device();
+	const resource_desc backbufferDescription = device->get_resource_desc(_runtime->get_current_back_buffer());
+	switch(format_to_typeless(backbufferDescription.texture.format))
+	{
+	case format::r8g8b8a8_typeless:
+		_isBgra = false;
+		break;
+	case format::b8g8r8a8_typeless:
+	case format::b8g8r8x8_typeless:
+		_isBgra = true;
+		break;
+	default:
+		// high bit depth and other formats are read synchronously.
+		return false;
+	}
+	if(_sourceBox.right > (int)backbufferDescription.texture.width || _sourceBox.bottom > (int)backbufferDescription.texture.height)
+	{
+		return false;
+	}
+	if(!device->create_query_heap(query_type::timestamp, numberOfSlots, &_queryHeap))
+	{
+		return false;
+	}
+	const format stagingFormat = format_to_default_typed(backbufferDescription.texture.format, 0);
+	for(int i = 0; i < numberOfSlots; i++)
+	{
+		resource stagingTexture = {};
+		if(!device->create_resource(resource_desc(_width, _height, 1, 1, stagingFormat, 1, memory_heap::gpu_to_cpu, resource_usage::copy_dest), nullptr, 
+									resource_usage::copy_dest, &stagingTexture))
+		{
+			destroySlots();
+			return false;
+		}
+		_stagingTextures.push_back(stagingTexture);
+	}
+	_frameWidth = (int)backbufferDescription.texture.width;
+	_frameHeight = (int)backbufferDescription.texture.height;
+	_backbufferFormat = backbufferDescription.texture.format;
+	_slotHasFrame.assign(numberOfSlots, false);
+	resource depthBuffer = {};
+	if(_captureDepth && IGCS::DepthBufferReader::findDepthBuffer(_runtime, depthBuffer, _depthFormat))
+	{
+		// depth stencil resources can only be copied as a whole, so the region is cut out when the slot is read.
+		_depthDescription = device->get_resource_desc(depthBuffer);
+		for(int i = 0; i < numberOfSlots; i++)
+		{
+			resource depthStagingTexture = {};
+			if(!device->create_resource(resource_desc(_depthDescription.texture.width, _depthDescription.texture.height, 1, 1, _depthDescription.texture.format, 1,
+													  memory_heap::gpu_to_cpu, resource_usage::copy_dest), nullptr, resource_usage::copy_dest, &depthStagingTexture))
+			{
+				// the shots are still read, without depth.
+				destroyDepthStagingTextures();
+				break;
+			}
+			_depthStagingTextures.push_back(depthStagingTexture);
+		}
+		_slotHasDepth.assign(_depthStagingTextures.size(), false);
+	}
+	return true;
+}
+
+
+void ReshadeReadbackDevice::destroySlots()
+{
+	device* const device = _runtime->get_device();
+	for(const resource stagingTexture : _stagingTextures)
+	{
+		device->destroy_resource(stagingTexture);
+	}
+	_stagingTextures.clear();
+	_slotHasFrame.clear();
+	destroyDepthStagingTextures();
+	if(0 != _queryHeap.handle)
+	{
+		device->destroy_query_heap(_queryHeap);
+		_queryHeap = {};
+	}
+}
+
+
+void ReshadeReadbackDevice::destroyDepthStagingTextures()
+{
+	device* const device = _runtime->get_device();
+	for(const resource depthStagingTexture : _depthStagingTextures)
+	{
+		device->destroy_resource(depthStagingTexture);
+	}
+	_depthStagingTextures.clear();
+	_slotHasDepth.clear();
+}
+
+
+void ReshadeReadbackDevice::copyBackbufferToSlot(int slot)
+{
+	command_queue* const queue = _runtime->get_command_queue();
+	const resource backbuffer = _runtime->get_current_back_buffer();
+	command_list* const commandList = queue->get_immediate_command_list();
+	// the backbuffer is recreated when the game changes its resolution or format. The staging textures and the region are for the backbuffer at the start,
+	// so another backbuffer isn't copied and the slot reads as failed. The query is still written, so the slot completes.
+	const resource_desc backbufferDescription = _runtime->get_device()->get_resource_desc(backbuffer);
+	_slotHasFrame[slot] = (int)backbufferDescription.texture.width == _frameWidth && (int)backbufferDescription.texture.height == _frameHeight && 
+						  backbufferDescription.texture.format == _backbufferFormat;
+	if(_slotHasFrame[slot])
+	{
+		commandList->barrier(backbuffer, resource_usage::present, resource_usage::copy_source);
+		commandList->copy_texture_region(backbuffer, 0, &_sourceBox, _stagingTextures[slot], 0, nullptr);
+		commandList->barrier(backbuffer, resource_usage::copy_source, resource_usage::present);
+	}
+	if(_slotHasFrame[slot] && isCapturingDepth())
+	{
+		// the depth buffer selected can change between shots. Only a depth buffer like the one the staging textures were created for can be copied.
+		resource depthBuffer = {};
+		format depthFormat = format::unknown;
+		const bool canCopyDepth = IGCS::DepthBufferReader::findDepthBuffer(_runtime, depthBuffer, depthFormat) && depthFormat == _depthFormat;
+		const resource_desc depthDescription = canCopyDepth ? _runtime->get_device()->get_resource_desc(depthBuffer) : resource_desc();
+		_slotHasDepth[slot] = canCopyDepth && depthDescription.texture.width == _depthDescription.texture.width && 
+							  depthDescription.texture.height == _depthDescription.texture.height && depthDescription.texture.format == _depthDescription.texture.format;
+		if(_slotHasDepth[slot])
+		{
+			commandList->barrier(depthBuffer, resource_usage::shader_resource, resource_usage::copy_source);
+			commandList->copy_texture_region(depthBuffer, 0, nullptr, _depthStagingTextures[slot], 0, nullptr);
+			commandList->barrier(depthBuffer, resource_usage::copy_source, resource_usage::shader_resource);
+		}
+	}
+	// the query is written after both copies, so it completes after them.
+	commandList->end_query(_queryHeap, query_type::timestamp, slot);
+	// submit, but don't wait for the gpu.
+	queue->flush_immediate_command_list();
+}
+
+
+bool ReshadeReadbackDevice::isCopyComplete(int slot)
+{
+	uint64_t timestamp = 0;
+	return _runtime->get_device()->get_query_heap_results(_queryHeap, slot, 1, &timestamp, sizeof(timestamp));
+}
+
+
+bool ReshadeReadbackDevice::readSlot(int slot, uint8_t* destination)
+{
+	if(!_slotHasFrame[slot])
+	{
+		return false;
+	}
+	device* const device = _runtime->get_device();
+	subresource_data mappedData = {};
+	if(!device->map_texture_region(_stagingTextures[slot], 0, nullptr, map_access::read_only, &mappedData))
+	{
+		return false;
+	}
+	// pack to RGB, like the synchronous capture does. 
+	const int redOffset = _isBgra ? 2 : 0;
+	const int blueOffset = _isBgra ? 0 : 2;
+	for(int y = 0; y < _height; y++)
+	{
+		const uint8_t* sourceRow = (const uint8_t*)mappedData.data + (size_t)y * mappedData.row_pitch;
+		uint8_t* destinationRow = destination + (size_t)y * _width * 3;
+		for(int x = 0; x < _width; x++)
+		{
+			destinationRow[x * 3] = sourceRow[x * 4 + redOffset];
+			destinationRow[x * 3 + 1] = sourceRow[x * 4 + 1];
+			destinationRow[x * 3 + 2] = sourceRow[x * 4 + blueOffset];
+		}
+	}
+	device->unmap_texture_region(_stagingTextures[slot], 0);
+	return true;
+}
+
+
+bool ReshadeReadbackDevice::readDepthSlot(int slot, std::vector<float>& rawDepth)
+{
+	if(!isCapturingDepth() || !_slotHasDepth[slot])
+	{
+		return false;
+	}
+	device* const device = _runtime->get_device();
+	subresource_data mappedData = {};
+	if(!device->map_texture_region(_depthStagingTextures[slot], 0, nullptr, map_access::read_only, &mappedData))
+	{
+		return false;
+	}
+	IGCS::DepthBufferReader::convertToRawDepth((const uint8_t*)mappedData.data, mappedData.row_pitch, _depthFormat, (int)_depthDescription.texture.width, 
+											   (int)_depthDescription.texture.height, _region, _frameWidth, _frameHeight, rawDepth);
+	device->unmap_texture_region(_depthStagingTextures[slot], 0);
+	return true;
+}
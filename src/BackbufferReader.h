@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <reshade_api.hpp>
+#include <vector>
+#include "AsyncReadbackRing.h"
+#include "ConstantsEnums.h"
+
+/// <summary>
+/// A copy of the backbuffer in its own format, as read by BackbufferReader.
+/// </summary>
+struct BackbufferData
+{
+	std::vector<uint8_t> data;
+	uint32_t rowPitch = 0;			// the number of bytes between the start of two rows in data
+	int width = 0;
+	int height = 0;
+	HighBitDepthPixelFormat pixelFormat = HighBitDepthPixelFormat::Unsupported;
+};
+
+
+namespace IGCS::BackbufferReader
+{
+	/// <summary>
+	/// Returns the high bit depth format of the current backbuffer of the runtime specified, or Unsupported if it's not a 10 bit or 16 bit float format.
+	/// </summary>
+	HighBitDepthPixelFormat getBackbufferPixelFormat(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Copies the region specified of the current backbuffer of the runtime specified to the cpu, without converting it, so high bit depth backbuffers keep
+	/// their full precision. Waits for the gpu to complete the copy. Has to be called on the render thread, after the effects have been rendered.
+	/// </summary>
+	/// <returns>true if the backbuffer has a supported format and was read, false otherwise</returns>
+	bool readBackbuffer(reshade::api::effect_runtime* runtime, const CaptureRegion& region, BackbufferData& destination);
+}
+
+
+/// <summary>
+/// Reads 8 bit RGBA and BGRA backbuffers through the ReShade device api for an AsyncReadbackRing. Every slot is a readback texture and a timestamp query,
+/// which is written after the copy, so a completed query means the copy has been completed as well. Only the capture region is copied to the slots.
+/// Optionally the depth buffer is copied along with the backbuffer into a second readback texture per slot.
+/// </summary>
+class ReshadeReadbackDevice : public ReadbackDevice
+{
+public:
+	/// <summary>
+	/// If captureDepth is true, the depth buffer is copied along with every shot, if it can be found. isCapturingDepth tells whether it has been found.
+	/// </summary>
+	ReshadeReadbackDevice(reshade::api::effect_runtime* runtime, const CaptureRegion& region, bool captureDepth = false);
+	~ReshadeReadbackDevice() override;
+
+	bool createSlots(int numberOfSlots) override;
+	void destroySlots() override;
+	void copyBackbufferToSlot(int slot) override;
+	bool isCopyComplete(int slot) override;
+	bool readSlot(int slot, uint8_t* destination) override;
+	bool readDepthSlot(int slot, std::vector<float>& rawDepth) override;
+	int width() override { return _width; }
+	int height() override { return _height; }
+	bool isCapturingDepth() { return _depthStagingTextures.size() > 0; }
+
+private:
+	void destroyDepthStagingTextures();
+
+	reshade::api::effect_runtime* _runtime = nullptr;
+	std::vector<reshade::api::resource> _stagingTextures;
+	reshade::api::query_heap _queryHeap = {};
+	reshade::api::subresource_box _sourceBox = {};
+	CaptureRegion _region;
+	int _width = 0;
+	int _height = 0;
+	bool _isBgra = false;
+	bool _captureDepth = false;
+	int _frameWidth = 0;
+	int _frameHeight = 0;
+	reshade::api::format _backbufferFormat = reshade::api::format::unknown;
+	std::vector<bool> _slotHasFrame;						// false if the backbuffer didn't match the staging textures when the slot was last written
+	std::vector<reshade::api::resource> _depthStagingTextures;
+	std::vector<bool> _slotHasDepth;						// false if the depth buffer couldn't be copied when the slot was last written
+	reshade::api::resource_desc _depthDescription = {};
+	reshade::api::format _depthFormat = reshade::api::format::unknown;
+};
@@ -61,6 +61,9 @@ void CameraToolsConnector::connectToCameraTools()
 			_igcs_EndScreenshotSessionFunc = (IGCS_EndScreenshotSession)GetProcAddress(moduleHandle, "IGCS_EndScreenshotSession");
 			_igcs_MoveCameraPanoramaFunc = (IGCS_MoveCameraPanorama)GetProcAddress(moduleHandle, "IGCS_MoveCameraPanorama");
 			_igcs_MoveCameraMultishotFunc = (IGCS_MoveCameraMultishot)GetProcAddress(moduleHandle, "IGCS_MoveCameraMultishot");
+			// optional functions, which older camera tools don't export.
+			_igcs_PauseCameraPathPlaybackFunc = (IGCS_PauseCameraPathPlayback)GetProcAddress(moduleHandle, "IGCS_PauseCameraPathPlayback");
+			_igcs_SetCameraPoseFunc = (IGCS_SetCameraPose)GetProcAddress(moduleHandle, "IGCS_SetCameraPose");
 			break;
 		}
 	}
@@ -107,3 +110,23 @@ void CameraToolsConnector::endScreenshotSession()
 	_igcs_EndScreenshotSessionFunc();
 }
 
+
+void CameraToolsConnector::pauseCameraPathPlayback(bool pause)
+{
+	if(!canPauseCameraPathPlayback())
+	{
+		return;
+	}
+	_igcs_PauseCameraPathPlaybackFunc(pause);
+}
+
+
+
+void CameraToolsConnector::setCameraPose(const float position[3], const float orientation[4], float fovDegrees)
+{
+	if(!canSetCameraPose())
+	{
+		return;
+	}
+	_igcs_SetCameraPoseFunc(position, orientation, fovDegrees);
+}
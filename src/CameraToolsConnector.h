@@ -67,6 +67,19 @@ typedef void(__stdcall* IGCS_MoveCameraMultishot)(float stepLeftRight, float ste
 /// Ends the active screenshot session, restoring camera data if required.
 /// </summary>
 typedef void(__stdcall* IGCS_EndScreenshotSession)();
+/// <summary>
+/// Pauses or resumes the camera path which is currently playing. Optional: not all camera tools export this function.
+/// </summary>
+/// <param name="pause">true to pause the playback, false to resume it</param>
+typedef void(__stdcall* IGCS_PauseCameraPathPlayback)(bool pause);
+/// <summary>
+/// Places the camera at the absolute pose specified, in the coordinate system and conventions of the camera data the camera tools write to the shared buffer.
+/// Only valid during a screenshot session. Optional: not all camera tools export this function.
+/// </summary>
+/// <param name="position">the camera coordinates x, y, z</param>
+/// <param name="orientation">the camera look quaternion qx, qy, qz, qw</param>
+/// <param name="fovDegrees">The fov in degrees. If &lt= 0, the value is ignored</param>
+typedef void(__stdcall* IGCS_SetCameraPose)(const float* position, const float* orientation, float fovDegrees);
 
 
 /// <summary>
@@ -114,6 +127,32 @@ public:
 	/// </summary>
 	void endScreenshotSession();
 	/// <summary>
+	/// Pauses or resumes the camera path which is currently playing, if the camera tools support it. 
+	/// </summary>
+	void pauseCameraPathPlayback(bool pause);
+	/// <summary>
+	/// Returns true if the camera tools can pause a camera path playback. This is an optional feature, so it's not part of cameraToolsConnected().
+	/// </summary>
+	bool canPauseCameraPathPlayback()
+	{
+		return cameraToolsConnected() && nullptr != _igcs_PauseCameraPathPlaybackFunc;
+	}
+	/// <summary>
+	/// Places the camera at the absolute pose specified during a screenshot session, if the camera tools support it. Absolute poses don't accumulate the
+	/// errors of relative moves.
+	/// </summary>
+	/// <param name="position">the camera coordinates x, y, z</param>
+	/// <param name="orientation">the camera look quaternion qx, qy, qz, qw</param>
+	/// <param name="fovDegrees">The fov in degrees. If &lt= 0, the value is ignored</param>
+	void setCameraPose(const float position[3], const float orientation[4], float fovDegrees);
+	/// <summary>
+	/// Returns true if the camera tools can place the camera at an absolute pose. This is an optional feature, so it's not part of cameraToolsConnected().
+	/// </summary>
+	bool canSetCameraPose()
+	{
+		return cameraToolsConnected() && nullptr != _igcs_SetCameraPoseFunc;
+	}
+	/// <summary>
 	/// Returns true if this object is connected to camera tools, false otherwise
 	/// </summary>
 	/// <returns></returns>
@@ -127,5 +166,7 @@ private:
 	IGCS_MoveCameraPanorama _igcs_MoveCameraPanoramaFunc = nullptr;
 	IGCS_MoveCameraMultishot _igcs_MoveCameraMultishotFunc = nullptr;
 	IGCS_EndScreenshotSession _igcs_EndScreenshotSessionFunc = nullptr;
+	IGCS_PauseCameraPathPlayback _igcs_PauseCameraPathPlaybackFunc = nullptr;		// optional
+	IGCS_SetCameraPose _igcs_SetCameraPoseFunc = nullptr;							// optional
 };
 
@@ -79,7 +79,70 @@ enum class ScreenshotType : int
 {
 	HorizontalPanorama = 0,
 	MultiShot = 1,
-	DebugGrid = 2,
+	Supersampling = 2,
+	MotionBlur = 3,
+	TemporalDenoise = 4,
+	Orbit = 5,
+	DebugGrid = 6,			// has to be the last one, as it's only in the list in debug builds.
+};
+
+
+enum class LightfieldQuiltMode : int
+{
+	Off,
+	QuiltAndShots,
+	QuiltOnly,			// the shots are only used for the quilt and aren't kept nor written to disk
+};
+
+
+enum class MotionBlurMovementType : int
+{
+	Translation,		// the camera moves left/right/up/down and optionally zooms
+	Rotation,			// the camera rotates around its up axis
+};
+
+
+// how the shots over the time the shutter is open are weighted.
+enum class ShutterShape : int
+{
+	Box,				// all shots have the same weight, like an ideal shutter
+	Triangle,
+	Cosine,				// smooth falloff towards the start and end, like a real rotary shutter
+};
+
+
+// how frames taken at the same camera position are combined into a single frame.
+enum class FrameStackingMethod : int
+{
+	Mean,
+	Median,				// removes outliers like fireflies, but keeps more noise than the mean
+	SigmaClippedMean,	// the mean of the values which are close to the median
+};
+
+
+// the formats of high bit depth backbuffers which can be captured at full precision.
+enum class HighBitDepthPixelFormat : int
+{
+	Unsupported,
+	R10G10B10A2,		// HDR10 (PQ encoded, BT.2020 primaries) or 10 bit SDR
+	B10G10R10A2,
+	R16G16B16A16Float,	// scRGB: linear, BT.709 primaries, 1.0 is 80 nits
+};
+
+
+// the file type of high dynamic range images, like high bit depth shots and merged exposure brackets.
+enum class HighBitDepthFiletype : int
+{
+	Exr,				// half float, linear scRGB
+	Png16Pq,			// 16 bit PNG, PQ encoded with BT.2020 primaries and a cICP chunk, like HDR10
+};
+
+
+// the file type of depth maps captured with the shots.
+enum class DepthFiletype : int
+{
+	Png16,				// 16 bit gray PNG, 0 at the near plane and 65535 at the far plane
+	Exr32,				// 32 bit float OpenEXR with a Z channel: the distance to the camera in the units of the near and far plane
 };
 
 
@@ -87,7 +150,33 @@ enum class ScreenshotFiletype : int
 {
 	Bmp,
 	Jpeg,
-	Png
+	Png,
+	Qoi
+};
+
+
+// how the file type of the frames written by a streaming encoder is chosen.
+enum class EncodingSelection : int
+{
+	Fixed,					// always the file type specified
+	AutoFastestLossless,	// per frame the smallest lossless file type which keeps up with the capture, or the fastest one if none does
+	AutoFastest,			// same as AutoFastestLossless, with JPEG as a candidate as well
+};
+
+
+// how the two eyes of a stereo pair are packed into one image.
+enum class StereoPacking : int
+{
+	SideBySide,			// left eye on the left, right eye on the right
+	OverUnder,			// left eye on top, right eye below it
+};
+
+
+// what the producer of a frame bus does with a frame when all slots are still held by the consumer.
+enum class FrameBusFullPolicy : int
+{
+	DropFrame,			// drop the frame, so the game never waits for the consumer
+	WaitForConsumer,	// block the render thread until the consumer has freed a slot, unless the consumer has stopped responding
 };
 
 
@@ -0,0 +1,229 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "DepthBufferReader.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <string_view>
+
+using namespace reshade::api;
+
+namespace
+{
+	// the depth texture ReShade.fxh declares with the DEPTH semantic.
+	constexpr char DepthTextureVariableName[] = "DepthBufferTex";
+
+	uint32_t bytesPerDepthPixel(format depthFormat)
+	{
+		switch(format_to_typeless(depthFormat))
+		{
+		case format::r16_typeless:
+			return 2;
+		case format::r24_g8_typeless:
+		case format::r32_typeless:
+			return 4;
+		case format::r32_g8_typeless:
+			return 8;
+		}
+		return 0;
+	}
+
+
+	float readDepthValue(const uint8_t* pixel, format typelessFormat)
+	{
+		switch(typelessFormat)
+		{
+		case format::r16_typeless:
+			return (float)*reinterpret_cast<const uint16_t*>(pixel) / 65535.0f;
+		case format::r24_g8_typeless:
+			// the depth is in the lower 24 bits, the stencil in the upper 8.
+			return (float)(*reinterpret_cast<const uint32_t*>(pixel) & 0xFFFFFF) / 16777215.0f;
+		default:
+			// 32 bit float, followed by the stencil for r32_g8.
+			return *reinterpret_cast<const float*>(pixel);
+		}
+	}
+}
+
+
+namespace IGCS::DepthBufferReader
+{
+	bool findDepthBuffer(effect_runtime* runtime, resource& depthBuffer, format& depthFormat)
+	{
+		resource_view depthView = {};
+		runtime->enumerate_texture_variables(nullptr, [&depthView](effect_runtime* effectRuntime, effect_texture_variable variable)
+		{
+			char name[256] = { 0 };
+			size_t nameSize = sizeof(name);
+			effectRuntime->get_texture_variable_name(variable, name, &nameSize);
+			// the name can be prefixed with the namespace, e.g. ReShade::DepthBufferTex.
+			const std::string_view nameView(name);
+			if(0 == depthView.handle && nameView.ends_with(DepthTextureVariableName))
+			{
+				effectRuntime->get_texture_binding(variable, &depthView);
+			}
+		});
+		if(0 == depthView.handle)
+		{
+			return false;
+		}
+		device* const device = runtime->get_device();
+		depthBuffer = device->get_resource_from_view(depthView);
+		depthFormat = device->get_resource_view_desc(depthView).format;
+		// multisampled depth buffers can't be copied to a texture the cpu can read.
+		return 0 != depthBuffer.handle && bytesPerDepthPixel(depthFormat) > 0 && device->get_resource_desc(depthBuffer).texture.samples <= 1;
+	}
+
+
+	bool readDepthBuffer(effect_runtime* runtime, const CaptureRegion& region, int frameWidth, int frameHeight, std::vector<float>& rawDepth)
+	{
+		resource depthBuffer = {};
+		format depthFormat = format::unknown;
+		if(!findDepthBuffer(runtime, depthBuffer, depthFormat))
+		{
+			return false;
+		}
+		device* const device = runtime->get_device();
+		command_queue* const queue = runtime->get_command_queue();
+		const resource_desc depthDescription = device->get_resource_desc(depthBuffer);
+		resource stagingTexture = {};
+		if(!device->create_resource(resource_desc(depthDescription.texture.width, depthDescription.texture.height, 1, 1, depthDescription.texture.format, 1, 
+												  memory_heap::gpu_to_cpu, resource_usage::copy_dest), nullptr, resource_usage::copy_dest, &stagingTexture))
+		{
+			return false;
+		}
+		// depth stencil resources can only be copied as a whole, so the region is cut out on the cpu. The depth buffer is bound to the effects, so it's 
+		// in the shader resource state after they've been rendered.
+		command_list* const commandList = queue->get_immediate_command_list();
+		commandList->barrier(depthBuffer, resource_usage::shader_resource, resource_usage::copy_source);
+		commandList->copy_texture_region(depthBuffer, 0, nullptr, stagingTexture, 0, nullptr);
+		commandList->barrier(depthBuffer, resource_usage::copy_source, resource_usage::shader_resource);
+		queue->flush_immediate_command_list();
+		queue->wait_idle();
+
+		subresource_data mappedData = {};
+		const bool isMapped = device->map_texture_region(stagingTexture, 0, nullptr, map_access::read_only, &mappedData);
+		if(isMapped)
+		{
+			convertToRawDepth((const uint8_t*)mappedData.data, mappedData.row_pitch, depthFormat, (int)depthDescription.texture.width, 
+							  (int)depthDescription.texture.height, region, frameWidth, frameHeight, rawDepth);
+			device->unmap_texture_region(stagingTexture, 0);
+		}
+		device->destroy_resource(stagingTexture);
+		return isMapped;
+	}
+
+
+	void convertToRawDepth(const uint8_t* data, uint32_t rowPitch, format depthFormat, int depthWidth, int depthHeight, const CaptureRegion& region, 
+						   int frameWidth, int frameHeight, std::vector<float>& rawDepth)
+	{
+		const format typelessFormat = format_to_typeless(depthFormat);
+		const uint32_t bytesPerPixel = bytesPerDepthPixel(depthFormat);
+		rawDepth.resize((size_t)region.width * region.height);
+		// the column in the depth buffer of every column of the region, so the division isn't done per pixel.
+		std::vector<uint32_t> sourceOffsetPerColumn(region.width);
+		for(int x = 0; x < region.width; x++)
+		{
+			const int depthX = (std::min)((int)(((float)(region.left + x) + 0.5f) * depthWidth / frameWidth), depthWidth - 1);
+			sourceOffsetPerColumn[x] = (uint32_t)depthX * bytesPerPixel;
+		}
+		for(int y = 0; y < region.height; y++)
+		{
+			const int depthY = (std::min)((int)(((float)(region.top + y) + 0.5f) * depthHeight / frameHeight), depthHeight - 1);
+			const uint8_t* sourceRow = data + (size_t)depthY * rowPitch;
+			float* destinationRow = rawDepth.data() + (size_t)y * region.width;
+			for(int x = 0; x < region.width; x++)
+			{
+				destinationRow[x] = readDepthValue(sourceRow + sourceOffsetPerColumn[x], typelessFormat);
+			}
+		}
+	}
+
+
+	void linearizeDepth(const float* rawDepth, size_t numberOfValues, float nearPlane, float farPlane, bool isReversed, float* linearDepth)
+	{
+		// distance = near * far / (far - depth * (far - near)). Reversed Z stores 1 - depth.
+		const float nearTimesFar = nearPlane * farPlane;
+		const float range = farPlane - nearPlane;
+		const __m128 nearTimesFar4 = _mm_set1_ps(nearTimesFar);
+		const __m128 far4 = _mm_set1_ps(farPlane);
+		const __m128 range4 = _mm_set1_ps(range);
+		const __m128 one4 = _mm_set1_ps(1.0f);
+		size_t i = 0;
+		for(; i + 4 <= numberOfValues; i += 4)
+		{
+			__m128 depth4 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(rawDepth + i), _mm_setzero_ps()), one4);
+			if(isReversed)
+			{
+				depth4 = _mm_sub_ps(one4, depth4);
+			}
+			_mm_storeu_ps(linearDepth + i, _mm_div_ps(nearTimesFar4, _mm_sub_ps(far4, _mm_mul_ps(depth4, range4))));
+		}
+		for(; i < numberOfValues; i++)
+		{
+			float depth = std::clamp(rawDepth[i], 0.0f, 1.0f);
+			if(isReversed)
+			{
+				depth = 1.0f - depth;
+			}
+			linearDepth[i] = nearTimesFar / (farPlane - depth * range);
+		}
+	}
+
+
+	void linearDepthToUnorm16(const float* linearDepth, size_t numberOfValues, float nearPlane, float farPlane, std::vector<uint16_t>& destination)
+	{
+		destination.resize(numberOfValues);
+		const float scale = 65535.0f / (farPlane - nearPlane);
+		const __m128 near4 = _mm_set1_ps(nearPlane);
+		const __m128 scale4 = _mm_set1_ps(scale);
+		const __m128 maximum4 = _mm_set1_ps(65535.0f);
+		size_t i = 0;
+		for(; i + 8 <= numberOfValues; i += 8)
+		{
+			const __m128 first4 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(linearDepth + i), near4), scale4), _mm_setzero_ps()), maximum4);
+			const __m128 second4 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(linearDepth + i + 4), near4), scale4), _mm_setzero_ps()), maximum4);
+			// the values are in [0, 65535], so they're biased to fit a signed 16 bit pack and unbiased after it.
+			const __m128i bias = _mm_set1_epi32(32768);
+			const __m128i firstInt = _mm_sub_epi32(_mm_cvtps_epi32(first4), bias);
+			const __m128i secondInt = _mm_sub_epi32(_mm_cvtps_epi32(second4), bias);
+			const __m128i packed = _mm_xor_si128(_mm_packs_epi32(firstInt, secondInt), _mm_set1_epi16((short)0x8000));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination.data() + i), packed);
+		}
+		for(; i < numberOfValues; i++)
+		{
+			destination[i] = (uint16_t)(std::clamp((linearDepth[i] - nearPlane) * scale, 0.0f, 65535.0f) + 0.5f);
+		}
+	}
+}
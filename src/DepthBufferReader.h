@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <reshade_api.hpp>
+#include <vector>
+#include "GrabbedFrame.h"
+
+namespace IGCS::DepthBufferReader
+{
+	/// <summary>
+	/// Finds the depth buffer ReShade binds to effects through the DEPTH semantic, e.g. the one selected in the generic depth addon. It's only bound while an
+	/// effect which uses depth, like IgcsDof, is loaded.
+	/// </summary>
+	/// <param name="runtime"></param>
+	/// <param name="depthBuffer">receives the resource of the depth buffer</param>
+	/// <param name="depthFormat">receives the format the depth buffer is read with</param>
+	/// <returns>true if a depth buffer which can be read was found, false otherwise</returns>
+	bool findDepthBuffer(reshade::api::effect_runtime* runtime, reshade::api::resource& depthBuffer, reshade::api::format& depthFormat);
+	/// <summary>
+	/// Copies the depth buffer to the cpu and converts the part under the capture region specified to raw depth. Waits for the gpu to complete the copy. 
+	/// Has to be called on the render thread, after the effects have been rendered.
+	/// </summary>
+	/// <param name="runtime"></param>
+	/// <param name="region">the capture region, in backbuffer pixels</param>
+	/// <param name="frameWidth">the size of the backbuffer, used to map the region onto a depth buffer of a different size</param>
+	/// <param name="frameHeight"></param>
+	/// <param name="rawDepth">receives the depth values in [0, 1] as stored in the depth buffer, 1 float per pixel of the region</param>
+	/// <returns>true if the depth buffer was found and read, false otherwise</returns>
+	bool readDepthBuffer(reshade::api::effect_runtime* runtime, const CaptureRegion& region, int frameWidth, int frameHeight, std::vector<float>& rawDepth);
+	/// <summary>
+	/// Converts a copy of the depth buffer to raw depth for the capture region specified. If the depth buffer doesn't have the size of the backbuffer, the 
+	/// nearest depth value is used for every pixel, so the depth always has the size of the region.
+	/// </summary>
+	void convertToRawDepth(const uint8_t* data, uint32_t rowPitch, reshade::api::format depthFormat, int depthWidth, int depthHeight, const CaptureRegion& region, 
+						   int frameWidth, int frameHeight, std::vector<float>& rawDepth);
+	/// <summary>
+	/// Converts raw depth to the distance to the camera, in the units of the near and far plane specified. 4 values at a time.
+	/// </summary>
+	/// <param name="rawDepth"></param>
+	/// <param name="numberOfValues"></param>
+	/// <param name="nearPlane">the distance to the near plane of the game's projection</param>
+	/// <param name="farPlane">the distance to the far plane of the game's projection</param>
+	/// <param name="isReversed">true if the game uses reversed Z, where the near plane is 1 and the far plane is 0</param>
+	/// <param name="linearDepth">receives the distances. Can be the same as rawDepth</param>
+	void linearizeDepth(const float* rawDepth, size_t numberOfValues, float nearPlane, float farPlane, bool isReversed, float* linearDepth);
+	/// <summary>
+	/// Converts distances to the camera to 16 bit values, with 0 at the near plane and 65535 at the far plane.
+	/// </summary>
+	void linearDepthToUnorm16(const float* linearDepth, size_t numberOfValues, float nearPlane, float farPlane, std::vector<uint16_t>& destination);
+}
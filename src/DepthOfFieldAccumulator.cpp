@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "DepthOfFieldAccumulator.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+	constexpr int RowsPerWorkItem = 16;
+	constexpr int NoiseTextureSize = 512;
+	// ConeOverlap of the shader: every channel keeps 1-2k of itself and gets k of both other channels. 
+	constexpr float ConeOverlapK = 0.4f * 0.33f;
+
+	inline __m128 absPs(__m128 values)
+	{
+		return _mm_and_ps(values, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+	}
+
+
+	/// <summary>
+	/// log2 of 4 positive values, with the logf polynomial of Cephes. Accurate to about 1 ulp, which is more precise than the pow of the GPU.
+	/// </summary>
+	inline __m128 log2Ps(__m128 values)
+	{
+		values = _mm_max_ps(values, _mm_set1_ps(1e-30f));
+		const __m128i bits = _mm_castps_si128(values);
+		__m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+		__m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+		// move the mantissa to [sqrt(0.5), sqrt(2)) so the polynomial is used around 1.
+		const __m128 isLarge = _mm_cmpgt_ps(mantissa, _mm_set1_ps(1.41421356f));
+		mantissa = _mm_or_ps(_mm_and_ps(isLarge, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))), _mm_andnot_ps(isLarge, mantissa));
+		exponent = _mm_add_ps(exponent, _mm_and_ps(isLarge, _mm_set1_ps(1.0f)));
+		const __m128 f = _mm_sub_ps(mantissa, _mm_set1_ps(1.0f));
+		const __m128 f2 = _mm_mul_ps(f, f);
+		__m128 polynomial = _mm_set1_ps(7.0376836292E-2f);
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(-1.1514610310E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(1.1676998740E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(-1.2420140846E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(1.4249322787E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(-1.6668057665E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(2.0000714765E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(-2.4999993993E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, f), _mm_set1_ps(3.3333331174E-1f));
+		const __m128 naturalLog = _mm_add_ps(f, _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(polynomial, f), f2), _mm_mul_ps(f2, _mm_set1_ps(0.5f))));
+		return _mm_add_ps(_mm_mul_ps(naturalLog, _mm_set1_ps(1.44269504f)), exponent);
+	}
+
+
+	/// <summary>
+	/// 2^values for 4 values, with the expf polynomial of Cephes. Results below 2^-126 are flushed to 2^-126.
+	/// </summary>
+	inline __m128 exp2Ps(__m128 values)
+	{
+		values = _mm_min_ps(_mm_max_ps(values, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+		const __m128i integerPart = _mm_cvtps_epi32(values);		// rounds to nearest, so the fraction is in [-0.5, 0.5]
+		const __m128 x = _mm_mul_ps(_mm_sub_ps(values, _mm_cvtepi32_ps(integerPart)), _mm_set1_ps(0.69314718f));
+		__m128 polynomial = _mm_set1_ps(1.9875691500E-4f);
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, x), _mm_set1_ps(1.3981999507E-3f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, x), _mm_set1_ps(8.3334519073E-3f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, x), _mm_set1_ps(4.1665795894E-2f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, x), _mm_set1_ps(1.6666665459E-1f));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, x), _mm_set1_ps(5.0000001201E-1f));
+		const __m128 fraction = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(polynomial, x), x), x), _mm_set1_ps(1.0f));
+		const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(integerPart, _mm_set1_epi32(127)), 23));
+		return _mm_mul_ps(fraction, scale);
+	}
+
+
+	inline __m128 powPs(__m128 values, __m128 exponent)
+	{
+		return exp2Ps(_mm_mul_ps(log2Ps(values), exponent));
+	}
+
+
+	/// <summary>
+	/// Multiplies the 3 channels with the symmetric matrix which has diagonal on the diagonal and offDiagonal elsewhere.
+	/// </summary>
+	inline void mixChannels(__m128& red, __m128& green, __m128& blue, float diagonal, float offDiagonal)
+	{
+		// diagonal*c + offDiagonal*(the other two) == (diagonal-offDiagonal)*c + offDiagonal*(sum of all three)
+		const __m128 sum = _mm_mul_ps(_mm_add_ps(_mm_add_ps(red, green), blue), _mm_set1_ps(offDiagonal));
+		const __m128 ownFactor = _mm_set1_ps(diagonal - offDiagonal);
+		red = _mm_add_ps(_mm_mul_ps(red, ownFactor), sum);
+		green = _mm_add_ps(_mm_mul_ps(green, ownFactor), sum);
+		blue = _mm_add_ps(_mm_mul_ps(blue, ownFactor), sum);
+	}
+
+
+	/// <summary>
+	/// Stand-in for monochrome_gaussnoise.png: the sum of 2 uniform values per texel, which like the texture is centered around 128.
+	/// </summary>
+	void generateDitherNoise(std::vector<uint8_t>& noise)
+	{
+		noise.resize(NoiseTextureSize * NoiseTextureSize);
+		uint32_t state = 0x9e3779b9;
+		for(auto& value : noise)
+		{
+			state = state * 1664525u + 1013904223u;
+			const uint32_t first = state >> 24;
+			state = state * 1664525u + 1013904223u;
+			value = (uint8_t)((first + (state >> 24) + 1) / 2);
+		}
+	}
+}
+
+
+void DepthOfFieldAccumulator::initialize(int width, int height, float highlightBoostFactor, float highlightGammaFactor)
+{
+	_width = width;
+	_height = height;
+	_stride = (width + 3) & ~3;
+	_numberOfFrames = 0;
+	_highlightBoostFactor = highlightBoostFactor;
+	_highlightGammaFactor = highlightGammaFactor;
+	_hdrFrame.assign((size_t)_stride * height * 3, 0.0f);
+	_accumulator.assign((size_t)_stride * height * 3, 0.0f);
+	if(_ditherNoise.empty())
+	{
+		generateDitherNoise(_ditherNoise);
+	}
+}
+
+
+void DepthOfFieldAccumulator::setDitherNoise(const uint8_t* noiseTexture)
+{
+	if(nullptr == noiseTexture)
+	{
+		generateDitherNoise(_ditherNoise);
+		return;
+	}
+	_ditherNoise.assign(noiseTexture, noiseTexture + NoiseTextureSize * NoiseTextureSize);
+}
+
+
+void DepthOfFieldAccumulator::addFrame(const uint8_t* data, float xAlignmentDelta, float yAlignmentDelta, const float sampleWeightRGB[3], float blendFactor)
+{
+	if(nullptr == data || !isInitialized())
+	{
+		return;
+	}
+	const size_t planeSize = (size_t)_stride * _height;
+	const int numberOfWorkItems = (_height + RowsPerWorkItem - 1) / RowsPerWorkItem;
+
+	// PS_CreateHDRInput: AccentuateWhites per pixel into the HDR frame.
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const __m128 gamma = _mm_set1_ps(_highlightGammaFactor);
+		const __m128 boost = _mm_set1_ps(_highlightBoostFactor);
+		const int lastRow = (std::min)((workItem + 1) * RowsPerWorkItem, _height);
+		for(int y = workItem * RowsPerWorkItem; y < lastRow; y++)
+		{
+			float* red = _hdrFrame.data() + (size_t)y * _stride;
+			float* green = red + planeSize;
+			float* blue = green + planeSize;
+			const uint8_t* source = data + (size_t)y * _width * 3;
+			for(int x = 0; x < _width; x++)
+			{
+				red[x] = source[x * 3] * (1.0f / 255.0f);
+				green[x] = source[x * 3 + 1] * (1.0f / 255.0f);
+				blue[x] = source[x * 3 + 2] * (1.0f / 255.0f);
+			}
+			for(int x = 0; x < _stride; x += 4)
+			{
+				__m128 r = _mm_loadu_ps(red + x);
+				__m128 g = _mm_loadu_ps(green + x);
+				__m128 b = _mm_loadu_ps(blue + x);
+				mixChannels(r, g, b, 1.0f - 2.0f * ConeOverlapK, ConeOverlapK);
+				__m128* channels[3] = { &r, &g, &b };
+				for(__m128* channel : channels)
+				{
+					const __m128 ramped = powPs(absPs(*channel), gamma);
+					*channel = _mm_div_ps(ramped, _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.001f), _mm_mul_ps(boost, ramped)), _mm_set1_ps(0.001f)));
+				}
+				_mm_storeu_ps(red + x, r);
+				_mm_storeu_ps(green + x, g);
+				_mm_storeu_ps(blue + x, b);
+			}
+		}
+	});
+
+	// PS_HandleStateRender: bilinear fetch at the alignment delta, which is the same for every pixel so the filter weights are too, then SRCALPHA blending.
+	// The y delta is scaled with the aspect ratio in the shader, so both deltas are in units of the width.
+	const float sourceOffsetX = xAlignmentDelta * _width;
+	const float sourceOffsetY = yAlignmentDelta * _width;
+	const int integerOffsetX = (int)std::floor(sourceOffsetX);
+	const int integerOffsetY = (int)std::floor(sourceOffsetY);
+	const float fractionX = sourceOffsetX - integerOffsetX;
+	const float fractionY = sourceOffsetY - integerOffsetY;
+	// the range of x for which both source columns are inside the frame, so they don't have to be clamped.
+	const int firstUnclampedX = (std::clamp)(-integerOffsetX, 0, _width);
+	const int endUnclampedX = (std::clamp)(_width - 1 - integerOffsetX, firstUnclampedX, _width);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const __m128 alpha = _mm_set1_ps(blendFactor);
+		const __m128 inverseAlpha = _mm_set1_ps(1.0f - blendFactor);
+		const __m128 weightX = _mm_set1_ps(fractionX);
+		const __m128 weightY = _mm_set1_ps(fractionY);
+		const int lastRow = (std::min)((workItem + 1) * RowsPerWorkItem, _height);
+		for(int y = workItem * RowsPerWorkItem; y < lastRow; y++)
+		{
+			const int sourceRow0 = (std::clamp)(y + integerOffsetY, 0, _height - 1);
+			const int sourceRow1 = (std::clamp)(y + integerOffsetY + 1, 0, _height - 1);
+			for(int channel = 0; channel < 3; channel++)
+			{
+				const float* plane = _hdrFrame.data() + planeSize * channel;
+				const float* row0 = plane + (size_t)sourceRow0 * _stride;
+				const float* row1 = plane + (size_t)sourceRow1 * _stride;
+				float* destination = _accumulator.data() + planeSize * channel + (size_t)y * _stride;
+				const float weight = sampleWeightRGB[channel] * blendFactor;
+				auto blendPixel = [&](int x)
+				{
+					const int column0 = (std::clamp)(x + integerOffsetX, 0, _width - 1);
+					const int column1 = (std::clamp)(x + integerOffsetX + 1, 0, _width - 1);
+					const float top = row0[column0] + (row0[column1] - row0[column0]) * fractionX;
+					const float bottom = row1[column0] + (row1[column1] - row1[column0]) * fractionX;
+					destination[x] = (top + (bottom - top) * fractionY) * weight + destination[x] * (1.0f - blendFactor);
+				};
+				for(int x = 0; x < firstUnclampedX; x++)
+				{
+					blendPixel(x);
+				}
+				const __m128 weights = _mm_set1_ps(sampleWeightRGB[channel]);
+				int x = firstUnclampedX;
+				for(; x + 4 <= endUnclampedX; x += 4)
+				{
+					const float* source0 = row0 + x + integerOffsetX;
+					const float* source1 = row1 + x + integerOffsetX;
+					const __m128 topLeft = _mm_loadu_ps(source0);
+					const __m128 bottomLeft = _mm_loadu_ps(source1);
+					const __m128 top = _mm_add_ps(topLeft, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(source0 + 1), topLeft), weightX));
+					const __m128 bottom = _mm_add_ps(bottomLeft, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(source1 + 1), bottomLeft), weightX));
+					const __m128 fetched = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), weightY));
+					_mm_storeu_ps(destination + x, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(fetched, weights), alpha), _mm_mul_ps(_mm_loadu_ps(destination + x), inverseAlpha)));
+				}
+				for(; x < _width; x++)
+				{
+					blendPixel(x);
+				}
+			}
+		}
+	});
+	_numberOfFrames++;
+}
+
+
+void DepthOfFieldAccumulator::resolve(std::vector<uint8_t>& destination)
+{
+	if(!isInitialized() || _numberOfFrames <= 0)
+	{
+		return;
+	}
+	destination.resize((size_t)_width * _height * 3);
+	const size_t planeSize = (size_t)_stride * _height;
+	const int numberOfWorkItems = (_height + RowsPerWorkItem - 1) / RowsPerWorkItem;
+	// ConeOverlapInverse of the shader.
+	const float inverseDiagonal = (ConeOverlapK - 1.0f) / (3.0f * ConeOverlapK - 1.0f);
+	const float inverseOffDiagonal = ConeOverlapK / (3.0f * ConeOverlapK - 1.0f);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const __m128 inverseGamma = _mm_set1_ps(1.0f / _highlightGammaFactor);
+		const __m128 boost = _mm_set1_ps(_highlightBoostFactor);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		alignas(16) int32_t values[3][4];
+		const int lastRow = (std::min)((workItem + 1) * RowsPerWorkItem, _height);
+		for(int y = workItem * RowsPerWorkItem; y < lastRow; y++)
+		{
+			const float* red = _accumulator.data() + (size_t)y * _stride;
+			const float* green = red + planeSize;
+			const float* blue = green + planeSize;
+			const uint8_t* noiseRow = _ditherNoise.data() + (size_t)(y % NoiseTextureSize) * NoiseTextureSize;
+			uint8_t* target = destination.data() + (size_t)y * _width * 3;
+			for(int x = 0; x < _width; x += 4)
+			{
+				__m128 r = _mm_loadu_ps(red + x);
+				__m128 g = _mm_loadu_ps(green + x);
+				__m128 b = _mm_loadu_ps(blue + x);
+				__m128* channels[3] = { &r, &g, &b };
+				for(__m128* channel : channels)
+				{
+					const __m128 toneMapped = _mm_div_ps(*channel, _mm_add_ps(_mm_set1_ps(1.001f), _mm_mul_ps(boost, *channel)));
+					*channel = powPs(absPs(toneMapped), inverseGamma);
+				}
+				mixChannels(r, g, b, inverseDiagonal, inverseOffDiagonal);
+				// lerp(-0.5/255, 0.5/255, noise), with the noise texture tiled 1 texel per pixel. x is a multiple of 4, so the 4 texels don't wrap.
+				const uint8_t* noise = noiseRow + (x % NoiseTextureSize);
+				const __m128 dither = _mm_mul_ps(_mm_sub_ps(_mm_set_ps(noise[3], noise[2], noise[1], noise[0]), _mm_set1_ps(127.5f)), _mm_set1_ps(1.0f / (255.0f * 255.0f)));
+				for(int channel = 0; channel < 3; channel++)
+				{
+					const __m128 saturated = _mm_min_ps(_mm_max_ps(_mm_add_ps(*channels[channel], dither), zero), one);
+					// the conversion to the 8 bit back buffer rounds to nearest.
+					_mm_store_si128((__m128i*)values[channel], _mm_cvtps_epi32(_mm_mul_ps(saturated, _mm_set1_ps(255.0f))));
+				}
+				const int numberOfPixels = (std::min)(4, _width - x);
+				for(int i = 0; i < numberOfPixels; i++)
+				{
+					target[(x + i) * 3] = (uint8_t)values[0][i];
+					target[(x + i) * 3 + 1] = (uint8_t)values[1][i];
+					target[(x + i) * 3 + 2] = (uint8_t)values[2][i];
+				}
+			}
+		}
+	});
+}
+
+
+void DepthOfFieldAccumulator::reset()
+{
+	_width = 0;
+	_height = 0;
+	_stride = 0;
+	_numberOfFrames = 0;
+	_hdrFrame.clear();
+	_hdrFrame.shrink_to_fit();
+	_accumulator.clear();
+	_accumulator.shrink_to_fit();
+}
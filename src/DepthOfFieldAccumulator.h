@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// CPU implementation of the accumulation IgcsDof.fx performs during a depth of field render: every frame is ramped into HDR (AccentuateWhites), fetched
+/// bilinearly at the alignment delta of its camera step, weighted and blended into a float image with the blend factor as alpha, and the result is
+/// converted back (CorrectForWhiteAccentuation) and dithered to 8 bits per channel. It follows the shader's maths step by step, so it can be used to
+/// check changes to the blending without a GPU and to profile it.
+/// </summary>
+class DepthOfFieldAccumulator
+{
+public:
+	DepthOfFieldAccumulator() = default;
+	~DepthOfFieldAccumulator() = default;
+
+	/// <summary>
+	/// Allocates the accumulator for frames of the size specified and clears it. The highlight values are HighlightBoost and HighlightGammaFactor of the shader.
+	/// </summary>
+	void initialize(int width, int height, float highlightBoostFactor, float highlightGammaFactor);
+	/// <summary>
+	/// Replaces the noise used for dithering with the 512x512 noise texture of the shader (monochrome_gaussnoise.png, 1 byte per texel), so the output can
+	/// be compared with the shader's output pixel by pixel. Without it, a generated noise texture with the same range is used.
+	/// </summary>
+	void setDitherNoise(const uint8_t* noiseTexture);
+	/// <summary>
+	/// Blends the frame specified into the accumulator, like PS_CreateHDRInput followed by PS_HandleStateRender.
+	/// </summary>
+	/// <param name="data">RGB, 3 bytes per pixel, of the size passed to initialize</param>
+	/// <param name="xAlignmentDelta">the AlignmentDelta of the camera step, in texture coordinates</param>
+	/// <param name="yAlignmentDelta"></param>
+	/// <param name="sampleWeightRGB">the SampleWeightR/G/B of the camera step</param>
+	/// <param name="blendFactor">the BlendFactor of the camera step, 1 for the first step, which replaces what's in the accumulator</param>
+	void addFrame(const uint8_t* data, float xAlignmentDelta, float yAlignmentDelta, const float sampleWeightRGB[3], float blendFactor);
+	/// <summary>
+	/// Converts the accumulated frames back to LDR and stores them as RGB, 3 bytes per pixel, in destination, like PS_OutputBlendedResultToFrameBuffer.
+	/// </summary>
+	void resolve(std::vector<uint8_t>& destination);
+	void reset();
+
+	bool isInitialized() { return _accumulator.size() > 0; }
+	int numberOfFrames() { return _numberOfFrames; }
+	int width() { return _width; }
+	int height() { return _height; }
+
+private:
+	int _width = 0;
+	int _height = 0;
+	int _stride = 0;				// the number of floats per row of a plane, a multiple of 4
+	int _numberOfFrames = 0;
+	float _highlightBoostFactor = 0.5f;
+	float _highlightGammaFactor = 2.2f;
+	std::vector<float> _hdrFrame;		// texColorHDR, the red, green and blue planes after each other
+	std::vector<float> _accumulator;	// texBlendAccumulate, same layout
+	std::vector<uint8_t> _ditherNoise;	// 512x512
+};
@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// DepthOfFieldAccumulatorTest: checks DepthOfFieldAccumulator against a float64 model of the accumulation of IgcsDof.fx and benchmarks it at 4K. The
+// model is written straight from the shader, without any of the shortcuts the accumulator takes, so a change to the accumulator which changes the
+// output by more than the rounding of a float shows up as a failed check. The camera steps of DepthOfFieldController::accumulateOnCpu are checked
+// against the model as well, with a step which is skipped.
+//
+// Usage: DepthOfFieldAccumulatorTest [number of steps to benchmark]
+// Returns 0 if the accumulator matches the model, 1 otherwise.
+#define IMGUI_DISABLE_INCLUDE_IMCONFIG_H
+#include "stdafx.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "CameraToolsConnector.h"
+#include "DepthOfFieldAccumulator.h"
+#include "DepthOfFieldController.h"
+
+namespace
+{
+	// odd sizes, so the ends of the rows which don't fill a group of 4 pixels are checked too.
+	constexpr int CheckWidth = 203;
+	constexpr int CheckHeight = 117;
+	constexpr int CheckNumberOfSteps = 16;
+	constexpr int ControllerQuality = 3;
+	constexpr int SkippedStep = 2;
+	constexpr int BenchmarkWidth = 3840;
+	constexpr int BenchmarkHeight = 2160;
+	constexpr int DefaultNumberOfBenchmarkSteps = 64;
+	constexpr int NoiseTextureSize = 512;
+	constexpr double HighlightBoostFactor = 0.9;
+	constexpr double HighlightGammaFactor = 2.2;
+	constexpr double ConeOverlapK = 0.4 * 0.33;
+	// the accumulator uses floats and a polynomial pow, so a channel may be off by 1 after rounding to 8 bits, on a small fraction of the pixels.
+	constexpr int MaximumDifference = 1;
+	constexpr double MaximumFractionOfDifferentChannels = 0.001;
+
+	/// <summary>
+	/// A camera step: the frame rendered at the step, the alignment delta, the sample weights and the blend factor, as the controller passes them to the shader.
+	/// </summary>
+	struct Step
+	{
+		const uint8_t* frame;
+		float xAlignmentDelta;
+		float yAlignmentDelta;
+		float sampleWeightRGB[3];
+		float blendFactor;
+	};
+
+
+	/// <summary>
+	/// A frame with detail everywhere, so no pixel is cheaper to blend than in a real frame.
+	/// </summary>
+	std::vector<uint8_t> createFrame(int width, int height, int seed = 0)
+	{
+		std::vector<uint8_t> frame((size_t)width * height * 3);
+		for(size_t i = 0; i < frame.size(); i++)
+		{
+			frame[i] = (uint8_t)((((i + seed * 7919u) * 2654435761u) >> 13) ^ (i / ((size_t)width * 3)));
+		}
+		return frame;
+	}
+
+
+	std::vector<uint8_t> createNoiseTexture()
+	{
+		std::vector<uint8_t> noise(NoiseTextureSize * NoiseTextureSize);
+		uint32_t state = 12345;
+		for(auto& value : noise)
+		{
+			state = state * 1664525u + 1013904223u;
+			value = (uint8_t)(state >> 24);
+		}
+		return noise;
+	}
+
+
+	/// <summary>
+	/// Steps on a ring, like the rings of the controller's aperture shape, with one step far outside the frame so every fetch of it is clamped.
+	/// </summary>
+	std::vector<Step> createSteps(const std::vector<uint8_t>& frame, int numberOfSteps)
+	{
+		std::vector<Step> steps;
+		for(int i = 0; i < numberOfSteps; i++)
+		{
+			Step step;
+			step.frame = frame.data();
+			step.xAlignmentDelta = (1 == i) ? -2.0f : 0.013f * std::sin(i * 1.7f);
+			step.yAlignmentDelta = 0.011f * std::cos(i * 1.3f);
+			step.sampleWeightRGB[0] = 1.0f + 0.1f * i;
+			step.sampleWeightRGB[1] = 0.9f;
+			step.sampleWeightRGB[2] = 1.1f;
+			step.blendFactor = 1.0f / (i + 1.0f);
+			steps.push_back(step);
+		}
+		return steps;
+	}
+
+
+	/// <summary>
+	/// Multiplies the RGB value specified with the symmetric matrix which has diagonal on the diagonal and offDiagonal elsewhere.
+	/// </summary>
+	void mixChannels(double rgb[3], double diagonal, double offDiagonal)
+	{
+		const double mixed[3] = { diagonal * rgb[0] + offDiagonal * (rgb[1] + rgb[2]), diagonal * rgb[1] + offDiagonal * (rgb[0] + rgb[2]), 
+								  diagonal * rgb[2] + offDiagonal * (rgb[0] + rgb[1]) };
+		std::copy(mixed, mixed + 3, rgb);
+	}
+
+
+	/// <summary>
+	/// The accumulation of the shader in float64: PS_CreateHDRInput and PS_HandleStateRender per step, then PS_OutputBlendedResultToFrameBuffer.
+	/// </summary>
+	std::vector<uint8_t> accumulateWithModel(int width, int height, const std::vector<Step>& steps, const std::vector<uint8_t>& noise)
+	{
+		std::vector<double> hdrFrame((size_t)width * height * 3);
+		auto texel = [&](int x, int y, int channel)
+		{
+			return hdrFrame[((size_t)std::clamp(y, 0, height - 1) * width + std::clamp(x, 0, width - 1)) * 3 + channel];
+		};
+		std::vector<double> accumulator((size_t)width * height * 3, 0.0);
+		for(const Step& step : steps)
+		{
+			// AccentuateWhites
+			for(size_t pixel = 0; pixel < (size_t)width * height; pixel++)
+			{
+				double rgb[3] = { step.frame[pixel * 3] / 255.0, step.frame[pixel * 3 + 1] / 255.0, step.frame[pixel * 3 + 2] / 255.0 };
+				mixChannels(rgb, 1.0 - 2.0 * ConeOverlapK, ConeOverlapK);
+				for(int channel = 0; channel < 3; channel++)
+				{
+					const double ramped = std::pow(std::abs(rgb[channel]), HighlightGammaFactor);
+					hdrFrame[pixel * 3 + channel] = ramped / (std::max)(1.001 - HighlightBoostFactor * ramped, 0.001);
+				}
+			}
+			for(int y = 0; y < height; y++)
+			{
+				for(int x = 0; x < width; x++)
+				{
+					// the y delta is scaled with the aspect ratio in the shader, so both deltas are in units of the width.
+					const double sourceX = x + (double)step.xAlignmentDelta * width;
+					const double sourceY = y + (double)step.yAlignmentDelta * width;
+					const int x0 = (int)std::floor(sourceX);
+					const int y0 = (int)std::floor(sourceY);
+					const double fractionX = sourceX - x0;
+					const double fractionY = sourceY - y0;
+					for(int channel = 0; channel < 3; channel++)
+					{
+						const double top = texel(x0, y0, channel) * (1.0 - fractionX) + texel(x0 + 1, y0, channel) * fractionX;
+						const double bottom = texel(x0, y0 + 1, channel) * (1.0 - fractionX) + texel(x0 + 1, y0 + 1, channel) * fractionX;
+						double& destination = accumulator[((size_t)y * width + x) * 3 + channel];
+						destination = (top * (1.0 - fractionY) + bottom * fractionY) * step.sampleWeightRGB[channel] * step.blendFactor + destination * (1.0 - step.blendFactor);
+					}
+				}
+			}
+		}
+		// CorrectForWhiteAccentuation and the dither
+		std::vector<uint8_t> result((size_t)width * height * 3);
+		for(int y = 0; y < height; y++)
+		{
+			for(int x = 0; x < width; x++)
+			{
+				const size_t pixel = (size_t)y * width + x;
+				double rgb[3];
+				for(int channel = 0; channel < 3; channel++)
+				{
+					const double value = accumulator[pixel * 3 + channel];
+					rgb[channel] = std::pow(std::abs(value / (1.001 + HighlightBoostFactor * value)), 1.0 / HighlightGammaFactor);
+				}
+				mixChannels(rgb, (ConeOverlapK - 1.0) / (3.0 * ConeOverlapK - 1.0), ConeOverlapK / (3.0 * ConeOverlapK - 1.0));
+				const double noiseValue = noise[(size_t)(y % NoiseTextureSize) * NoiseTextureSize + (x % NoiseTextureSize)] / 255.0;
+				const double dither = -0.5 / 255.0 + noiseValue / 255.0;
+				for(int channel = 0; channel < 3; channel++)
+				{
+					result[pixel * 3 + channel] = (uint8_t)std::floor(std::clamp(rgb[channel] + dither, 0.0, 1.0) * 255.0 + 0.5);
+				}
+			}
+		}
+		return result;
+	}
+
+
+	std::vector<uint8_t> accumulate(DepthOfFieldAccumulator& accumulator, int width, int height, const std::vector<Step>& steps)
+	{
+		accumulator.initialize(width, height, (float)HighlightBoostFactor, (float)HighlightGammaFactor);
+		for(const Step& step : steps)
+		{
+			accumulator.addFrame(step.frame, step.xAlignmentDelta, step.yAlignmentDelta, step.sampleWeightRGB, step.blendFactor);
+		}
+		std::vector<uint8_t> result;
+		accumulator.resolve(result);
+		return result;
+	}
+
+
+	bool compareWithModel(const char* description, const std::vector<uint8_t>& result, const std::vector<uint8_t>& expected)
+	{
+		if(result.size() != expected.size())
+		{
+			printf("FAILED: %s: the accumulator returned %zu bytes instead of %zu\n", description, result.size(), expected.size());
+			return false;
+		}
+		int largestDifference = 0;
+		size_t numberOfDifferentChannels = 0;
+		for(size_t i = 0; i < result.size(); i++)
+		{
+			const int difference = std::abs((int)result[i] - (int)expected[i]);
+			largestDifference = (std::max)(largestDifference, difference);
+			numberOfDifferentChannels += (difference > 0) ? 1 : 0;
+		}
+		const double fractionOfDifferentChannels = (double)numberOfDifferentChannels / (double)result.size();
+		const bool isMatch = largestDifference <= MaximumDifference && fractionOfDifferentChannels <= MaximumFractionOfDifferentChannels;
+		printf("%s: %s: largest difference with the model %d, %.4f%% of the channels differ\n", isMatch ? "OK" : "FAILED", description, largestDifference, 
+			   fractionOfDifferentChannels * 100.0);
+		return isMatch;
+	}
+
+
+	bool checkAgainstModel()
+	{
+		const std::vector<uint8_t> frame = createFrame(CheckWidth, CheckHeight);
+		const std::vector<uint8_t> noise = createNoiseTexture();
+		const std::vector<Step> steps = createSteps(frame, CheckNumberOfSteps);
+		DepthOfFieldAccumulator accumulator;
+		accumulator.setDitherNoise(noise.data());
+		const std::vector<uint8_t> result = accumulate(accumulator, CheckWidth, CheckHeight, steps);
+		return compareWithModel("accumulator", result, accumulateWithModel(CheckWidth, CheckHeight, steps, noise));
+	}
+
+
+	/// <summary>
+	/// Renders the camera steps of a controller with accumulateOnCpu, with a different frame per step and one step without a frame, and checks the result
+	/// against the model of the steps the controller reports, without the skipped step. The blend factors of the steps after the skipped one have to follow 
+	/// the number of frames accumulated, or the frames aren't weighted evenly.
+	/// </summary>
+	bool checkControllerAgainstModel()
+	{
+		CameraToolsConnector connector;
+		DepthOfFieldController controller(connector);
+		controller.setHighlightBoostFactor((float)HighlightBoostFactor);
+		controller.setHighlightGammaFactor((float)HighlightGammaFactor);
+		controller.setSphericalAberrationDimFactor(0.5f);
+		controller.setFringeIntensity(0.5f);
+		controller.setQuality(ControllerQuality);
+		const int numberOfSteps = controller.getTotalNumberOfStepsToTake();
+		std::vector<std::vector<uint8_t>> framePerStep;
+		for(int i = 0; i < numberOfSteps; i++)
+		{
+			framePerStep.push_back(createFrame(CheckWidth, CheckHeight, i));
+		}
+		const std::vector<uint8_t> noise = createNoiseTexture();
+		DepthOfFieldAccumulator accumulator;
+		accumulator.setDitherNoise(noise.data());
+		controller.accumulateOnCpu(accumulator, CheckWidth, CheckHeight, [&](int step) { return SkippedStep == step ? nullptr : framePerStep[step].data(); });
+		std::vector<uint8_t> result;
+		accumulator.resolve(result);
+		std::vector<Step> steps;
+		for(int i = 0; i < numberOfSteps; i++)
+		{
+			if(SkippedStep == i)
+			{
+				continue;
+			}
+			Step step;
+			step.frame = framePerStep[i].data();
+			controller.getShaderValuesForStep(i, (int)steps.size(), step.xAlignmentDelta, step.yAlignmentDelta, step.sampleWeightRGB, step.blendFactor);
+			steps.push_back(step);
+		}
+		if(numberOfSteps <= SkippedStep || accumulator.numberOfFrames() != (int)steps.size())
+		{
+			printf("FAILED: the controller accumulated %d of the %zu steps with a frame\n", accumulator.numberOfFrames(), steps.size());
+			return false;
+		}
+		return compareWithModel("controller steps with a skipped step", result, accumulateWithModel(CheckWidth, CheckHeight, steps, noise));
+	}
+
+
+	void benchmark(int numberOfSteps)
+	{
+		const std::vector<uint8_t> frame = createFrame(BenchmarkWidth, BenchmarkHeight);
+		const std::vector<Step> steps = createSteps(frame, numberOfSteps);
+		DepthOfFieldAccumulator accumulator;
+		const auto start = std::chrono::steady_clock::now();
+		accumulate(accumulator, BenchmarkWidth, BenchmarkHeight, steps);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const double numberOfSamples = (double)BenchmarkWidth * BenchmarkHeight * numberOfSteps;
+		printf("%d steps at %dx%d: %.2f seconds, %.1f million samples per second\n", numberOfSteps, BenchmarkWidth, BenchmarkHeight, seconds, 
+			   numberOfSamples / (seconds * 1000000.0));
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const int numberOfBenchmarkSteps = argc > 1 ? (std::max)(atoi(argv[1]), 1) : DefaultNumberOfBenchmarkSteps;
+	bool isMatch = checkAgainstModel();
+	isMatch &= checkControllerAgainstModel();
+	benchmark(numberOfBenchmarkSteps);
+	return isMatch ? 0 : 1;
+}
@@ -291,15 +291,50 @@ void DepthOfFieldController::performRenderFrameSetupWork()
 	_xAlignmentDelta = currentFrameData.xAlignmentDelta;
 	_yAlignmentDelta = currentFrameData.yAlignmentDelta;
 	_frameWaitCounter = _numberOfFramesToWaitPerFrame;
-	_blendFactor = 1.0f / (static_cast<float>(_currentFrame) + 1.0f);		// frame start at 0 so +1, to get 1/1=100% blend factor for first frame
+	determineBlendValues(_currentFrame, _currentFrame, _blendFactor, _sampleWeightRGB);
+	// Set the framestate to wait so the counter will take effect.
+	_renderFrameState = DepthOfFieldRenderFrameState::FrameWait;
+}
+
+
+void DepthOfFieldController::determineBlendValues(int frameIndex, int numberOfFramesAccumulated, float& blendFactor, float sampleWeightRGB[3])
+{
+	const auto& frameData = _cameraSteps[frameIndex];
+	blendFactor = 1.0f / (static_cast<float>(numberOfFramesAccumulated) + 1.0f);		// +1, to get 1/1=100% blend factor for the first frame
 
 	//since the lerp blending implicitly already divides the sum by N, we must not do it again, so compensate
 	float numSamples =  _cameraSteps.size();
-	_sampleWeightRGB[0] = currentFrameData.sampleWeightRGB[0] * numSamples;
-	_sampleWeightRGB[1] = currentFrameData.sampleWeightRGB[1] * numSamples;
-	_sampleWeightRGB[2] = currentFrameData.sampleWeightRGB[2] * numSamples;
-	// Set the framestate to wait so the counter will take effect.
-	_renderFrameState = DepthOfFieldRenderFrameState::FrameWait;
+	sampleWeightRGB[0] = frameData.sampleWeightRGB[0] * numSamples;
+	sampleWeightRGB[1] = frameData.sampleWeightRGB[1] * numSamples;
+	sampleWeightRGB[2] = frameData.sampleWeightRGB[2] * numSamples;
+}
+
+
+void DepthOfFieldController::accumulateOnCpu(DepthOfFieldAccumulator& accumulator, int width, int height, const std::function<const uint8_t*(int)>& frameForStep)
+{
+	accumulator.initialize(width, height, _highlightBoostFactor, _highlightGammaFactor);
+	for(int i = 0; i < (int)_cameraSteps.size(); i++)
+	{
+		const uint8_t* frame = frameForStep(i);
+		if(nullptr == frame)
+		{
+			continue;
+		}
+		float xAlignmentDelta, yAlignmentDelta, blendFactor;
+		float sampleWeightRGB[3];
+		// skipped steps aren't in the accumulator, so the blend factor follows the frames accumulated, not the step index, or the average is off.
+		getShaderValuesForStep(i, accumulator.numberOfFrames(), xAlignmentDelta, yAlignmentDelta, sampleWeightRGB, blendFactor);
+		accumulator.addFrame(frame, xAlignmentDelta, yAlignmentDelta, sampleWeightRGB, blendFactor);
+	}
+}
+
+
+void DepthOfFieldController::getShaderValuesForStep(int stepIndex, int numberOfFramesAccumulated, float& xAlignmentDelta, float& yAlignmentDelta, float sampleWeightRGB[3], 
+													float& blendFactor)
+{
+	xAlignmentDelta = _cameraSteps[stepIndex].xAlignmentDelta;
+	yAlignmentDelta = _cameraSteps[stepIndex].yAlignmentDelta;
+	determineBlendValues(stepIndex, numberOfFramesAccumulated, blendFactor, sampleWeightRGB);
 }
 
 
@@ -45,6 +45,7 @@
 #include "Utils.h"
 
 #include "ReshadeStateSnapshot.h"
+#include "DepthOfFieldAccumulator.h"
 
 class DepthOfFieldController
 {
@@ -149,6 +150,18 @@ public:
 	void loadIniFileData(CDataFile& iniFile);
 	void saveIniFileData(CDataFile& iniFile);
 	void invalidateShapePoints() { calculateShapePoints(); }
+	/// <summary>
+	/// Renders the current camera steps with the CPU implementation of the shader's accumulation, with the same alignment deltas, sample weights and
+	/// blend factors a render uses. Call resolve on the accumulator afterwards to get the final image.
+	/// </summary>
+	/// <param name="frameForStep">returns the frame (RGB, width x height) rendered at the camera step with the index passed in. If it returns nullptr, the step is skipped</param>
+	void accumulateOnCpu(DepthOfFieldAccumulator& accumulator, int width, int height, const std::function<const uint8_t*(int)>& frameForStep);
+	/// <summary>
+	/// Returns the alignment delta, sample weights and blend factor the shader gets for the camera step with the index specified, which is blended over the
+	/// number of frames specified. These are the values accumulateOnCpu passes to the accumulator.
+	/// </summary>
+	void getShaderValuesForStep(int stepIndex, int numberOfFramesAccumulated, float& xAlignmentDelta, float& yAlignmentDelta, float sampleWeightRGB[3], 
+								float& blendFactor);
 
 	// setters
 	void setNumberOfFramesToWaitPerFrame(int newValue) { _numberOfFramesToWaitPerFrame = newValue; }
@@ -277,6 +290,11 @@ private:
 	/// Method which will setup the frame for blending, moving the camera, configuring the shader.
 	/// </summary>
 	void performRenderFrameSetupWork();
+	/// <summary>
+	/// Calculates the blend factor and the per channel sample weights the shader uses for the camera step with the index specified, which is blended
+	/// over the number of frames specified.
+	/// </summary>
+	void determineBlendValues(int frameIndex, int numberOfFramesAccumulated, float& blendFactor, float sampleWeightRGB[3]);
 	bool isReshadeStateEmpty()
 	{
 		std::scoped_lock lock(_reshadeStateMutex);
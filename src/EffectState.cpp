@@ -152,6 +152,17 @@ void EffectState::applyStateFromTo(reshade::api::effect_runtime* runtime, Effect
 }
 
 
+bool EffectState::getUniformFloatVariable(const std::string& uniformName, float& valueRead)
+{
+	if(!_uniformFloatValuePerName.contains(uniformName))
+	{
+		return false;
+	}
+	valueRead = _uniformFloatValuePerName[uniformName].x;
+	return true;
+}
+
+
 void EffectState::setUniformIntVariable(reshade::api::effect_runtime* runtime, const std::string& uniformName, int valueToWrite)
 {
 	if(!_uniformVariableIdPerName.contains(uniformName))
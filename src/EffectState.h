@@ -61,6 +61,10 @@ public:
 	/// <param name="idSource"></param>
 	void migrateIds(const EffectState& idSource);
 	void applyStateFromTo(reshade::api::effect_runtime* runtime, EffectState destinationEffect, float interpolationFactor);
+	/// <summary>
+	/// Reads the first value of the float uniform specified, as it was when the state was obtained. Returns false if the uniform isn't a known float uniform.
+	/// </summary>
+	bool getUniformFloatVariable(const std::string& uniformName, float& valueRead);
 	void setUniformIntVariable(reshade::api::effect_runtime* runtime, const std::string& uniformName, int valueToWrite);
 	void setUniformFloatVariable(reshade::api::effect_runtime* runtime, const std::string& uniformName, float valueToWrite);
 	void setUniformFloat2Variable(reshade::api::effect_runtime* runtime, const std::string& uniformName, float value1ToWrite, float value2ToWrite);
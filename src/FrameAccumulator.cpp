@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "FrameAccumulator.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace
+{
+	// the accumulator is processed in chunks of this many values per work item, a multiple of 16.
+	constexpr size_t ValuesPerWorkItem = 256 * 1024;
+}
+
+
+void FrameAccumulator::initialize(int width, int height)
+{
+	_width = width;
+	_height = height;
+	_numberOfFrames = 0;
+	_totalWeight = 0.0f;
+	_accumulator.assign((size_t)width * height * 3, 0.0f);
+}
+
+
+void FrameAccumulator::addFrame(const uint8_t* data, float weight)
+{
+	if(nullptr == data || !isInitialized())
+	{
+		return;
+	}
+	const size_t numberOfValues = _accumulator.size();
+	const int numberOfWorkItems = (int)((numberOfValues + ValuesPerWorkItem - 1) / ValuesPerWorkItem);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const size_t start = (size_t)workItem * ValuesPerWorkItem;
+		const size_t end = (std::min)(start + ValuesPerWorkItem, numberOfValues);
+		float* accumulator = _accumulator.data();
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 weights = _mm_set1_ps(weight);
+		size_t i = start;
+		for(; i + 16 <= end; i += 16)
+		{
+			const __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+			const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+			const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+			_mm_storeu_ps(accumulator + i, _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), weights)));
+			_mm_storeu_ps(accumulator + i + 4, _mm_add_ps(_mm_loadu_ps(accumulator + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), weights)));
+			_mm_storeu_ps(accumulator + i + 8, _mm_add_ps(_mm_loadu_ps(accumulator + i + 8), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), weights)));
+			_mm_storeu_ps(accumulator + i + 12, _mm_add_ps(_mm_loadu_ps(accumulator + i + 12), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), weights)));
+		}
+		for(; i < end; i++)
+		{
+			accumulator[i] += data[i] * weight;
+		}
+	});
+	_numberOfFrames++;
+	_totalWeight += weight;
+}
+
+
+void FrameAccumulator::resolve(std::vector<uint8_t>& destination)
+{
+	if(!isInitialized() || _totalWeight <= 0.0f)
+	{
+		return;
+	}
+	const size_t numberOfValues = _accumulator.size();
+	destination.resize(numberOfValues);
+	const float scale = 1.0f / _totalWeight;
+	const int numberOfWorkItems = (int)((numberOfValues + ValuesPerWorkItem - 1) / ValuesPerWorkItem);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const size_t start = (size_t)workItem * ValuesPerWorkItem;
+		const size_t end = (std::min)(start + ValuesPerWorkItem, numberOfValues);
+		const float* accumulator = _accumulator.data();
+		const __m128 scales = _mm_set1_ps(scale);
+		size_t i = start;
+		for(; i + 16 <= end; i += 16)
+		{
+			// cvtps rounds to nearest, the packs saturate to 0-255.
+			const __m128i values0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(accumulator + i), scales));
+			const __m128i values1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(accumulator + i + 4), scales));
+			const __m128i values2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(accumulator + i + 8), scales));
+			const __m128i values3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(accumulator + i + 12), scales));
+			_mm_storeu_si128((__m128i*)(destination.data() + i), _mm_packus_epi16(_mm_packs_epi32(values0, values1), _mm_packs_epi32(values2, values3)));
+		}
+		for(; i < end; i++)
+		{
+			destination[i] = (uint8_t)std::clamp((int)(accumulator[i] * scale + 0.5f), 0, 255);
+		}
+	});
+}
+
+
+void FrameAccumulator::reset()
+{
+	_width = 0;
+	_height = 0;
+	_numberOfFrames = 0;
+	_totalWeight = 0.0f;
+	_accumulator.clear();
+	_accumulator.shrink_to_fit();
+}
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Accumulates RGB frames into a float image, e.g. to average jittered frames for supersampling. The frames themselves don't have to be kept, so the memory
+/// used is a single float image, regardless of the number of frames added.
+/// </summary>
+class FrameAccumulator
+{
+public:
+	FrameAccumulator() = default;
+	~FrameAccumulator() = default;
+
+	/// <summary>
+	/// Allocates the accumulator for frames of the size specified and clears it.
+	/// </summary>
+	void initialize(int width, int height);
+	/// <summary>
+	/// Adds the frame specified, multiplied by weight, to the accumulator. 
+	/// </summary>
+	/// <param name="data">RGB, 3 bytes per pixel, of the size passed to initialize</param>
+	/// <param name="weight">the weight of the frame in the final image</param>
+	void addFrame(const uint8_t* data, float weight = 1.0f);
+	/// <summary>
+	/// Divides the accumulated frames by the total weight and stores the result as RGB, 3 bytes per pixel, in destination.
+	/// </summary>
+	void resolve(std::vector<uint8_t>& destination);
+	void reset();
+
+	bool isInitialized() { return _accumulator.size() > 0; }
+	int numberOfFrames() { return _numberOfFrames; }
+	int width() { return _width; }
+	int height() { return _height; }
+
+private:
+	int _width = 0;
+	int _height = 0;
+	int _numberOfFrames = 0;
+	float _totalWeight = 0.0f;
+	std::vector<float> _accumulator;
+};
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// FrameBusConsumer: the reference consumer of the frame bus of IGCS Connector. Takes the frames a path recording publishes off the bus, writes them as 
+// PNG files and appends their camera pose to poses.csv, outside the game process. Handles one recording after the other until it's closed. 
+//
+// Usage: FrameBusConsumer <output folder> [bus name]
+#include "stdafx.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fpng.h"
+#include "FrameBusProtocol.h"
+#include "SharedMemoryRegion.h"
+
+using namespace IGCS::FrameBus;
+
+namespace
+{
+	constexpr auto PollInterval = std::chrono::milliseconds(1);
+	constexpr auto WaitForBusInterval = std::chrono::milliseconds(250);
+
+	/// <summary>
+	/// Opens the bus with the name specified, waiting until a producer has created it. A bus of which the producer has closed and all frames have been
+	/// consumed is from a previous recording, so it's skipped.
+	/// </summary>
+	FrameBusHeader* waitForBus(SharedMemoryRegion& region, const std::string& name)
+	{
+		while(true)
+		{
+			if(region.open(name) && region.size() >= sizeof(FrameBusHeader))
+			{
+				FrameBusHeader* header = (FrameBusHeader*)region.data();
+				const bool isValid = Magic == header->magic && Version == header->version &&
+									 region.size() >= busSizeInBytes(header->numberOfSlots, header->slotSizeInBytes);
+				const bool isFinished = header->isProducerClosed.load(std::memory_order_acquire) &&
+										header->numberOfConsumedFrames.load() == header->numberOfPublishedFrames.load(std::memory_order_acquire);
+				if(isValid && !isFinished)
+				{
+					std::atomic_thread_fence(std::memory_order_acquire);
+					return header;
+				}
+				region.close();
+			}
+			std::this_thread::sleep_for(WaitForBusInterval);
+		}
+	}
+
+
+	bool writeFrame(const std::string& outputFolder, const FrameBusSlotHeader* slot)
+	{
+		if(PixelFormat::Rgb8 != slot->pixelFormat || slot->dataSizeInBytes < slot->width * slot->height * 3)
+		{
+			return false;
+		}
+		char filename[1024];
+		snprintf(filename, sizeof(filename), "%s/frame_%.6llu.png", outputFolder.c_str(), (unsigned long long)slot->frameIndex);
+		// the pixel data is encoded straight from the slot.
+		return fpng::fpng_encode_image_to_file(filename, (const uint8_t*)slot + sizeof(FrameBusSlotHeader), slot->width, slot->height, 3);
+	}
+
+
+	void writePose(FILE* poseFile, const FrameBusSlotHeader* slot)
+	{
+		if(nullptr == poseFile || !slot->hasPose)
+		{
+			return;
+		}
+		const CameraPose& pose = slot->pose;
+		fprintf(poseFile, "%llu,%f,%f,%f,%f,%f,%f,%f,%f\n", (unsigned long long)slot->frameIndex, pose.position[0], pose.position[1], pose.position[2],
+				pose.orientation[0], pose.orientation[1], pose.orientation[2], pose.orientation[3], pose.fovDegrees);
+	}
+
+
+	/// <summary>
+	/// Consumes the frames of the bus until the producer has closed it and every frame has been consumed. The frames available are written in parallel,
+	/// after which their slots are handed back to the producer in one go.
+	/// </summary>
+	void consumeRecording(FrameBusHeader* header, const std::string& outputFolder, FILE* poseFile)
+	{
+		const uint64_t maximumBatchSize = (std::max)(std::thread::hardware_concurrency(), 1u);
+		uint64_t numberOfFramesWritten = 0;
+		uint64_t numberOfFramesFailed = 0;
+		while(true)
+		{
+			header->consumerHeartbeat.fetch_add(1, std::memory_order_relaxed);
+			// read the closed flag first, so no frame published before the producer closed the bus is missed.
+			const bool isProducerClosed = 0 != header->isProducerClosed.load(std::memory_order_acquire);
+			const uint64_t numberOfPublishedFrames = header->numberOfPublishedFrames.load(std::memory_order_acquire);
+			const uint64_t numberOfConsumedFrames = header->numberOfConsumedFrames.load(std::memory_order_relaxed);
+			if(numberOfConsumedFrames == numberOfPublishedFrames)
+			{
+				if(isProducerClosed)
+				{
+					break;
+				}
+				std::this_thread::sleep_for(PollInterval);
+				continue;
+			}
+			const uint64_t batchSize = (std::min)(numberOfPublishedFrames - numberOfConsumedFrames, maximumBatchSize);
+			std::vector<uint8_t> isWritten(batchSize, 0);
+			std::vector<std::thread> writers;
+			for(uint64_t i = 0; i < batchSize; i++)
+			{
+				writers.emplace_back([&, i] { isWritten[i] = writeFrame(outputFolder, slotHeader(header, numberOfConsumedFrames + i)) ? 1 : 0; });
+			}
+			for(std::thread& writer : writers)
+			{
+				writer.join();
+			}
+			for(uint64_t i = 0; i < batchSize; i++)
+			{
+				writePose(poseFile, slotHeader(header, numberOfConsumedFrames + i));
+				isWritten[i] ? numberOfFramesWritten++ : numberOfFramesFailed++;
+			}
+			// the slots are owned by the producer again from here on.
+			header->numberOfConsumedFrames.store(numberOfConsumedFrames + batchSize, std::memory_order_release);
+			printf("\rFrames written: %llu, failed: %llu", (unsigned long long)numberOfFramesWritten, (unsigned long long)numberOfFramesFailed);
+		}
+		printf("\nRecording done.\n");
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		printf("Usage: FrameBusConsumer <output folder> [bus name]\n");
+		return 1;
+	}
+	const std::string outputFolder = argv[1];
+	const std::string busName = argc > 2 ? argv[2] : DefaultName;
+	fpng::fpng_init();
+	FILE* poseFile = nullptr;
+	fopen_s(&poseFile, (outputFolder + "/poses.csv").c_str(), "a");
+	if(nullptr == poseFile)
+	{
+		printf("Can't write to %s\n", outputFolder.c_str());
+		return 1;
+	}
+	while(true)
+	{
+		printf("Waiting for a recording on frame bus '%s'...\n", busName.c_str());
+		SharedMemoryRegion region;
+		FrameBusHeader* header = waitForBus(region, busName);
+		printf("Recording started: %u slots of %u bytes.\n", header->numberOfSlots, header->slotSizeInBytes);
+		consumeRecording(header, outputFolder, poseFile);
+		fflush(poseFile);
+	}
+	return 0;
+}
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "FrameBusProducer.h"
+#include <new>
+#include <thread>
+
+using namespace IGCS::FrameBus;
+
+namespace
+{
+	// a consumer of which the heartbeat hasn't changed for this long is considered to have stopped or crashed.
+	constexpr auto ConsumerTimeout = std::chrono::milliseconds(2000);
+	constexpr auto WaitForConsumerPollInterval = std::chrono::milliseconds(1);
+}
+
+
+FrameBusProducer::~FrameBusProducer()
+{
+	close();
+}
+
+
+bool FrameBusProducer::create(const std::string& name, int numberOfSlots, uint32_t maximumFrameSizeInBytes, FrameBusFullPolicy fullPolicy)
+{
+	close();
+	if(numberOfSlots <= 0 || maximumFrameSizeInBytes <= 0)
+	{
+		return false;
+	}
+	const uint32_t slotSizeInBytes = slotSizeForFrameSize(maximumFrameSizeInBytes);
+	if(!_region.create(name, busSizeInBytes((uint32_t)numberOfSlots, slotSizeInBytes)))
+	{
+		return false;
+	}
+	_header = new(_region.data()) FrameBusHeader();
+	_header->numberOfSlots = (uint32_t)numberOfSlots;
+	_header->slotSizeInBytes = slotSizeInBytes;
+	_header->version = Version;
+	_header->numberOfPublishedFrames.store(0);
+	_header->numberOfConsumedFrames.store(0);
+	_header->consumerHeartbeat.store(0);
+	_header->isProducerClosed.store(0);
+	// the magic is written last, so a consumer which opens the bus early doesn't see a half initialized header.
+	std::atomic_thread_fence(std::memory_order_release);
+	_header->magic = Magic;
+	_fullPolicy = fullPolicy;
+	_maximumFrameSizeInBytes = maximumFrameSizeInBytes;
+	_numberOfDroppedFrames = 0;
+	_numberOfConsumedFrames = 0;
+	_lastSeenHeartbeat = 0;
+	_lastHeartbeatChangeTime = std::chrono::steady_clock::now();
+	return true;
+}
+
+
+void FrameBusProducer::close()
+{
+	if(!isOpen())
+	{
+		return;
+	}
+	_numberOfConsumedFrames = _header->numberOfConsumedFrames.load(std::memory_order_acquire);
+	_header->isProducerClosed.store(1, std::memory_order_release);
+	_header = nullptr;
+	// the consumer keeps its own mapping, so it can consume the frames still in the bus.
+	_region.close();
+}
+
+
+uint8_t* FrameBusProducer::acquireFrameBuffer()
+{
+	if(!isOpen())
+	{
+		return nullptr;
+	}
+	if(!hasFreeSlot() && FrameBusFullPolicy::WaitForConsumer == _fullPolicy)
+	{
+		while(!hasFreeSlot() && isConsumerAlive())
+		{
+			std::this_thread::sleep_for(WaitForConsumerPollInterval);
+		}
+	}
+	if(!hasFreeSlot())
+	{
+		_numberOfDroppedFrames++;
+		return nullptr;
+	}
+	return slotData(slotHeader(_header, _header->numberOfPublishedFrames.load(std::memory_order_relaxed)));
+}
+
+
+void FrameBusProducer::publishFrame(uint64_t frameIndex, int width, int height, PixelFormat pixelFormat, uint32_t dataSizeInBytes, const CameraPose* pose)
+{
+	if(!isOpen())
+	{
+		return;
+	}
+	const uint64_t numberOfPublishedFrames = _header->numberOfPublishedFrames.load(std::memory_order_relaxed);
+	FrameBusSlotHeader* slot = slotHeader(_header, numberOfPublishedFrames);
+	slot->frameIndex = frameIndex;
+	slot->width = (uint32_t)width;
+	slot->height = (uint32_t)height;
+	slot->pixelFormat = pixelFormat;
+	slot->dataSizeInBytes = (std::min)(dataSizeInBytes, _maximumFrameSizeInBytes);
+	slot->hasPose = nullptr != pose ? 1 : 0;
+	slot->pose = nullptr != pose ? *pose : CameraPose();
+	// the release makes the slot header and pixel data visible to the consumer before the new count.
+	_header->numberOfPublishedFrames.store(numberOfPublishedFrames + 1, std::memory_order_release);
+}
+
+
+bool FrameBusProducer::isConsumerAlive()
+{
+	if(!isOpen())
+	{
+		return false;
+	}
+	const uint64_t heartbeat = _header->consumerHeartbeat.load(std::memory_order_relaxed);
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(heartbeat != _lastSeenHeartbeat)
+	{
+		_lastSeenHeartbeat = heartbeat;
+		_lastHeartbeatChangeTime = now;
+	}
+	return 0 != heartbeat && now - _lastHeartbeatChangeTime < ConsumerTimeout;
+}
+
+
+int FrameBusProducer::numberOfFramesInFlight()
+{
+	if(!isOpen())
+	{
+		return 0;
+	}
+	return (int)(_header->numberOfPublishedFrames.load(std::memory_order_relaxed) - _header->numberOfConsumedFrames.load(std::memory_order_acquire));
+}
+
+
+uint64_t FrameBusProducer::numberOfConsumedFrames()
+{
+	if(isOpen())
+	{
+		_numberOfConsumedFrames = _header->numberOfConsumedFrames.load(std::memory_order_acquire);
+	}
+	return _numberOfConsumedFrames;
+}
+
+
+bool FrameBusProducer::hasFreeSlot()
+{
+	return numberOfFramesInFlight() < (int)_header->numberOfSlots;
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "ConstantsEnums.h"
+#include "FrameBusProtocol.h"
+#include "SharedMemoryRegion.h"
+
+/// <summary>
+/// The game side of a frame bus: publishes frames to a consumer in an external process through a ring of slots in shared memory, so encoding and writing 
+/// frames doesn't compete with the game for memory and can't take the game down if it fails. Frames are written straight into a slot, so publishing a frame
+/// doesn't copy it. The consumer is considered to have stopped when its heartbeat hasn't changed for a while, after which frames are dropped instead of 
+/// waited for. Not thread safe, all methods are called on the render thread.
+/// </summary>
+class FrameBusProducer
+{
+public:
+	FrameBusProducer() = default;
+	~FrameBusProducer();
+
+	/// <summary>
+	/// Creates the shared memory of the bus with the name specified. Returns false if it can't be created, e.g. because a consumer of a previous bus
+	/// with the same name is still attached.
+	/// </summary>
+	bool create(const std::string& name, int numberOfSlots, uint32_t maximumFrameSizeInBytes, FrameBusFullPolicy fullPolicy);
+	/// <summary>
+	/// Marks the bus as closed, so the consumer stops once it has consumed the frames published, and releases the shared memory of this process.
+	/// </summary>
+	void close();
+	/// <summary>
+	/// Returns the buffer the next frame has to be written to, of maximumFrameSizeInBytes. If all slots are held by the consumer, the frame is dropped
+	/// and nullptr is returned, after waiting for the consumer to free a slot if the policy is WaitForConsumer and the consumer is alive. 
+	/// </summary>
+	uint8_t* acquireFrameBuffer();
+	/// <summary>
+	/// Hands the frame written to the buffer returned by the last acquireFrameBuffer call to the consumer. pose can be nullptr.
+	/// </summary>
+	void publishFrame(uint64_t frameIndex, int width, int height, IGCS::FrameBus::PixelFormat pixelFormat, uint32_t dataSizeInBytes, const CameraPose* pose);
+	/// <summary>
+	/// Returns true if a consumer has attached and its heartbeat has recently changed.
+	/// </summary>
+	bool isConsumerAlive();
+
+	bool isOpen() { return nullptr != _header; }
+	int numberOfSlots() { return isOpen() ? (int)_header->numberOfSlots : 0; }
+	int numberOfFramesInFlight();
+	uint64_t numberOfPublishedFrames() { return isOpen() ? _header->numberOfPublishedFrames.load(std::memory_order_relaxed) : 0; }
+	uint64_t numberOfConsumedFrames();
+	int numberOfDroppedFrames() { return _numberOfDroppedFrames; }
+
+private:
+	bool hasFreeSlot();
+
+	SharedMemoryRegion _region;
+	IGCS::FrameBus::FrameBusHeader* _header = nullptr;
+	FrameBusFullPolicy _fullPolicy = FrameBusFullPolicy::DropFrame;
+	uint32_t _maximumFrameSizeInBytes = 0;
+	int _numberOfDroppedFrames = 0;
+	uint64_t _numberOfConsumedFrames = 0;			// kept after the bus has been closed, for the statistics of the last recording
+	uint64_t _lastSeenHeartbeat = 0;
+	std::chrono::steady_clock::time_point _lastHeartbeatChangeTime;
+};
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "GrabbedFrame.h"
+
+/// <summary>
+/// The layout of the shared memory of a frame bus, which is shared by the producer in the game process and the consumer in an external process. The memory
+/// starts with a FrameBusHeader, followed by the slots. Every slot starts with a FrameBusSlotHeader, followed by the pixel data of the frame. The slots form
+/// a ring with a single producer and a single consumer: the producer writes the slot of frame numberOfPublishedFrames and the consumer reads the slot of frame
+/// numberOfConsumedFrames. A slot is owned by the consumer from the moment it's published until the consumer increments numberOfConsumedFrames, so neither
+/// side copies the pixel data.
+/// </summary>
+namespace IGCS::FrameBus
+{
+	constexpr uint32_t Magic = 0x42464749;			// 'IGFB'
+	constexpr uint32_t Version = 1;
+	constexpr char DefaultName[] = "IgcsConnectorFrameBus";
+	// slot headers and pixel data start at a multiple of this, so the consumer can use aligned loads.
+	constexpr uint32_t SlotAlignment = 64;
+
+	enum class PixelFormat : uint32_t
+	{
+		Rgb8,			// 3 bytes per pixel, rows are tightly packed
+	};
+
+	struct alignas(64) FrameBusHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numberOfSlots;
+		uint32_t slotSizeInBytes;						// including the slot header
+		alignas(64) std::atomic<uint64_t> numberOfPublishedFrames;	// written by the producer only
+		alignas(64) std::atomic<uint64_t> numberOfConsumedFrames;	// written by the consumer only
+		alignas(64) std::atomic<uint64_t> consumerHeartbeat;		// incremented by the consumer while it's alive, 0 if no consumer has attached yet
+		std::atomic<uint32_t> isProducerClosed;					// 1 once the producer won't publish any more frames
+	};
+
+	struct alignas(64) FrameBusSlotHeader
+	{
+		uint64_t frameIndex;			// the number of the frame in the recording, which has gaps if frames were dropped
+		uint32_t width;
+		uint32_t height;
+		PixelFormat pixelFormat;
+		uint32_t dataSizeInBytes;
+		uint32_t hasPose;				// 1 if pose contains the camera pose at the moment the frame was rendered, 0 if no camera data was available
+		CameraPose pose;
+	};
+
+	inline uint32_t slotSizeForFrameSize(uint32_t frameSizeInBytes)
+	{
+		const uint32_t slotSize = (uint32_t)sizeof(FrameBusSlotHeader) + frameSizeInBytes;
+		return (slotSize + SlotAlignment - 1) / SlotAlignment * SlotAlignment;
+	}
+
+	inline size_t busSizeInBytes(uint32_t numberOfSlots, uint32_t slotSizeInBytes)
+	{
+		return sizeof(FrameBusHeader) + (size_t)numberOfSlots * slotSizeInBytes;
+	}
+
+	inline FrameBusSlotHeader* slotHeader(FrameBusHeader* header, uint64_t frameNumber)
+	{
+		uint8_t* const slots = (uint8_t*)header + sizeof(FrameBusHeader);
+		return (FrameBusSlotHeader*)(slots + (size_t)(frameNumber % header->numberOfSlots) * header->slotSizeInBytes);
+	}
+
+	inline uint8_t* slotData(FrameBusSlotHeader* slot)
+	{
+		return (uint8_t*)slot + sizeof(FrameBusSlotHeader);
+	}
+}
@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "FrameStacker.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+	// the frames are processed in chunks of this many values per work item, a multiple of 16.
+	constexpr size_t ValuesPerWorkItem = 64 * 1024;
+	// the number of standard deviations a value can be away from the median before it's clipped by the sigma clipped mean.
+	constexpr float SigmaClippingFactor = 2.0f;
+	constexpr int MaximumNumberOfClippingIterations = 3;
+
+	struct Comparator
+	{
+		uint8_t low;
+		uint8_t high;
+	};
+
+
+	/// <summary>
+	/// Creates Batcher's odd-even merge sort network for the number of values specified. The network is built for the next power of two and the comparators
+	/// which touch values past the end are dropped, which is the same as padding with values larger than any other value.
+	/// </summary>
+	std::vector<Comparator> createSortingNetwork(int numberOfValues)
+	{
+		std::vector<Comparator> network;
+		int paddedNumberOfValues = 1;
+		while(paddedNumberOfValues < numberOfValues)
+		{
+			paddedNumberOfValues *= 2;
+		}
+		for(int p = 1; p < paddedNumberOfValues; p *= 2)
+		{
+			for(int k = p; k >= 1; k /= 2)
+			{
+				for(int j = k % p; j + k < paddedNumberOfValues; j += 2 * k)
+				{
+					for(int i = 0; i < k && i + j + k < paddedNumberOfValues; i++)
+					{
+						const int low = i + j;
+						const int high = i + j + k;
+						if((low / (2 * p)) == (high / (2 * p)) && high < numberOfValues)
+						{
+							network.push_back({ (uint8_t)low, (uint8_t)high });
+						}
+					}
+				}
+			}
+		}
+		return network;
+	}
+
+
+	/// <summary>
+	/// Returns the mean of the sorted values specified, after iteratively removing the values further than SigmaClippingFactor standard deviations away from
+	/// the median.
+	/// </summary>
+	uint8_t sigmaClippedMean(const uint8_t* sortedValues, int numberOfValues)
+	{
+		int start = 0;
+		int end = numberOfValues;
+		float mean = 0.0f;
+		for(int iteration = 0; iteration < MaximumNumberOfClippingIterations; iteration++)
+		{
+			const int count = end - start;
+			float sum = 0.0f;
+			float sumOfSquares = 0.0f;
+			for(int i = start; i < end; i++)
+			{
+				sum += sortedValues[i];
+				sumOfSquares += (float)sortedValues[i] * sortedValues[i];
+			}
+			mean = sum / count;
+			// never clip closer than a single step, so frames which differ only by rounding aren't clipped.
+			const float maximumDeviation = (std::max)(SigmaClippingFactor * sqrtf((std::max)(sumOfSquares / count - mean * mean, 0.0f)), 1.0f);
+			const float median = 0.5f * (sortedValues[start + (count - 1) / 2] + sortedValues[start + count / 2]);
+			const int previousCount = count;
+			while(start < end - 1 && sortedValues[start] < median - maximumDeviation)
+			{
+				start++;
+			}
+			while(end - 1 > start && sortedValues[end - 1] > median + maximumDeviation)
+			{
+				end--;
+			}
+			if(end - start == previousCount)
+			{
+				break;
+			}
+			if(iteration == MaximumNumberOfClippingIterations - 1)
+			{
+				// values were clipped in the last iteration, so the mean has to be updated. 
+				sum = 0.0f;
+				for(int i = start; i < end; i++)
+				{
+					sum += sortedValues[i];
+				}
+				mean = sum / (end - start);
+			}
+		}
+		return (uint8_t)(std::min)((int)(mean + 0.5f), 255);
+	}
+
+
+	/// <summary>
+	/// Stacks 16 values per frame with a sorting network. samples has to contain a register per frame, which are sorted in place.
+	/// </summary>
+	__m128i stackWithNetwork(__m128i* samples, int numberOfFrames, const std::vector<Comparator>& network, FrameStackingMethod method)
+	{
+		if(FrameStackingMethod::Mean == method)
+		{
+			// 16 bit sums don't overflow up to 257 frames, which is more than the network handles.
+			const __m128i zero = _mm_setzero_si128();
+			__m128i sumLow = zero;
+			__m128i sumHigh = zero;
+			for(int i = 0; i < numberOfFrames; i++)
+			{
+				sumLow = _mm_add_epi16(sumLow, _mm_unpacklo_epi8(samples[i], zero));
+				sumHigh = _mm_add_epi16(sumHigh, _mm_unpackhi_epi8(samples[i], zero));
+			}
+			const __m128 scale = _mm_set1_ps(1.0f / numberOfFrames);
+			const __m128i values0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(sumLow, zero)), scale));
+			const __m128i values1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(sumLow, zero)), scale));
+			const __m128i values2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(sumHigh, zero)), scale));
+			const __m128i values3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(sumHigh, zero)), scale));
+			return _mm_packus_epi16(_mm_packs_epi32(values0, values1), _mm_packs_epi32(values2, values3));
+		}
+		for(const Comparator& comparator : network)
+		{
+			const __m128i low = samples[comparator.low];
+			samples[comparator.low] = _mm_min_epu8(low, samples[comparator.high]);
+			samples[comparator.high] = _mm_max_epu8(low, samples[comparator.high]);
+		}
+		if(FrameStackingMethod::Median == method)
+		{
+			// with an even number of frames, the median is the average of the two middle values.
+			return (numberOfFrames & 1) ? samples[numberOfFrames / 2] : _mm_avg_epu8(samples[numberOfFrames / 2 - 1], samples[numberOfFrames / 2]);
+		}
+		alignas(16) uint8_t sortedValues[IGCS::FrameStacker::MaximumNumberOfFramesForNetwork][16];
+		for(int i = 0; i < numberOfFrames; i++)
+		{
+			_mm_store_si128((__m128i*)sortedValues[i], samples[i]);
+		}
+		alignas(16) uint8_t result[16];
+		uint8_t laneValues[IGCS::FrameStacker::MaximumNumberOfFramesForNetwork];
+		for(int lane = 0; lane < 16; lane++)
+		{
+			for(int i = 0; i < numberOfFrames; i++)
+			{
+				laneValues[i] = sortedValues[i][lane];
+			}
+			result[lane] = sigmaClippedMean(laneValues, numberOfFrames);
+		}
+		return _mm_load_si128((const __m128i*)result);
+	}
+
+
+	/// <summary>
+	/// Stacks a single value per frame, for more frames than the network handles. values is sorted in place.
+	/// </summary>
+	uint8_t stackWithSort(std::vector<uint8_t>& values, FrameStackingMethod method)
+	{
+		const int numberOfFrames = (int)values.size();
+		if(FrameStackingMethod::Mean == method)
+		{
+			int sum = 0;
+			for(const uint8_t value : values)
+			{
+				sum += value;
+			}
+			return (uint8_t)((sum + numberOfFrames / 2) / numberOfFrames);
+		}
+		std::sort(values.begin(), values.end());
+		if(FrameStackingMethod::Median == method)
+		{
+			return (uint8_t)((values[(numberOfFrames - 1) / 2] + values[numberOfFrames / 2] + 1) / 2);
+		}
+		return sigmaClippedMean(values.data(), numberOfFrames);
+	}
+}
+
+
+namespace IGCS::FrameStacker
+{
+	void stack(const std::vector<const uint8_t*>& frames, size_t numberOfValues, FrameStackingMethod method, std::vector<uint8_t>& destination)
+	{
+		const int numberOfFrames = (int)frames.size();
+		if(numberOfFrames <= 0 || numberOfValues <= 0)
+		{
+			return;
+		}
+		destination.resize(numberOfValues);
+		const bool useNetwork = numberOfFrames <= MaximumNumberOfFramesForNetwork;
+		const std::vector<Comparator> network = useNetwork ? createSortingNetwork(numberOfFrames) : std::vector<Comparator>();
+		const int numberOfWorkItems = (int)((numberOfValues + ValuesPerWorkItem - 1) / ValuesPerWorkItem);
+		IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+		{
+			const size_t start = (size_t)workItem * ValuesPerWorkItem;
+			const size_t end = (std::min)(start + ValuesPerWorkItem, numberOfValues);
+			if(useNetwork)
+			{
+				__m128i samples[MaximumNumberOfFramesForNetwork];
+				size_t i = start;
+				for(; i + 16 <= end; i += 16)
+				{
+					for(int frame = 0; frame < numberOfFrames; frame++)
+					{
+						samples[frame] = _mm_loadu_si128((const __m128i*)(frames[frame] + i));
+					}
+					_mm_storeu_si128((__m128i*)(destination.data() + i), stackWithNetwork(samples, numberOfFrames, network, method));
+				}
+				if(i < end)
+				{
+					// the last values of the frame: pad them to a full register.
+					const size_t numberOfRemainingValues = end - i;
+					alignas(16) uint8_t paddedValues[16] = {};
+					for(int frame = 0; frame < numberOfFrames; frame++)
+					{
+						memcpy(paddedValues, frames[frame] + i, numberOfRemainingValues);
+						samples[frame] = _mm_load_si128((const __m128i*)paddedValues);
+					}
+					_mm_store_si128((__m128i*)paddedValues, stackWithNetwork(samples, numberOfFrames, network, method));
+					memcpy(destination.data() + i, paddedValues, numberOfRemainingValues);
+				}
+				return;
+			}
+			std::vector<uint8_t> values(numberOfFrames);
+			for(size_t i = start; i < end; i++)
+			{
+				for(int frame = 0; frame < numberOfFrames; frame++)
+				{
+					values[frame] = frames[frame][i];
+				}
+				destination[i] = stackWithSort(values, method);
+			}
+		});
+	}
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ConstantsEnums.h"
+
+namespace IGCS::FrameStacker
+{
+	/// <summary>
+	/// Combines the frames specified into a single frame with a per value robust estimator, e.g. to remove the noise of path traced or stochastic effects from
+	/// frames taken at the same camera position. The frames are processed in tiles of 16 values, spread over all cores, so the median needs only the values
+	/// of a single tile of every frame at a time. Up to MaximumNumberOfFramesForNetwork frames, the values of a tile are sorted with an SSE2 sorting network, 
+	/// which sorts 16 values per instruction. 
+	/// </summary>
+	/// <param name="frames">the frames to stack. Every frame has to contain numberOfValues bytes</param>
+	/// <param name="numberOfValues">the number of bytes per frame, e.g. width * height * 3 for RGB</param>
+	/// <param name="method">the estimator used to combine the values of a pixel</param>
+	/// <param name="destination">receives the stacked frame, numberOfValues bytes</param>
+	void stack(const std::vector<const uint8_t*>& frames, size_t numberOfValues, FrameStackingMethod method, std::vector<uint8_t>& destination);
+
+	// with more frames than this, the values are sorted with std::sort instead of a sorting network.
+	constexpr int MaximumNumberOfFramesForNetwork = 64;
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "CameraToolsData.h"
+
+/// <summary>
+/// The pose of the camera at the moment a shot was taken, as reported by the camera tools.
+/// </summary>
+struct CameraPose
+{
+	float position[3] = { 0.0f, 0.0f, 0.0f };
+	float orientation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };		// look quaternion, qx, qy, qz, qw
+	float rightVector[3] = { 1.0f, 0.0f, 0.0f };			// right/up/forward vectors of the camera, in world space
+	float upVector[3] = { 0.0f, 1.0f, 0.0f };
+	float forwardVector[3] = { 0.0f, 0.0f, 1.0f };
+	float fovDegrees = 0.0f;
+
+	/// <summary>
+	/// Copies the pose from the camera tools data. Returns false if the data doesn't contain a pose yet: the buffer is zeroed until the camera tools fill it
+	/// in, so a pose is only present once the camera is enabled or the rotation vectors have been set.
+	/// </summary>
+	bool obtainFromCameraToolsData(const CameraToolsData& data)
+	{
+		bool hasRotation = false;
+		for(int i = 0; i < 3; i++)
+		{
+			position[i] = data.coordinates.values[i];
+			rightVector[i] = data.rotationMatrixRightVector.values[i];
+			upVector[i] = data.rotationMatrixUpVector.values[i];
+			forwardVector[i] = data.rotationMatrixForwardVector.values[i];
+			hasRotation |= 0.0f != rightVector[i] || 0.0f != upVector[i] || 0.0f != forwardVector[i];
+		}
+		for(int i = 0; i < 4; i++)
+		{
+			orientation[i] = data.lookQuaternion.values[i];
+		}
+		fovDegrees = data.fov;
+		return 0 != data.cameraEnabled || hasRotation;
+	}
+};
+
+
+/// <summary>
+/// The rectangle of the backbuffer, in pixels, which is captured for every shot. Covers the whole backbuffer unless a region of interest is used.
+/// </summary>
+struct CaptureRegion
+{
+	int left = 0;
+	int top = 0;
+	int width = 0;
+	int height = 0;
+};
+
+
+/// <summary>
+/// A shot grabbed during a screenshot session, with the pose of the camera at the moment the shot was grabbed.
+/// </summary>
+struct GrabbedFrame
+{
+	std::vector<uint8_t> data;		// RGB data, 3 bytes per pixel.
+	CameraPose pose;
+	bool hasPose = false;			// false if no camera data was available when the shot was grabbed
+	int shotIndex = 0;				// the index of the shot in the session, which determines where the camera was when the shot was taken
+	int gridRow = 0;				// for lightfield grids: the row and column of the shot in the grid. Always 0 for the other shot types.
+	int gridColumn = 0;
+	std::vector<float> radiance;	// with exposure bracketing or high bit depth capture: linear RGB, 3 floats per pixel. Empty otherwise.
+	std::vector<float> depth;		// with depth capture: the raw depth in [0, 1] as stored in the depth buffer, 1 float per pixel. Empty otherwise.
+	uint64_t captureTimeMicroseconds = 0;	// since 1970-01-01 UTC
+	int numberOfFramesWaited = 0;	// the number of frames presented between the previous shot and this one
+};
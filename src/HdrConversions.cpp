@@ -0,0 +1,237 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "HdrConversions.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	// the rows are processed in bands of this many rows per work item.
+	constexpr int RowsPerWorkItem = 16;
+	// scRGB has 1.0 at 80 nits.
+	constexpr float NitsPerScRgbUnit = 80.0f;
+
+	// PQ (SMPTE ST 2084) constants
+	constexpr float PqM1 = 2610.0f / 16384.0f;
+	constexpr float PqM2 = 2523.0f / 4096.0f * 128.0f;
+	constexpr float PqC1 = 3424.0f / 4096.0f;
+	constexpr float PqC2 = 2413.0f / 4096.0f * 32.0f;
+	constexpr float PqC3 = 2392.0f / 4096.0f * 32.0f;
+	constexpr float PqMaximumNits = 10000.0f;
+
+	// row major, linear RGB.
+	constexpr float Bt2020ToBt709[9] = { 1.660491f, -0.587641f, -0.072850f,
+										 -0.124550f, 1.132900f, -0.008349f,
+										 -0.018151f, -0.100579f, 1.118730f };
+	constexpr float Bt709ToBt2020[9] = { 0.627404f, 0.329283f, 0.043313f,
+										 0.069097f, 0.919540f, 0.011362f,
+										 0.016391f, 0.088013f, 0.895595f };
+
+	float srgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+
+	/// <summary>
+	/// Converts 4 half floats, in the lower 16 bits of every 32 bit lane, to floats. The exponent is rebiased by a multiplication, which handles denormals as
+	/// well. Infinity and NaN get their exponent set to all ones afterwards.
+	/// </summary>
+	__m128 halvesToFloats(__m128i halves)
+	{
+		const __m128i exponentAndMantissa = _mm_and_si128(halves, _mm_set1_epi32(0x7FFF));
+		const __m128i sign = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x8000)), 16);
+		const __m128 rebiased = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponentAndMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));
+		const __m128i isInfinityOrNaN = _mm_cmpgt_epi32(exponentAndMantissa, _mm_set1_epi32(0x7BFF));
+		const __m128i bits = _mm_or_si128(_mm_castps_si128(rebiased), _mm_and_si128(isInfinityOrNaN, _mm_set1_epi32(0x7F800000)));
+		return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+	}
+
+
+	void convertTenBitRows(const uint8_t* source, uint32_t rowPitch, int width, int startRow, int endRow, bool isBgr, const float* linearPerValue, bool convertPrimaries, 
+						   float* destination)
+	{
+		const __m128 m00 = _mm_set1_ps(Bt2020ToBt709[0]), m01 = _mm_set1_ps(Bt2020ToBt709[1]), m02 = _mm_set1_ps(Bt2020ToBt709[2]);
+		const __m128 m10 = _mm_set1_ps(Bt2020ToBt709[3]), m11 = _mm_set1_ps(Bt2020ToBt709[4]), m12 = _mm_set1_ps(Bt2020ToBt709[5]);
+		const __m128 m20 = _mm_set1_ps(Bt2020ToBt709[6]), m21 = _mm_set1_ps(Bt2020ToBt709[7]), m22 = _mm_set1_ps(Bt2020ToBt709[8]);
+		const int redShift = isBgr ? 20 : 0;
+		const int blueShift = isBgr ? 0 : 20;
+		for(int y = startRow; y < endRow; y++)
+		{
+			const uint32_t* sourceRow = (const uint32_t*)(source + (size_t)y * rowPitch);
+			float* destinationRow = destination + (size_t)y * width * 3;
+			for(int x = 0; x < width; x += 4)
+			{
+				// 4 pixels at a time: the curve is looked up per channel, the primaries are converted as 3 vectors of 4 reds, greens and blues.
+				const int numberOfPixels = (std::min)(4, width - x);
+				alignas(16) float reds[4] = {}, greens[4] = {}, blues[4] = {};
+				for(int i = 0; i < numberOfPixels; i++)
+				{
+					const uint32_t pixel = sourceRow[x + i];
+					reds[i] = linearPerValue[(pixel >> redShift) & 0x3FF];
+					greens[i] = linearPerValue[(pixel >> 10) & 0x3FF];
+					blues[i] = linearPerValue[(pixel >> blueShift) & 0x3FF];
+				}
+				if(convertPrimaries)
+				{
+					const __m128 r = _mm_load_ps(reds);
+					const __m128 g = _mm_load_ps(greens);
+					const __m128 b = _mm_load_ps(blues);
+					_mm_store_ps(reds, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, r), _mm_mul_ps(m01, g)), _mm_mul_ps(m02, b)));
+					_mm_store_ps(greens, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, r), _mm_mul_ps(m11, g)), _mm_mul_ps(m12, b)));
+					_mm_store_ps(blues, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, r), _mm_mul_ps(m21, g)), _mm_mul_ps(m22, b)));
+				}
+				for(int i = 0; i < numberOfPixels; i++)
+				{
+					destinationRow[(x + i) * 3] = reds[i];
+					destinationRow[(x + i) * 3 + 1] = greens[i];
+					destinationRow[(x + i) * 3 + 2] = blues[i];
+				}
+			}
+		}
+	}
+
+
+	void convertHalfFloatRows(const uint8_t* source, uint32_t rowPitch, int width, int startRow, int endRow, float* destination)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		for(int y = startRow; y < endRow; y++)
+		{
+			const uint8_t* sourceRow = source + (size_t)y * rowPitch;
+			float* destinationRow = destination + (size_t)y * width * 3;
+			for(int x = 0; x < width; x++)
+			{
+				// RGBA, 8 bytes per pixel. The RGB values are stored as a 4 float vector, of which the 4th float is overwritten by the next pixel, except 
+				// for the last pixel of the row, which could be the end of the destination.
+				const __m128 rgba = halvesToFloats(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(sourceRow + (size_t)x * 8)), zero));
+				if(x < width - 1)
+				{
+					_mm_storeu_ps(destinationRow + x * 3, rgba);
+				}
+				else
+				{
+					alignas(16) float values[4];
+					_mm_store_ps(values, rgba);
+					memcpy(destinationRow + x * 3, values, 3 * sizeof(float));
+				}
+			}
+		}
+	}
+}
+
+
+namespace IGCS::HdrConversions
+{
+	void convertToLinear(const uint8_t* source, uint32_t rowPitch, int width, int height, HighBitDepthPixelFormat pixelFormat, bool tenBitIsPq, 
+						 std::vector<float>& destination)
+	{
+		if(nullptr == source || width <= 0 || height <= 0 || HighBitDepthPixelFormat::Unsupported == pixelFormat)
+		{
+			return;
+		}
+		destination.resize((size_t)width * height * 3);
+		// 10 bit values only have 1024 possible values per channel, so the curve is looked up.
+		float linearPerValue[1024];
+		for(int i = 0; i < 1024; i++)
+		{
+			linearPerValue[i] = tenBitIsPq ? pqToNits(i / 1023.0f) / NitsPerScRgbUnit : srgbToLinear(i / 1023.0f);
+		}
+		const int numberOfWorkItems = (height + RowsPerWorkItem - 1) / RowsPerWorkItem;
+		IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+		{
+			const int startRow = workItem * RowsPerWorkItem;
+			const int endRow = (std::min)(startRow + RowsPerWorkItem, height);
+			switch(pixelFormat)
+			{
+			case HighBitDepthPixelFormat::R10G10B10A2:
+			case HighBitDepthPixelFormat::B10G10R10A2:
+				convertTenBitRows(source, rowPitch, width, startRow, endRow, HighBitDepthPixelFormat::B10G10R10A2 == pixelFormat, linearPerValue, tenBitIsPq, 
+								  destination.data());
+				break;
+			case HighBitDepthPixelFormat::R16G16B16A16Float:
+				convertHalfFloatRows(source, rowPitch, width, startRow, endRow, destination.data());
+				break;
+			case HighBitDepthPixelFormat::Unsupported:
+				// rejected above.
+				break;
+			}
+		});
+	}
+
+
+	void convertLinearToPq16(const std::vector<float>& source, std::vector<uint16_t>& destination)
+	{
+		const size_t numberOfPixels = source.size() / 3;
+		destination.resize(numberOfPixels * 3);
+		const int numberOfWorkItems = (int)((numberOfPixels + 65535) / 65536);
+		IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+		{
+			const size_t start = (size_t)workItem * 65536;
+			const size_t end = (std::min)(start + 65536, numberOfPixels);
+			for(size_t i = start; i < end; i++)
+			{
+				const float* rgb = source.data() + i * 3;
+				for(int channel = 0; channel < 3; channel++)
+				{
+					const float* matrixRow = Bt709ToBt2020 + channel * 3;
+					const float value = matrixRow[0] * rgb[0] + matrixRow[1] * rgb[1] + matrixRow[2] * rgb[2];
+					destination[i * 3 + channel] = (uint16_t)(nitsToPq(value * NitsPerScRgbUnit) * 65535.0f + 0.5f);
+				}
+			}
+		});
+	}
+
+
+	float halfToFloat(uint16_t value)
+	{
+		return _mm_cvtss_f32(halvesToFloats(_mm_cvtsi32_si128(value)));
+	}
+
+
+	float pqToNits(float value)
+	{
+		const float power = powf(std::clamp(value, 0.0f, 1.0f), 1.0f / PqM2);
+		return PqMaximumNits * powf((std::max)(power - PqC1, 0.0f) / (PqC2 - PqC3 * power), 1.0f / PqM1);
+	}
+
+
+	float nitsToPq(float nits)
+	{
+		const float power = powf(std::clamp(nits / PqMaximumNits, 0.0f, 1.0f), PqM1);
+		return powf((PqC1 + PqC2 * power) / (1.0f + PqC3 * power), PqM2);
+	}
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ConstantsEnums.h"
+
+namespace IGCS::HdrConversions
+{
+	/// <summary>
+	/// Converts a high bit depth image, as read from the backbuffer, to linear scRGB: BT.709 primaries with 1.0 at 80 nits. Colors outside BT.709 get
+	/// negative values. 10 bit images are decoded with the PQ curve and converted from BT.2020 primaries, or with the sRGB curve if they're not HDR10.
+	/// The image is converted in rows spread over all cores.
+	/// </summary>
+	/// <param name="source">the pixels, 4 bytes (10 bit formats) or 8 bytes (16 bit float) per pixel</param>
+	/// <param name="rowPitch">the number of bytes between the start of two rows in source</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="pixelFormat"></param>
+	/// <param name="tenBitIsPq">true if 10 bit images are HDR10, false if they're SDR with the sRGB curve</param>
+	/// <param name="destination">receives the linear RGB values, 3 floats per pixel</param>
+	void convertToLinear(const uint8_t* source, uint32_t rowPitch, int width, int height, HighBitDepthPixelFormat pixelFormat, bool tenBitIsPq, 
+						 std::vector<float>& destination);
+	/// <summary>
+	/// Converts linear scRGB to 16 bit PQ encoded values with BT.2020 primaries, the HDR10 encoding. Negative values after the conversion to BT.2020 are clipped.
+	/// </summary>
+	/// <param name="source">linear RGB values, 3 floats per pixel</param>
+	/// <param name="destination">receives the PQ encoded values, 3 per pixel</param>
+	void convertLinearToPq16(const std::vector<float>& source, std::vector<uint16_t>& destination);
+	/// <summary>
+	/// Converts a half float to a float. Handles denormals, infinity and NaN.
+	/// </summary>
+	float halfToFloat(uint16_t value);
+	/// <summary>
+	/// The PQ (SMPTE ST 2084) curve: converts a PQ encoded value in [0, 1] to nits and back.
+	/// </summary>
+	float pqToNits(float value);
+	float nitsToPq(float nits);
+}
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// HdrConversionsTest: checks IGCS::HdrConversions against reference values: the PQ curve against the SMPTE ST 2084 reference points, and the conversion 
+// to linear scRGB on synthetic R10G10B10A2, B10G10R10A2 and R16G16B16A16F buffers, with padded rows and widths which aren't a multiple of 4.
+//
+// Usage: HdrConversionsTest
+// Returns 0 if all checks pass, 1 otherwise.
+#include "stdafx.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "HdrConversions.h"
+
+namespace
+{
+	// the number of padding bytes at the end of every row of the synthetic buffers, like a row pitch rounded up by the gpu.
+	constexpr uint32_t RowPadding = 12;
+
+	bool check(bool condition, const char* description)
+	{
+		if(!condition)
+		{
+			printf("FAILED: %s\n", description);
+		}
+		return condition;
+	}
+
+
+	bool isNear(float value, double expected, double relativeTolerance)
+	{
+		return fabs(value - expected) <= relativeTolerance * (std::max)(fabs(expected), 1e-3);
+	}
+
+
+	bool checkPqCurve()
+	{
+		using namespace IGCS::HdrConversions;
+		bool isMatch = check(isNear(pqToNits(0.0f), 0.0, 1e-4), "PQ 0 isn't 0 nits");
+		isMatch &= check(isNear(pqToNits(0.5f), 92.2457, 1e-3), "PQ 0.5 isn't 92.25 nits");
+		isMatch &= check(isNear(pqToNits(0.508078f), 100.0, 1e-3), "PQ 0.508078 isn't 100 nits");
+		isMatch &= check(isNear(pqToNits(0.751827f), 1000.0, 1e-3), "PQ 0.751827 isn't 1000 nits");
+		isMatch &= check(isNear(pqToNits(1.0f), 10000.0, 1e-4), "PQ 1 isn't 10000 nits");
+		isMatch &= check(isNear(nitsToPq(100.0f), 0.508078, 1e-4) && isNear(nitsToPq(1000.0f), 0.751827, 1e-4), "nits aren't encoded as the reference PQ values");
+		return isMatch;
+	}
+
+
+	/// <summary>
+	/// A 10 bit buffer of 5 x 2 pixels with padded rows: greys at the PQ codes specified, then a pure BT.2020 red.
+	/// </summary>
+	std::vector<uint8_t> createTenBitBuffer(bool isBgr, const uint32_t codes[4], uint32_t redCode, uint32_t& rowPitch)
+	{
+		constexpr int Width = 5;
+		rowPitch = Width * 4 + RowPadding;
+		std::vector<uint8_t> toReturn(rowPitch * 2, 0xFF);
+		for(int y = 0; y < 2; y++)
+		{
+			uint32_t* row = (uint32_t*)(toReturn.data() + y * rowPitch);
+			for(int x = 0; x < 4; x++)
+			{
+				row[x] = codes[x] | (codes[x] << 10) | (codes[x] << 20) | (3u << 30);
+			}
+			row[4] = (isBgr ? redCode << 20 : redCode) | (3u << 30);
+		}
+		return toReturn;
+	}
+
+
+	bool checkTenBit()
+	{
+		// the scRGB values of the greys, 1.0 is 80 nits. A grey is still a grey after the conversion from BT.2020 to BT.709 primaries.
+		const uint32_t pqCodes[4] = { 0, 520, 769, 1023 };
+		const double pqGreys[4] = { 0.0, 1.2528735691397093, 12.48665488806298, 125.0 };
+		// BT.2020 red is outside BT.709, so its green and blue are negative.
+		const double bt2020RedInBt709[3] = { 1.660491, -0.124550, -0.018151 };
+		bool isMatch = true;
+		for(int isBgr = 0; isBgr < 2; isBgr++)
+		{
+			uint32_t rowPitch;
+			const std::vector<uint8_t> buffer = createTenBitBuffer(isBgr, pqCodes, 520, rowPitch);
+			std::vector<float> linear;
+			IGCS::HdrConversions::convertToLinear(buffer.data(), rowPitch, 5, 2, isBgr ? HighBitDepthPixelFormat::B10G10R10A2 : HighBitDepthPixelFormat::R10G10B10A2,
+												  true, linear);
+			if(!check(linear.size() == 5 * 2 * 3, "a 10 bit image isn't converted to 3 floats per pixel"))
+			{
+				return false;
+			}
+			for(int y = 0; y < 2; y++)
+			{
+				const float* row = linear.data() + y * 5 * 3;
+				for(int x = 0; x < 4; x++)
+				{
+					for(int channel = 0; channel < 3; channel++)
+					{
+						isMatch &= check(isNear(row[x * 3 + channel], pqGreys[x], 2e-4), "a PQ encoded grey isn't converted to the reference scRGB value");
+					}
+				}
+				for(int channel = 0; channel < 3; channel++)
+				{
+					isMatch &= check(isNear(row[4 * 3 + channel], bt2020RedInBt709[channel] * pqGreys[1], 1e-3), 
+									 isBgr ? "BT.2020 red in B10G10R10A2 isn't converted to the reference scRGB value" 
+										   : "BT.2020 red in R10G10B10A2 isn't converted to the reference scRGB value");
+				}
+			}
+		}
+
+		// without HDR10, the sRGB curve is used and the primaries are left as they are.
+		const uint32_t srgbCodes[4] = { 0, 20, 512, 1023 };
+		const double srgbGreys[4] = { 0.0, 0.0015131843754634126, 0.21449380614942534, 1.0 };
+		uint32_t rowPitch;
+		const std::vector<uint8_t> buffer = createTenBitBuffer(false, srgbCodes, 1023, rowPitch);
+		std::vector<float> linear;
+		IGCS::HdrConversions::convertToLinear(buffer.data(), rowPitch, 5, 2, HighBitDepthPixelFormat::R10G10B10A2, false, linear);
+		for(int x = 0; x < 4; x++)
+		{
+			isMatch &= check(isNear(linear[x * 3], srgbGreys[x], 1e-3) && isNear(linear[x * 3 + 2], srgbGreys[x], 1e-3), 
+							 "an sRGB encoded grey isn't converted to the reference linear value");
+		}
+		isMatch &= check(linear[4 * 3] == 1.0f && linear[4 * 3 + 1] == 0.0f && linear[4 * 3 + 2] == 0.0f, "sRGB red isn't left pure red");
+		return isMatch;
+	}
+
+
+	bool checkHalfFloat()
+	{
+		// half floats with their float values: normal values, a denormal, the largest half and infinity.
+		const uint16_t halves[9] = { 0x3C00, 0xB800, 0x5640, 0x0001, 0x7BFF, 0x7C00, 0x0000, 0x4000, 0x3555 };
+		const float expected[9] = { 1.0f, -0.5f, 100.0f, 5.9604645e-8f, 65504.0f, INFINITY, 0.0f, 2.0f, 0.33325195f };
+		// 3 x 2 pixels, RGBA, with padded rows. Alpha is a value which would stand out if it ended up in the destination.
+		constexpr int Width = 3;
+		const uint32_t rowPitch = Width * 8 + RowPadding;
+		std::vector<uint8_t> buffer(rowPitch * 2, 0xFF);
+		for(int y = 0; y < 2; y++)
+		{
+			uint16_t* row = (uint16_t*)(buffer.data() + y * rowPitch);
+			for(int x = 0; x < Width; x++)
+			{
+				for(int channel = 0; channel < 3; channel++)
+				{
+					row[x * 4 + channel] = halves[x * 3 + channel];
+				}
+				row[x * 4 + 3] = 0x7777;
+			}
+		}
+		std::vector<float> linear;
+		IGCS::HdrConversions::convertToLinear(buffer.data(), rowPitch, Width, 2, HighBitDepthPixelFormat::R16G16B16A16Float, true, linear);
+		if(!check(linear.size() == Width * 2 * 3, "a half float image isn't converted to 3 floats per pixel"))
+		{
+			return false;
+		}
+		bool isMatch = true;
+		for(int y = 0; y < 2; y++)
+		{
+			for(int i = 0; i < 9; i++)
+			{
+				isMatch &= check(linear[y * 9 + i] == expected[i], "a half float isn't converted to its exact float value");
+			}
+		}
+		return isMatch;
+	}
+
+
+	bool checkPq16()
+	{
+		// scRGB white is 80 nits, which is PQ 0.485857. White stays white in BT.2020.
+		std::vector<float> linear = { 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+		std::vector<uint16_t> pq;
+		IGCS::HdrConversions::convertLinearToPq16(linear, pq);
+		bool isMatch = check(pq.size() == 6, "linear values aren't converted to 3 PQ values per pixel");
+		for(int channel = 0; channel < 3 && isMatch; channel++)
+		{
+			isMatch &= check(abs((int)pq[channel] - 31841) <= 8 && pq[3 + channel] == 0, "scRGB isn't encoded as the reference 16 bit PQ value");
+		}
+		return isMatch;
+	}
+}
+
+
+int main()
+{
+	bool isMatch = checkPqCurve();
+	isMatch &= checkTenBit();
+	isMatch &= checkHalfFloat();
+	isMatch &= checkPq16();
+	const uint8_t pixel[8] = {};
+	std::vector<float> linear;
+	IGCS::HdrConversions::convertToLinear(pixel, 8, 1, 1, HighBitDepthPixelFormat::Unsupported, true, linear);
+	isMatch &= check(linear.empty(), "an unsupported format is converted");
+	printf("%s\n", isMatch ? "OK" : "FAILED");
+	return isMatch ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "HdrMerger.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+	// the merger is processed in chunks of this many values per work item, a multiple of 4.
+	constexpr size_t ValuesPerWorkItem = 256 * 1024;
+	// the smallest total weight of a value, so values which are black or white in all brackets don't divide by 0.
+	constexpr float MinimumWeight = 1e-6f;
+
+	float srgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+}
+
+
+void HdrMerger::initialize(int width, int height)
+{
+	_width = width;
+	_height = height;
+	_numberOfBrackets = 0;
+	_radianceSum.assign((size_t)width * height * 3, 0.0f);
+	_weightSum.assign((size_t)width * height * 3, 0.0f);
+}
+
+
+void HdrMerger::addBracket(const uint8_t* data, float exposureStops, bool isDarkestBracket, bool isBrightestBracket)
+{
+	if(nullptr == data || !isInitialized())
+	{
+		return;
+	}
+	// the weight and the weighted radiance only depend on the byte value, so they're looked up per value.
+	const float exposureScale = 1.0f / exp2f(exposureStops);
+	float weightPerValue[256];
+	float weightedRadiancePerValue[256];
+	for(int i = 0; i < 256; i++)
+	{
+		// hat function: 1 in the middle, 0 at black and white.
+		float weight = 1.0f - fabsf((float)i - 127.5f) / 127.5f;
+		if((isDarkestBracket && i > 127) || (isBrightestBracket && i < 128))
+		{
+			weight = 1.0f;
+		}
+		weightPerValue[i] = weight;
+		weightedRadiancePerValue[i] = weight * srgbToLinear(i / 255.0f) * exposureScale;
+	}
+
+	const size_t numberOfValues = _radianceSum.size();
+	const int numberOfWorkItems = (int)((numberOfValues + ValuesPerWorkItem - 1) / ValuesPerWorkItem);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const size_t start = (size_t)workItem * ValuesPerWorkItem;
+		const size_t end = (std::min)(start + ValuesPerWorkItem, numberOfValues);
+		float* radianceSum = _radianceSum.data();
+		float* weightSum = _weightSum.data();
+		size_t i = start;
+		for(; i + 4 <= end; i += 4)
+		{
+			const __m128 radiances = _mm_setr_ps(weightedRadiancePerValue[data[i]], weightedRadiancePerValue[data[i + 1]], weightedRadiancePerValue[data[i + 2]], 
+												 weightedRadiancePerValue[data[i + 3]]);
+			const __m128 weights = _mm_setr_ps(weightPerValue[data[i]], weightPerValue[data[i + 1]], weightPerValue[data[i + 2]], weightPerValue[data[i + 3]]);
+			_mm_storeu_ps(radianceSum + i, _mm_add_ps(_mm_loadu_ps(radianceSum + i), radiances));
+			_mm_storeu_ps(weightSum + i, _mm_add_ps(_mm_loadu_ps(weightSum + i), weights));
+		}
+		for(; i < end; i++)
+		{
+			radianceSum[i] += weightedRadiancePerValue[data[i]];
+			weightSum[i] += weightPerValue[data[i]];
+		}
+	});
+	_numberOfBrackets++;
+}
+
+
+void HdrMerger::resolve(std::vector<float>& destination)
+{
+	if(!isInitialized() || _numberOfBrackets <= 0)
+	{
+		return;
+	}
+	const size_t numberOfValues = _radianceSum.size();
+	destination.resize(numberOfValues);
+	const int numberOfWorkItems = (int)((numberOfValues + ValuesPerWorkItem - 1) / ValuesPerWorkItem);
+	IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+	{
+		const size_t start = (size_t)workItem * ValuesPerWorkItem;
+		const size_t end = (std::min)(start + ValuesPerWorkItem, numberOfValues);
+		const float* radianceSum = _radianceSum.data();
+		const float* weightSum = _weightSum.data();
+		const __m128 minimumWeights = _mm_set1_ps(MinimumWeight);
+		size_t i = start;
+		for(; i + 4 <= end; i += 4)
+		{
+			_mm_storeu_ps(destination.data() + i, _mm_div_ps(_mm_loadu_ps(radianceSum + i), _mm_max_ps(_mm_loadu_ps(weightSum + i), minimumWeights)));
+		}
+		for(; i < end; i++)
+		{
+			destination[i] = radianceSum[i] / (std::max)(weightSum[i], MinimumWeight);
+		}
+	});
+}
+
+
+void HdrMerger::reset()
+{
+	_width = 0;
+	_height = 0;
+	_numberOfBrackets = 0;
+	_radianceSum.clear();
+	_radianceSum.shrink_to_fit();
+	_weightSum.clear();
+	_weightSum.shrink_to_fit();
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Merges exposure brackets of the same view into a linear radiance image, following Debevec and Malik: every bracket is converted to linear light, divided
+/// by its exposure and averaged with a weight which favors well exposed values over values close to black or white. The brackets are merged as they come in,
+/// so only the running sums are kept, not the brackets themselves. The frames are assumed to be sRGB encoded.
+/// </summary>
+class HdrMerger
+{
+public:
+	HdrMerger() = default;
+	~HdrMerger() = default;
+
+	/// <summary>
+	/// Allocates the merger for frames of the size specified and clears it.
+	/// </summary>
+	void initialize(int width, int height);
+	/// <summary>
+	/// Merges the bracket specified into the radiance image.
+	/// </summary>
+	/// <param name="data">RGB, 3 bytes per pixel, of the size passed to initialize</param>
+	/// <param name="exposureStops">the exposure of the bracket, in stops relative to the reference exposure</param>
+	/// <param name="isDarkestBracket">true if no bracket has a lower exposure. Bright values of the darkest bracket aren't weighted down, as no other bracket
+	/// has better data for them</param>
+	/// <param name="isBrightestBracket">true if no bracket has a higher exposure. Dark values of the brightest bracket aren't weighted down.</param>
+	void addBracket(const uint8_t* data, float exposureStops, bool isDarkestBracket, bool isBrightestBracket);
+	/// <summary>
+	/// Stores the merged radiance as linear RGB, 3 floats per pixel, in destination. A value of 1.0 is white in the reference exposure.
+	/// </summary>
+	void resolve(std::vector<float>& destination);
+	void reset();
+
+	bool isInitialized() { return _radianceSum.size() > 0; }
+	int numberOfBrackets() { return _numberOfBrackets; }
+	int width() { return _width; }
+	int height() { return _height; }
+
+private:
+	int _width = 0;
+	int _height = 0;
+	int _numberOfBrackets = 0;
+	std::vector<float> _radianceSum;		// per value: the sum of weight * radiance over all brackets
+	std::vector<float> _weightSum;			// per value: the sum of the weights over all brackets
+};
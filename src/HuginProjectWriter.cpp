@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "HuginProjectWriter.h"
+#include "Utils.h"
+#include <algorithm>
+
+namespace IGCS::HuginProjectWriter
+{
+	bool writeProject(const std::string& projectFilename, const HuginProjectData& data)
+	{
+		if(data.imageFilenames.size() <= 0 || data.imageFilenames.size() != data.yawDegrees.size() || data.imageWidth <= 0 || data.imageHeight <= 0 || data.horizontalFoVDegrees <= 0.0f)
+		{
+			return false;
+		}
+
+		// The output is equirectangular, so the amount of pixels per degree is the same horizontally and vertically. We keep the same pixel density as the source shots.
+		const float horizontalFoVRadians = IGCS::Utils::degreesToRadians(data.horizontalFoVDegrees);
+		const float verticalFoVDegrees = 2.0f * atanf(tanf(horizontalFoVRadians / 2.0f) * ((float)data.imageHeight / (float)data.imageWidth)) * (180.0f / DirectX::XM_PI);
+		const float pixelsPerDegree = (float)data.imageWidth / data.horizontalFoVDegrees;
+		// the first and last shot are centered on the edges of the total fov so they stick out half a shot on either side.
+		const float panoramaFoVDegrees = (std::min)(data.totalFoVDegrees + data.horizontalFoVDegrees, 360.0f);
+		const int panoramaWidth = (int)(panoramaFoVDegrees * pixelsPerDegree + 0.5f);
+		const int panoramaHeight = (int)(verticalFoVDegrees * pixelsPerDegree + 0.5f);
+
+		FILE* projectFile = nullptr;
+		if(fopen_s(&projectFile, projectFilename.c_str(), "w") != 0 || nullptr == projectFile)
+		{
+			return false;
+		}
+
+		fprintf(projectFile, "# hugin project file\n");
+		fprintf(projectFile, "#hugin_ptoversion 2\n");
+		fprintf(projectFile, "# Written by IGCS Connector. Image positions are exact, so no control points are needed.\n");
+		fprintf(projectFile, "# Shot fov: %.4f degrees. Total fov: %.4f degrees. Overlap between shots: %.1f%%\n", data.horizontalFoVDegrees, data.totalFoVDegrees, data.overlapPercentage);
+		// panorama line: f2 is equirectangular.
+		fprintf(projectFile, "p f2 w%d h%d v%.6f k0 E0 R0 S0,%d,0,%d n\"TIFF_m c:LZW r:CROP\"\n", panoramaWidth, panoramaHeight, panoramaFoVDegrees, panoramaWidth, panoramaHeight);
+		fprintf(projectFile, "m i0\n\n");
+		fprintf(projectFile, "# image lines\n");
+		for(size_t i = 0; i < data.imageFilenames.size(); i++)
+		{
+			// f0 is rectilinear. Lens parameters of all images after the first are linked to the first image ('=0'), as they're all taken with the same camera.
+			const std::string lensParameters = (0 == i) ? IGCS::Utils::formatString("v%.6f a0 b0 c0 d%.3f e%.3f g0 t0", data.horizontalFoVDegrees, data.imageShiftX, data.imageShiftY)
+														: "v=0 a=0 b=0 c=0 d=0 e=0 g=0 t=0";
+			fprintf(projectFile, "i w%u h%u f0 %s Ra0 Rb0 Rc0 Rd0 Re0 Eev0 Er1 Eb1 r0 p0 y%.6f TrX0 TrY0 TrZ0 Tpy0 Tpp0 j0 Va1 Vb0 Vc0 Vd0 Vx0 Vy0 Vm5 n\"%s\"\n",
+					data.imageWidth, data.imageHeight, lensParameters.c_str(), data.yawDegrees[i], data.imageFilenames[i].c_str());
+		}
+		// no variables to optimize, and no control points.
+		fprintf(projectFile, "\n# specify variables that should be optimized\nv\n\n");
+		fprintf(projectFile, "# control points\n\n");
+		fprintf(projectFile, "#hugin_optimizeReferenceImage 0\n");
+		fprintf(projectFile, "#hugin_blender enblend\n");
+		fprintf(projectFile, "#hugin_remapper nona\n");
+		fprintf(projectFile, "#hugin_enblendOptions \n");
+		fprintf(projectFile, "#hugin_outputLDRBlended true\n");
+		fprintf(projectFile, "#hugin_outputLDRLayers false\n");
+		fprintf(projectFile, "#hugin_outputImageType tif\n");
+		fprintf(projectFile, "#hugin_outputImageTypeCompression LZW\n");
+		fclose(projectFile);
+		return true;
+	}
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Data needed to write a Hugin project for a horizontal panorama. All angles are in degrees.
+/// </summary>
+struct HuginProjectData
+{
+	uint32_t imageWidth = 0;
+	uint32_t imageHeight = 0;
+	float horizontalFoVDegrees = 0.0f;				// horizontal fov of a single shot
+	float imageShiftX = 0.0f;						// with a region of interest: offset in pixels of the optical axis from the center of a shot. 0 otherwise.
+	float imageShiftY = 0.0f;
+	float totalFoVDegrees = 0.0f;					// horizontal fov covered by the complete panorama
+	float overlapPercentage = 0.0f;					// overlap between two consecutive shots, as specified by the user
+	std::vector<std::string> imageFilenames;		// filenames relative to the project file
+	std::vector<float> yawDegrees;					// yaw per image, same order as imageFilenames. Negative is to the left.
+};
+
+
+namespace IGCS::HuginProjectWriter
+{
+	/// <summary>
+	/// Writes a Hugin (.pto) project for the panorama described by the data specified. As we know the exact geometry of every shot,
+	///	the project contains the final image positions and no control points, so stitching is a remap/blend pass without any optimization. 
+	/// </summary>
+	/// <param name="projectFilename">full path of the .pto file to write</param>
+	/// <param name="data"></param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeProject(const std::string& projectFilename, const HuginProjectData& data);
+}
@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// HuginProjectWriterTest: writes a .pto project with HuginProjectWriter for a panorama with known geometry, parses its panorama ('p') and image ('i')
+// lines back the way Hugin reads them and checks the projections, the field of view and the yaw of every image.
+//
+// Usage: HuginProjectWriterTest
+// Returns 0 if the project matches the panorama it was written for, 1 otherwise.
+#include "stdafx.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "HuginProjectWriter.h"
+
+namespace
+{
+	constexpr float Tolerance = 0.0001f;
+
+	/// <summary>
+	/// A line of a .pto file: the line type and its parameters, the letters of a parameter as key and the rest as value. n"..." is stored with key n.
+	/// </summary>
+	struct ProjectLine
+	{
+		char type = 0;
+		std::map<std::string, std::string> parameters;
+	};
+
+
+	std::vector<ProjectLine> readProject(const std::string& projectFilename)
+	{
+		std::vector<ProjectLine> lines;
+		FILE* projectFile = nullptr;
+		if(fopen_s(&projectFile, projectFilename.c_str(), "r") != 0 || nullptr == projectFile)
+		{
+			return lines;
+		}
+		char buffer[4096];
+		while(nullptr != fgets(buffer, sizeof(buffer), projectFile))
+		{
+			const std::string text(buffer);
+			if(text.size() < 2 || (text[0] != 'p' && text[0] != 'i') || text[1] != ' ')
+			{
+				continue;
+			}
+			ProjectLine line;
+			line.type = text[0];
+			size_t position = 2;
+			while(position < text.size())
+			{
+				const size_t end = (text[position] == 'n' && position + 1 < text.size() && text[position + 1] == '"') ? text.find('"', position + 2) + 1 
+																													   : text.find_first_of(" \r\n", position);
+				const std::string token = text.substr(position, (std::string::npos == end) ? std::string::npos : end - position);
+				if(!token.empty())
+				{
+					// the key is the leading letters, e.g. 'v', 'Ra' or 'Eev', the value is what follows them.
+					size_t keyLength = 0;
+					while(keyLength < token.size() && isalpha((unsigned char)token[keyLength]))
+					{
+						keyLength++;
+					}
+					line.parameters[token.substr(0, keyLength)] = token.substr(keyLength);
+				}
+				if(std::string::npos == end)
+				{
+					break;
+				}
+				position = end + 1;
+			}
+			lines.push_back(line);
+		}
+		fclose(projectFile);
+		return lines;
+	}
+
+
+	bool check(bool condition, const char* description)
+	{
+		if(!condition)
+		{
+			printf("FAILED: %s\n", description);
+		}
+		return condition;
+	}
+
+
+	bool isClose(const std::string& value, float expected)
+	{
+		return !value.empty() && std::fabs((float)atof(value.c_str()) - expected) <= Tolerance;
+	}
+}
+
+
+int main()
+{
+	// a 120 degree panorama of 5 shots of 60 degrees each, as the screenshot controller sets it up.
+	HuginProjectData data;
+	data.imageWidth = 1920;
+	data.imageHeight = 1080;
+	data.horizontalFoVDegrees = 60.0f;
+	data.totalFoVDegrees = 120.0f;
+	data.overlapPercentage = 50.0f;
+	for(int i = 0; i < 5; i++)
+	{
+		data.imageFilenames.push_back(std::to_string(i) + ".png");
+		data.yawDegrees.push_back(-60.0f + i * 30.0f);
+	}
+	const std::string projectFilename = (std::filesystem::temp_directory_path() / "HuginProjectWriterTest.pto").string();
+	bool isMatch = check(IGCS::HuginProjectWriter::writeProject(projectFilename, data), "the project can't be written");
+	const std::vector<ProjectLine> lines = readProject(projectFilename);
+	std::filesystem::remove(projectFilename);
+
+	std::vector<const ProjectLine*> imageLines;
+	const ProjectLine* panoramaLine = nullptr;
+	for(const ProjectLine& line : lines)
+	{
+		if('p' == line.type)
+		{
+			panoramaLine = &line;
+		}
+		else
+		{
+			imageLines.push_back(&line);
+		}
+	}
+	isMatch &= check(nullptr != panoramaLine, "no panorama line");
+	if(nullptr != panoramaLine)
+	{
+		const auto& parameters = panoramaLine->parameters;
+		isMatch &= check(parameters.count("f") && parameters.at("f") == "2", "the panorama isn't equirectangular");
+		// the first and last shot stick out half a shot on either side.
+		isMatch &= check(parameters.count("v") && isClose(parameters.at("v"), 180.0f), "the panorama fov isn't the total fov plus a shot");
+		// equirectangular at the pixel density of the shots: 32 pixels per degree.
+		isMatch &= check(parameters.count("w") && parameters.at("w") == "5760", "the panorama width doesn't keep the pixel density of the shots");
+	}
+	isMatch &= check(imageLines.size() == data.imageFilenames.size(), "the number of image lines isn't the number of shots");
+	for(size_t i = 0; i < imageLines.size() && i < data.imageFilenames.size(); i++)
+	{
+		const auto& parameters = imageLines[i]->parameters;
+		isMatch &= check(parameters.count("f") && parameters.at("f") == "0", "an image isn't rectilinear");
+		isMatch &= check(parameters.count("w") && parameters.at("w") == "1920" && parameters.count("h") && parameters.at("h") == "1080", "an image has the wrong size");
+		isMatch &= check(parameters.count("y") && isClose(parameters.at("y"), data.yawDegrees[i]), "an image has the wrong yaw");
+		isMatch &= check(parameters.count("p") && isClose(parameters.at("p"), 0.0f) && parameters.count("r") && isClose(parameters.at("r"), 0.0f), 
+						 "an image has a pitch or roll");
+		isMatch &= check(parameters.count("n") && parameters.at("n") == "\"" + data.imageFilenames[i] + "\"", "an image has the wrong filename");
+		// the lens is specified on the first image and linked to it on the others.
+		isMatch &= check(parameters.count("v") && ((0 == i) ? isClose(parameters.at("v"), data.horizontalFoVDegrees) : parameters.at("v") == "=0"), 
+						 "an image has the wrong fov");
+	}
+
+	// a project which can't be stitched isn't written.
+	HuginProjectData mismatchedData = data;
+	mismatchedData.yawDegrees.pop_back();
+	isMatch &= check(!IGCS::HuginProjectWriter::writeProject(projectFilename, mismatchedData), "a project with a yaw missing is written");
+	printf("%s\n", isMatch ? "OK" : "FAILED");
+	return isMatch ? 0 : 1;
+}
@@ -0,0 +1,635 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ImageFileWriters.h"
+#include "ArchivalDeflate.h"
+#include "fpng.h"
+#include "WorkerPool.h"
+#include "std_image_write.h"
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+// implemented in std_image_write.h, which is compiled as part of ScreenshotController.cpp. Returns a zlib stream allocated with malloc.
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace IGCS::ImageFileWriters
+{
+	namespace
+	{
+		void writeBigEndian32(uint8_t* destination, uint32_t value)
+		{
+			destination[0] = (uint8_t)(value >> 24);
+			destination[1] = (uint8_t)(value >> 16);
+			destination[2] = (uint8_t)(value >> 8);
+			destination[3] = (uint8_t)value;
+		}
+
+
+		// OpenEXR ZIP compression compresses blocks of 16 scanlines.
+		constexpr int ExrScanlinesPerBlock = 16;
+		constexpr uint32_t ExrPixelTypeHalf = 1;
+		constexpr uint32_t ExrPixelTypeFloat = 2;
+
+
+		void appendLittleEndian32(std::vector<uint8_t>& destination, uint32_t value)
+		{
+			for(int i = 0; i < 4; i++)
+			{
+				destination.push_back((uint8_t)(value >> (i * 8)));
+			}
+		}
+
+
+		void appendExrAttribute(std::vector<uint8_t>& destination, const char* name, const char* type, const std::vector<uint8_t>& value)
+		{
+			destination.insert(destination.end(), name, name + strlen(name) + 1);
+			destination.insert(destination.end(), type, type + strlen(type) + 1);
+			appendLittleEndian32(destination, (uint32_t)value.size());
+			destination.insert(destination.end(), value.begin(), value.end());
+		}
+
+
+		uint16_t floatToHalf(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, 4);
+			const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+			bits &= 0x7FFFFFFF;
+			if(bits > 0x7F800000)
+			{
+				// NaN
+				return sign | 0x7E00;
+			}
+			if(bits >= 0x477FF000)
+			{
+				// too large for a half, also infinity: clamp to the largest half value.
+				return sign | 0x7BFF;
+			}
+			if(bits < 0x38800000)
+			{
+				// denormal half (or 0): shift the mantissa with its implicit 1 into place, rounding to nearest even.
+				if(bits < 0x33000000)
+				{
+					return sign;
+				}
+				const int exponent = (int)(bits >> 23);
+				const uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+				const int shift = 126 - exponent;
+				uint32_t half = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1);
+				const uint32_t halfway = 1u << (shift - 1);
+				if(remainder > halfway || (remainder == halfway && (half & 1)))
+				{
+					half++;
+				}
+				return sign | (uint16_t)half;
+			}
+			// normal: rebias the exponent and round the mantissa to nearest even. A carry into the exponent is correct as well.
+			const uint32_t half = ((bits - 0x38000000) + 0xFFF + ((bits >> 13) & 1)) >> 13;
+			return sign | (uint16_t)half;
+		}
+
+
+		/// <summary>
+		/// Compresses a block of scanlines the way OpenEXR's ZIP compression does: the bytes are split in the even and odd bytes, delta encoded and deflated.
+		/// If compressing doesn't make the block smaller, the block is stored uncompressed, which readers detect by its size.
+		/// </summary>
+		void compressExrBlock(const std::vector<uint8_t>& rawBlock, std::vector<uint8_t>& destination)
+		{
+			const size_t size = rawBlock.size();
+			std::vector<uint8_t> reordered(size);
+			const size_t halfSize = (size + 1) / 2;
+			for(size_t i = 0; i < size; i++)
+			{
+				reordered[(i & 1) ? halfSize + i / 2 : i / 2] = rawBlock[i];
+			}
+			uint8_t previous = reordered.size() > 0 ? reordered[0] : 0;
+			for(size_t i = 1; i < size; i++)
+			{
+				const uint8_t current = reordered[i];
+				reordered[i] = (uint8_t)(current - previous + 128);
+				previous = current;
+			}
+			int compressedSize = 0;
+			uint8_t* compressedData = stbi_zlib_compress(reordered.data(), (int)size, &compressedSize, 8);
+			if(nullptr != compressedData && (size_t)compressedSize < size)
+			{
+				destination.assign(compressedData, compressedData + compressedSize);
+			}
+			else
+			{
+				destination = rawBlock;
+			}
+			free(compressedData);
+		}
+
+
+		/// <summary>
+		/// Writes a single part scanline OpenEXR file with ZIP compression. writeScanline writes the values of a scanline, channel after channel in the order
+		/// of channelNames, which has to be alphabetical. The blocks of scanlines are converted and compressed in parallel.
+		/// </summary>
+		bool writeExrFile(const std::string& filename, const std::vector<const char*>& channelNames, uint32_t pixelType, int width, int height, 
+						  const std::function<void(int y, uint8_t* destination)>& writeScanline)
+		{
+			if(width <= 0 || height <= 0)
+			{
+				return false;
+			}
+
+			std::vector<uint8_t> header = { 0x76, 0x2F, 0x31, 0x01, 2, 0, 0, 0 };		// magic number, version 2, single part scanline file
+			// channels have to be stored in alphabetical order. Every channel: name, pixel type, pLinear + 3 reserved bytes, x and y sampling.
+			std::vector<uint8_t> channelList;
+			for(const char* channelName : channelNames)
+			{
+				channelList.push_back((uint8_t)channelName[0]);
+				channelList.push_back(0);
+				appendLittleEndian32(channelList, pixelType);
+				appendLittleEndian32(channelList, 0);
+				appendLittleEndian32(channelList, 1);
+				appendLittleEndian32(channelList, 1);
+			}
+			channelList.push_back(0);
+			appendExrAttribute(header, "channels", "chlist", channelList);
+			appendExrAttribute(header, "compression", "compression", { 3 });		// ZIP_COMPRESSION
+			std::vector<uint8_t> window;
+			appendLittleEndian32(window, 0);
+			appendLittleEndian32(window, 0);
+			appendLittleEndian32(window, (uint32_t)(width - 1));
+			appendLittleEndian32(window, (uint32_t)(height - 1));
+			appendExrAttribute(header, "dataWindow", "box2i", window);
+			appendExrAttribute(header, "displayWindow", "box2i", window);
+			appendExrAttribute(header, "lineOrder", "lineOrder", { 0 });			// INCREASING_Y
+			const float one = 1.0f;
+			std::vector<uint8_t> oneValue((const uint8_t*)&one, (const uint8_t*)&one + 4);
+			appendExrAttribute(header, "pixelAspectRatio", "float", oneValue);
+			appendExrAttribute(header, "screenWindowCenter", "v2f", std::vector<uint8_t>(8, 0));
+			appendExrAttribute(header, "screenWindowWidth", "float", oneValue);
+			header.push_back(0);
+
+			const size_t bytesPerScanline = (size_t)width * channelNames.size() * (ExrPixelTypeHalf == pixelType ? 2 : 4);
+			const int numberOfBlocks = (height + ExrScanlinesPerBlock - 1) / ExrScanlinesPerBlock;
+			std::vector<std::vector<uint8_t>> compressedBlocks(numberOfBlocks);
+			IGCS::WorkerPool::parallelFor(numberOfBlocks, [&](int blockIndex)
+			{
+				const int firstScanline = blockIndex * ExrScanlinesPerBlock;
+				const int numberOfScanlines = (std::min)(ExrScanlinesPerBlock, height - firstScanline);
+				std::vector<uint8_t> rawBlock((size_t)numberOfScanlines * bytesPerScanline);
+				for(int y = firstScanline; y < firstScanline + numberOfScanlines; y++)
+				{
+					writeScanline(y, rawBlock.data() + (size_t)(y - firstScanline) * bytesPerScanline);
+				}
+				compressExrBlock(rawBlock, compressedBlocks[blockIndex]);
+			});
+
+			// the offset table contains the file offset of every block, which starts with its first scanline and its size.
+			std::vector<uint8_t> offsetTable;
+			uint64_t blockOffset = header.size() + (size_t)numberOfBlocks * 8;
+			for(const auto& block : compressedBlocks)
+			{
+				for(int i = 0; i < 8; i++)
+				{
+					offsetTable.push_back((uint8_t)(blockOffset >> (i * 8)));
+				}
+				blockOffset += 8 + block.size();
+			}
+
+			FILE* exrFile = nullptr;
+			if(fopen_s(&exrFile, filename.c_str(), "wb") != 0 || nullptr == exrFile)
+			{
+				return false;
+			}
+			fwrite(header.data(), header.size(), 1, exrFile);
+			fwrite(offsetTable.data(), offsetTable.size(), 1, exrFile);
+			for(int blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+			{
+				std::vector<uint8_t> blockHeader;
+				appendLittleEndian32(blockHeader, (uint32_t)(blockIndex * ExrScanlinesPerBlock));
+				appendLittleEndian32(blockHeader, (uint32_t)compressedBlocks[blockIndex].size());
+				fwrite(blockHeader.data(), blockHeader.size(), 1, exrFile);
+				fwrite(compressedBlocks[blockIndex].data(), compressedBlocks[blockIndex].size(), 1, exrFile);
+			}
+			fclose(exrFile);
+			return true;
+		}
+
+
+		void appendToBuffer(void* context, void* data, int size)
+		{
+			std::vector<uint8_t>* buffer = (std::vector<uint8_t>*)context;
+			buffer->insert(buffer->end(), (uint8_t*)data, (uint8_t*)data + size);
+		}
+
+
+		constexpr size_t QoiHeaderSize = 14;
+		constexpr uint8_t QoiEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		constexpr uint8_t QoiOpIndex = 0x00;
+		constexpr uint8_t QoiOpDiff = 0x40;
+		constexpr uint8_t QoiOpLuma = 0x80;
+		constexpr uint8_t QoiOpRun = 0xc0;
+		constexpr uint8_t QoiOpRgb = 0xfe;
+		constexpr int QoiMaximumRunLength = 62;
+
+		/// <summary>
+		/// Encodes RGB data as a QOI image (https://qoiformat.org). It compresses a lot less than PNG but is many times faster, as it's a single pass
+		/// over the pixels without entropy coding.
+		/// </summary>
+		void encodeQoi(const uint8_t* data, int width, int height, std::vector<uint8_t>& encoded)
+		{
+			const size_t numberOfPixels = (size_t)width * height;
+			// worst case every pixel is a 4 byte rgb op.
+			encoded.resize(QoiHeaderSize + numberOfPixels * 4 + sizeof(QoiEndMarker));
+			uint8_t* destination = encoded.data();
+			memcpy(destination, "qoif", 4);
+			writeBigEndian32(destination + 4, (uint32_t)width);
+			writeBigEndian32(destination + 8, (uint32_t)height);
+			destination[12] = 3;		// channels
+			destination[13] = 0;		// sRGB with linear alpha
+			destination += QoiHeaderSize;
+
+			// the alpha of every pixel is 255, which is part of the hash and the seen pixels, as decoders work with RGBA.
+			uint32_t seenPixels[64] = {};
+			uint8_t previousR = 0;
+			uint8_t previousG = 0;
+			uint8_t previousB = 0;
+			int runLength = 0;
+			for(size_t i = 0; i < numberOfPixels; i++)
+			{
+				const uint8_t r = data[i * 3];
+				const uint8_t g = data[i * 3 + 1];
+				const uint8_t b = data[i * 3 + 2];
+				if(r == previousR && g == previousG && b == previousB)
+				{
+					runLength++;
+					if(runLength == QoiMaximumRunLength || i == numberOfPixels - 1)
+					{
+						*destination++ = QoiOpRun | (uint8_t)(runLength - 1);
+						runLength = 0;
+					}
+					continue;
+				}
+				if(runLength > 0)
+				{
+					*destination++ = QoiOpRun | (uint8_t)(runLength - 1);
+					runLength = 0;
+				}
+				const uint32_t pixel = r | (g << 8) | (b << 16) | 0xff000000u;
+				const int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+				if(seenPixels[hash] == pixel)
+				{
+					*destination++ = QoiOpIndex | (uint8_t)hash;
+				}
+				else
+				{
+					seenPixels[hash] = pixel;
+					// the differences wrap around, as specified.
+					const int8_t deltaR = (int8_t)(r - previousR);
+					const int8_t deltaG = (int8_t)(g - previousG);
+					const int8_t deltaB = (int8_t)(b - previousB);
+					const int deltaRMinusG = deltaR - deltaG;
+					const int deltaBMinusG = deltaB - deltaG;
+					if(deltaR >= -2 && deltaR <= 1 && deltaG >= -2 && deltaG <= 1 && deltaB >= -2 && deltaB <= 1)
+					{
+						*destination++ = QoiOpDiff | (uint8_t)((deltaR + 2) << 4 | (deltaG + 2) << 2 | (deltaB + 2));
+					}
+					else if(deltaG >= -32 && deltaG <= 31 && deltaRMinusG >= -8 && deltaRMinusG <= 7 && deltaBMinusG >= -8 && deltaBMinusG <= 7)
+					{
+						*destination++ = QoiOpLuma | (uint8_t)(deltaG + 32);
+						*destination++ = (uint8_t)((deltaRMinusG + 8) << 4 | (deltaBMinusG + 8));
+					}
+					else
+					{
+						*destination++ = QoiOpRgb;
+						*destination++ = r;
+						*destination++ = g;
+						*destination++ = b;
+					}
+				}
+				previousR = r;
+				previousG = g;
+				previousB = b;
+			}
+			memcpy(destination, QoiEndMarker, sizeof(QoiEndMarker));
+			destination += sizeof(QoiEndMarker);
+			encoded.resize(destination - encoded.data());
+		}
+	}
+
+
+	void writePngChunk(FILE* file, const char* type, const uint8_t* data, uint32_t length)
+	{
+		uint8_t header[8];
+		writeBigEndian32(header, length);
+		memcpy(header + 4, type, 4);
+		// the crc covers the type and the data, not the length.
+		uint32_t crc = fpng::fpng_crc32(header + 4, 4);
+		if(length > 0)
+		{
+			crc = fpng::fpng_crc32(data, length, crc);
+		}
+		uint8_t footer[4];
+		writeBigEndian32(footer, crc);
+		fwrite(header, 8, 1, file);
+		if(length > 0)
+		{
+			fwrite(data, length, 1, file);
+		}
+		fwrite(footer, 4, 1, file);
+	}
+
+
+	size_t writeImage(const std::string& filename, ScreenshotFiletype filetype, const uint8_t* data, int width, int height)
+	{
+		std::vector<uint8_t> encodedData;
+		if(!encodeImage(filetype, data, width, height, encodedData))
+		{
+			return 0;
+		}
+		return writeEncodedImage(filename, encodedData);
+	}
+
+
+	bool encodeImage(ScreenshotFiletype filetype, const uint8_t* data, int width, int height, std::vector<uint8_t>& encodedData)
+	{
+		encodedData.clear();
+		if(nullptr == data || width <= 0 || height <= 0)
+		{
+			return false;
+		}
+		switch(filetype)
+		{
+		case ScreenshotFiletype::Bmp:
+			encodedData.reserve(54 + (size_t)((width * 3 + 3) & ~3) * height);
+			return stbi_write_bmp_to_func(&appendToBuffer, &encodedData, width, height, 3, data) != 0;
+		case ScreenshotFiletype::Jpeg:
+			return stbi_write_jpg_to_func(&appendToBuffer, &encodedData, width, height, 3, data, 98) != 0;
+		case ScreenshotFiletype::Png:
+			return fpng::fpng_encode_image_to_memory(data, width, height, 3, encodedData);
+		case ScreenshotFiletype::Qoi:
+			encodeQoi(data, width, height, encodedData);
+			return true;
+		}
+		return false;
+	}
+
+
+	size_t writeEncodedImage(const std::string& filename, const std::vector<uint8_t>& encodedData)
+	{
+		FILE* file = nullptr;
+		if(encodedData.empty() || fopen_s(&file, filename.c_str(), "wb") != 0 || nullptr == file)
+		{
+			return 0;
+		}
+		const size_t numberOfBytesWritten = fwrite(encodedData.data(), 1, encodedData.size(), file);
+		const bool isClosed = fclose(file) == 0;
+		return (isClosed && numberOfBytesWritten == encodedData.size()) ? numberOfBytesWritten : 0;
+	}
+
+
+	std::string fileExtension(ScreenshotFiletype filetype)
+	{
+		switch(filetype)
+		{
+		case ScreenshotFiletype::Bmp:
+			return "bmp";
+		case ScreenshotFiletype::Jpeg:
+			return "jpg";
+		case ScreenshotFiletype::Png:
+			return "png";
+		case ScreenshotFiletype::Qoi:
+			return "qoi";
+		}
+		return "";
+	}
+
+
+	bool writePng16(const std::string& filename, const uint16_t* data, int width, int height, int numberOfChannels, bool isHdr10)
+	{
+		uint8_t colorType = 0;
+		switch(numberOfChannels)
+		{
+		case 1:
+			colorType = 0;
+			break;
+		case 3:
+			colorType = 2;
+			break;
+		case 4:
+			colorType = 6;
+			break;
+		default:
+			return false;
+		}
+		if(nullptr == data || width <= 0 || height <= 0)
+		{
+			return false;
+		}
+
+		// PNG stores 16 bit values big endian. Every row is prefixed with its filter type. We use the Sub filter (1) which works well for smooth
+		// data like depth: each byte is stored as the difference with the same byte of the pixel to its left.
+		const size_t bytesPerPixel = (size_t)numberOfChannels * 2;
+		const size_t rowSizeInBytes = (size_t)width * bytesPerPixel;
+		std::vector<uint8_t> filteredData((rowSizeInBytes + 1) * height);
+		std::vector<uint8_t> rawRow(rowSizeInBytes);
+		for(int y = 0; y < height; y++)
+		{
+			const uint16_t* sourceRow = data + (size_t)y * width * numberOfChannels;
+			for(size_t i = 0; i < (size_t)width * numberOfChannels; i++)
+			{
+				rawRow[i * 2] = (uint8_t)(sourceRow[i] >> 8);
+				rawRow[i * 2 + 1] = (uint8_t)sourceRow[i];
+			}
+			uint8_t* destinationRow = filteredData.data() + y * (rowSizeInBytes + 1);
+			destinationRow[0] = 1;
+			for(size_t i = 0; i < rowSizeInBytes; i++)
+			{
+				destinationRow[i + 1] = (uint8_t)(rawRow[i] - (i >= bytesPerPixel ? rawRow[i - bytesPerPixel] : 0));
+			}
+		}
+		int compressedSize = 0;
+		uint8_t* compressedData = stbi_zlib_compress(filteredData.data(), (int)filteredData.size(), &compressedSize, 8);
+		if(nullptr == compressedData)
+		{
+			return false;
+		}
+
+		FILE* pngFile = nullptr;
+		if(fopen_s(&pngFile, filename.c_str(), "wb") != 0 || nullptr == pngFile)
+		{
+			free(compressedData);
+			return false;
+		}
+		const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		fwrite(signature, 8, 1, pngFile);
+		uint8_t imageHeader[13];
+		writeBigEndian32(imageHeader, (uint32_t)width);
+		writeBigEndian32(imageHeader + 4, (uint32_t)height);
+		imageHeader[8] = 16;			// bit depth
+		imageHeader[9] = colorType;
+		imageHeader[10] = 0;			// compression: deflate
+		imageHeader[11] = 0;			// filter method: adaptive
+		imageHeader[12] = 0;			// no interlacing
+		writePngChunk(pngFile, "IHDR", imageHeader, 13);
+		if(isHdr10)
+		{
+			// coding independent code points: BT.2020 primaries (9), PQ transfer (16), RGB (0), full range (1).
+			const uint8_t codePoints[4] = { 9, 16, 0, 1 };
+			writePngChunk(pngFile, "cICP", codePoints, 4);
+		}
+		writePngChunk(pngFile, "IDAT", compressedData, (uint32_t)compressedSize);
+		writePngChunk(pngFile, "IEND", nullptr, 0);
+		fclose(pngFile);
+		free(compressedData);
+		return true;
+	}
+
+
+	bool writeArchivalPng(const std::string& filename, const uint8_t* data, int width, int height)
+	{
+		if(nullptr == data || width <= 0 || height <= 0)
+		{
+			return false;
+		}
+		// every row gets the filter which gives the smallest sum of absolute differences, the heuristic libpng uses. fpng uses one filter for all rows.
+		const size_t rowSizeInBytes = (size_t)width * 3;
+		std::vector<uint8_t> filteredData((rowSizeInBytes + 1) * height);
+		IGCS::WorkerPool::parallelFor(height, [&](int y)
+			{
+				const uint8_t* row = data + (size_t)y * rowSizeInBytes;
+				const uint8_t* rowAbove = (y > 0) ? row - rowSizeInBytes : nullptr;
+				std::vector<uint8_t> candidate(rowSizeInBytes);
+				uint8_t* destinationRow = filteredData.data() + (size_t)y * (rowSizeInBytes + 1);
+				uint64_t smallestSum = UINT64_MAX;
+				for(uint8_t filterType = 0; filterType <= 4; filterType++)
+				{
+					uint64_t sum = 0;
+					for(size_t i = 0; i < rowSizeInBytes; i++)
+					{
+						const int left = (i >= 3) ? row[i - 3] : 0;
+						const int above = (nullptr != rowAbove) ? rowAbove[i] : 0;
+						const int aboveLeft = (nullptr != rowAbove && i >= 3) ? rowAbove[i - 3] : 0;
+						int predicted = 0;
+						switch(filterType)
+						{
+						case 1:
+							predicted = left;
+							break;
+						case 2:
+							predicted = above;
+							break;
+						case 3:
+							predicted = (left + above) / 2;
+							break;
+						case 4:
+							{
+								const int estimate = left + above - aboveLeft;
+								const int distanceLeft = std::abs(estimate - left);
+								const int distanceAbove = std::abs(estimate - above);
+								const int distanceAboveLeft = std::abs(estimate - aboveLeft);
+								predicted = (distanceLeft <= distanceAbove && distanceLeft <= distanceAboveLeft) ? left : (distanceAbove <= distanceAboveLeft) ? above : aboveLeft;
+							}
+							break;
+						}
+						candidate[i] = (uint8_t)(row[i] - predicted);
+						sum += (uint64_t)std::abs((int)(int8_t)candidate[i]);
+					}
+					if(sum < smallestSum)
+					{
+						smallestSum = sum;
+						destinationRow[0] = filterType;
+						memcpy(destinationRow + 1, candidate.data(), rowSizeInBytes);
+					}
+				}
+			});
+		std::vector<uint8_t> compressedData;
+		IGCS::ArchivalDeflate::compress(filteredData.data(), filteredData.size(), compressedData);
+
+		FILE* pngFile = nullptr;
+		if(fopen_s(&pngFile, filename.c_str(), "wb") != 0 || nullptr == pngFile)
+		{
+			return false;
+		}
+		const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		fwrite(signature, 8, 1, pngFile);
+		uint8_t imageHeader[13];
+		writeBigEndian32(imageHeader, (uint32_t)width);
+		writeBigEndian32(imageHeader + 4, (uint32_t)height);
+		imageHeader[8] = 8;				// bit depth
+		imageHeader[9] = 2;				// color type: RGB
+		imageHeader[10] = 0;			// compression: deflate
+		imageHeader[11] = 0;			// filter method: adaptive
+		imageHeader[12] = 0;			// no interlacing
+		writePngChunk(pngFile, "IHDR", imageHeader, 13);
+		writePngChunk(pngFile, "IDAT", compressedData.data(), (uint32_t)compressedData.size());
+		writePngChunk(pngFile, "IEND", nullptr, 0);
+		const bool isWritten = ferror(pngFile) == 0;
+		return (fclose(pngFile) == 0) && isWritten;
+	}
+
+
+	bool writeExr(const std::string& filename, const float* data, int width, int height)
+	{
+		if(nullptr == data)
+		{
+			return false;
+		}
+		// per scanline all B values, then all G values, then all R values.
+		return writeExrFile(filename, { "B", "G", "R" }, ExrPixelTypeHalf, width, height, [&](int y, uint8_t* destination)
+		{
+			const float* sourceRow = data + (size_t)y * width * 3;
+			for(int channel = 2; channel >= 0; channel--)
+			{
+				for(int x = 0; x < width; x++)
+				{
+					const uint16_t half = floatToHalf(sourceRow[x * 3 + channel]);
+					*destination++ = (uint8_t)half;
+					*destination++ = (uint8_t)(half >> 8);
+				}
+			}
+		});
+	}
+
+
+	bool writeExrDepth(const std::string& filename, const float* data, int width, int height)
+	{
+		if(nullptr == data)
+		{
+			return false;
+		}
+		// the values are stored as is, little endian like the cpu.
+		return writeExrFile(filename, { "Z" }, ExrPixelTypeFloat, width, height, [&](int y, uint8_t* destination)
+		{
+			memcpy(destination, data + (size_t)y * width, (size_t)width * sizeof(float));
+		});
+	}
+}
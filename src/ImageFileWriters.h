@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ConstantsEnums.h"
+
+namespace IGCS::ImageFileWriters
+{
+	/// <summary>
+	/// Writes an 8 bit RGB image in the file type specified. Used for the shots and everything else which is written in the file type of the session.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="filetype"></param>
+	/// <param name="data">RGB, 3 bytes per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <returns>the number of bytes written, or 0 if the file couldn't be written</returns>
+	size_t writeImage(const std::string& filename, ScreenshotFiletype filetype, const uint8_t* data, int width, int height);
+	/// <summary>
+	/// Encodes an 8 bit RGB image in memory in the file type specified. Together with writeEncodedImage this is writeImage split in its CPU bound and
+	/// its disk bound half, so both can be timed separately.
+	/// </summary>
+	/// <param name="filetype"></param>
+	/// <param name="data">RGB, 3 bytes per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="encodedData">receives the complete file</param>
+	/// <returns>true if the image was encoded, false otherwise</returns>
+	bool encodeImage(ScreenshotFiletype filetype, const uint8_t* data, int width, int height, std::vector<uint8_t>& encodedData);
+	/// <summary>
+	/// Writes an image encoded by encodeImage to the file specified.
+	/// </summary>
+	/// <returns>the number of bytes written, or 0 if the file couldn't be written</returns>
+	size_t writeEncodedImage(const std::string& filename, const std::vector<uint8_t>& encodedData);
+	/// <summary>
+	/// Writes a PNG chunk with the type and data specified to the file specified, including its length and crc.
+	/// </summary>
+	void writePngChunk(FILE* file, const char* type, const uint8_t* data, uint32_t length);
+	/// <summary>
+	/// Returns the file extension, without the '.', of the file type specified.
+	/// </summary>
+	std::string fileExtension(ScreenshotFiletype filetype);
+
+	/// <summary>
+	/// Writes a PNG with 16 bits per channel, for data which doesn't fit in 8 bits like depth maps.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="data">numberOfChannels values per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="numberOfChannels">1 (gray), 3 (RGB) or 4 (RGBA)</param>
+	/// <param name="isHdr10">true if the data is PQ encoded with BT.2020 primaries. A cICP chunk is then written so viewers display the image as HDR</param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writePng16(const std::string& filename, const uint16_t* data, int width, int height, int numberOfChannels, bool isHdr10 = false);
+	/// <summary>
+	/// Writes an 8 bit RGB PNG compressed as much as is reasonable, for archiving: the filter is chosen per row and the data is compressed with
+	/// ArchivalDeflate on all cores. Many times slower than writeImage, so meant to run in the background after a session.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="data">RGB, 3 bytes per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeArchivalPng(const std::string& filename, const uint8_t* data, int width, int height);
+
+	/// <summary>
+	/// Writes an OpenEXR file with half float RGB channels and ZIP compression, for linear high dynamic range data. Values which don't fit in a half float
+	/// are clamped to the largest half float value.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="data">RGB, 3 floats per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeExr(const std::string& filename, const float* data, int width, int height);
+	/// <summary>
+	/// Writes an OpenEXR file with a single 32 bit float Z channel and ZIP compression, for depth maps.
+	/// </summary>
+	/// <param name="filename">full path of the file to write</param>
+	/// <param name="data">1 float per pixel, top row first</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeExrDepth(const std::string& filename, const float* data, int width, int height);
+}
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ImageOperations.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace IGCS::ImageOperations
+{
+	namespace
+	{
+		constexpr int RowsPerWorkItem = 16;
+
+		/// <summary>
+		/// The source pixels covering a destination pixel along one axis, with the part of each source pixel covered as weight.
+		/// </summary>
+		struct AreaSpan
+		{
+			int firstSourceIndex = 0;
+			std::vector<float> weights;
+		};
+
+
+		std::vector<AreaSpan> createAreaSpans(int sourceSize, int destinationSize)
+		{
+			std::vector<AreaSpan> toReturn(destinationSize);
+			const double scale = (double)sourceSize / destinationSize;
+			for(int i = 0; i < destinationSize; i++)
+			{
+				const double start = i * scale;
+				const double end = (std::min)((i + 1) * scale, (double)sourceSize);
+				AreaSpan& span = toReturn[i];
+				span.firstSourceIndex = (int)start;
+				const int lastSourceIndex = (std::min)((int)ceil(end) - 1, sourceSize - 1);
+				for(int sourceIndex = span.firstSourceIndex; sourceIndex <= lastSourceIndex; sourceIndex++)
+				{
+					const double covered = (std::min)(end, sourceIndex + 1.0) - (std::max)(start, (double)sourceIndex);
+					span.weights.push_back((float)(covered / (end - start)));
+				}
+			}
+			return toReturn;
+		}
+
+
+		/// <summary>
+		/// accumulator[i] += row[i] * weight, for numberOfValues bytes.
+		/// </summary>
+		void accumulateRow(float* accumulator, const uint8_t* row, size_t numberOfValues, float weight)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 weights = _mm_set1_ps(weight);
+			size_t i = 0;
+			for(; i + 16 <= numberOfValues; i += 16)
+			{
+				const __m128i bytes = _mm_loadu_si128((const __m128i*)(row + i));
+				const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+				const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+				_mm_storeu_ps(accumulator + i, _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), weights)));
+				_mm_storeu_ps(accumulator + i + 4, _mm_add_ps(_mm_loadu_ps(accumulator + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), weights)));
+				_mm_storeu_ps(accumulator + i + 8, _mm_add_ps(_mm_loadu_ps(accumulator + i + 8), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), weights)));
+				_mm_storeu_ps(accumulator + i + 12, _mm_add_ps(_mm_loadu_ps(accumulator + i + 12), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), weights)));
+			}
+			for(; i < numberOfValues; i++)
+			{
+				accumulator[i] += row[i] * weight;
+			}
+		}
+	}
+
+
+	void downscaleRgb(const uint8_t* source, int sourceWidth, int sourceHeight, uint8_t* destination, int destinationWidth, int destinationHeight, int destinationRowStride)
+	{
+		if(nullptr == source || nullptr == destination || sourceWidth <= 0 || sourceHeight <= 0 || destinationWidth <= 0 || destinationHeight <= 0)
+		{
+			return;
+		}
+		const std::vector<AreaSpan> horizontalSpans = createAreaSpans(sourceWidth, destinationWidth);
+		const std::vector<AreaSpan> verticalSpans = createAreaSpans(sourceHeight, destinationHeight);
+		const size_t sourceRowSizeInBytes = (size_t)sourceWidth * 3;
+
+		// First the source rows of a destination row are blended into a single row, which touches every source byte once and is done with SIMD,
+		// then that row is reduced horizontally, which only touches the much smaller blended row.
+		const int numberOfWorkItems = (destinationHeight + RowsPerWorkItem - 1) / RowsPerWorkItem;
+		IGCS::WorkerPool::parallelFor(numberOfWorkItems, [&](int workItem)
+		{
+			std::vector<float> blendedRow(sourceRowSizeInBytes);
+			const int lastRow = (std::min)((workItem + 1) * RowsPerWorkItem, destinationHeight);
+			for(int y = workItem * RowsPerWorkItem; y < lastRow; y++)
+			{
+				std::fill(blendedRow.begin(), blendedRow.end(), 0.0f);
+				const AreaSpan& verticalSpan = verticalSpans[y];
+				for(int i = 0; i < (int)verticalSpan.weights.size(); i++)
+				{
+					accumulateRow(blendedRow.data(), source + (verticalSpan.firstSourceIndex + i) * sourceRowSizeInBytes, sourceRowSizeInBytes, verticalSpan.weights[i]);
+				}
+				uint8_t* destinationRow = destination + (size_t)y * destinationRowStride;
+				for(int x = 0; x < destinationWidth; x++)
+				{
+					const AreaSpan& horizontalSpan = horizontalSpans[x];
+					float red = 0.0f;
+					float green = 0.0f;
+					float blue = 0.0f;
+					const float* blendedPixel = blendedRow.data() + (size_t)horizontalSpan.firstSourceIndex * 3;
+					for(const float weight : horizontalSpan.weights)
+					{
+						red += blendedPixel[0] * weight;
+						green += blendedPixel[1] * weight;
+						blue += blendedPixel[2] * weight;
+						blendedPixel += 3;
+					}
+					destinationRow[x * 3] = (uint8_t)std::clamp((int)(red + 0.5f), 0, 255);
+					destinationRow[x * 3 + 1] = (uint8_t)std::clamp((int)(green + 0.5f), 0, 255);
+					destinationRow[x * 3 + 2] = (uint8_t)std::clamp((int)(blue + 0.5f), 0, 255);
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+
+namespace IGCS::ImageOperations
+{
+	/// <summary>
+	/// Resizes an RGB image (3 bytes per pixel) using an area filter: every destination pixel is the average of the source pixels it covers. Meant for
+	/// downscaling, where it doesn't alias like point or bilinear sampling. The rows are spread over all cores.
+	/// </summary>
+	/// <param name="source">the source image, top row first, rows are tightly packed</param>
+	/// <param name="sourceWidth"></param>
+	/// <param name="sourceHeight"></param>
+	/// <param name="destination">the top left pixel of the destination. Can be inside a larger image</param>
+	/// <param name="destinationWidth"></param>
+	/// <param name="destinationHeight"></param>
+	/// <param name="destinationRowStride">the number of bytes between two rows in the destination</param>
+	void downscaleRgb(const uint8_t* source, int sourceWidth, int sourceHeight, uint8_t* destination, int destinationWidth, int destinationHeight, int destinationRowStride);
+}
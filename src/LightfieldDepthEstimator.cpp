@@ -0,0 +1,417 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "LightfieldDepthEstimator.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace IGCS::LightfieldDepthEstimator
+{
+	namespace
+	{
+		constexpr int WindowRadius = 2;					// the SAD window is (2 * radius + 1)^2 pixels
+		constexpr int TileSize = 64;					// the unit of work. A tile plus its window border fits in the L1/L2 cache
+		constexpr int RefinementRadius = 2;				// the search range, in candidates, around the upscaled disparity of the coarser level
+		constexpr int MaximumCoarseSearchRange = 32;	// the pyramid is made deep enough that the coarsest level searches at most this many candidates
+		constexpr int MinimumLevelSize = 64;
+		constexpr int MaximumNumberOfMatchViews = 8;
+
+		/// <summary>
+		/// A view the reference view is matched against. Disparities are searched in candidate steps which shift the view furthest away from the reference
+		/// view by 1 pixel. Stepping per pixel of disparity instead would shift far views by several pixels per step and miss the match on fine texture.
+		/// </summary>
+		struct MatchView
+		{
+			int imageIndex = 0;				// index in the images of a pyramid level
+			float shiftPerCandidateX = 0.0f;
+			float shiftPerCandidateY = 0.0f;
+			bool isLeft = false;			// which side of the reference view the view is on, used to handle occlusions.
+		};
+
+
+		struct PyramidLevel
+		{
+			int width = 0;
+			int height = 0;
+			std::vector<std::vector<uint8_t>> images;		// grayscale. The reference view is the first image, then the match views.
+		};
+
+
+		void convertToLuma(const uint8_t* rgbData, int width, int height, std::vector<uint8_t>& luma)
+		{
+			luma.resize((size_t)width * height);
+			for(size_t i = 0; i < luma.size(); i++)
+			{
+				const uint8_t* pixel = rgbData + i * 3;
+				luma[i] = (uint8_t)((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2]) >> 8);
+			}
+		}
+
+
+		void downsample(const std::vector<uint8_t>& source, int sourceWidth, int sourceHeight, std::vector<uint8_t>& destination, int width, int height)
+		{
+			destination.resize((size_t)width * height);
+			for(int y = 0; y < height; y++)
+			{
+				const uint8_t* topRow = source.data() + (size_t)(std::min)(y * 2, sourceHeight - 1) * sourceWidth;
+				const uint8_t* bottomRow = source.data() + (size_t)(std::min)(y * 2 + 1, sourceHeight - 1) * sourceWidth;
+				for(int x = 0; x < width; x++)
+				{
+					const int left = (std::min)(x * 2, sourceWidth - 1);
+					const int right = (std::min)(x * 2 + 1, sourceWidth - 1);
+					destination[(size_t)y * width + x] = (uint8_t)((topRow[left] + topRow[right] + bottomRow[left] + bottomRow[right] + 2) >> 2);
+				}
+			}
+		}
+
+
+		/// <summary>
+		/// Adds |reference(x) - view(x + shiftX)| to sums for the count pixels starting at firstX. Coordinates outside the image are clamped to the edge.
+		/// </summary>
+		void accumulateAbsoluteDifferences(uint16_t* sums, const uint8_t* referenceRow, const uint8_t* viewRow, int firstX, int count, int shiftX, int width)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			int i = 0;
+			while(i < count)
+			{
+				const int x = firstX + i;
+				if(x >= 0 && x + shiftX >= 0 && x + 16 <= width && x + shiftX + 16 <= width && i + 16 <= count)
+				{
+					const __m128i referenceBytes = _mm_loadu_si128((const __m128i*)(referenceRow + x));
+					const __m128i viewBytes = _mm_loadu_si128((const __m128i*)(viewRow + x + shiftX));
+					// unsigned bytes have no abs, but one of the saturated differences is always 0.
+					const __m128i absoluteDifferences = _mm_or_si128(_mm_subs_epu8(referenceBytes, viewBytes), _mm_subs_epu8(viewBytes, referenceBytes));
+					__m128i* destination = (__m128i*)(sums + i);
+					_mm_storeu_si128(destination, _mm_add_epi16(_mm_loadu_si128(destination), _mm_unpacklo_epi8(absoluteDifferences, zero)));
+					_mm_storeu_si128(destination + 1, _mm_add_epi16(_mm_loadu_si128(destination + 1), _mm_unpackhi_epi8(absoluteDifferences, zero)));
+					i += 16;
+					continue;
+				}
+				const int referenceValue = referenceRow[std::clamp(x, 0, width - 1)];
+				const int viewValue = viewRow[std::clamp(x + shiftX, 0, width - 1)];
+				sums[i] += (uint16_t)std::abs(referenceValue - viewValue);
+				i++;
+			}
+		}
+
+
+		/// <summary>
+		/// Sums the window around every tile pixel. sums is the region of the tile plus a border of WindowRadius pixels on every side.
+		/// </summary>
+		void sumWindows(const std::vector<uint16_t>& sums, int regionWidth, int tileWidth, int tileHeight, std::vector<uint32_t>& columnSums, uint32_t* windowSums)
+		{
+			constexpr int windowSize = WindowRadius * 2 + 1;
+			for(int y = 0; y < tileHeight; y++)
+			{
+				std::fill(columnSums.begin(), columnSums.end(), 0);
+				for(int row = 0; row < windowSize; row++)
+				{
+					const uint16_t* sourceRow = sums.data() + (size_t)(y + row) * regionWidth;
+					for(int x = 0; x < regionWidth; x++)
+					{
+						columnSums[x] += sourceRow[x];
+					}
+				}
+				uint32_t runningSum = 0;
+				for(int x = 0; x < windowSize - 1; x++)
+				{
+					runningSum += columnSums[x];
+				}
+				for(int x = 0; x < tileWidth; x++)
+				{
+					runningSum += columnSums[x + windowSize - 1];
+					windowSums[y * tileWidth + x] = runningSum;
+					runningSum -= columnSums[x];
+				}
+			}
+		}
+
+
+		/// <summary>
+		/// Estimates the disparity, in candidate steps, of the pixels in the tile. Every pixel only considers the candidates
+		/// [lowestCandidates[pixel], lowestCandidates[pixel] + numberOfCandidates).
+		/// </summary>
+		void processTile(const PyramidLevel& level, const std::vector<MatchView>& matchViews, int tileX, int tileY, const std::vector<int>& lowestCandidates,
+						 int numberOfCandidates, int maximumCandidate, std::vector<float>& disparities)
+		{
+			const int width = level.width;
+			const int height = level.height;
+			const int tileWidth = (std::min)(TileSize, width - tileX);
+			const int tileHeight = (std::min)(TileSize, height - tileY);
+			const int regionX = tileX - WindowRadius;
+			const int regionY = tileY - WindowRadius;
+			const int regionWidth = tileWidth + 2 * WindowRadius;
+			const int regionHeight = tileHeight + 2 * WindowRadius;
+			const int numberOfTilePixels = tileWidth * tileHeight;
+
+			int lowestCandidate = INT_MAX;
+			int highestCandidate = 0;
+			for(int y = 0; y < tileHeight; y++)
+			{
+				for(int x = 0; x < tileWidth; x++)
+				{
+					const int pixelLowestCandidate = lowestCandidates[(size_t)(tileY + y) * width + tileX + x];
+					lowestCandidate = (std::min)(lowestCandidate, pixelLowestCandidate);
+					highestCandidate = (std::max)(highestCandidate, pixelLowestCandidate);
+				}
+			}
+			highestCandidate = (std::min)(highestCandidate + numberOfCandidates - 1, maximumCandidate);
+
+			int numberOfLeftViews = 0;
+			for(const auto& matchView : matchViews)
+			{
+				numberOfLeftViews += matchView.isLeft ? 1 : 0;
+			}
+			const int numberOfRightViews = (int)matchViews.size() - numberOfLeftViews;
+
+			std::vector<uint32_t> costs((size_t)numberOfTilePixels * numberOfCandidates, UINT32_MAX);
+			std::vector<uint16_t> leftSums((size_t)regionWidth * regionHeight);
+			std::vector<uint16_t> rightSums((size_t)regionWidth * regionHeight);
+			std::vector<uint32_t> columnSums(regionWidth);
+			std::vector<uint32_t> leftWindowSums(numberOfTilePixels);
+			std::vector<uint32_t> rightWindowSums(numberOfTilePixels);
+			const uint8_t* referenceImage = level.images[0].data();
+			for(int candidate = lowestCandidate; candidate <= highestCandidate; candidate++)
+			{
+				std::fill(leftSums.begin(), leftSums.end(), 0);
+				std::fill(rightSums.begin(), rightSums.end(), 0);
+				for(const auto& matchView : matchViews)
+				{
+					const int shiftX = (int)lroundf(candidate * matchView.shiftPerCandidateX);
+					const int shiftY = (int)lroundf(candidate * matchView.shiftPerCandidateY);
+					const uint8_t* viewImage = level.images[matchView.imageIndex].data();
+					std::vector<uint16_t>& sums = matchView.isLeft ? leftSums : rightSums;
+					for(int row = 0; row < regionHeight; row++)
+					{
+						const int referenceY = std::clamp(regionY + row, 0, height - 1);
+						const int viewY = std::clamp(regionY + row + shiftY, 0, height - 1);
+						accumulateAbsoluteDifferences(sums.data() + (size_t)row * regionWidth, referenceImage + (size_t)referenceY * width, viewImage + (size_t)viewY * width,
+													  regionX, regionWidth, shiftX, width);
+					}
+				}
+				sumWindows(leftSums, regionWidth, tileWidth, tileHeight, columnSums, leftWindowSums.data());
+				sumWindows(rightSums, regionWidth, tileWidth, tileHeight, columnSums, rightWindowSums.data());
+
+				for(int y = 0; y < tileHeight; y++)
+				{
+					for(int x = 0; x < tileWidth; x++)
+					{
+						const int slot = candidate - lowestCandidates[(size_t)(tileY + y) * width + tileX + x];
+						if(slot < 0 || slot >= numberOfCandidates)
+						{
+							continue;
+						}
+						// A point visible in the reference view can be occluded on one side, but rarely on both. Taking the best side avoids the
+						// fattening of foreground edges a plain sum over all views gives. The sides are scaled to the same number of views.
+						const int pixelIndex = y * tileWidth + x;
+						uint32_t cost;
+						if(numberOfLeftViews > 0 && numberOfRightViews > 0)
+						{
+							cost = (std::min)(leftWindowSums[pixelIndex] * numberOfRightViews, rightWindowSums[pixelIndex] * numberOfLeftViews);
+						}
+						else
+						{
+							cost = numberOfLeftViews > 0 ? leftWindowSums[pixelIndex] : rightWindowSums[pixelIndex];
+						}
+						costs[(size_t)pixelIndex * numberOfCandidates + slot] = cost;
+					}
+				}
+			}
+
+			for(int y = 0; y < tileHeight; y++)
+			{
+				for(int x = 0; x < tileWidth; x++)
+				{
+					const uint32_t* pixelCosts = costs.data() + (size_t)(y * tileWidth + x) * numberOfCandidates;
+					int bestSlot = 0;
+					for(int slot = 1; slot < numberOfCandidates; slot++)
+					{
+						if(pixelCosts[slot] < pixelCosts[bestSlot])
+						{
+							bestSlot = slot;
+						}
+					}
+					// fit a parabola through the best cost and its neighbours for the sub-pixel part.
+					float offset = 0.0f;
+					if(bestSlot > 0 && bestSlot < numberOfCandidates - 1 && pixelCosts[bestSlot - 1] != UINT32_MAX && pixelCosts[bestSlot + 1] != UINT32_MAX)
+					{
+						const float previousCost = (float)pixelCosts[bestSlot - 1];
+						const float bestCost = (float)pixelCosts[bestSlot];
+						const float nextCost = (float)pixelCosts[bestSlot + 1];
+						const float denominator = previousCost - 2.0f * bestCost + nextCost;
+						if(denominator > 0.0f)
+						{
+							offset = std::clamp(0.5f * (previousCost - nextCost) / denominator, -0.5f, 0.5f);
+						}
+					}
+					const size_t pixelIndex = (size_t)(tileY + y) * width + tileX + x;
+					disparities[pixelIndex] = (float)(lowestCandidates[pixelIndex] + bestSlot) + offset;
+				}
+			}
+		}
+
+
+		/// <summary>
+		/// Picks the views to match against: at most MaximumNumberOfMatchViews, spread evenly over the distances to the reference view so both short
+		/// baselines (few occlusions) and long baselines (precision) are used.
+		/// </summary>
+		std::vector<int> selectMatchViews(const std::vector<LightfieldView>& views, int referenceViewIndex)
+		{
+			const LightfieldView& referenceView = views[referenceViewIndex];
+			std::vector<int> candidates;
+			for(int i = 0; i < (int)views.size(); i++)
+			{
+				if(i != referenceViewIndex && (views[i].u != referenceView.u || views[i].v != referenceView.v))
+				{
+					candidates.push_back(i);
+				}
+			}
+			auto distanceToReference = [&](int index)
+			{
+				return fabsf(views[index].u - referenceView.u) + fabsf(views[index].v - referenceView.v);
+			};
+			std::stable_sort(candidates.begin(), candidates.end(), [&](int a, int b) { return distanceToReference(a) < distanceToReference(b); });
+			if(candidates.size() <= MaximumNumberOfMatchViews)
+			{
+				return candidates;
+			}
+			std::vector<int> toReturn;
+			for(int i = 0; i < MaximumNumberOfMatchViews; i++)
+			{
+				toReturn.push_back(candidates[(size_t)i * (candidates.size() - 1) / (MaximumNumberOfMatchViews - 1)]);
+			}
+			return toReturn;
+		}
+	}
+
+
+	void estimateDisparity(const std::vector<LightfieldView>& views, int referenceViewIndex, int width, int height, float maximumDisparity, std::vector<float>& disparities)
+	{
+		disparities.assign((size_t)width * height, 0.0f);
+		if(referenceViewIndex < 0 || referenceViewIndex >= (int)views.size() || width <= 0 || height <= 0 || maximumDisparity <= 0.0f)
+		{
+			return;
+		}
+		const std::vector<int> matchViewIndices = selectMatchViews(views, referenceViewIndex);
+		if(matchViewIndices.size() <= 0)
+		{
+			return;
+		}
+		const LightfieldView& referenceView = views[referenceViewIndex];
+		float largestShiftPerDisparity = 0.0f;
+		for(const int viewIndex : matchViewIndices)
+		{
+			largestShiftPerDisparity = (std::max)({ largestShiftPerDisparity, fabsf(views[viewIndex].u - referenceView.u), fabsf(views[viewIndex].v - referenceView.v) });
+		}
+		std::vector<MatchView> matchViews;
+		for(int i = 0; i < (int)matchViewIndices.size(); i++)
+		{
+			const LightfieldView& view = views[matchViewIndices[i]];
+			MatchView matchView;
+			matchView.imageIndex = i + 1;
+			matchView.shiftPerCandidateX = -(view.u - referenceView.u) / largestShiftPerDisparity;
+			matchView.shiftPerCandidateY = -(view.v - referenceView.v) / largestShiftPerDisparity;
+			matchView.isLeft = view.u < referenceView.u || (view.u == referenceView.u && view.v < referenceView.v);
+			matchViews.push_back(matchView);
+		}
+		const float maximumCandidate = maximumDisparity * largestShiftPerDisparity;
+
+		int coarsestLevel = 0;
+		while(maximumCandidate / (float)(1 << coarsestLevel) > MaximumCoarseSearchRange && (width >> (coarsestLevel + 1)) >= MinimumLevelSize
+			  && (height >> (coarsestLevel + 1)) >= MinimumLevelSize)
+		{
+			coarsestLevel++;
+		}
+
+		// build the pyramids, one image per thread.
+		const int numberOfImages = (int)matchViews.size() + 1;
+		std::vector<PyramidLevel> pyramid(coarsestLevel + 1);
+		for(int level = 0; level <= coarsestLevel; level++)
+		{
+			pyramid[level].width = (std::max)(width >> level, 1);
+			pyramid[level].height = (std::max)(height >> level, 1);
+			pyramid[level].images.resize(numberOfImages);
+		}
+		IGCS::WorkerPool::parallelFor(numberOfImages, [&](int imageIndex)
+		{
+			const uint8_t* rgbData = imageIndex == 0 ? referenceView.data : views[matchViewIndices[imageIndex - 1]].data;
+			convertToLuma(rgbData, width, height, pyramid[0].images[imageIndex]);
+			for(int level = 1; level <= coarsestLevel; level++)
+			{
+				downsample(pyramid[level - 1].images[imageIndex], pyramid[level - 1].width, pyramid[level - 1].height, pyramid[level].images[imageIndex],
+						   pyramid[level].width, pyramid[level].height);
+			}
+		});
+
+		std::vector<float> previousDisparities;
+		for(int level = coarsestLevel; level >= 0; level--)
+		{
+			const PyramidLevel& currentLevel = pyramid[level];
+			const int maximumCandidateOnLevel = (int)ceilf(maximumCandidate / (float)(1 << level));
+			std::vector<int> lowestCandidates((size_t)currentLevel.width * currentLevel.height, 0);
+			int numberOfCandidates = maximumCandidateOnLevel + 1;
+			if(level < coarsestLevel)
+			{
+				// search around the disparity of the coarser level, which is half the disparity on this level.
+				numberOfCandidates = (std::min)(2 * RefinementRadius + 1, maximumCandidateOnLevel + 1);
+				const PyramidLevel& coarserLevel = pyramid[level + 1];
+				for(int y = 0; y < currentLevel.height; y++)
+				{
+					for(int x = 0; x < currentLevel.width; x++)
+					{
+						const float coarserDisparity = previousDisparities[(size_t)(std::min)(y / 2, coarserLevel.height - 1) * coarserLevel.width + (std::min)(x / 2, coarserLevel.width - 1)];
+						lowestCandidates[(size_t)y * currentLevel.width + x] = std::clamp((int)lroundf(coarserDisparity * 2.0f) - RefinementRadius, 0,
+																						   maximumCandidateOnLevel - numberOfCandidates + 1);
+					}
+				}
+			}
+
+			std::vector<float> currentDisparities((size_t)currentLevel.width * currentLevel.height, 0.0f);
+			const int numberOfTilesX = (currentLevel.width + TileSize - 1) / TileSize;
+			const int numberOfTilesY = (currentLevel.height + TileSize - 1) / TileSize;
+			IGCS::WorkerPool::parallelFor(numberOfTilesX * numberOfTilesY, [&](int tileIndex)
+			{
+				processTile(currentLevel, matchViews, (tileIndex % numberOfTilesX) * TileSize, (tileIndex / numberOfTilesX) * TileSize, lowestCandidates,
+							numberOfCandidates, maximumCandidateOnLevel, currentDisparities);
+			});
+			previousDisparities = std::move(currentDisparities);
+		}
+		for(size_t i = 0; i < disparities.size(); i++)
+		{
+			disparities[i] = previousDisparities[i] / largestShiftPerDisparity;
+		}
+	}
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+#include "LightfieldRefocuser.h"
+
+namespace IGCS::LightfieldDepthEstimator
+{
+	/// <summary>
+	/// Estimates the disparity of every pixel of the reference view using multi-baseline block matching over the other views. The views are rectified
+	/// by construction (the camera only moves along its right and up vectors), so a point with disparity d in the reference view is found at
+	/// x - d * (u - uReference), y - d * (v - vReference) in another view. The search runs coarse-to-fine over an image pyramid: the full disparity range
+	/// is only searched at the coarsest level, the finer levels refine the upscaled estimate. Per candidate the cost is the SAD over a small window,
+	/// taking the best of the views left and right of the reference to handle occlusions. The result is refined to sub-pixel precision.
+	/// </summary>
+	/// <param name="views">the views of the lightfield. At most 8 views next to the reference view are used, spread over the available baselines</param>
+	/// <param name="referenceViewIndex">the index in views of the view to estimate the disparity for</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="maximumDisparity">the maximum disparity, in pixels per step, to search for. The minimum is 0 (infinity)</param>
+	/// <param name="disparities">receives the disparity per pixel, in pixels per step, top row first</param>
+	void estimateDisparity(const std::vector<LightfieldView>& views, int referenceViewIndex, int width, int height, float maximumDisparity, std::vector<float>& disparities);
+}
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// LightfieldRefocus: writes refocused images of a lightfield session after the session, for any focus disparities, with the shift-and-add refocusing
+// the addon uses when 'Write refocused images' is checked. The grid is read from the lightfield.json in the session folder, the shots have to be PNG
+// files as the addon writes them: files which have been recompressed for archiving can't be read.
+//
+// Usage: LightfieldRefocus <session folder> <disparity> [disparity ...]
+// Writes refocused_disparity_{disparity}.png into the session folder for every disparity specified.
+#include "stdafx.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "fpng.h"
+#include "LightfieldRefocuser.h"
+#include "WorkerPool.h"
+
+namespace
+{
+	struct SessionShot
+	{
+		std::string filename;
+		int row = 0;
+		int column = 0;
+	};
+
+
+	struct LightfieldSession
+	{
+		int numberOfRows = 1;
+		int numberOfColumns = 0;
+		float horizontalSpacing = 0.0f;
+		float verticalSpacing = 0.0f;
+		std::vector<SessionShot> shots;
+	};
+
+
+	/// <summary>
+	/// Returns the number after the key specified in the line specified, or defaultValue if the line doesn't contain the key.
+	/// </summary>
+	float readNumber(const char* line, const char* key, float defaultValue)
+	{
+		const std::string quotedKey = std::string("\"") + key + "\":";
+		const char* keyStart = strstr(line, quotedKey.c_str());
+		return nullptr == keyStart ? defaultValue : (float)atof(keyStart + quotedKey.size());
+	}
+
+
+	/// <summary>
+	/// Reads the grid and the shots from lightfield.json, which the addon writes with one value or view per line. The interpolated views are skipped:
+	/// they're synthesized from the shots, so they don't add anything to a refocused image.
+	/// </summary>
+	bool readSession(const std::string& sessionFolder, LightfieldSession& session)
+	{
+		FILE* metadataFile = nullptr;
+		if(fopen_s(&metadataFile, (sessionFolder + "/lightfield.json").c_str(), "r") != 0 || nullptr == metadataFile)
+		{
+			return false;
+		}
+		char line[1024];
+		while(nullptr != fgets(line, sizeof(line), metadataFile))
+		{
+			if(nullptr != strstr(line, "\"interpolatedViews"))
+			{
+				break;
+			}
+			const char* fileStart = strstr(line, "\"file\": \"");
+			if(nullptr == fileStart)
+			{
+				session.numberOfRows = (int)readNumber(line, "rows", (float)session.numberOfRows);
+				session.numberOfColumns = (int)readNumber(line, "columns", (float)session.numberOfColumns);
+				session.horizontalSpacing = readNumber(line, "horizontalSpacing", session.horizontalSpacing);
+				session.verticalSpacing = readNumber(line, "verticalSpacing", session.verticalSpacing);
+				continue;
+			}
+			fileStart += strlen("\"file\": \"");
+			const char* fileEnd = strchr(fileStart, '"');
+			if(nullptr == fileEnd)
+			{
+				continue;
+			}
+			SessionShot shot;
+			shot.filename.assign(fileStart, fileEnd);
+			shot.row = (int)readNumber(fileEnd, "row", 0.0f);
+			shot.column = (int)readNumber(fileEnd, "column", 0.0f);
+			session.shots.push_back(shot);
+		}
+		fclose(metadataFile);
+		return session.numberOfColumns > 0 && !session.shots.empty();
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		printf("Usage: LightfieldRefocus <session folder> <disparity> [disparity ...]\n");
+		return 1;
+	}
+	const std::string sessionFolder = argv[1];
+	std::vector<float> disparities;
+	for(int i = 2; i < argc; i++)
+	{
+		char* numberEnd = nullptr;
+		disparities.push_back(strtof(argv[i], &numberEnd));
+		if(numberEnd == argv[i])
+		{
+			printf("'%s' isn't a disparity.\n", argv[i]);
+			return 1;
+		}
+	}
+	LightfieldSession session;
+	if(!readSession(sessionFolder, session))
+	{
+		printf("Can't read the lightfield session in %s: lightfield.json is missing or has no shots.\n", sessionFolder.c_str());
+		return 1;
+	}
+	fpng::fpng_init();
+	// the positions of the views the same way the addon determines them: disparities are specified in pixels per horizontal step, so the vertical positions 
+	// are scaled with the ratio between the row and column spacing.
+	const float verticalScale = session.horizontalSpacing > 0.0f ? session.verticalSpacing / session.horizontalSpacing : 0.0f;
+	std::vector<std::vector<uint8_t>> shotPixels(session.shots.size());
+	std::vector<LightfieldView> views(session.shots.size());
+	uint32_t width = 0;
+	uint32_t height = 0;
+	for(size_t i = 0; i < session.shots.size(); i++)
+	{
+		const SessionShot& shot = session.shots[i];
+		uint32_t shotWidth, shotHeight, numberOfChannels;
+		if(fpng::fpng_decode_file((sessionFolder + "/" + shot.filename).c_str(), shotPixels[i], shotWidth, shotHeight, numberOfChannels, 3) != fpng::FPNG_DECODE_SUCCESS)
+		{
+			printf("Can't read %s: only PNG files as written by the addon can be read.\n", shot.filename.c_str());
+			return 1;
+		}
+		if(i > 0 && (shotWidth != width || shotHeight != height))
+		{
+			printf("%s is %ux%u, the other shots are %ux%u.\n", shot.filename.c_str(), shotWidth, shotHeight, width, height);
+			return 1;
+		}
+		width = shotWidth;
+		height = shotHeight;
+		views[i].data = shotPixels[i].data();
+		views[i].u = shot.column - 0.5f * (session.numberOfColumns - 1);
+		views[i].v = (shot.row - 0.5f * (session.numberOfRows - 1)) * verticalScale;
+	}
+	printf("%zu shots of %ux%u read.\n", session.shots.size(), width, height);
+	// one image at a time, so the memory needed doesn't grow with the number of disparities.
+	std::vector<uint8_t> refocusedImage;
+	bool isWritten = true;
+	for(const float disparity : disparities)
+	{
+		IGCS::LightfieldRefocuser::refocus(views, (int)width, (int)height, disparity, refocusedImage);
+		char filename[64];
+		snprintf(filename, sizeof(filename), "refocused_disparity_%.2f.png", disparity);
+		if(fpng::fpng_encode_image_to_file((sessionFolder + "/" + filename).c_str(), refocusedImage.data(), width, height, 3))
+		{
+			printf("%s written.\n", filename);
+		}
+		else
+		{
+			printf("Can't write %s.\n", filename);
+			isWritten = false;
+		}
+	}
+	IGCS::WorkerPool::stop();
+	return isWritten ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "LightfieldRefocuser.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace IGCS::LightfieldRefocuser
+{
+	namespace
+	{
+		// The size of the float accumulator of a single band. Together with the source rows read for the band this stays well inside the L2 cache.
+		constexpr int AccumulatorBudgetInBytes = 128 * 1024;
+
+		/// <summary>
+		/// How a view is sampled for a given disparity. As the shift is the same for every pixel of a view, the bilinear weights are constant per view.
+		/// </summary>
+		struct ViewSampler
+		{
+			const uint8_t* data = nullptr;
+			int offsetX = 0;
+			int offsetY = 0;
+			float weightTopLeft = 0.0f;
+			float weightTopRight = 0.0f;
+			float weightBottomLeft = 0.0f;
+			float weightBottomRight = 0.0f;
+		};
+
+
+		ViewSampler createSampler(const LightfieldView& view, float disparity, float weightPerView)
+		{
+			ViewSampler toReturn;
+			toReturn.data = view.data;
+			// a point on the focus plane at x in the center view is at x - disparity * u in the view.
+			const float shiftX = -disparity * view.u;
+			const float shiftY = -disparity * view.v;
+			const float floorX = floorf(shiftX);
+			const float floorY = floorf(shiftY);
+			const float fractionX = shiftX - floorX;
+			const float fractionY = shiftY - floorY;
+			toReturn.offsetX = (int)floorX;
+			toReturn.offsetY = (int)floorY;
+			// the weight per view is folded into the bilinear weights so the accumulator contains the final average.
+			toReturn.weightTopLeft = (1.0f - fractionX) * (1.0f - fractionY) * weightPerView;
+			toReturn.weightTopRight = fractionX * (1.0f - fractionY) * weightPerView;
+			toReturn.weightBottomLeft = (1.0f - fractionX) * fractionY * weightPerView;
+			toReturn.weightBottomRight = fractionX * fractionY * weightPerView;
+			return toReturn;
+		}
+
+
+		/// <summary>
+		/// Converts 16 bytes to 16 floats and adds them, multiplied with weight, to the 4 sums.
+		/// </summary>
+		inline void multiplyAdd(__m128i bytes, __m128 weight, __m128 sums[4])
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+			const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+			sums[0] = _mm_add_ps(sums[0], _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), weight));
+			sums[1] = _mm_add_ps(sums[1], _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), weight));
+			sums[2] = _mm_add_ps(sums[2], _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), weight));
+			sums[3] = _mm_add_ps(sums[3], _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), weight));
+		}
+
+
+		inline void accumulatePixelClamped(float* accumulator, const uint8_t* topRow, const uint8_t* bottomRow, int x, int width, const ViewSampler& sampler)
+		{
+			const int leftX = std::clamp(x + sampler.offsetX, 0, width - 1) * 3;
+			const int rightX = std::clamp(x + sampler.offsetX + 1, 0, width - 1) * 3;
+			for(int channel = 0; channel < 3; channel++)
+			{
+				accumulator[x * 3 + channel] += topRow[leftX + channel] * sampler.weightTopLeft + topRow[rightX + channel] * sampler.weightTopRight
+											  + bottomRow[leftX + channel] * sampler.weightBottomLeft + bottomRow[rightX + channel] * sampler.weightBottomRight;
+			}
+		}
+
+
+		/// <summary>
+		/// Adds the row y of the shifted view to the accumulator row.
+		/// </summary>
+		void accumulateRow(float* accumulator, const ViewSampler& sampler, int y, int width, int height)
+		{
+			const size_t rowSizeInBytes = (size_t)width * 3;
+			const uint8_t* topRow = sampler.data + std::clamp(y + sampler.offsetY, 0, height - 1) * rowSizeInBytes;
+			const uint8_t* bottomRow = sampler.data + std::clamp(y + sampler.offsetY + 1, 0, height - 1) * rowSizeInBytes;
+
+			// pixels for which both the left and the right source pixel are inside the view don't need clamping.
+			const int firstUnclampedX = std::clamp(-sampler.offsetX, 0, width);
+			const int lastUnclampedX = std::clamp(width - 1 - sampler.offsetX, firstUnclampedX, width);
+			for(int x = 0; x < firstUnclampedX; x++)
+			{
+				accumulatePixelClamped(accumulator, topRow, bottomRow, x, width, sampler);
+			}
+
+			// In the unclamped range source byte i + 3*offsetX belongs to destination byte i, and its right neighbour is 3 bytes further. As the shift is
+			// the same for all channels we can process the row as a flat array of bytes.
+			const ptrdiff_t sourceOffset = (ptrdiff_t)sampler.offsetX * 3;
+			const __m128 weightTopLeft = _mm_set1_ps(sampler.weightTopLeft);
+			const __m128 weightTopRight = _mm_set1_ps(sampler.weightTopRight);
+			const __m128 weightBottomLeft = _mm_set1_ps(sampler.weightBottomLeft);
+			const __m128 weightBottomRight = _mm_set1_ps(sampler.weightBottomRight);
+			int byteIndex = firstUnclampedX * 3;
+			const int endByteIndex = lastUnclampedX * 3;
+			for(; byteIndex + 16 <= endByteIndex; byteIndex += 16)
+			{
+				const uint8_t* topSource = topRow + byteIndex + sourceOffset;
+				const uint8_t* bottomSource = bottomRow + byteIndex + sourceOffset;
+				float* destination = accumulator + byteIndex;
+				__m128 sums[4] = { _mm_loadu_ps(destination), _mm_loadu_ps(destination + 4), _mm_loadu_ps(destination + 8), _mm_loadu_ps(destination + 12) };
+				multiplyAdd(_mm_loadu_si128((const __m128i*)topSource), weightTopLeft, sums);
+				multiplyAdd(_mm_loadu_si128((const __m128i*)(topSource + 3)), weightTopRight, sums);
+				multiplyAdd(_mm_loadu_si128((const __m128i*)bottomSource), weightBottomLeft, sums);
+				multiplyAdd(_mm_loadu_si128((const __m128i*)(bottomSource + 3)), weightBottomRight, sums);
+				_mm_storeu_ps(destination, sums[0]);
+				_mm_storeu_ps(destination + 4, sums[1]);
+				_mm_storeu_ps(destination + 8, sums[2]);
+				_mm_storeu_ps(destination + 12, sums[3]);
+			}
+			for(; byteIndex < endByteIndex; byteIndex++)
+			{
+				const uint8_t* topSource = topRow + byteIndex + sourceOffset;
+				const uint8_t* bottomSource = bottomRow + byteIndex + sourceOffset;
+				accumulator[byteIndex] += topSource[0] * sampler.weightTopLeft + topSource[3] * sampler.weightTopRight
+										+ bottomSource[0] * sampler.weightBottomLeft + bottomSource[3] * sampler.weightBottomRight;
+			}
+
+			for(int x = lastUnclampedX; x < width; x++)
+			{
+				accumulatePixelClamped(accumulator, topRow, bottomRow, x, width, sampler);
+			}
+		}
+
+
+		/// <summary>
+		/// Converts the accumulated floats to bytes, rounded to nearest and saturated.
+		/// </summary>
+		void storeAccumulator(const float* accumulator, uint8_t* destination, size_t numberOfValues)
+		{
+			size_t i = 0;
+			for(; i + 16 <= numberOfValues; i += 16)
+			{
+				const __m128i values0 = _mm_cvtps_epi32(_mm_loadu_ps(accumulator + i));
+				const __m128i values1 = _mm_cvtps_epi32(_mm_loadu_ps(accumulator + i + 4));
+				const __m128i values2 = _mm_cvtps_epi32(_mm_loadu_ps(accumulator + i + 8));
+				const __m128i values3 = _mm_cvtps_epi32(_mm_loadu_ps(accumulator + i + 12));
+				const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(values0, values1), _mm_packs_epi32(values2, values3));
+				_mm_storeu_si128((__m128i*)(destination + i), packed);
+			}
+			for(; i < numberOfValues; i++)
+			{
+				destination[i] = (uint8_t)std::clamp((int)(accumulator[i] + 0.5f), 0, 255);
+			}
+		}
+	}
+
+
+	void refocus(const std::vector<LightfieldView>& views, int width, int height, float disparity, std::vector<uint8_t>& destination)
+	{
+		if(views.size() <= 0 || width <= 0 || height <= 0)
+		{
+			return;
+		}
+		const size_t rowSizeInBytes = (size_t)width * 3;
+		destination.resize(rowSizeInBytes * height);
+
+		std::vector<ViewSampler> samplers;
+		samplers.reserve(views.size());
+		const float weightPerView = 1.0f / (float)views.size();
+		for(const auto& view : views)
+		{
+			samplers.push_back(createSampler(view, disparity, weightPerView));
+		}
+
+		// A band is the unit of work: its accumulator stays in the cache while all views are added to it, so the memory needed is independent of the
+		// number of views and the size of the image.
+		const int rowsPerBand = std::clamp(AccumulatorBudgetInBytes / (int)(rowSizeInBytes * sizeof(float)), 1, height);
+		const int numberOfBands = (height + rowsPerBand - 1) / rowsPerBand;
+		IGCS::WorkerPool::parallelFor(numberOfBands, [&](int band)
+		{
+			const int firstRow = band * rowsPerBand;
+			const int numberOfRows = (std::min)(rowsPerBand, height - firstRow);
+			std::vector<float> accumulator(rowSizeInBytes * numberOfRows, 0.0f);
+			for(const auto& sampler : samplers)
+			{
+				for(int row = 0; row < numberOfRows; row++)
+				{
+					accumulateRow(accumulator.data() + row * rowSizeInBytes, sampler, firstRow + row, width, height);
+				}
+			}
+			storeAccumulator(accumulator.data(), destination.data() + firstRow * rowSizeInBytes, accumulator.size());
+		});
+	}
+}
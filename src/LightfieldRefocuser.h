@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// A single view of a lightfield, used as input for refocusing.
+/// </summary>
+struct LightfieldView
+{
+	const uint8_t* data = nullptr;		// RGB, 3 bytes per pixel, top row first. Has to contain width * height pixels.
+	float u = 0.0f;						// horizontal position of the camera, in steps, relative to the center of the lightfield. Positive is to the right.
+	float v = 0.0f;						// vertical position of the camera, in steps, relative to the center of the lightfield. Positive is down.
+};
+
+
+namespace IGCS::LightfieldRefocuser
+{
+	/// <summary>
+	/// Synthesizes an image focused on the plane with the disparity specified by shifting every view with disparity * (u, v) pixels and averaging the results
+	/// (shift-and-add). A disparity of 0 focuses on infinity, positive values focus closer to the camera. Sub-pixel shifts are bilinearly interpolated, pixels
+	/// outside the view are clamped to the edge. The image is processed in horizontal bands which fit in the cache, spread over all cores.
+	/// </summary>
+	/// <param name="views">the views to combine. All views have to have the same size</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="disparity">the shift, in pixels, of the plane to focus on between two neighbouring views</param>
+	/// <param name="destination">receives the refocused image, RGB, 3 bytes per pixel</param>
+	void refocus(const std::vector<LightfieldView>& views, int width, int height, float disparity, std::vector<uint8_t>& destination);
+}
@@ -49,9 +49,12 @@
 #include "ScreenshotController.h"
 #include "ScreenshotSettings.h"
 #include "OverlayControl.h"
+#include "PathRecorder.h"
+#include "StereoCapture.h"
 #include "ReshadeStateController.h"
 #include "ThreadSafeQueue.h"
 #include "WorkItem.h"
+#include "WorkerPool.h"
 
 using namespace reshade::api;
 
@@ -65,6 +68,8 @@ extern "C" __declspec(dllexport) LPBYTE getDataFromCameraToolsBuffer();
 extern "C" __declspec(dllexport) void addCameraPath();
 extern "C" __declspec(dllexport) void appendStateSnapshotAfterSnapshotOnPath(int pathIndex, int indexToAppendAfter);
 extern "C" __declspec(dllexport) void appendStateSnapshotToPath(int pathIndex);
+extern "C" __declspec(dllexport) void cameraPathPlaybackStarted();
+extern "C" __declspec(dllexport) void cameraPathPlaybackStopped();
 extern "C" __declspec(dllexport) void clearPaths();
 extern "C" __declspec(dllexport) void insertStateSnapshotBeforeSnapshotOnPath(int pathIndex, int indexToInsertBefore);
 extern "C" __declspec(dllexport) void removeCameraPath(int pathIndex);
@@ -81,8 +86,11 @@ static ScreenshotSettings g_screenshotSettings;
 static ScreenshotController g_screenshotController(g_cameraToolsConnector);
 static DepthOfFieldController g_depthOfFieldController(g_cameraToolsConnector);
 static ReshadeStateController g_reshadeStateController;
+static PathRecorder g_pathRecorder(g_cameraToolsConnector);
+static StereoCapture g_stereoCapture;
 static IGCS::ThreadSafeQueue<WorkItem> g_presentWorkQueue;
 static bool g_recordReshadeState = true;
+static int g_numberOfEffectRuntimes = 0;
 
 /// <summary>
 /// Entry point for IGCS camera tools. Call this to initialize the buffers. Obtain the buffers using the getDataFrom/ToCameraToolsBuffer functions
@@ -261,6 +269,46 @@ void setReshadeState(int pathIndex, int stateIndex)
 
 
 
+static void configurePathRecorder()
+{
+	g_pathRecorder.configure(g_screenshotSettings.screenshotFolder, (ScreenshotFiletype)g_screenshotSettings.screenshotFileType, 
+							 (EncodingSelection)g_screenshotSettings.pathRecording_encodingSelection, g_screenshotSettings.pathRecording_everyNthFrame, g_screenshotSettings.pathRecording_pausePlaybackWhenBehind, 
+							 g_screenshotSettings.pathRecording_writeAnimation, g_screenshotSettings.pathRecording_animationFramesPerSecond);
+	g_pathRecorder.configureFrameBus(g_screenshotSettings.pathRecording_publishToFrameBus, (FrameBusFullPolicy)g_screenshotSettings.pathRecording_frameBusFullPolicy,
+									 (CameraToolsData*)g_dataFromCameraToolsBuffer);
+}
+
+
+/// <summary>
+/// Called by the camera tools when a camera path starts playing. Starts the path recording if it's set to start with the playback.
+/// </summary>
+void cameraPathPlaybackStarted()
+{
+	if(!g_screenshotSettings.pathRecording_startWithPlayback)
+	{
+		return;
+	}
+	g_presentWorkQueue.push({ [](effect_runtime* lambdaRuntime)
+	{
+		configurePathRecorder();
+		g_pathRecorder.start(lambdaRuntime);
+	} });
+}
+
+
+/// <summary>
+/// Called by the camera tools when a camera path stops playing. Stops the path recording if it's set to start with the playback.
+/// </summary>
+void cameraPathPlaybackStopped()
+{
+	if(!g_screenshotSettings.pathRecording_startWithPlayback)
+	{
+		return;
+	}
+	g_presentWorkQueue.push({ [](effect_runtime* lambdaRuntime) { g_pathRecorder.stop(); } });
+}
+
+
 void handleWorkQueue(effect_runtime* runtime)
 {
 	for(;;)
@@ -289,10 +337,14 @@ static void onReshadeOverlay(effect_runtime* runtime)
 {
 	// first let the screenshot controller grab screenshots
 	g_screenshotController.reshadeEffectsRendered(runtime);
+	g_pathRecorder.frameRendered(runtime);
+	g_stereoCapture.effectsRendered(runtime);
 
 	// then we'll render our own overlays if needed
 	OverlayControl::renderOverlay();
-	g_depthOfFieldController.renderOverlay();		// if it has something to display it can do that here
+	g_depthOfFieldController.renderOverlay();
+	g_pathRecorder.renderOverlay();
+	g_stereoCapture.renderOverlay();		// if it has something to display it can do that here
 }
 
 
@@ -310,17 +362,85 @@ static void showHelpMarker(const char* desc)
 }
 
 
+static void drawRegionOfInterestPreview()
+{
+	// the region is drawn behind the overlay windows, on top of the game, with the area outside the region darkened.
+	const ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+	const ImVec2 topLeftCoords(g_screenshotSettings.regionOfInterest_left * displaySize.x, g_screenshotSettings.regionOfInterest_top * displaySize.y);
+	const ImVec2 bottomRightCoords((std::min)(g_screenshotSettings.regionOfInterest_left + g_screenshotSettings.regionOfInterest_width, 1.0f) * displaySize.x,
+								   (std::min)(g_screenshotSettings.regionOfInterest_top + g_screenshotSettings.regionOfInterest_height, 1.0f) * displaySize.y);
+	const ImU32 outsideColor = IM_COL32(0, 0, 0, 128);
+	ImDrawList* drawList = ImGui::GetBackgroundDrawList();
+	drawList->AddRectFilled(ImVec2(0.0f, 0.0f), ImVec2(displaySize.x, topLeftCoords.y), outsideColor);
+	drawList->AddRectFilled(ImVec2(0.0f, bottomRightCoords.y), displaySize, outsideColor);
+	drawList->AddRectFilled(ImVec2(0.0f, topLeftCoords.y), ImVec2(topLeftCoords.x, bottomRightCoords.y), outsideColor);
+	drawList->AddRectFilled(ImVec2(bottomRightCoords.x, topLeftCoords.y), ImVec2(displaySize.x, bottomRightCoords.y), outsideColor);
+	drawList->AddRect(topLeftCoords, bottomRightCoords, IM_COL32(255, 255, 0, 255), 0.0f, 0, 2.0f);
+}
+
+
+static void configureScreenshotController()
+{
+	const auto cameraData = (CameraToolsData*)g_dataFromCameraToolsBuffer;
+	g_screenshotController.configure(g_screenshotSettings.screenshotFolder, g_screenshotSettings.numberOfFramesToWaitBetweenSteps, (ScreenshotFiletype)g_screenshotSettings.screenshotFileType, cameraData);
+	g_screenshotController.configureExposureBracketing(g_screenshotSettings.bracketing_enabled, g_screenshotSettings.bracketing_effectName, g_screenshotSettings.bracketing_uniformName,
+													   g_screenshotSettings.bracketing_uniformIsMultiplier, g_screenshotSettings.bracketing_numberOfBrackets, 
+													   g_screenshotSettings.bracketing_stopsBetweenBrackets);
+	g_screenshotController.configureAsynchronousCapture(g_screenshotSettings.asynchronousCapture);
+	g_screenshotController.configureRegionOfInterest(g_screenshotSettings.regionOfInterest_enabled, g_screenshotSettings.regionOfInterest_left, 
+													 g_screenshotSettings.regionOfInterest_top, g_screenshotSettings.regionOfInterest_width, 
+													 g_screenshotSettings.regionOfInterest_height);
+	g_screenshotController.configureHighBitDepth(g_screenshotSettings.highBitDepth_enabled, g_screenshotSettings.highBitDepth_tenBitIsPq, 
+												 (HighBitDepthFiletype)g_screenshotSettings.highBitDepth_fileType);
+	g_screenshotController.configureDepthCapture(g_screenshotSettings.depth_enabled, g_screenshotSettings.depth_nearPlane, g_screenshotSettings.depth_farPlane, 
+												 g_screenshotSettings.depth_isReversed, (DepthFiletype)g_screenshotSettings.depth_fileType);
+	g_screenshotController.configureArchivalRecompression(g_screenshotSettings.archivalRecompression_enabled);
+}
+
+
 static void startScreenshotSession(bool isTestRun)
 {
-	g_screenshotController.configure(g_screenshotSettings.screenshotFolder, g_screenshotSettings.numberOfFramesToWaitBetweenSteps, (ScreenshotFiletype)g_screenshotSettings.screenshotFileType);
 	const auto cameraData = (CameraToolsData*)g_dataFromCameraToolsBuffer;
+	configureScreenshotController();
 	switch(g_screenshotSettings.typeOfScreenshot)
 	{
 	case (int)ScreenshotType::HorizontalPanorama:
 		g_screenshotController.startHorizontalPanoramaShot(g_screenshotSettings.pano_totalAngleDegrees, g_screenshotSettings.pano_overlapPercentagePerShot, cameraData->fov, isTestRun);
 		break;
 	case (int)ScreenshotType::MultiShot:
-		g_screenshotController.startLightfieldShot(g_screenshotSettings.lightField_distanceBetweenShots, g_screenshotSettings.lightField_numberOfShotsToTake, isTestRun);
+		g_screenshotController.configureLightfieldRefocusing(g_screenshotSettings.lightField_writeRefocusedImages, g_screenshotSettings.lightField_refocusMinimumDisparity,
+															 g_screenshotSettings.lightField_refocusMaximumDisparity, g_screenshotSettings.lightField_refocusNumberOfFocusPlanes);
+		g_screenshotController.configureLightfieldDisparityMap(g_screenshotSettings.lightField_writeDisparityMap, g_screenshotSettings.lightField_maximumDisparity);
+		g_screenshotController.configureLightfieldInterpolation(g_screenshotSettings.lightField_numberOfInterpolatedViews);
+		g_screenshotController.configureLightfieldWiggleAnimation(g_screenshotSettings.lightField_writeWiggleAnimation);
+		g_screenshotController.configureLightfieldQuilt((LightfieldQuiltMode)g_screenshotSettings.lightField_quiltMode, g_screenshotSettings.lightField_quiltNumberOfColumns,
+														 g_screenshotSettings.lightField_quiltWidth);
+		g_screenshotController.startLightfieldShot(g_screenshotSettings.lightField_distanceBetweenShots, g_screenshotSettings.lightField_numberOfShotsToTake,
+												  g_screenshotSettings.lightField_distanceBetweenRows, g_screenshotSettings.lightField_numberOfRows, isTestRun);
+		break;
+	case (int)ScreenshotType::Supersampling:
+		g_screenshotController.startSupersamplingShot(g_screenshotSettings.supersampling_numberOfSamples, g_screenshotSettings.supersampling_referenceDistance, cameraData->fov, isTestRun);
+		break;
+	case (int)ScreenshotType::MotionBlur:
+		g_screenshotController.configureMotionBlur((MotionBlurMovementType)g_screenshotSettings.motionBlur_movementType, g_screenshotSettings.motionBlur_distanceRight,
+												   g_screenshotSettings.motionBlur_distanceUp, g_screenshotSettings.motionBlur_fovChangeDegrees, g_screenshotSettings.motionBlur_angleDegrees,
+												   (ShutterShape)g_screenshotSettings.motionBlur_shutterShape);
+		g_screenshotController.startMotionBlurShot(g_screenshotSettings.motionBlur_numberOfSamples, cameraData->fov, isTestRun);
+		break;
+	case (int)ScreenshotType::TemporalDenoise:
+		g_screenshotController.startTemporalDenoiseShot(g_screenshotSettings.temporalDenoise_numberOfFrames, (FrameStackingMethod)g_screenshotSettings.temporalDenoise_stackingMethod,
+														isTestRun);
+		break;
+	case (int)ScreenshotType::Orbit:
+		{
+			OrbitLayout layout;
+			layout.distance = g_screenshotSettings.orbit_distance;
+			layout.numberOfShotsPerRing = g_screenshotSettings.orbit_numberOfShotsPerRing;
+			layout.numberOfRings = g_screenshotSettings.orbit_numberOfRings;
+			layout.minimumElevationDegrees = g_screenshotSettings.orbit_minimumElevationDegrees;
+			layout.maximumElevationDegrees = g_screenshotSettings.orbit_maximumElevationDegrees;
+			g_screenshotController.startOrbitShot(layout, isTestRun);
+		}
 		break;
 #ifdef _DEBUG
 	case (int)ScreenshotType::DebugGrid:
@@ -383,11 +503,95 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 						ImGui::InputText("Screenshot output directory", g_screenshotSettings.screenshotFolder, 256);
 						ImGui::SliderInt("Number of frames to wait between steps", &g_screenshotSettings.numberOfFramesToWaitBetweenSteps, 1, 100);
 #ifdef _DEBUG
-						ImGui::Combo("Multi-screenshot type", &g_screenshotSettings.typeOfScreenshot, "Horizontal panorama\0Lightfield\0DEBUG: Grid\0");
+						ImGui::Combo("Multi-screenshot type", &g_screenshotSettings.typeOfScreenshot, "Horizontal panorama\0Lightfield\0Supersampling\0Motion blur\0Temporal denoise\0Orbit\0DEBUG: Grid\0");
 #else
-						ImGui::Combo("Multi-screenshot type", &g_screenshotSettings.typeOfScreenshot, "Horizontal panorama\0Lightfield\0\0");
+						ImGui::Combo("Multi-screenshot type", &g_screenshotSettings.typeOfScreenshot, "Horizontal panorama\0Lightfield\0Supersampling\0Motion blur\0Temporal denoise\0Orbit\0\0");
 #endif
 						ImGui::Combo("File type", &g_screenshotSettings.screenshotFileType, "Bmp\0Jpeg\0Png\0\0");
+						if((int)ScreenshotFiletype::Png == g_screenshotSettings.screenshotFileType)
+						{
+							ImGui::Checkbox("Recompress for archiving", &g_screenshotSettings.archivalRecompression_enabled);
+							ImGui::SameLine();
+							showHelpMarker("After a session has been written, its PNG files are compressed again in the background with a much slower, stronger compression on all cores, which makes them 20-30% smaller. They stay standard PNG files. The game can run slower while this runs.");
+						}
+						ArchivalRecompressor& archivalRecompressor = g_screenshotController.archivalRecompressor();
+						if(archivalRecompressor.isBusy())
+						{
+							const int numberOfFilesQueued = archivalRecompressor.numberOfFilesQueued();
+							const int numberOfFilesDone = archivalRecompressor.numberOfFilesDone();
+							const uint64_t numberOfBytesBefore = archivalRecompressor.numberOfBytesBefore();
+							const float percentageSaved = (numberOfBytesBefore > 0) ? 100.0f * (1.0f - (float)archivalRecompressor.numberOfBytesAfter() / (float)numberOfBytesBefore) : 0.0f;
+							ImGui::ProgressBar(numberOfFilesQueued > 0 ? (float)numberOfFilesDone / (float)numberOfFilesQueued : 0.0f, ImVec2(0.0f, 0.0f),
+											   IGCS::Utils::formatString("Recompressing %d/%d files, %.1f%% smaller", numberOfFilesDone, numberOfFilesQueued, percentageSaved).c_str());
+							ImGui::SameLine();
+							if(ImGui::Button("Cancel recompressing"))
+							{
+								archivalRecompressor.cancel();
+							}
+						}
+						ImGui::Checkbox("Asynchronous capture", &g_screenshotSettings.asynchronousCapture);
+						ImGui::SameLine();
+						showHelpMarker("Reads the shots from the gpu a frame or two later, so the game doesn't stall when a shot is taken. Only for 8 bit backbuffers, and not used with high bit depth capture or exposure bracketing.");
+						ImGui::Checkbox("Region of interest", &g_screenshotSettings.regionOfInterest_enabled);
+						ImGui::SameLine();
+						showHelpMarker("Only the region shown on screen is captured, stored and written for every shot. For panoramas a narrower region lowers the overlap between the shots.");
+						if(g_screenshotSettings.regionOfInterest_enabled)
+						{
+							float tempValues[2] = { g_screenshotSettings.regionOfInterest_left, g_screenshotSettings.regionOfInterest_top };
+							if(ImGui::DragFloat2("Region location", tempValues, 0.001f, 0.0f, 0.99f))
+							{
+								g_screenshotSettings.regionOfInterest_left = tempValues[0];
+								g_screenshotSettings.regionOfInterest_top = tempValues[1];
+							}
+							tempValues[0] = g_screenshotSettings.regionOfInterest_width;
+							tempValues[1] = g_screenshotSettings.regionOfInterest_height;
+							if(ImGui::DragFloat2("Region size", tempValues, 0.001f, 0.01f, 1.0f))
+							{
+								g_screenshotSettings.regionOfInterest_width = tempValues[0];
+								g_screenshotSettings.regionOfInterest_height = tempValues[1];
+							}
+							drawRegionOfInterestPreview();
+						}
+						if(g_screenshotSettings.typeOfScreenshot == (int)ScreenshotType::HorizontalPanorama || g_screenshotSettings.typeOfScreenshot == (int)ScreenshotType::MultiShot ||
+						   g_screenshotSettings.typeOfScreenshot == (int)ScreenshotType::Orbit)
+						{
+							ImGui::Checkbox("High bit depth capture", &g_screenshotSettings.highBitDepth_enabled);
+							ImGui::SameLine();
+							showHelpMarker("If the game renders to a 10 bit or 16 bit float (HDR) backbuffer, every shot is also read at full precision and written as HDR image next to the shot. Not used with exposure bracketing.");
+							if(g_screenshotSettings.highBitDepth_enabled)
+							{
+								ImGui::Checkbox("10 bit backbuffer is HDR10", &g_screenshotSettings.highBitDepth_tenBitIsPq);
+							}
+							if(g_screenshotSettings.highBitDepth_enabled || g_screenshotSettings.bracketing_enabled)
+							{
+								ImGui::Combo("HDR file type", &g_screenshotSettings.highBitDepth_fileType, "OpenEXR\0PNG 16 bit (HDR10)\0\0");
+							}
+							ImGui::Checkbox("Depth capture", &g_screenshotSettings.depth_enabled);
+							ImGui::SameLine();
+							showHelpMarker("Reads the depth buffer ReShade uses for its effects along with every shot and writes it as depth map next to the shot. Requires an enabled effect which uses depth, like IgcsDof, and the right depth buffer selected in the Add-ons tab.");
+							if(g_screenshotSettings.depth_enabled)
+							{
+								ImGui::DragFloat("Near plane", &g_screenshotSettings.depth_nearPlane, 0.01f, 0.001f, 100.0f, "%.3f");
+								ImGui::DragFloat("Far plane", &g_screenshotSettings.depth_farPlane, 1.0f, 1.0f, 100000.0f, "%.1f");
+								ImGui::SameLine();
+								showHelpMarker("The distances to the near and far plane of the game's projection, which are used to convert the depth buffer to distances. The far plane is usually the same as RESHADE_DEPTH_LINEARIZATION_FAR_PLANE.");
+								ImGui::Checkbox("Reversed depth", &g_screenshotSettings.depth_isReversed);
+								ImGui::Combo("Depth file type", &g_screenshotSettings.depth_fileType, "PNG 16 bit (near to far plane)\0OpenEXR 32 bit float (distance)\0\0");
+							}
+							ImGui::Checkbox("Exposure bracketing", &g_screenshotSettings.bracketing_enabled);
+							ImGui::SameLine();
+							showHelpMarker("Takes every shot multiple times with a different exposure, by changing a uniform of an effect, and merges them into an HDR image which is written as OpenEXR file next to the shot.");
+							if(g_screenshotSettings.bracketing_enabled)
+							{
+								ImGui::InputText("Exposure effect", g_screenshotSettings.bracketing_effectName, 256);
+								ImGui::InputText("Exposure uniform", g_screenshotSettings.bracketing_uniformName, 256);
+								ImGui::Checkbox("Exposure uniform is a multiplier", &g_screenshotSettings.bracketing_uniformIsMultiplier);
+								ImGui::SameLine();
+								showHelpMarker("If checked, the uniform's value is multiplied with the exposure factor. Otherwise the uniform is in stops, like the Exposure uniform of Tonemap.fx, and the stops are added to it.");
+								ImGui::SliderInt("Number of brackets", &g_screenshotSettings.bracketing_numberOfBrackets, 2, 9);
+								ImGui::SliderFloat("Stops between brackets", &g_screenshotSettings.bracketing_stopsBetweenBrackets, 0.5f, 4.0f, "%.1f");
+							}
+						}
 						switch(g_screenshotSettings.typeOfScreenshot)
 						{
 							case (int)ScreenshotType::HorizontalPanorama:
@@ -397,6 +601,72 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 							case (int)ScreenshotType::MultiShot:
 								ImGui::SliderFloat("Distance between Lightfield shots", &g_screenshotSettings.lightField_distanceBetweenShots, 0.0f, 5.0f, "%.3f");
 								ImGui::SliderInt("Number of shots to take", &g_screenshotSettings.lightField_numberOfShotsToTake, 0, 60);
+								ImGui::SliderInt("Number of rows", &g_screenshotSettings.lightField_numberOfRows, 1, 30);
+								if(g_screenshotSettings.lightField_numberOfRows > 1)
+								{
+									ImGui::SliderFloat("Distance between rows", &g_screenshotSettings.lightField_distanceBetweenRows, 0.0f, 5.0f, "%.3f");
+									ImGui::TextUnformatted("With more than 1 row, 'Number of shots to take' is the number of shots per row.");
+								}
+								ImGui::Checkbox("Write refocused images", &g_screenshotSettings.lightField_writeRefocusedImages);
+								if(g_screenshotSettings.lightField_writeRefocusedImages)
+								{
+									ImGui::DragFloatRange2("Focus disparity range (in pixels)", &g_screenshotSettings.lightField_refocusMinimumDisparity, &g_screenshotSettings.lightField_refocusMaximumDisparity, 0.05f, -50.0f, 50.0f, "%.2f");
+									ImGui::SliderInt("Number of focus planes", &g_screenshotSettings.lightField_refocusNumberOfFocusPlanes, 1, 64);
+								}
+								ImGui::Checkbox("Write disparity map", &g_screenshotSettings.lightField_writeDisparityMap);
+								ImGui::SliderInt("Views to interpolate between shots", &g_screenshotSettings.lightField_numberOfInterpolatedViews, 0, 8);
+								ImGui::Checkbox("Write wiggle animation", &g_screenshotSettings.lightField_writeWiggleAnimation);
+								ImGui::SameLine();
+								showHelpMarker("Writes an animated PNG (wiggle.png) which plays the shots of the middle row back and forth.");
+								if(g_screenshotSettings.lightField_writeDisparityMap || g_screenshotSettings.lightField_numberOfInterpolatedViews > 0)
+								{
+									ImGui::SliderFloat("Maximum disparity (in pixels)", &g_screenshotSettings.lightField_maximumDisparity, 0.5f, 100.0f, "%.1f");
+								}
+								ImGui::Combo("Quilt output", &g_screenshotSettings.lightField_quiltMode, "Off\0Quilt and shots\0Only quilt\0\0");
+								if(g_screenshotSettings.lightField_quiltMode != (int)LightfieldQuiltMode::Off)
+								{
+									ImGui::SliderInt("Number of columns in quilt", &g_screenshotSettings.lightField_quiltNumberOfColumns, 1, 16);
+									ImGui::SliderInt("Quilt width (in pixels)", &g_screenshotSettings.lightField_quiltWidth, 1024, 8192);
+								}
+								break;
+							case (int)ScreenshotType::Supersampling:
+								ImGui::SliderInt("Number of samples", &g_screenshotSettings.supersampling_numberOfSamples, 1, 256);
+								ImGui::SliderFloat("Reference distance", &g_screenshotSettings.supersampling_referenceDistance, 0.1f, 1000.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+								ImGui::SameLine();
+								showHelpMarker("The distance, in world units, from the camera of the objects which should get exact sub-pixel offsets. The camera is moved to jitter the image, so objects further away move less and objects closer by move more.");
+								break;
+							case (int)ScreenshotType::MotionBlur:
+								ImGui::SliderInt("Number of samples", &g_screenshotSettings.motionBlur_numberOfSamples, 2, 256);
+								ImGui::Combo("Movement", &g_screenshotSettings.motionBlur_movementType, "Translation\0Rotation\0\0");
+								if(g_screenshotSettings.motionBlur_movementType == (int)MotionBlurMovementType::Translation)
+								{
+									ImGui::SliderFloat("Distance to the right", &g_screenshotSettings.motionBlur_distanceRight, -5.0f, 5.0f, "%.3f");
+									ImGui::SliderFloat("Distance up", &g_screenshotSettings.motionBlur_distanceUp, -5.0f, 5.0f, "%.3f");
+									ImGui::SliderFloat("Change of field of view (in degrees)", &g_screenshotSettings.motionBlur_fovChangeDegrees, -20.0f, 20.0f, "%.2f");
+								}
+								else
+								{
+									ImGui::SliderFloat("Angle to the right (in degrees)", &g_screenshotSettings.motionBlur_angleDegrees, -20.0f, 20.0f, "%.2f");
+								}
+								ImGui::Combo("Shutter shape", &g_screenshotSettings.motionBlur_shutterShape, "Box\0Triangle\0Cosine\0\0");
+								break;
+							case (int)ScreenshotType::TemporalDenoise:
+								ImGui::SliderInt("Number of frames", &g_screenshotSettings.temporalDenoise_numberOfFrames, 2, 256);
+								ImGui::Combo("Stacking method", &g_screenshotSettings.temporalDenoise_stackingMethod, "Mean\0Median\0Sigma clipped mean\0\0");
+								ImGui::SameLine();
+								showHelpMarker("Mean: the average of all frames, only keeps a single frame in memory.\nMedian: removes outliers like fireflies.\nSigma clipped mean: the average of the values close to the median, removes outliers and most noise.");
+								break;
+							case (int)ScreenshotType::Orbit:
+								if(!g_screenshotController.canSetCameraPose())
+								{
+									ImGui::TextDisabled("The camera tools can't set the camera pose, which an orbit needs.");
+								}
+								ImGui::SliderFloat("Distance to the target", &g_screenshotSettings.orbit_distance, 0.1f, 1000.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+								ImGui::SameLine();
+								showHelpMarker("The camera orbits the point this far in front of the camera, always looking at it. The shots and their exact camera poses are written for photogrammetry.");
+								ImGui::SliderInt("Shots per ring", &g_screenshotSettings.orbit_numberOfShotsPerRing, 3, 120);
+								ImGui::SliderInt("Number of rings", &g_screenshotSettings.orbit_numberOfRings, 1, 15);
+								ImGui::DragFloatRange2("Elevation range (in degrees)", &g_screenshotSettings.orbit_minimumElevationDegrees, &g_screenshotSettings.orbit_maximumElevationDegrees, 0.5f, -89.0f, 89.0f, "%.1f");
 								break;
 								// others: ignore.
 						}
@@ -412,6 +682,13 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 							{
 								startScreenshotSession(true);
 							}
+							if(ImGui::Button("Resume interrupted session"))
+							{
+								configureScreenshotController();
+								g_screenshotController.resumeInterruptedSession();
+							}
+							ImGui::SameLine();
+							showHelpMarker("Panorama, lightfield and orbit sessions write every shot as soon as it's taken, with a journal of the shots written. If a session is interrupted, e.g. because the game crashed or the session was canceled, it continues from the first missing shot of the most recent interrupted session in the output directory. The camera is placed at the start of the session if the camera tools support it, otherwise move the camera back to where the session started.");
 						}
 						else
 						{
@@ -815,6 +1092,134 @@ static void displaySettings(reshade::api::effect_runtime* runtime)
 			}
 		}
 	}
+	ImGui::AlignTextToFramePadding();
+	if(ImGui::CollapsingHeader("Camera path recording"))
+	{
+		if(g_pathRecorder.isRecording())
+		{
+			ImGui::Text("Frames recorded: %d. %s: %d.", g_pathRecorder.numberOfRecordedFrames(), g_pathRecorder.isPublishingToFrameBus() ? "Consumed" : "Written", 
+						g_pathRecorder.numberOfWrittenFrames());
+			ImGui::Text("Dropped frames: %d. Late frames: %d.", g_pathRecorder.numberOfDroppedFrames(), g_pathRecorder.numberOfLateFrames());
+			ImGui::Text("%s: %d / %d%s", g_pathRecorder.isPublishingToFrameBus() ? "Frame bus slots in use" : "Encoder queue", g_pathRecorder.queueLength(), 
+						g_pathRecorder.queueCapacity(), g_pathRecorder.isPlaybackPaused() ? " (playback paused)" : "");
+			if(g_pathRecorder.isPublishingToFrameBus() && !g_pathRecorder.isFrameBusConsumerAlive())
+			{
+				ImGui::TextDisabled("No frame bus consumer is running: frames are dropped.");
+			}
+			ImGui::Text("Writing: %.1f MB/s. Average: %.1f MB/s.", g_pathRecorder.currentMegabytesPerSecond(), g_pathRecorder.averageMegabytesPerSecond());
+			if(ImGui::Button("Stop recording"))
+			{
+				g_pathRecorder.stop();
+			}
+		}
+		else
+		{
+			ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+			ImGui::Checkbox("Start recording with camera path playback", &g_screenshotSettings.pathRecording_startWithPlayback);
+			ImGui::SameLine();
+			showHelpMarker("Records every frame of a camera path playback to the screenshot output directory, in the file type of the screenshots. The camera tools have to report when a path starts and stops playing. Otherwise start and stop the recording with the button below.");
+			ImGui::SliderInt("Record every Nth frame", &g_screenshotSettings.pathRecording_everyNthFrame, 1, 10);
+			ImGui::Combo("Frame file type", &g_screenshotSettings.pathRecording_encodingSelection, "Screenshot file type\0Auto (fastest lossless)\0Auto (fastest)\0\0");
+			ImGui::SameLine();
+			showHelpMarker("The auto file types measure how fast the frames are encoded and how fast the disk writes them during the recording, and per frame pick the file type with the smallest files which still keeps up, or the fastest one when the encoder falls behind: BMP, QOI or PNG, and JPEG with Auto (fastest). The file type picked for every frame is listed in encoding_report.csv in the recording folder.");
+			ImGui::Checkbox("Write as animated PNG", &g_screenshotSettings.pathRecording_writeAnimation);
+			ImGui::SameLine();
+			showHelpMarker("Writes the frames as one animated PNG (APNG) instead of separate files. Every frame only stores what changed since the previous frame, so mostly static recordings stay small.");
+			if(g_screenshotSettings.pathRecording_writeAnimation)
+			{
+				ImGui::SliderInt("Animation frames per second", &g_screenshotSettings.pathRecording_animationFramesPerSecond, 1, 60);
+			}
+			ImGui::Checkbox("Publish frames to an external consumer", &g_screenshotSettings.pathRecording_publishToFrameBus);
+			ImGui::SameLine();
+			showHelpMarker("Publishes the frames with their camera pose to a frame bus in shared memory instead of writing them, so an external process, like the FrameBusConsumer tool, encodes and writes them outside the game process. Start the consumer after the recording has started.");
+			if(g_screenshotSettings.pathRecording_publishToFrameBus)
+			{
+				ImGui::Combo("When the consumer falls behind", &g_screenshotSettings.pathRecording_frameBusFullPolicy, "Drop frames\0Wait for the consumer\0\0");
+				ImGui::SameLine();
+				showHelpMarker("Drop frames keeps the game running at full speed. Wait for the consumer stalls the game until the consumer has freed a slot, unless it has stopped responding.");
+			}
+			ImGui::Checkbox("Pause playback when the encoder falls behind", &g_screenshotSettings.pathRecording_pausePlaybackWhenBehind);
+			ImGui::SameLine();
+			showHelpMarker("If the frames can't be written as fast as they're recorded, the playback is paused until the encoder has caught up, so no frames are dropped. Requires camera tools which support pausing a path playback.");
+			if(g_screenshotSettings.pathRecording_pausePlaybackWhenBehind && !g_cameraToolsConnector.canPauseCameraPathPlayback())
+			{
+				ImGui::TextDisabled("The camera tools can't pause a playback: frames are dropped when the encoder falls behind.");
+			}
+			ImGui::PopItemWidth();
+			if(g_pathRecorder.isWritingRemainingFrames())
+			{
+				ImGui::TextDisabled("The previous recording is still being written.");
+			}
+			else if(ImGui::Button("Start recording"))
+			{
+				configurePathRecorder();
+				g_pathRecorder.start(runtime);
+			}
+		}
+	}
+	ImGui::AlignTextToFramePadding();
+	if(ImGui::CollapsingHeader("Stereo capture"))
+	{
+		if(g_stereoCapture.isCapturing())
+		{
+			ImGui::Text("Pairs captured: %d / %d. Dropped pairs: %d.", g_stereoCapture.numberOfCapturedPairs(), g_stereoCapture.numberOfPairsToCapture(), 
+						g_stereoCapture.numberOfDroppedPairs());
+			if(ImGui::Button("Stop capturing"))
+			{
+				g_stereoCapture.stop();
+			}
+		}
+		else
+		{
+			ImGui::Text("ReShade runtimes: %d", g_stereoCapture.numberOfRuntimes());
+			if(!g_stereoCapture.hasStereoRuntimes())
+			{
+				ImGui::TextDisabled("No runtime per eye found. Stereo capture works with games running in VR.");
+			}
+			ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+			ImGui::Combo("Packing", &g_screenshotSettings.stereo_packing, "Side by side\0Over under\0\0");
+			ImGui::SameLine();
+			showHelpMarker("Captures both eyes from the same frame and writes them as one image, in the file type of the screenshots.");
+			ImGui::Checkbox("Swap eyes", &g_screenshotSettings.stereo_swapEyes);
+			ImGui::SameLine();
+			showHelpMarker("The first runtime ReShade creates is taken as the left eye. Swap the eyes if they end up on the wrong side.");
+			ImGui::SliderInt("Number of pairs", &g_screenshotSettings.stereo_numberOfPairs, 1, 300);
+			ImGui::PopItemWidth();
+			if(g_stereoCapture.isWritingRemainingPairs())
+			{
+				ImGui::TextDisabled("The previous capture is still being written.");
+			}
+			else if(ImGui::Button("Capture stereo pairs"))
+			{
+				g_stereoCapture.configure(g_screenshotSettings.screenshotFolder, (ScreenshotFiletype)g_screenshotSettings.screenshotFileType, 
+										  (StereoPacking)g_screenshotSettings.stereo_packing, g_screenshotSettings.stereo_swapEyes);
+				g_stereoCapture.start(g_screenshotSettings.stereo_numberOfPairs);
+			}
+		}
+	}
+}
+
+
+static void onInitEffectRuntime(effect_runtime* runtime)
+{
+	// in VR, ReShade creates a runtime per eye.
+	g_stereoCapture.registerRuntime(runtime);
+	g_numberOfEffectRuntimes++;
+}
+
+
+static void onDestroyEffectRuntime(effect_runtime* runtime)
+{
+	g_stereoCapture.unregisterRuntime(runtime);
+	g_numberOfEffectRuntimes--;
+	if(g_numberOfEffectRuntimes <= 0)
+	{
+		// the game is shutting down its swapchain, likely to exit. The background threads are joined here, as DllMain runs under the loader lock, in
+		// which joining a thread deadlocks. They start again if a runtime is created after this.
+		g_screenshotController.archivalRecompressor().stop();
+		// after the recompressor, which uses the pool.
+		IGCS::WorkerPool::stop();
+	}
 }
 
 
@@ -854,6 +1259,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		reshade::register_event<reshade::addon_event::reshade_begin_effects>(onReshadeBeginEffects);
 		reshade::register_event<reshade::addon_event::reshade_begin_effects>(onReshadeFinishEffects);
 		reshade::register_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadEffects);
+		reshade::register_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
+		reshade::register_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
 		reshade::register_overlay(nullptr, &displaySettings);
 		loadIniFile();
 		break;
@@ -863,8 +1270,14 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		reshade::unregister_event<reshade::addon_event::reshade_begin_effects>(onReshadeBeginEffects);
 		reshade::unregister_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadEffects);
 		reshade::unregister_event<reshade::addon_event::reshade_begin_effects>(onReshadeFinishEffects);
+		reshade::unregister_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
+		reshade::unregister_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
 		reshade::unregister_overlay(nullptr, &displaySettings);
 		reshade::unregister_addon(hModule);
+		// the loader lock is held here, so the background threads are only told to stop, not joined. They've been joined when the last effect runtime
+		// was destroyed.
+		g_screenshotController.archivalRecompressor().cancel();
+		IGCS::WorkerPool::requestStop();
 		if(nullptr!=g_dataFromCameraToolsBuffer)
 		{
 			free(g_dataFromCameraToolsBuffer);
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// MockCameraTools: a stand-in for IGCS camera tools, used by OrbitPlannerTest. It exports the functions CameraToolsConnector looks up in the modules of
+// the process and records the poses it's asked to place the camera at. It's built twice: MockCameraTools exports the optional IGCS_SetCameraPose,
+// MockLegacyCameraTools is built with MOCK_LEGACY_CAMERA_TOOLS defined and doesn't, like camera tools from before IGCS_SetCameraPose was added.
+#include "stdafx.h"
+#include <cstdint>
+#include "ConstantsEnums.h"
+
+namespace
+{
+	float _lastPosition[3] = { 0.0f, 0.0f, 0.0f };
+	float _lastOrientation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float _lastFovDegrees = 0.0f;
+	int _numberOfPosesSet = 0;
+}
+
+
+extern "C" __declspec(dllexport) ScreenshotSessionStartReturnCode __stdcall IGCS_StartScreenshotSession(uint8_t type)
+{
+	return ScreenshotSessionStartReturnCode::AllOk;
+}
+
+
+extern "C" __declspec(dllexport) void __stdcall IGCS_MoveCameraPanorama(float stepAngle)
+{
+}
+
+
+extern "C" __declspec(dllexport) void __stdcall IGCS_MoveCameraMultishot(float stepLeftRight, float stepUpDown, float fovDegrees, bool fromStartPosition)
+{
+}
+
+
+extern "C" __declspec(dllexport) void __stdcall IGCS_EndScreenshotSession()
+{
+}
+
+
+#ifndef MOCK_LEGACY_CAMERA_TOOLS
+extern "C" __declspec(dllexport) void __stdcall IGCS_SetCameraPose(const float* position, const float* orientation, float fovDegrees)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		_lastPosition[i] = position[i];
+	}
+	for(int i = 0; i < 4; i++)
+	{
+		_lastOrientation[i] = orientation[i];
+	}
+	_lastFovDegrees = fovDegrees;
+	_numberOfPosesSet++;
+}
+#endif
+
+
+/// <summary>
+/// Not part of the camera tools interface: lets the test read back the last pose set through IGCS_SetCameraPose.
+/// </summary>
+/// <returns>the number of poses set so far</returns>
+extern "C" __declspec(dllexport) int __stdcall MockCameraTools_GetLastPose(float* position, float* orientation, float* fovDegrees)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		position[i] = _lastPosition[i];
+	}
+	for(int i = 0; i < 4; i++)
+	{
+		orientation[i] = _lastOrientation[i];
+	}
+	*fovDegrees = _lastFovDegrees;
+	return _numberOfPosesSet;
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "OrbitPlanner.h"
+#include <cmath>
+
+namespace IGCS::OrbitPlanner
+{
+	namespace
+	{
+		constexpr float Pi = 3.14159265358979f;
+
+		void rotationMatrixToQuaternion(const float m[3][3], float q[4])
+		{
+			// q is qx, qy, qz, qw.
+			const float trace = m[0][0] + m[1][1] + m[2][2];
+			if(trace > 0.0f)
+			{
+				const float s = 0.5f / sqrtf(trace + 1.0f);
+				q[3] = 0.25f / s;
+				q[0] = (m[2][1] - m[1][2]) * s;
+				q[1] = (m[0][2] - m[2][0]) * s;
+				q[2] = (m[1][0] - m[0][1]) * s;
+			}
+			else if(m[0][0] > m[1][1] && m[0][0] > m[2][2])
+			{
+				const float s = 2.0f * sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]);
+				q[3] = (m[2][1] - m[1][2]) / s;
+				q[0] = 0.25f * s;
+				q[1] = (m[0][1] + m[1][0]) / s;
+				q[2] = (m[0][2] + m[2][0]) / s;
+			}
+			else if(m[1][1] > m[2][2])
+			{
+				const float s = 2.0f * sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]);
+				q[3] = (m[0][2] - m[2][0]) / s;
+				q[0] = (m[0][1] + m[1][0]) / s;
+				q[1] = 0.25f * s;
+				q[2] = (m[1][2] + m[2][1]) / s;
+			}
+			else
+			{
+				const float s = 2.0f * sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]);
+				q[3] = (m[1][0] - m[0][1]) / s;
+				q[0] = (m[0][2] + m[2][0]) / s;
+				q[1] = (m[1][2] + m[2][1]) / s;
+				q[2] = 0.25f * s;
+			}
+		}
+
+
+		void multiplyQuaternions(const float a[4], const float b[4], float result[4])
+		{
+			// a * b, so b is applied first.
+			result[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+			result[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+			result[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+			result[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+		}
+	}
+
+
+	std::vector<CameraPose> planOrbit(const CameraPose& startPose, const OrbitLayout& layout)
+	{
+		std::vector<CameraPose> toReturn;
+		if(layout.numberOfShotsPerRing <= 0 || layout.numberOfRings <= 0)
+		{
+			return toReturn;
+		}
+		const float* right = startPose.rightVector;
+		const float* up = startPose.upVector;
+		const float* forward = startPose.forwardVector;
+		float target[3];
+		for(int i = 0; i < 3; i++)
+		{
+			target[i] = startPose.position[i] + layout.distance * forward[i];
+		}
+		for(int ring = 0; ring < layout.numberOfRings; ring++)
+		{
+			// with 1 ring, the ring is in the middle of the elevation range.
+			const float ringFraction = layout.numberOfRings > 1 ? (float)ring / (float)(layout.numberOfRings - 1) : 0.5f;
+			const float elevation = (layout.minimumElevationDegrees + ringFraction * (layout.maximumElevationDegrees - layout.minimumElevationDegrees)) * (Pi / 180.0f);
+			const float sinElevation = sinf(elevation);
+			const float cosElevation = cosf(elevation);
+			for(int shot = 0; shot < layout.numberOfShotsPerRing; shot++)
+			{
+				const float azimuth = 2.0f * Pi * (float)shot / (float)layout.numberOfShotsPerRing;
+				const float sinAzimuth = sinf(azimuth);
+				const float cosAzimuth = cosf(azimuth);
+				// the axes of the shot in the frame of the start pose: yawed by the azimuth, then pitched down by the elevation, so it looks at the target.
+				// Columns are right, up, forward. These are rotations in the start frame, so the handedness of the game's world doesn't matter.
+				const float shotAxes[3][3] = { { cosAzimuth, -sinElevation * sinAzimuth, -cosElevation * sinAzimuth },
+											   { 0.0f, cosElevation, -sinElevation },
+											   { sinAzimuth, sinElevation * cosAzimuth, cosElevation * cosAzimuth } };
+				CameraPose pose;
+				pose.fovDegrees = startPose.fovDegrees;
+				for(int i = 0; i < 3; i++)
+				{
+					pose.rightVector[i] = shotAxes[0][0] * right[i] + shotAxes[1][0] * up[i] + shotAxes[2][0] * forward[i];
+					pose.upVector[i] = shotAxes[0][1] * right[i] + shotAxes[1][1] * up[i] + shotAxes[2][1] * forward[i];
+					pose.forwardVector[i] = shotAxes[0][2] * right[i] + shotAxes[1][2] * up[i] + shotAxes[2][2] * forward[i];
+					pose.position[i] = target[i] - layout.distance * pose.forwardVector[i];
+				}
+				// the world rotation from the start axes to the shot axes, applied on top of the start orientation.
+				float rotation[3][3];
+				for(int row = 0; row < 3; row++)
+				{
+					for(int column = 0; column < 3; column++)
+					{
+						rotation[row][column] = pose.rightVector[row] * right[column] + pose.upVector[row] * up[column] + pose.forwardVector[row] * forward[column];
+					}
+				}
+				float rotationQuaternion[4];
+				rotationMatrixToQuaternion(rotation, rotationQuaternion);
+				multiplyQuaternions(rotationQuaternion, startPose.orientation, pose.orientation);
+				toReturn.push_back(pose);
+			}
+		}
+		return toReturn;
+	}
+}
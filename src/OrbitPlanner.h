@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+
+#include "GrabbedFrame.h"
+
+/// <summary>
+/// The layout of an orbit: rings of shots on a sphere around a target point, every shot looking at the target.
+/// </summary>
+struct OrbitLayout
+{
+	float distance = 10.0f;						// the radius of the sphere, which is the distance from the start location to the target
+	int numberOfShotsPerRing = 24;
+	int numberOfRings = 1;
+	float minimumElevationDegrees = 0.0f;		// elevation of the lowest ring. Positive is above the target
+	float maximumElevationDegrees = 0.0f;		// elevation of the highest ring
+};
+
+
+namespace IGCS::OrbitPlanner
+{
+	/// <summary>
+	/// Plans the poses of an orbit around the point at the layout's distance in front of the start pose. The orbit is built in the frame of the start
+	/// pose, so the rings are horizontal relative to the start camera and the first shot of the ring at elevation 0 is the start pose itself. Rings go 
+	/// from the lowest to the highest, every ring goes around once to the right. The orientations follow from the start orientation, so they're in 
+	/// the same conventions as the camera data of the camera tools.
+	/// </summary>
+	/// <param name="startPose">the pose of the camera at the start of the session</param>
+	/// <param name="layout"></param>
+	/// <returns>the poses of the shots, ring after ring</returns>
+	std::vector<CameraPose> planOrbit(const CameraPose& startPose, const OrbitLayout& layout);
+}
@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+// OrbitPlannerTest: checks the poses IGCS::OrbitPlanner::planOrbit plans, and the lookup of the optional IGCS_SetCameraPose export by 
+// CameraToolsConnector, with the mock camera tools MockCameraTools and MockLegacyCameraTools, which have to be next to the executable.
+//
+// Usage: OrbitPlannerTest
+// Returns 0 if all checks pass, 1 otherwise.
+#include "stdafx.h"
+#include <cmath>
+#include <cstdio>
+#include "CameraToolsConnector.h"
+#include "OrbitPlanner.h"
+
+namespace
+{
+	typedef int(__stdcall* MockCameraTools_GetLastPose)(float* position, float* orientation, float* fovDegrees);
+
+	constexpr float Tolerance = 1e-4f;
+
+	bool check(bool condition, const char* description)
+	{
+		if(!condition)
+		{
+			printf("FAILED: %s\n", description);
+		}
+		return condition;
+	}
+
+
+	bool isNear(const float* a, const float* b, int numberOfValues, float tolerance)
+	{
+		for(int i = 0; i < numberOfValues; i++)
+		{
+			if(fabsf(a[i] - b[i]) > tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	float dot(const float a[3], const float b[3])
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+
+	/// <summary>
+	/// Rotates the vector specified with the quaternion (qx, qy, qz, qw) specified, as q * v * q^-1.
+	/// </summary>
+	void rotate(const float q[4], const float v[3], float result[3])
+	{
+		const float x = q[0], y = q[1], z = q[2], w = q[3];
+		const float m[3][3] = { { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w) },
+								{ 2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w) },
+								{ 2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y) } };
+		for(int i = 0; i < 3; i++)
+		{
+			result[i] = m[i][0] * v[0] + m[i][1] * v[1] + m[i][2] * v[2];
+		}
+	}
+
+
+	/// <summary>
+	/// A start pose which isn't aligned with the world axes, with its axes derived from its orientation like the camera tools do.
+	/// </summary>
+	CameraPose createStartPose()
+	{
+		CameraPose toReturn;
+		const float orientation[4] = { 0.3f, -0.5f, 0.2f, 0.78f };
+		const float length = sqrtf(dot(orientation, orientation) + orientation[3] * orientation[3]);
+		for(int i = 0; i < 4; i++)
+		{
+			toReturn.orientation[i] = orientation[i] / length;
+		}
+		const float xAxis[3] = { 1.0f, 0.0f, 0.0f };
+		const float yAxis[3] = { 0.0f, 1.0f, 0.0f };
+		const float zAxis[3] = { 0.0f, 0.0f, 1.0f };
+		rotate(toReturn.orientation, xAxis, toReturn.rightVector);
+		rotate(toReturn.orientation, yAxis, toReturn.upVector);
+		rotate(toReturn.orientation, zAxis, toReturn.forwardVector);
+		toReturn.position[0] = 5.0f;
+		toReturn.position[1] = 2.0f;
+		toReturn.position[2] = -3.0f;
+		toReturn.fovDegrees = 60.0f;
+		return toReturn;
+	}
+
+
+	bool checkOrbit()
+	{
+		const CameraPose startPose = createStartPose();
+		OrbitLayout layout;
+		layout.distance = 7.0f;
+		layout.numberOfShotsPerRing = 12;
+		layout.numberOfRings = 3;
+		layout.minimumElevationDegrees = -30.0f;
+		layout.maximumElevationDegrees = 60.0f;
+		const std::vector<CameraPose> poses = IGCS::OrbitPlanner::planOrbit(startPose, layout);
+		bool isMatch = check(poses.size() == 36, "the orbit doesn't have a shot for every ring and position");
+		float target[3];
+		for(int i = 0; i < 3; i++)
+		{
+			target[i] = startPose.position[i] + layout.distance * startPose.forwardVector[i];
+		}
+		const float xAxis[3] = { 1.0f, 0.0f, 0.0f };
+		const float yAxis[3] = { 0.0f, 1.0f, 0.0f };
+		const float zAxis[3] = { 0.0f, 0.0f, 1.0f };
+		for(size_t shot = 0; shot < poses.size(); shot++)
+		{
+			const CameraPose& pose = poses[shot];
+			float toTarget[3];
+			for(int i = 0; i < 3; i++)
+			{
+				toTarget[i] = target[i] - pose.position[i];
+			}
+			const float distance = sqrtf(dot(toTarget, toTarget));
+			isMatch &= check(fabsf(distance - layout.distance) < Tolerance * layout.distance, "a shot isn't at the orbit distance from the target");
+			isMatch &= check(fabsf(dot(toTarget, pose.forwardVector) / distance - 1.0f) < Tolerance, "a shot doesn't look at the target");
+			float right[3], up[3], forward[3];
+			rotate(pose.orientation, xAxis, right);
+			rotate(pose.orientation, yAxis, up);
+			rotate(pose.orientation, zAxis, forward);
+			isMatch &= check(isNear(right, pose.rightVector, 3, Tolerance) && isNear(up, pose.upVector, 3, Tolerance) && 
+							 isNear(forward, pose.forwardVector, 3, Tolerance), "the orientation of a shot doesn't match its axes");
+			isMatch &= check(pose.fovDegrees == startPose.fovDegrees, "a shot doesn't have the fov of the start pose");
+			// the height above the target, in the frame of the start pose, follows from the elevation of the shot's ring.
+			const float elevation = (layout.minimumElevationDegrees + (float)(shot / 12) * 45.0f) * (3.14159265f / 180.0f);
+			isMatch &= check(fabsf(-dot(toTarget, startPose.upVector) - layout.distance * sinf(elevation)) < Tolerance * layout.distance, 
+							 "a shot isn't at the elevation of its ring");
+		}
+
+		// a single ring at elevation 0 starts at the start pose and goes around to the right.
+		layout.numberOfRings = 1;
+		layout.minimumElevationDegrees = 0.0f;
+		layout.maximumElevationDegrees = 0.0f;
+		const std::vector<CameraPose> ring = IGCS::OrbitPlanner::planOrbit(startPose, layout);
+		isMatch &= check(ring.size() == 12 && isNear(ring[0].position, startPose.position, 3, Tolerance * layout.distance) && 
+						 isNear(ring[0].orientation, startPose.orientation, 4, Tolerance), "the first shot of the ring at elevation 0 isn't the start pose");
+		if(ring.size() == 12)
+		{
+			float fromTarget[3];
+			for(int i = 0; i < 3; i++)
+			{
+				fromTarget[i] = ring[3].position[i] - target[i];
+			}
+			isMatch &= check(fabsf(dot(fromTarget, startPose.rightVector) - layout.distance) < Tolerance * layout.distance, 
+							 "a quarter of the way around, the ring isn't to the right of the target");
+		}
+
+		layout.numberOfShotsPerRing = 0;
+		isMatch &= check(IGCS::OrbitPlanner::planOrbit(startPose, layout).empty(), "an orbit without shots has poses");
+		return isMatch;
+	}
+
+
+	/// <summary>
+	/// Loads the mock camera tools specified, connects to it like the addon does and checks whether IGCS_SetCameraPose is found and the poses of an 
+	/// orbit arrive at the camera tools, or, without the export, that the connector falls back to not setting poses at all.
+	/// </summary>
+	bool checkConnector(const wchar_t* mockFilename, bool exportsSetCameraPose)
+	{
+		const HMODULE mockModule = LoadLibraryW(mockFilename);
+		if(!check(nullptr != mockModule, "the mock camera tools can't be loaded"))
+		{
+			return false;
+		}
+		const MockCameraTools_GetLastPose getLastPose = (MockCameraTools_GetLastPose)GetProcAddress(mockModule, "MockCameraTools_GetLastPose");
+		CameraToolsConnector connector;
+		connector.connectToCameraTools();
+		bool isMatch = check(nullptr != getLastPose, "the mock camera tools don't export MockCameraTools_GetLastPose");
+		isMatch &= check(connector.cameraToolsConnected(), "the mock camera tools aren't found");
+		isMatch &= check(connector.canSetCameraPose() == exportsSetCameraPose, exportsSetCameraPose ? "IGCS_SetCameraPose isn't found" 
+																									   : "IGCS_SetCameraPose is found but isn't exported");
+		if(isMatch)
+		{
+			OrbitLayout layout;
+			layout.numberOfShotsPerRing = 8;
+			const std::vector<CameraPose> poses = IGCS::OrbitPlanner::planOrbit(createStartPose(), layout);
+			float position[3], orientation[4], fovDegrees;
+			for(size_t shot = 0; shot < poses.size(); shot++)
+			{
+				connector.setCameraPose(poses[shot].position, poses[shot].orientation, poses[shot].fovDegrees);
+				const int numberOfPosesSet = getLastPose(position, orientation, &fovDegrees);
+				if(exportsSetCameraPose)
+				{
+					isMatch &= check(numberOfPosesSet == (int)shot + 1 && isNear(position, poses[shot].position, 3, 0.0f) && 
+									 isNear(orientation, poses[shot].orientation, 4, 0.0f) && fovDegrees == poses[shot].fovDegrees, 
+									 "a pose didn't arrive at the camera tools as it was set");
+				}
+				else
+				{
+					isMatch &= check(0 == numberOfPosesSet, "a pose was set on camera tools which don't export IGCS_SetCameraPose");
+				}
+			}
+		}
+		FreeLibrary(mockModule);
+		return isMatch;
+	}
+}
+
+
+int main()
+{
+	bool isMatch = checkOrbit();
+	isMatch &= checkConnector(L"MockLegacyCameraTools.dll", false);
+	isMatch &= checkConnector(L"MockCameraTools.dll", true);
+	printf("%s\n", isMatch ? "OK" : "FAILED");
+	return isMatch ? 0 : 1;
+}
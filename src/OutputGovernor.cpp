@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "OutputGovernor.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+namespace
+{
+	// every candidate is measured this many times before the measurements are trusted, as the first frames include the warm up of the caches.
+	constexpr int MinimumNumberOfSamples = 2;
+	// every this many frames the candidate which hasn't been chosen for the longest time is chosen, to keep its measurements up to date.
+	constexpr int ReprobeInterval = 30;
+	// the weight of a new measurement in the moving averages.
+	constexpr double SampleWeight = 0.2;
+	// a candidate keeps up if it's predicted to be this much faster than the rate at which frames arrive.
+	constexpr double RequiredHeadroom = 1.25;
+	// above this queue fill level the encoders are falling behind, so the fastest candidate is chosen regardless of its file size.
+	constexpr float BackedUpQueueFillFraction = 0.5f;
+
+
+	void addSample(double& average, double sample, int numberOfSamples)
+	{
+		average = (numberOfSamples == 0) ? sample : average + (sample - average) * SampleWeight;
+	}
+}
+
+
+void OutputGovernor::start(EncodingSelection selection, int numberOfEncoderThreads)
+{
+	std::scoped_lock lock(_mutex);
+	_selection = selection;
+	_numberOfEncoderThreads = (std::max)(numberOfEncoderThreads, 1);
+	// ordered from the least to the most CPU per pixel, which is the order the candidates are tried in at the start.
+	_candidates = { ScreenshotFiletype::Bmp, ScreenshotFiletype::Qoi, ScreenshotFiletype::Png };
+	if(EncodingSelection::AutoFastest == selection)
+	{
+		_candidates.push_back(ScreenshotFiletype::Jpeg);
+	}
+	_statistics = {};
+	_numberOfChosenFrames = 0;
+	_numberOfDiskSamples = 0;
+	_diskSecondsPerByte = 0.0;
+	_hasQueuedFrame = false;
+	_queueIntervalSeconds = 0.0;
+}
+
+
+void OutputGovernor::frameQueued()
+{
+	std::scoped_lock lock(_mutex);
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(_hasQueuedFrame)
+	{
+		const double intervalSeconds = std::chrono::duration<double>(now - _lastQueueTime).count();
+		_queueIntervalSeconds = (_queueIntervalSeconds <= 0.0) ? intervalSeconds : _queueIntervalSeconds + (intervalSeconds - _queueIntervalSeconds) * SampleWeight;
+	}
+	_lastQueueTime = now;
+	_hasQueuedFrame = true;
+}
+
+
+ScreenshotFiletype OutputGovernor::chooseFiletype(int width, int height, float queueFillFraction)
+{
+	std::scoped_lock lock(_mutex);
+	if(_candidates.empty())
+	{
+		return ScreenshotFiletype::Png;
+	}
+	const int frameIndex = _numberOfChosenFrames++;
+	ScreenshotFiletype chosenFiletype = _candidates[0];
+	// candidates which haven't been measured enough are tried first, spread over the threads which are encoding at the same time.
+	int fewestTimesChosen = INT_MAX;
+	for(ScreenshotFiletype candidate : _candidates)
+	{
+		const FiletypeStatistics& statistics = _statistics[(int)candidate];
+		if(statistics.numberOfSamples < MinimumNumberOfSamples && statistics.numberOfTimesChosen < fewestTimesChosen)
+		{
+			fewestTimesChosen = statistics.numberOfTimesChosen;
+			chosenFiletype = candidate;
+		}
+	}
+	if(fewestTimesChosen == INT_MAX)
+	{
+		if(frameIndex % ReprobeInterval == 0)
+		{
+			int oldestChosenFrame = INT_MAX;
+			for(ScreenshotFiletype candidate : _candidates)
+			{
+				if(_statistics[(int)candidate].lastChosenFrame < oldestChosenFrame)
+				{
+					oldestChosenFrame = _statistics[(int)candidate].lastChosenFrame;
+					chosenFiletype = candidate;
+				}
+			}
+		}
+		else
+		{
+			const double numberOfPixels = (double)width * height;
+			const double arrivingFramesPerSecond = (_queueIntervalSeconds > 0.0) ? 1.0 / _queueIntervalSeconds : 0.0;
+			const bool isBackedUp = queueFillFraction > BackedUpQueueFillFraction;
+			double highestFramesPerSecond = -1.0;
+			double smallestBytesPerPixel = DBL_MAX;
+			bool hasCandidateWhichKeepsUp = false;
+			for(ScreenshotFiletype candidate : _candidates)
+			{
+				const FiletypeStatistics& statistics = _statistics[(int)candidate];
+				const double framesPerSecond = predictedFramesPerSecond(statistics, numberOfPixels);
+				if(!isBackedUp && framesPerSecond >= arrivingFramesPerSecond * RequiredHeadroom)
+				{
+					if(!hasCandidateWhichKeepsUp || statistics.bytesPerPixel < smallestBytesPerPixel)
+					{
+						smallestBytesPerPixel = statistics.bytesPerPixel;
+						chosenFiletype = candidate;
+					}
+					hasCandidateWhichKeepsUp = true;
+				}
+				else if(!hasCandidateWhichKeepsUp && framesPerSecond > highestFramesPerSecond)
+				{
+					highestFramesPerSecond = framesPerSecond;
+					chosenFiletype = candidate;
+				}
+			}
+		}
+	}
+	FiletypeStatistics& chosenStatistics = _statistics[(int)chosenFiletype];
+	chosenStatistics.numberOfTimesChosen++;
+	chosenStatistics.lastChosenFrame = frameIndex;
+	return chosenFiletype;
+}
+
+
+void OutputGovernor::frameWritten(ScreenshotFiletype filetype, int width, int height, size_t numberOfBytes, double encodeSeconds, double writeSeconds)
+{
+	const double numberOfPixels = (double)width * height;
+	if((int)filetype < 0 || (int)filetype >= NumberOfFiletypes || numberOfPixels <= 0.0 || numberOfBytes == 0)
+	{
+		return;
+	}
+	std::scoped_lock lock(_mutex);
+	FiletypeStatistics& statistics = _statistics[(int)filetype];
+	addSample(statistics.encodeSecondsPerPixel, encodeSeconds / numberOfPixels, statistics.numberOfSamples);
+	addSample(statistics.bytesPerPixel, (double)numberOfBytes / numberOfPixels, statistics.numberOfSamples);
+	statistics.numberOfSamples++;
+	// the disk doesn't care about the file type, so all frames measure the same disk throughput.
+	addSample(_diskSecondsPerByte, writeSeconds / (double)numberOfBytes, _numberOfDiskSamples);
+	_numberOfDiskSamples++;
+}
+
+
+double OutputGovernor::predictedFramesPerSecond(const FiletypeStatistics& statistics, double numberOfPixels)
+{
+	// every encoder thread encodes a frame and then writes it, so a frame occupies a thread for the sum of both. The write time is measured while
+	// the other threads write too, so it already is the share of the disk throughput one thread gets.
+	const double secondsPerFrame = numberOfPixels * (statistics.encodeSecondsPerPixel + statistics.bytesPerPixel * _diskSecondsPerByte);
+	return (secondsPerFrame > 0.0) ? _numberOfEncoderThreads / secondsPerFrame : DBL_MAX;
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "ConstantsEnums.h"
+
+/// <summary>
+/// Chooses the file type of every frame written by a StreamingEncoder, from the encode and disk write throughput measured while writing. Every
+/// candidate file type is tried a couple of times at the start and once in a while after that, so the measurements follow the machine. Per frame it
+/// picks the candidate with the smallest files which still keeps up with the rate at which frames are queued, or the fastest candidate if none does
+/// or if the queue is backing up. Which candidate is fastest depends on what the bottleneck is: on a slow disk a compressing format is faster than
+/// BMP, on a fast disk with few cores BMP is.
+/// </summary>
+class OutputGovernor
+{
+public:
+	/// <summary>
+	/// Starts a new session, throwing away the measurements of the previous one.
+	/// </summary>
+	/// <param name="selection">AutoFastestLossless or AutoFastest. The governor is inactive with Fixed</param>
+	/// <param name="numberOfEncoderThreads">the number of threads which encode and write frames in parallel</param>
+	void start(EncodingSelection selection, int numberOfEncoderThreads);
+	/// <summary>
+	/// Called when a frame has been queued, to measure the rate at which frames arrive.
+	/// </summary>
+	void frameQueued();
+	/// <summary>
+	/// Returns the file type to encode the next frame in.
+	/// </summary>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="queueFillFraction">the fill level of the queue in front of the encoders, 0 (empty) to 1 (full)</param>
+	ScreenshotFiletype chooseFiletype(int width, int height, float queueFillFraction);
+	/// <summary>
+	/// Called when a frame chosen by chooseFiletype has been written, with the measurements of its two stages.
+	/// </summary>
+	/// <param name="filetype"></param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="numberOfBytes">the size of the file written</param>
+	/// <param name="encodeSeconds">the time it took to encode the frame, on one thread</param>
+	/// <param name="writeSeconds">the time it took to write the encoded frame to disk</param>
+	void frameWritten(ScreenshotFiletype filetype, int width, int height, size_t numberOfBytes, double encodeSeconds, double writeSeconds);
+
+	bool isActive() { return _selection != EncodingSelection::Fixed; }
+
+private:
+	/// <summary>
+	/// The measurements of one file type, normalized per pixel so they're independent of the frame size.
+	/// </summary>
+	struct FiletypeStatistics
+	{
+		int numberOfTimesChosen = 0;
+		int numberOfSamples = 0;
+		int lastChosenFrame = -1;
+		double encodeSecondsPerPixel = 0.0;
+		double bytesPerPixel = 0.0;
+	};
+
+	double predictedFramesPerSecond(const FiletypeStatistics& statistics, double numberOfPixels);
+
+	static constexpr int NumberOfFiletypes = (int)ScreenshotFiletype::Qoi + 1;
+
+	std::mutex _mutex;
+	EncodingSelection _selection = EncodingSelection::Fixed;
+	int _numberOfEncoderThreads = 1;
+	std::vector<ScreenshotFiletype> _candidates;
+	std::array<FiletypeStatistics, NumberOfFiletypes> _statistics;
+	int _numberOfChosenFrames = 0;
+	int _numberOfDiskSamples = 0;
+	double _diskSecondsPerByte = 0.0;			// as seen by one writer, so it includes the contention with the other writers
+	bool _hasQueuedFrame = false;
+	std::chrono::steady_clock::time_point _lastQueueTime;
+	double _queueIntervalSeconds = 0.0;
+};
@@ -0,0 +1,464 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#define IMGUI_DISABLE_INCLUDE_IMCONFIG_H
+#include "stdafx.h"
+#include "PathRecorder.h"
+#include "BackbufferReader.h"
+#include "ImageFileWriters.h"
+#include "OverlayControl.h"
+#include "Utils.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <direct.h>
+#include <imgui.h>
+#include <thread>
+
+using namespace reshade::api;
+
+namespace
+{
+	// the frames waiting to be encoded may use at most this much memory. The queue capacity follows from the frame size.
+	constexpr size_t QueueBudgetInBytes = 1024ull * 1024ull * 1024ull;
+	constexpr int MinimumQueueCapacity = 4;
+	constexpr int NumberOfReadbackSlots = 3;
+	// when the recording stops, the readbacks in flight are waited for at most this long.
+	constexpr auto MaximumWaitForPendingReadbacks = std::chrono::milliseconds(500);
+	// the playback is paused when the queue is filled above the first fraction and resumed when it's drained below the second.
+	constexpr float PausePlaybackQueueFillFraction = 0.75f;
+	constexpr float ResumePlaybackQueueFillFraction = 0.25f;
+	// the shared memory of the frame bus may use at most this much memory. The number of slots follows from the frame size.
+	constexpr size_t FrameBusBudgetInBytes = 512ull * 1024ull * 1024ull;
+	constexpr int MinimumNumberOfFrameBusSlots = 2;
+	constexpr int MaximumNumberOfFrameBusSlots = 32;
+}
+
+
+void PathRecorder::configure(const std::string& rootFolder, ScreenshotFiletype filetype, EncodingSelection encodingSelection, int recordEveryNthFrame, bool pausePlaybackWhenBehind, bool writeAnimation,
+							 int animationFramesPerSecond)
+{
+	if(_isRecording)
+	{
+		return;
+	}
+	_rootFolder = rootFolder;
+	_filetype = filetype;
+	_encodingSelection = encodingSelection;
+	_recordEveryNthFrame = (std::max)(recordEveryNthFrame, 1);
+	_pausePlaybackWhenBehind = pausePlaybackWhenBehind;
+	_writeAnimation = writeAnimation;
+	_animationFramesPerSecond = animationFramesPerSecond;
+}
+
+
+void PathRecorder::configureFrameBus(bool publishToFrameBus, FrameBusFullPolicy fullPolicy, CameraToolsData* cameraToolsData)
+{
+	if(_isRecording)
+	{
+		return;
+	}
+	_publishToFrameBus = publishToFrameBus;
+	_frameBusFullPolicy = fullPolicy;
+	_cameraToolsData = cameraToolsData;
+}
+
+
+void PathRecorder::start(effect_runtime* runtime)
+{
+	if(_isRecording)
+	{
+		return;
+	}
+	if(_encoder.isFinishing())
+	{
+		// the encoder is still busy with the previous recording.
+		OverlayControl::addNotification("The previous recording is still being written. Start the recording again when it's done.");
+		return;
+	}
+	uint32_t width = 0;
+	uint32_t height = 0;
+	runtime->get_screenshot_width_and_height(&width, &height);
+	if(width <= 0 || height <= 0)
+	{
+		return;
+	}
+	CaptureRegion region;
+	region.width = (int)width;
+	region.height = (int)height;
+	if(!_readbackRing.initialize(std::make_unique<ReshadeReadbackDevice>(runtime, region), NumberOfReadbackSlots))
+	{
+		// the frames are captured synchronously instead, which stalls the game per frame but works with every backbuffer format.
+		OverlayControl::addNotification("The backbuffer can't be read asynchronously. Frames are recorded synchronously.");
+	}
+	_frameWidth = width;
+	_frameHeight = height;
+	_frameSizeInBytes = (size_t)width * height * 3;
+	_isPublishingToFrameBus = false;
+	if(_publishToFrameBus)
+	{
+		// a slot is large enough for RGBA, so a synchronous capture can be written into it and packed in place.
+		const uint32_t maximumFrameSizeInBytes = width * height * 4;
+		const int numberOfSlots = std::clamp((int)(FrameBusBudgetInBytes / maximumFrameSizeInBytes), MinimumNumberOfFrameBusSlots, MaximumNumberOfFrameBusSlots);
+		_isPublishingToFrameBus = _frameBus.create(IGCS::FrameBus::DefaultName, numberOfSlots, maximumFrameSizeInBytes, _frameBusFullPolicy);
+		if(!_isPublishingToFrameBus)
+		{
+			OverlayControl::addNotification("The frame bus can't be created, the consumer of a previous recording might still be running. Frames are written by the addon instead.");
+		}
+	}
+	if(!_isPublishingToFrameBus)
+	{
+		_destinationFolder = createRecordingFolder();
+		const int queueCapacity = (std::max)((int)(QueueBudgetInBytes / _frameSizeInBytes), MinimumQueueCapacity);
+		const bool isAnimationStarted = _writeAnimation && _encoder.startAnimation(IGCS::Utils::formatString("%s\\recording.png", _destinationFolder.c_str()).c_str(), 
+																					(int)width, (int)height, _animationFramesPerSecond, queueCapacity);
+		if(!isAnimationStarted)
+		{
+			// leave a core for the game.
+			_encoder.start(_filetype, (std::max)(IGCS::WorkerPool::numberOfWorkers() - 1, 1), queueCapacity, _encodingSelection);
+		}
+		_isWritingAnimation = isAnimationStarted;
+	}
+	_frameCounter = 0;
+	_numberOfRecordedFrames = 0;
+	_numberOfDroppedFrames = 0;
+	_numberOfLateFrames = 0;
+	_startTime = std::chrono::steady_clock::now();
+	_throughputSampleTime = _startTime;
+	_throughputSampleBytes = 0;
+	_currentMegabytesPerSecond = 0.0f;
+	_isPlaybackPaused = false;
+	_isRecording = true;
+	OverlayControl::addNotification("Camera path recording started");
+}
+
+
+void PathRecorder::stop()
+{
+	if(!_isRecording)
+	{
+		return;
+	}
+	// the readbacks in flight are of frames which have been presented, so they're part of the recording.
+	const std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+	while(_readbackRing.hasPendingReadbacks() && std::chrono::steady_clock::now() - waitStart < MaximumWaitForPendingReadbacks)
+	{
+		queueCompletedReadbacks();
+		std::this_thread::yield();
+	}
+	_readbackRing.release();
+	if(_isPlaybackPaused)
+	{
+		_cameraToolsConnector.pauseCameraPathPlayback(false);
+		_isPlaybackPaused = false;
+	}
+	_isRecording = false;
+	if(_isPublishingToFrameBus)
+	{
+		// the consumer keeps consuming the frames still on the bus after it has been closed.
+		updateThroughput(true);
+		_frameBus.close();
+		OverlayControl::addNotification(IGCS::Utils::formatString("Camera path recording stopped. %d frames published to the frame bus", 
+																  (int)_frameBus.numberOfPublishedFrames()).c_str());
+		return;
+	}
+	updateThroughput(true);
+	OverlayControl::addNotification("Camera path recording stopped. Writing the remaining frames...");
+	// the queue can hold seconds of frames, so they're written off the render thread. Progress is shown by renderOverlay.
+	const bool writeReport = EncodingSelection::Fixed != _encodingSelection && !_isWritingAnimation;
+	_encoder.stopInBackground([this, writeReport, destinationFolder = _destinationFolder]()
+	{
+		if(writeReport)
+		{
+			// records which file type was chosen for every frame, as the frames of one recording are a mix of file types.
+			_encoder.writeReport(IGCS::Utils::formatString("%s\\encoding_report.csv", destinationFolder.c_str()).c_str());
+		}
+		OverlayControl::addNotification(IGCS::Utils::formatString("Camera path recording written. %d frames written to %s", _encoder.numberOfFramesWritten(),
+																  destinationFolder.c_str()).c_str());
+	});
+}
+
+
+void PathRecorder::renderOverlay()
+{
+	if(!_encoder.isFinishing())
+	{
+		return;
+	}
+	const int numberOfFramesQueued = (std::max)(_encoder.numberOfFramesQueued(), 1);
+	const int numberOfFramesDone = _encoder.numberOfFramesWritten() + _encoder.numberOfFailedFrames();
+	ImGui::SetNextWindowBgAlpha(0.9f);
+	ImGui::SetNextWindowPos(ImVec2(10, 10));
+	if(ImGui::Begin("IgcsConnector_PathRecordingProgress", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings))
+	{
+		ImGui::Text("Writing the recorded frames");
+		ImGui::ProgressBar((float)numberOfFramesDone / (float)numberOfFramesQueued, ImVec2(0.f, 0.f), 
+						   IGCS::Utils::formatString("%d/%d", numberOfFramesDone, numberOfFramesQueued).c_str());
+	}
+	ImGui::End();
+}
+
+
+void PathRecorder::frameRendered(effect_runtime* runtime)
+{
+	if(!_isRecording)
+	{
+		return;
+	}
+	queueCompletedReadbacks();
+	applyBackpressure();
+	updateThroughput(false);
+	if(_isPlaybackPaused)
+	{
+		// the camera doesn't move, so this frame is the same as the previous one.
+		return;
+	}
+	_frameCounter++;
+	if((_frameCounter - 1) % _recordEveryNthFrame != 0)
+	{
+		return;
+	}
+	if(_readbackRing.isInitialized())
+	{
+		GrabbedFrame frameWithoutData;
+		frameWithoutData.shotIndex = _frameCounter;
+		frameWithoutData.hasPose = obtainCurrentPose(frameWithoutData.pose);
+		if(!_readbackRing.requestReadback(std::move(frameWithoutData)))
+		{
+			// all slots are still in flight, so the gpu is too far behind to read this frame.
+			_numberOfDroppedFrames++;
+		}
+		return;
+	}
+	if(_isPublishingToFrameBus)
+	{
+		publishCapturedFrame(runtime);
+		return;
+	}
+	uint32_t width = 0;
+	uint32_t height = 0;
+	runtime->get_screenshot_width_and_height(&width, &height);
+	std::vector<uint8_t> frameData((size_t)width * height * 4);
+	if(!runtime->capture_screenshot(frameData.data()))
+	{
+		_numberOfDroppedFrames++;
+		return;
+	}
+	// pack RGBA as RGB in place, like the screenshot controller does.
+	for(size_t i = 0; i < (size_t)width * height; ++i)
+	{
+		*reinterpret_cast<uint32_t*>(frameData.data() + 3 * i) = *reinterpret_cast<const uint32_t*>(frameData.data() + 4 * i);
+	}
+	frameData.resize((size_t)width * height * 3);
+	queueFrame(std::move(frameData), (int)width, (int)height);
+}
+
+
+float PathRecorder::averageMegabytesPerSecond()
+{
+	const float elapsedSeconds = std::chrono::duration<float>(_throughputSampleTime - _startTime).count();
+	return elapsedSeconds > 0.0f ? (float)_throughputSampleBytes / (1024.0f * 1024.0f * elapsedSeconds) : 0.0f;
+}
+
+
+std::string PathRecorder::createRecordingFolder()
+{
+	time_t t = time(nullptr);
+	tm tm;
+	localtime_s(&tm, &t);
+	const std::string optionalBackslash = (_rootFolder.ends_with('\\')) ? "" : "\\";
+	std::string folderName = IGCS::Utils::formatString("%s%sPathRecording-%.4d-%.2d-%.2d-%.2d-%.2d-%.2d", _rootFolder.c_str(), optionalBackslash.c_str(),
+													   (tm.tm_year + 1900), (tm.tm_mon + 1), tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+	_mkdir(folderName.c_str());
+	return folderName;
+}
+
+
+void PathRecorder::queueCompletedReadbacks()
+{
+	if(_isPublishingToFrameBus)
+	{
+		publishCompletedReadbacks();
+		return;
+	}
+	std::vector<GrabbedFrame> completedFrames;
+	_readbackRing.collectCompletedReadbacks(completedFrames);
+	for(GrabbedFrame& frame : completedFrames)
+	{
+		if(frame.data.size() <= 0)
+		{
+			_numberOfDroppedFrames++;
+			continue;
+		}
+		if(_frameCounter - frame.shotIndex > 1)
+		{
+			_numberOfLateFrames++;
+		}
+		queueFrame(std::move(frame.data), _readbackRing.width(), _readbackRing.height());
+	}
+}
+
+
+void PathRecorder::queueFrame(std::vector<uint8_t> data, int width, int height)
+{
+	EncodeJob job;
+	job.filename = IGCS::Utils::formatString("%s\\frame_%.6d.%s", _destinationFolder.c_str(), _numberOfRecordedFrames, 
+											 IGCS::ImageFileWriters::fileExtension(_filetype).c_str()).c_str();
+	job.data = std::move(data);
+	job.width = width;
+	job.height = height;
+	if(_encoder.tryEnqueue(std::move(job)))
+	{
+		_numberOfRecordedFrames++;
+	}
+	else
+	{
+		_numberOfDroppedFrames++;
+	}
+}
+
+
+void PathRecorder::publishCompletedReadbacks()
+{
+	const int width = _readbackRing.width();
+	const int height = _readbackRing.height();
+	while(_readbackRing.isOldestReadbackComplete())
+	{
+		// frames the bus has no slot for are counted as dropped by the bus.
+		uint8_t* const frameBuffer = _frameBus.acquireFrameBuffer();
+		GrabbedFrame frame;
+		if(!_readbackRing.readOldestReadback(frame, frameBuffer))
+		{
+			if(nullptr != frameBuffer)
+			{
+				_numberOfDroppedFrames++;
+			}
+			continue;
+		}
+		if(_frameCounter - frame.shotIndex > 1)
+		{
+			_numberOfLateFrames++;
+		}
+		_frameBus.publishFrame(frame.shotIndex, width, height, IGCS::FrameBus::PixelFormat::Rgb8, (uint32_t)(width * height * 3), frame.hasPose ? &frame.pose : nullptr);
+		_numberOfRecordedFrames++;
+	}
+}
+
+
+void PathRecorder::publishCapturedFrame(effect_runtime* runtime)
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	runtime->get_screenshot_width_and_height(&width, &height);
+	if(width != _frameWidth || height != _frameHeight)
+	{
+		// the slots of the bus are sized for the backbuffer at the start of the recording, so a larger frame would overrun its slot. All frames from here on
+		// would be dropped, so the recording is stopped.
+		stop();
+		OverlayControl::addNotification("The resolution of the game changed, so the recording has been stopped.");
+		return;
+	}
+	uint8_t* const frameBuffer = _frameBus.acquireFrameBuffer();
+	if(nullptr == frameBuffer)
+	{
+		return;
+	}
+	if(!runtime->capture_screenshot(frameBuffer))
+	{
+		_numberOfDroppedFrames++;
+		return;
+	}
+	for(size_t i = 0; i < (size_t)width * height; ++i)
+	{
+		*reinterpret_cast<uint32_t*>(frameBuffer + 3 * i) = *reinterpret_cast<const uint32_t*>(frameBuffer + 4 * i);
+	}
+	CameraPose pose;
+	const bool hasPose = obtainCurrentPose(pose);
+	_frameBus.publishFrame(_frameCounter, (int)width, (int)height, IGCS::FrameBus::PixelFormat::Rgb8, width * height * 3, hasPose ? &pose : nullptr);
+	_numberOfRecordedFrames++;
+}
+
+
+bool PathRecorder::obtainCurrentPose(CameraPose& pose)
+{
+	if(nullptr == _cameraToolsData)
+	{
+		return false;
+	}
+	return pose.obtainFromCameraToolsData(*_cameraToolsData);
+}
+
+
+uint64_t PathRecorder::numberOfBytesHandedOff()
+{
+	if(!_isPublishingToFrameBus)
+	{
+		return _encoder.numberOfBytesWritten();
+	}
+	// the bus doesn't know how many bytes the consumer writes, so the throughput is the raw frame data taken off the bus.
+	return _frameBus.numberOfConsumedFrames() * (uint64_t)_frameSizeInBytes;
+}
+
+
+void PathRecorder::applyBackpressure()
+{
+	if(!_pausePlaybackWhenBehind || !_cameraToolsConnector.canPauseCameraPathPlayback())
+	{
+		return;
+	}
+	const float queueFillFraction = (float)queueLength() / (float)queueCapacity();
+	if(!_isPlaybackPaused && queueFillFraction >= PausePlaybackQueueFillFraction)
+	{
+		_cameraToolsConnector.pauseCameraPathPlayback(true);
+		_isPlaybackPaused = true;
+	}
+	else if(_isPlaybackPaused && queueFillFraction <= ResumePlaybackQueueFillFraction)
+	{
+		_cameraToolsConnector.pauseCameraPathPlayback(false);
+		_isPlaybackPaused = false;
+	}
+}
+
+
+void PathRecorder::updateThroughput(bool forceSample)
+{
+	// the current throughput is measured over the last second, the average over the whole recording.
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const float secondsSinceLastSample = std::chrono::duration<float>(now - _throughputSampleTime).count();
+	if(secondsSinceLastSample < 1.0f && (!forceSample || secondsSinceLastSample <= 0.0f))
+	{
+		return;
+	}
+	const uint64_t numberOfBytesWritten = numberOfBytesHandedOff();
+	_currentMegabytesPerSecond = (float)(numberOfBytesWritten - _throughputSampleBytes) / (1024.0f * 1024.0f * secondsSinceLastSample);
+	_throughputSampleBytes = numberOfBytesWritten;
+	_throughputSampleTime = now;
+}
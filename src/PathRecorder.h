@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <reshade.hpp>
+#include <string>
+#include "AsyncReadbackRing.h"
+#include "CameraToolsConnector.h"
+#include "ConstantsEnums.h"
+#include "FrameBusProducer.h"
+#include "StreamingEncoder.h"
+
+/// <summary>
+/// Records the frames presented during a camera path playback as an image sequence, e.g. to create a video from it. Frames are read from the gpu 
+/// asynchronously and handed to a StreamingEncoder, so frames are written while the path plays. If the encoder falls behind, the playback is paused through
+/// the camera tools until the encoder has caught up, if the camera tools support it. Otherwise frames are dropped. Frames can be published to a frame bus 
+/// instead, so an external process encodes and writes them. All methods are called on the render thread. The frames still queued when a recording stops
+/// are written on a background thread.
+/// </summary>
+class PathRecorder
+{
+public:
+	PathRecorder(CameraToolsConnector& connector) : _cameraToolsConnector(connector) { }
+	~PathRecorder() = default;
+
+	/// <summary>
+	/// Configures the next recording.
+	/// </summary>
+	/// <param name="rootFolder">the folder in which the folder for the recording is created</param>
+	/// <param name="filetype"></param>
+	/// <param name="encodingSelection">if automatic, the file type of every frame is chosen by the measured encode and disk throughput instead, and an
+	/// encoding report is written with the recording</param>
+	/// <param name="recordEveryNthFrame">1 records every frame, 2 every other frame etc.</param>
+	/// <param name="pausePlaybackWhenBehind">if true the playback is paused while the encoder is behind, otherwise frames are dropped</param>
+	/// <param name="writeAnimation">if true the frames are written as one animated PNG instead of separate files in the file type specified</param>
+	/// <param name="animationFramesPerSecond">the speed at which the animated PNG plays</param>
+	void configure(const std::string& rootFolder, ScreenshotFiletype filetype, EncodingSelection encodingSelection, int recordEveryNthFrame, bool pausePlaybackWhenBehind, bool writeAnimation,
+				   int animationFramesPerSecond);
+	/// <summary>
+	/// Configures whether the frames of the next recording are published to a frame bus instead of written by the addon.
+	/// </summary>
+	/// <param name="publishToFrameBus"></param>
+	/// <param name="fullPolicy">what to do with a frame when the consumer of the bus still holds all slots</param>
+	/// <param name="cameraToolsData">the buffer shared with the camera tools, from which the pose published with every frame is read. Can be nullptr</param>
+	void configureFrameBus(bool publishToFrameBus, FrameBusFullPolicy fullPolicy, CameraToolsData* cameraToolsData);
+	void start(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Stops the recording. Waits for the readbacks in flight, the frames still queued are written on a background thread.
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// Shows the progress of writing the frames left in the queue when the recording was stopped, if that's still going on.
+	/// </summary>
+	void renderOverlay();
+	/// <summary>
+	/// Records the frame which has just been rendered, if a recording is active.
+	/// </summary>
+	void frameRendered(reshade::api::effect_runtime* runtime);
+
+	bool isRecording() { return _isRecording; }
+	bool isWritingRemainingFrames() { return _encoder.isFinishing(); }
+	bool isPlaybackPaused() { return _isPlaybackPaused; }
+	bool isPublishingToFrameBus() { return _isPublishingToFrameBus; }
+	bool isFrameBusConsumerAlive() { return _frameBus.isConsumerAlive(); }
+	int numberOfRecordedFrames() { return _numberOfRecordedFrames; }
+	/// <summary>
+	/// With a frame bus: the number of frames the consumer has taken off the bus.
+	/// </summary>
+	int numberOfWrittenFrames() { return _isPublishingToFrameBus ? (int)_frameBus.numberOfConsumedFrames() : _encoder.numberOfFramesWritten(); }
+	int numberOfDroppedFrames() { return _numberOfDroppedFrames + (_isPublishingToFrameBus ? _frameBus.numberOfDroppedFrames() : _encoder.numberOfFailedFrames()); }
+	int numberOfLateFrames() { return _numberOfLateFrames; }
+	int queueLength() { return _isPublishingToFrameBus ? _frameBus.numberOfFramesInFlight() : _encoder.queueLength(); }
+	int queueCapacity() { return _isPublishingToFrameBus ? _frameBus.numberOfSlots() : _encoder.queueCapacity(); }
+	float currentMegabytesPerSecond() { return _currentMegabytesPerSecond; }
+	float averageMegabytesPerSecond();
+
+private:
+	std::string createRecordingFolder();
+	/// <summary>
+	/// Queues the frames of which the readback has been completed for encoding.
+	/// </summary>
+	void queueCompletedReadbacks();
+	void queueFrame(std::vector<uint8_t> data, int width, int height);
+	/// <summary>
+	/// Publishes the frames of which the readback has been completed to the frame bus, reading them straight into the slots of the bus.
+	/// </summary>
+	void publishCompletedReadbacks();
+	/// <summary>
+	/// Captures the current frame synchronously into a slot of the frame bus and publishes it.
+	/// </summary>
+	void publishCapturedFrame(reshade::api::effect_runtime* runtime);
+	bool obtainCurrentPose(CameraPose& pose);
+	uint64_t numberOfBytesHandedOff();
+	/// <summary>
+	/// Pauses the playback if the encoder has fallen behind and resumes it once the encoder has caught up.
+	/// </summary>
+	void applyBackpressure();
+	void updateThroughput(bool forceSample);
+
+	CameraToolsConnector& _cameraToolsConnector;
+	std::string _rootFolder;
+	ScreenshotFiletype _filetype = ScreenshotFiletype::Png;
+	EncodingSelection _encodingSelection = EncodingSelection::Fixed;
+	int _recordEveryNthFrame = 1;
+	bool _pausePlaybackWhenBehind = true;
+	bool _writeAnimation = false;
+	int _animationFramesPerSecond = 30;
+	bool _publishToFrameBus = false;
+	FrameBusFullPolicy _frameBusFullPolicy = FrameBusFullPolicy::DropFrame;
+	CameraToolsData* _cameraToolsData = nullptr;
+
+	bool _isRecording = false;
+	bool _isWritingAnimation = false;
+	bool _isPlaybackPaused = false;
+	std::string _destinationFolder;
+	AsyncReadbackRing _readbackRing;
+	StreamingEncoder _encoder;
+	FrameBusProducer _frameBus;
+	bool _isPublishingToFrameBus = false;	// false if publishing was configured but the bus couldn't be created
+	uint32_t _frameWidth = 0;				// the size of the backbuffer at the start of the recording
+	uint32_t _frameHeight = 0;
+	size_t _frameSizeInBytes = 0;			// RGB
+	int _frameCounter = 0;					// the number of frames rendered since the start of the recording
+	int _numberOfRecordedFrames = 0;		// the number of frames queued for encoding, which is also the number of the next frame file
+	int _numberOfDroppedFrames = 0;
+	int _numberOfLateFrames = 0;			// frames of which the readback took more than a frame, a sign the gpu is behind
+	std::chrono::steady_clock::time_point _startTime;
+	std::chrono::steady_clock::time_point _throughputSampleTime;
+	uint64_t _throughputSampleBytes = 0;
+	float _currentMegabytesPerSecond = 0.0f;
+};
@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "PoseDatasetWriter.h"
+#include "Utils.h"
+
+namespace IGCS::PoseDatasetWriter
+{
+	//-----------------------------------------------
+	// private structs
+	
+	/// <summary>
+	/// Camera-to-world rotation (the columns are the camera's right, up and forward vectors) and position, in a right-handed world.
+	/// </summary>
+	struct CameraToWorld
+	{
+		float right[3];
+		float up[3];
+		float forward[3];
+		float position[3];
+	};
+
+	//-----------------------------------------------
+	// forward declarations
+	bool worldIsLeftHanded(const PoseDatasetData& data);
+	CameraToWorld toRightHandedCameraToWorld(const CameraPose& pose, bool worldIsLeftHanded);
+	void rotationMatrixToQuaternion(const float m[3][3], float& qw, float& qx, float& qy, float& qz);
+	float focalLengthInPixels(const PoseDatasetData& data);
+	float principalPointX(const PoseDatasetData& data);
+	float principalPointY(const PoseDatasetData& data);
+
+	//-----------------------------------------------
+	// code
+
+	bool writeColmapModel(const std::string& destinationFolder, const PoseDatasetData& data)
+	{
+		if(data.imageFilenames.size() <= 0 || data.imageFilenames.size() != data.poses.size())
+		{
+			return false;
+		}
+		const float focalLength = focalLengthInPixels(data);
+		FILE* camerasFile = nullptr;
+		if(fopen_s(&camerasFile, IGCS::Utils::formatString("%s\\cameras.txt", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == camerasFile)
+		{
+			return false;
+		}
+		// all shots are taken with the same camera, so there's just 1.
+		fprintf(camerasFile, "# Camera list with one line of data per camera:\n");
+		fprintf(camerasFile, "#   CAMERA_ID, MODEL, WIDTH, HEIGHT, PARAMS[]\n");
+		fprintf(camerasFile, "# Number of cameras: 1\n");
+		fprintf(camerasFile, "1 PINHOLE %u %u %.6f %.6f %.6f %.6f\n", data.imageWidth, data.imageHeight, focalLength, focalLength, principalPointX(data), principalPointY(data));
+		fclose(camerasFile);
+
+		FILE* imagesFile = nullptr;
+		if(fopen_s(&imagesFile, IGCS::Utils::formatString("%s\\images.txt", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == imagesFile)
+		{
+			return false;
+		}
+		fprintf(imagesFile, "# Image list with two lines of data per image:\n");
+		fprintf(imagesFile, "#   IMAGE_ID, QW, QX, QY, QZ, TX, TY, TZ, CAMERA_ID, NAME\n");
+		fprintf(imagesFile, "#   POINTS2D[] as (X, Y, POINT3D_ID)\n");
+		fprintf(imagesFile, "# Number of images: %d, mean observations per image: 0\n", (int)data.imageFilenames.size());
+		const bool isLeftHanded = worldIsLeftHanded(data);
+		for(size_t i = 0; i < data.poses.size(); i++)
+		{
+			const CameraToWorld cameraToWorld = toRightHandedCameraToWorld(data.poses[i], isLeftHanded);
+			// COLMAP stores world-to-camera, with the camera looking down +Z and Y pointing down. So the rows of the rotation are right, down and forward.
+			const float worldToCamera[3][3] = {
+				{ cameraToWorld.right[0], cameraToWorld.right[1], cameraToWorld.right[2] },
+				{ -cameraToWorld.up[0], -cameraToWorld.up[1], -cameraToWorld.up[2] },
+				{ cameraToWorld.forward[0], cameraToWorld.forward[1], cameraToWorld.forward[2] } };
+			float translation[3];
+			for(int row = 0; row < 3; row++)
+			{
+				translation[row] = -(worldToCamera[row][0] * cameraToWorld.position[0] + worldToCamera[row][1] * cameraToWorld.position[1] + worldToCamera[row][2] * cameraToWorld.position[2]);
+			}
+			float qw, qx, qy, qz;
+			rotationMatrixToQuaternion(worldToCamera, qw, qx, qy, qz);
+			fprintf(imagesFile, "%d %.9f %.9f %.9f %.9f %.9f %.9f %.9f 1 %s\n\n", (int)(i + 1), qw, qx, qy, qz, translation[0], translation[1], translation[2], data.imageFilenames[i].c_str());
+		}
+		fclose(imagesFile);
+
+		FILE* pointsFile = nullptr;
+		if(fopen_s(&pointsFile, IGCS::Utils::formatString("%s\\points3D.txt", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == pointsFile)
+		{
+			return false;
+		}
+		fprintf(pointsFile, "# 3D point list with one line of data per point:\n");
+		fprintf(pointsFile, "#   POINT3D_ID, X, Y, Z, R, G, B, ERROR, TRACK[] as (IMAGE_ID, POINT2D_IDX)\n");
+		fprintf(pointsFile, "# Number of points: 0, mean track length: 0\n");
+		fclose(pointsFile);
+		return true;
+	}
+
+
+	bool writeNerfTransforms(const std::string& destinationFolder, const PoseDatasetData& data)
+	{
+		if(data.imageFilenames.size() <= 0 || data.imageFilenames.size() != data.poses.size())
+		{
+			return false;
+		}
+		FILE* transformsFile = nullptr;
+		if(fopen_s(&transformsFile, IGCS::Utils::formatString("%s\\transforms.json", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == transformsFile)
+		{
+			return false;
+		}
+		const float focalLength = focalLengthInPixels(data);
+		const float cameraAngleX = 2.0f * atanf((data.imageWidth / 2.0f) / focalLength);
+		const float cameraAngleY = 2.0f * atanf((data.imageHeight / 2.0f) / focalLength);
+		fprintf(transformsFile, "{\n");
+		fprintf(transformsFile, "\t\"camera_angle_x\": %.9f,\n\t\"camera_angle_y\": %.9f,\n", cameraAngleX, cameraAngleY);
+		fprintf(transformsFile, "\t\"fl_x\": %.6f,\n\t\"fl_y\": %.6f,\n", focalLength, focalLength);
+		fprintf(transformsFile, "\t\"cx\": %.6f,\n\t\"cy\": %.6f,\n", principalPointX(data), principalPointY(data));
+		fprintf(transformsFile, "\t\"w\": %u,\n\t\"h\": %u,\n", data.imageWidth, data.imageHeight);
+		fprintf(transformsFile, "\t\"frames\": [\n");
+		const bool isLeftHanded = worldIsLeftHanded(data);
+		for(size_t i = 0; i < data.poses.size(); i++)
+		{
+			const CameraToWorld c = toRightHandedCameraToWorld(data.poses[i], isLeftHanded);
+			// NeRF uses the OpenGL camera convention: X right, Y up, and the camera looks down -Z.
+			fprintf(transformsFile, "\t\t{\n\t\t\t\"file_path\": \"%s\",\n\t\t\t\"transform_matrix\": [\n", data.imageFilenames[i].c_str());
+			fprintf(transformsFile, "\t\t\t\t[%.9f, %.9f, %.9f, %.9f],\n", c.right[0], c.up[0], -c.forward[0], c.position[0]);
+			fprintf(transformsFile, "\t\t\t\t[%.9f, %.9f, %.9f, %.9f],\n", c.right[1], c.up[1], -c.forward[1], c.position[1]);
+			fprintf(transformsFile, "\t\t\t\t[%.9f, %.9f, %.9f, %.9f],\n", c.right[2], c.up[2], -c.forward[2], c.position[2]);
+			fprintf(transformsFile, "\t\t\t\t[0.0, 0.0, 0.0, 1.0]\n\t\t\t]\n\t\t}%s\n", (i + 1 < data.poses.size()) ? "," : "");
+		}
+		fprintf(transformsFile, "\t]\n}\n");
+		fclose(transformsFile);
+		return true;
+	}
+
+
+	float focalLengthInPixels(const PoseDatasetData& data)
+	{
+		// The fov reported by the camera tools is the horizontal fov, like the panorama code uses it. All shots are taken with the same fov, so we use the first one.
+		const float fovRadians = IGCS::Utils::degreesToRadians(data.poses.size() > 0 && data.poses[0].fovDegrees > 0.0f ? data.poses[0].fovDegrees : 90.0f);
+		// with a region of interest the fov is the fov of the uncropped frame.
+		const uint32_t frameWidth = data.frameWidth > 0 ? data.frameWidth : data.imageWidth;
+		return (frameWidth / 2.0f) / tanf(fovRadians / 2.0f);
+	}
+
+
+	float principalPointX(const PoseDatasetData& data)
+	{
+		// the optical axis goes through the center of the uncropped frame.
+		return data.frameWidth > 0 ? data.frameWidth / 2.0f - data.regionLeft : data.imageWidth / 2.0f;
+	}
+
+
+	float principalPointY(const PoseDatasetData& data)
+	{
+		return data.frameHeight > 0 ? data.frameHeight / 2.0f - data.regionTop : data.imageHeight / 2.0f;
+	}
+
+
+	bool worldIsLeftHanded(const PoseDatasetData& data)
+	{
+		if(data.poses.size() <= 0)
+		{
+			return false;
+		}
+		// In a right-handed world, right x up points backwards, so det([right up forward]) < 0. In a left-handed world (e.g. most DirectX engines) it's > 0.
+		const CameraPose& pose = data.poses[0];
+		const float* r = pose.rightVector;
+		const float* u = pose.upVector;
+		const float* f = pose.forwardVector;
+		const float determinant = r[0] * (u[1] * f[2] - u[2] * f[1]) - r[1] * (u[0] * f[2] - u[2] * f[0]) + r[2] * (u[0] * f[1] - u[1] * f[0]);
+		return determinant > 0.0f;
+	}
+
+
+	CameraToWorld toRightHandedCameraToWorld(const CameraPose& pose, bool worldIsLeftHanded)
+	{
+		// Both COLMAP and NeRF expect a right-handed world. For left-handed worlds we mirror the Z axis, which keeps all poses consistent with each other.
+		CameraToWorld toReturn;
+		const float zFactor = worldIsLeftHanded ? -1.0f : 1.0f;
+		for(int i = 0; i < 3; i++)
+		{
+			const float factor = (2 == i) ? zFactor : 1.0f;
+			toReturn.right[i] = pose.rightVector[i] * factor;
+			toReturn.up[i] = pose.upVector[i] * factor;
+			toReturn.forward[i] = pose.forwardVector[i] * factor;
+			toReturn.position[i] = pose.position[i] * factor;
+		}
+		return toReturn;
+	}
+
+
+	void rotationMatrixToQuaternion(const float m[3][3], float& qw, float& qx, float& qy, float& qz)
+	{
+		const float trace = m[0][0] + m[1][1] + m[2][2];
+		if(trace > 0.0f)
+		{
+			const float s = 0.5f / sqrtf(trace + 1.0f);
+			qw = 0.25f / s;
+			qx = (m[2][1] - m[1][2]) * s;
+			qy = (m[0][2] - m[2][0]) * s;
+			qz = (m[1][0] - m[0][1]) * s;
+		}
+		else if(m[0][0] > m[1][1] && m[0][0] > m[2][2])
+		{
+			const float s = 2.0f * sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]);
+			qw = (m[2][1] - m[1][2]) / s;
+			qx = 0.25f * s;
+			qy = (m[0][1] + m[1][0]) / s;
+			qz = (m[0][2] + m[2][0]) / s;
+		}
+		else if(m[1][1] > m[2][2])
+		{
+			const float s = 2.0f * sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]);
+			qw = (m[0][2] - m[2][0]) / s;
+			qx = (m[0][1] + m[1][0]) / s;
+			qy = 0.25f * s;
+			qz = (m[1][2] + m[2][1]) / s;
+		}
+		else
+		{
+			const float s = 2.0f * sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]);
+			qw = (m[1][0] - m[0][1]) / s;
+			qx = (m[0][2] + m[2][0]) / s;
+			qy = (m[1][2] + m[2][1]) / s;
+			qz = 0.25f * s;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GrabbedFrame.h"
+
+/// <summary>
+/// Data needed to write a posed image dataset. 
+/// </summary>
+struct PoseDatasetData
+{
+	uint32_t imageWidth = 0;
+	uint32_t imageHeight = 0;
+	uint32_t frameWidth = 0;						// with a region of interest: the size of the uncropped frame, which the fov of the poses applies to. 0 otherwise.
+	uint32_t frameHeight = 0;
+	int regionLeft = 0;								// with a region of interest: the location of the images in the uncropped frame. 
+	int regionTop = 0;
+	std::vector<std::string> imageFilenames;		// filenames relative to the destination folder
+	std::vector<CameraPose> poses;					// pose per image, same order as imageFilenames
+};
+
+
+namespace IGCS::PoseDatasetWriter
+{
+	/// <summary>
+	/// Writes cameras.txt, images.txt and an empty points3D.txt in the COLMAP text model format to the destination folder, so structure-from-motion
+	///	tools can use the exact poses instead of estimating them. 
+	/// </summary>
+	/// <returns>true if all files were written, false otherwise</returns>
+	bool writeColmapModel(const std::string& destinationFolder, const PoseDatasetData& data);
+	/// <summary>
+	/// Writes a NeRF style transforms.json (as used by instant-ngp / nerfstudio) to the destination folder.
+	/// </summary>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeNerfTransforms(const std::string& destinationFolder, const PoseDatasetData& data);
+}
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "QuiltBuilder.h"
+#include "ImageOperations.h"
+#include "Utils.h"
+#include <algorithm>
+
+void QuiltBuilder::configure(int numberOfViews, int numberOfColumns, int quiltWidth)
+{
+	reset();
+	_numberOfViews = (std::max)(numberOfViews, 1);
+	_numberOfColumns = std::clamp(numberOfColumns, 1, _numberOfViews);
+	_numberOfRows = (_numberOfViews + _numberOfColumns - 1) / _numberOfColumns;
+	_tileWidth = (std::max)(quiltWidth / _numberOfColumns, 1);
+	// tiles are exactly the same size, so the quilt can be a few pixels narrower than requested.
+	_quiltWidth = _tileWidth * _numberOfColumns;
+}
+
+
+void QuiltBuilder::addView(int viewIndex, const uint8_t* viewData, int viewWidth, int viewHeight)
+{
+	if(viewIndex < 0 || viewIndex >= _numberOfViews || nullptr == viewData || viewWidth <= 0 || viewHeight <= 0)
+	{
+		return;
+	}
+	if(_quiltData.size() <= 0)
+	{
+		// first view, we now know the aspect ratio of the tiles.
+		_viewAspectRatio = (float)viewWidth / (float)viewHeight;
+		_tileHeight = (std::max)((int)((float)_tileWidth / _viewAspectRatio + 0.5f), 1);
+		_quiltData.resize((size_t)_quiltWidth * height() * 3, 0);
+	}
+	const int tileColumn = viewIndex % _numberOfColumns;
+	const int tileRowFromBottom = viewIndex / _numberOfColumns;
+	const size_t quiltRowSizeInBytes = (size_t)_quiltWidth * 3;
+	uint8_t* tileTopLeft = _quiltData.data() + (size_t)(_numberOfRows - 1 - tileRowFromBottom) * _tileHeight * quiltRowSizeInBytes + (size_t)tileColumn * _tileWidth * 3;
+	IGCS::ImageOperations::downscaleRgb(viewData, viewWidth, viewHeight, tileTopLeft, _tileWidth, _tileHeight, (int)quiltRowSizeInBytes);
+	_numberOfViewsAdded++;
+}
+
+
+void QuiltBuilder::reset()
+{
+	_numberOfViews = 0;
+	_numberOfColumns = 0;
+	_numberOfRows = 0;
+	_quiltWidth = 0;
+	_tileWidth = 0;
+	_tileHeight = 0;
+	_viewAspectRatio = 0.0f;
+	_numberOfViewsAdded = 0;
+	_quiltData.clear();
+	_quiltData.shrink_to_fit();
+}
+
+
+std::string QuiltBuilder::createFilenameSuffix()
+{
+	return IGCS::Utils::formatString("_qs%dx%da%.2f", _numberOfColumns, _numberOfRows, _viewAspectRatio).c_str();
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Assembles the views of a lightfield into a quilt: a single image with the views tiled in a grid, as used by holographic displays like the ones from
+/// Looking Glass Factory. View 0 (the leftmost camera) is the bottom left tile, the views continue to the right and then upwards. Views are downscaled
+/// into their tile when they're added, so the full resolution views don't have to be kept around.
+/// </summary>
+class QuiltBuilder
+{
+public:
+	QuiltBuilder() = default;
+	~QuiltBuilder() = default;
+
+	/// <summary>
+	/// Sets up the layout of the quilt. The tile size is determined when the first view is added, as that's when the view size is known.
+	/// </summary>
+	/// <param name="numberOfViews">the number of views in the quilt</param>
+	/// <param name="numberOfColumns">the number of tiles per row. The number of rows follows from the number of views</param>
+	/// <param name="quiltWidth">the width, in pixels, of the quilt</param>
+	void configure(int numberOfViews, int numberOfColumns, int quiltWidth);
+	/// <summary>
+	/// Downscales the view specified into its tile.
+	/// </summary>
+	/// <param name="viewIndex">index of the view, 0 is the leftmost camera</param>
+	/// <param name="viewData">RGB data, 3 bytes per pixel</param>
+	void addView(int viewIndex, const uint8_t* viewData, int viewWidth, int viewHeight);
+	void reset();
+
+	bool hasViews() { return _numberOfViewsAdded > 0; }
+	int width() { return _quiltWidth; }
+	int height() { return _tileHeight * _numberOfRows; }
+	const std::vector<uint8_t>& data() { return _quiltData; }
+	/// <summary>
+	/// Returns the suffix for the filename which tells viewers the layout of the quilt, e.g. "_qs8x6a1.78": 8 columns, 6 rows, a view aspect ratio of 1.78
+	/// </summary>
+	std::string createFilenameSuffix();
+
+private:
+	int _numberOfViews = 0;
+	int _numberOfColumns = 0;
+	int _numberOfRows = 0;
+	int _quiltWidth = 0;
+	int _tileWidth = 0;
+	int _tileHeight = 0;
+	float _viewAspectRatio = 0.0f;
+	int _numberOfViewsAdded = 0;
+	std::vector<uint8_t> _quiltData;		// RGB, 3 bytes per pixel
+};
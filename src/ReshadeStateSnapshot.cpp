@@ -57,6 +57,17 @@ void ReshadeStateSnapshot::logContents()
 }
 
 
+bool ReshadeStateSnapshot::getUniformFloatVariable(const std::string& effectName, const std::string& uniformName, float& valueRead)
+{
+	if(isEmpty() || !_effectStatePerEffectName.contains(effectName))
+	{
+		return false;
+	}
+	auto& effectState = _effectStatePerEffectName[effectName];
+	return effectState.getUniformFloatVariable(uniformName, valueRead);
+}
+
+
 void ReshadeStateSnapshot::setUniformIntVariable(reshade::api::effect_runtime* runtime, const std::string& effectName, const std::string& uniformName, int valueToWrite)
 {
 	if(isEmpty() || !_effectStatePerEffectName.contains(effectName))
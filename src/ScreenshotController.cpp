@@ -41,13 +41,41 @@
 #include <thread>
 
 #include "fpng.h"
+#include "HuginProjectWriter.h"
+#include "PoseDatasetWriter.h"
+#include "LightfieldDepthEstimator.h"
+#include "ImageFileWriters.h"
+#include "ViewInterpolator.h"
+#include "FrameStacker.h"
+#include "BackbufferReader.h"
+#include "HdrConversions.h"
+#include "DepthBufferReader.h"
+#include "ApngWriter.h"
+#include "SessionJournal.h"
+#include <algorithm>
+
+namespace
+{
+	// exposure brackets are taken without moving the camera, so only the changed exposure uniform has to be in effect before the next bracket is taken.
+	constexpr int FramesToWaitBetweenBrackets = 2;
+	// the number of shots which can be read back from the gpu at the same time with asynchronous capture.
+	constexpr int NumberOfReadbackSlots = 3;
+	// the wiggle animation plays the lightfield shots at this speed.
+	constexpr uint16_t WiggleAnimationFramesPerSecond = 12;
+	// a session without absolute camera poses can only be resumed if the camera is this close to the start pose of the session, in world units.
+	constexpr float StartPoseTolerance = 0.01f;
+	// and if the dot product of the camera orientation and the start orientation is at least this.
+	constexpr float StartOrientationTolerance = 0.9999f;
+	// the number of shots of a journaled session which can wait for the shot writer before the session waits for it.
+	constexpr int JournaledShotQueueCapacity = 4;
+}
 
 ScreenshotController::ScreenshotController(CameraToolsConnector& connector) : _cameraToolsConnector(connector)
 {
 }
 
 
-void ScreenshotController::configure(std::string rootFolder, int numberOfFramesToWaitBetweenSteps, ScreenshotFiletype filetype)
+void ScreenshotController::configure(std::string rootFolder, int numberOfFramesToWaitBetweenSteps, ScreenshotFiletype filetype, CameraToolsData* cameraToolsData)
 {
 	if (_state != ScreenshotControllerState::Off)
 	{
@@ -58,7 +86,9 @@ void ScreenshotController::configure(std::string rootFolder, int numberOfFramesT
 
 	_rootFolder = rootFolder;
 	_numberOfFramesToWaitBetweenSteps = numberOfFramesToWaitBetweenSteps;
-	_filetype = filetype;
+	// the stitchers and reconstruction tools which read the shots of a session (Hugin, COLMAP, NeRF) can't read QOI, so those are written as PNG.
+	_filetype = ScreenshotFiletype::Qoi == filetype ? ScreenshotFiletype::Png : filetype;
+	_cameraToolsData = cameraToolsData;
 }
 
 
@@ -69,12 +99,14 @@ bool ScreenshotController::shouldTakeShot()
 		// always false as we're still waiting
 		return false;
 	}
-	return _state == ScreenshotControllerState::InSession;
+	// with asynchronous capture, the session waits for the last shots to come in after all shots have been requested.
+	return _state == ScreenshotControllerState::InSession && _shotCounter < _numberOfShotsToTake;
 }
 
 
 void ScreenshotController::presentCalled()
 {
+	_numberOfFramesSinceLastShot++;
 	if (_convolutionFrameCounter > 0)
 	{
 		_convolutionFrameCounter--;
@@ -86,23 +118,203 @@ void ScreenshotController::reshadeEffectsRendered(reshade::api::effect_runtime*
 {
 	if(_state!=ScreenshotControllerState::InSession)
 	{
+		if(_bracketing_isActive)
+		{
+			// session has ended or has been canceled: put the exposure back to what it was at the start.
+			_bracketing_stateAtStart.setUniformFloatVariable(runtime, _bracketing_effectName, _bracketing_uniformName, _bracketing_referenceValue);
+			_bracketing_isActive = false;
+		}
+		if(_readbackRing.isInitialized())
+		{
+			// the resources have to be destroyed on the render thread. Readbacks still in flight after a cancel are dropped.
+			_readbackRing.release();
+		}
+		return;
+	}
+	if(isBracketingSession() && !_bracketing_isActive)
+	{
+		// first frame of the session: the first bracket has to be set before the first shot is taken.
+		if(!startBracketing(runtime))
+		{
+			OverlayControl::addNotification("The exposure uniform for bracketing couldn't be found. The shots are taken without bracketing.");
+			_bracketing_enabled = false;
+		}
+	}
+	if(isAsynchronousCaptureSession())
+	{
+		storeCompletedAsynchronousShots();
+		if(shouldTakeShot() && requestAsynchronousShot(runtime))
+		{
+			// the camera can move on while the gpu copies the shot.
+			advanceToNextShot();
+		}
 		return;
 	}
 	if(shouldTakeShot())
 	{
-		// take a screenshot
-		runtime->get_screenshot_width_and_height(&_framebufferWidth, &_framebufferHeight);
-		std::vector<uint8_t> shotData(_framebufferWidth * _framebufferHeight * 4);
-		runtime->capture_screenshot(shotData.data());
+		grabShot(runtime);
+	}
+}
+
+
+void ScreenshotController::grabShot(reshade::api::effect_runtime* runtime)
+{
+	// take a screenshot
+	runtime->get_screenshot_width_and_height(&_frameWidth, &_frameHeight);
+	_captureRegion = determineCaptureRegion(_frameWidth, _frameHeight);
+	_framebufferWidth = _captureRegion.width;
+	_framebufferHeight = _captureRegion.height;
+	GrabbedFrame grabbedFrame;
+	grabbedFrame.shotIndex = _shotCounter;
+	stampShot(grabbedFrame);
+	std::vector<uint8_t>& shotData = grabbedFrame.data;
+	shotData.resize((size_t)_frameWidth * _frameHeight * 4);
+	runtime->capture_screenshot(shotData.data());
+	// the camera has been moved and has settled, so the camera data in the shared buffer is the pose this shot was taken with.
+	if(nullptr != _cameraToolsData)
+	{
+		grabbedFrame.hasPose = grabbedFrame.pose.obtainFromCameraToolsData(*_cameraToolsData);
+	}
+
+	// as alpha is 0 anyway, we pack the RGBA data as RGB data. This is faster than setting all alpha channels to FF.
+	// From Reshade. Only the pixels in the capture region are packed, so everything after this only sees the region. Packing is done in place: a pixel is 
+	// never written past a pixel which still has to be read.
+	size_t destinationPixel = 0;
+	for(int y = _captureRegion.top; y < _captureRegion.top + _captureRegion.height; ++y)
+	{
+		const size_t rowStart = (size_t)y * _frameWidth + _captureRegion.left;
+		for(int x = 0; x < _captureRegion.width; ++x)
+		{
+			*reinterpret_cast<uint32_t*>(shotData.data() + 3 * destinationPixel) = *reinterpret_cast<const uint32_t*>(shotData.data() + 4 * (rowStart + x));
+			++destinationPixel;
+		}
+	}
+	shotData.resize((size_t)_framebufferWidth * _framebufferHeight * 3);
+	if(isHighBitDepthSession())
+	{
+		// the shot above is converted to 8 bit by ReShade, so read the backbuffer again in its own format.
+		BackbufferData backbuffer;
+		if(IGCS::BackbufferReader::readBackbuffer(runtime, _captureRegion, backbuffer))
+		{
+			IGCS::HdrConversions::convertToLinear(backbuffer.data.data(), backbuffer.rowPitch, backbuffer.width, backbuffer.height, backbuffer.pixelFormat, 
+												  _highBitDepth_tenBitIsPq, grabbedFrame.radiance);
+		}
+		else
+		{
+			OverlayControl::addNotification("The backbuffer isn't a 10 bit or 16 bit float format. The shots are taken in 8 bit only.");
+			_highBitDepth_enabled = false;
+		}
+	}
+	// with bracketing only the reference bracket is stored as the shot, so only its depth is read.
+	const bool isReferenceBracket = !isBracketingSession() || _bracketing_currentBracket == (_bracketing_numberOfBrackets - 1) / 2;
+	if(isDepthCaptureSession() && isReferenceBracket && 
+	   !IGCS::DepthBufferReader::readDepthBuffer(runtime, _captureRegion, _frameWidth, _frameHeight, grabbedFrame.depth))
+	{
+		OverlayControl::addNotification("The depth buffer can't be read. Enable an effect which uses depth, like IgcsDof. The shots are taken without depth.");
+		_depth_enabled = false;
+	}
+	if(isBracketingSession())
+	{
+		storeGrabbedBracket(runtime, std::move(grabbedFrame));
+	}
+	else if(storeGrabbedShot(std::move(grabbedFrame)))
+	{
+		advanceToNextShot();
+	}
+}
+
+
+bool ScreenshotController::requestAsynchronousShot(reshade::api::effect_runtime* runtime)
+{
+	if(!_readbackRing.isInitialized())
+	{
+		runtime->get_screenshot_width_and_height(&_frameWidth, &_frameHeight);
+		_captureRegion = determineCaptureRegion(_frameWidth, _frameHeight);
+		std::unique_ptr<ReshadeReadbackDevice> readbackDevice = std::make_unique<ReshadeReadbackDevice>(runtime, _captureRegion, isDepthCaptureSession());
+		// the ring owns the device once it's initialized, so keep a pointer to ask it about depth.
+		ReshadeReadbackDevice* const readbackDevicePointer = readbackDevice.get();
+		if(!_readbackRing.initialize(std::move(readbackDevice), NumberOfReadbackSlots))
+		{
+			OverlayControl::addNotification("The backbuffer can't be read asynchronously. The shots are taken synchronously.");
+			_asynchronousCapture_enabled = false;
+			return false;
+		}
+		if(isDepthCaptureSession() && !readbackDevicePointer->isCapturingDepth())
+		{
+			OverlayControl::addNotification("The depth buffer can't be read. Enable an effect which uses depth, like IgcsDof. The shots are taken without depth.");
+			_depth_enabled = false;
+		}
+		_framebufferWidth = _readbackRing.width();
+		_framebufferHeight = _readbackRing.height();
+	}
+	GrabbedFrame shotWithoutData;
+	shotWithoutData.shotIndex = _shotCounter;
+	stampShot(shotWithoutData);
+	if(nullptr != _cameraToolsData)
+	{
+		shotWithoutData.hasPose = shotWithoutData.pose.obtainFromCameraToolsData(*_cameraToolsData);
+	}
+	// if all slots are in flight, the shot is requested again next frame.
+	return _readbackRing.requestReadback(std::move(shotWithoutData));
+}
+
 
-		// as alpha is 0 anyway, we pack the RGBA data as RGB data. This is faster than setting all alpha channels to FF.
-		// From Reshade
-		for(int i = 0; i < _framebufferWidth * _framebufferHeight; ++i)
+void ScreenshotController::storeCompletedAsynchronousShots()
+{
+	std::vector<GrabbedFrame> completedShots;
+	_readbackRing.collectCompletedReadbacks(completedShots);
+	for(GrabbedFrame& shot : completedShots)
+	{
+		if(shot.data.size() <= 0)
 		{
-			*reinterpret_cast<uint32_t*>(shotData.data() + 3 * i) = *reinterpret_cast<const uint32_t*>(shotData.data() + 4 * i);
+			// the camera has already moved on, so the shot can't be taken again. Keep its metadata so the other shots keep their index.
+			OverlayControl::addNotification("A shot couldn't be read from the gpu and is missing from the session.");
+			if(ScreenshotType::MultiShot == _typeOfShot)
+			{
+				// otherwise it claims the default grid cell, which belongs to another shot.
+				lightfieldGridCellForShot(shot.shotIndex, shot.gridRow, shot.gridColumn);
+			}
+			_grabbedFrames.push_back(std::move(shot));
+			continue;
 		}
-		storeGrabbedShot(shotData);
+		storeGrabbedShot(std::move(shot));
+	}
+	if(completedShots.size() > 0 && _shotCounter >= _numberOfShotsToTake && !_readbackRing.hasPendingReadbacks())
+	{
+		// the last shots have come in.
+		endShotTaking();
+	}
+}
+
+
+bool ScreenshotController::isAsynchronousCaptureSession()
+{
+	// bracketing and high bit depth capture need the shot before the next one can be taken, so they're synchronous.
+	return _asynchronousCapture_enabled && !isBracketingSession() && !isHighBitDepthSession();
+}
+
+
+CaptureRegion ScreenshotController::determineCaptureRegion(int frameWidth, int frameHeight)
+{
+	CaptureRegion region;
+	region.width = frameWidth;
+	region.height = frameHeight;
+	if(!_regionOfInterest_enabled || frameWidth <= 0 || frameHeight <= 0)
+	{
+		return region;
 	}
+	// the region is clipped to the frame and is at least 1 pixel in size.
+	region.left = std::clamp((int)(_regionOfInterest_left * frameWidth + 0.5f), 0, frameWidth - 1);
+	region.top = std::clamp((int)(_regionOfInterest_top * frameHeight + 0.5f), 0, frameHeight - 1);
+	region.width = std::clamp((int)(_regionOfInterest_width * frameWidth + 0.5f), 1, frameWidth - region.left);
+	region.height = std::clamp((int)(_regionOfInterest_height * frameHeight + 0.5f), 1, frameHeight - region.top);
+	return region;
+}
+
+
+float ScreenshotController::focalLengthInPixels(float horizontalFoVRadians)
+{
+	return 0.5f * (float)_frameWidth / tanf(0.5f * horizontalFoVRadians);
 }
 
 
@@ -173,6 +385,26 @@ void ScreenshotController::displayScreenshotSessionStartError(const ScreenshotSe
 bool ScreenshotController::startSession()
 {
 	uint8_t typeOfShotToUse = (uint8_t)_typeOfShot;
+	// the camera tools only know panoramas and multishots. Supersampling moves the camera like a multishot does, motion blur either
+	// rotates like a panorama or moves like a multishot.
+	if(_typeOfShot==ScreenshotType::Supersampling)
+	{
+		typeOfShotToUse = (uint8_t)ScreenshotType::MultiShot;
+	}
+	if(_typeOfShot==ScreenshotType::TemporalDenoise)
+	{
+		// the camera isn't moved, but the session makes sure the camera tools keep the camera in place.
+		typeOfShotToUse = (uint8_t)ScreenshotType::MultiShot;
+	}
+	if(_typeOfShot==ScreenshotType::Orbit)
+	{
+		// the camera is placed with absolute poses, which the camera tools accept in a multishot session.
+		typeOfShotToUse = (uint8_t)ScreenshotType::MultiShot;
+	}
+	if(_typeOfShot==ScreenshotType::MotionBlur)
+	{
+		typeOfShotToUse = (uint8_t)(MotionBlurMovementType::Rotation == _motionBlur_movementType ? ScreenshotType::HorizontalPanorama : ScreenshotType::MultiShot);
+	}
 #ifdef _DEBUG
 	if(_typeOfShot==ScreenshotType::DebugGrid)
 	{
@@ -186,6 +418,7 @@ bool ScreenshotController::startSession()
 		displayScreenshotSessionStartError(sessionStartResult);
 		return false;
 	}
+	_numberOfFramesSinceLastShot = 0;
 	return true;
 }
 
@@ -220,6 +453,7 @@ void ScreenshotController::startHorizontalPanoramaShot(float totalFoVInDegrees,
 	{
 		return;
 	}
+	startJournal();
 	
 	// move to start
 	moveCameraForPanorama(-1, true);
@@ -234,7 +468,7 @@ void ScreenshotController::startHorizontalPanoramaShot(float totalFoVInDegrees,
 }
 
 
-void ScreenshotController::startLightfieldShot(float distancePerStep, int numberOfShots, bool isTestRun)
+void ScreenshotController::startLightfieldShot(float distancePerStep, int numberOfShotsPerRow, float distancePerRow, int numberOfRows, bool isTestRun)
 {
 	if(!_cameraToolsConnector.cameraToolsConnected())
 	{
@@ -244,17 +478,25 @@ void ScreenshotController::startLightfieldShot(float distancePerStep, int number
 	reset();
 	_isTestRun = isTestRun;
 	_lightField_distancePerStep = distancePerStep;
-	_numberOfShotsToTake = numberOfShots;
+	_lightField_distancePerRow = distancePerRow;
+	_lightField_numberOfColumns = numberOfShotsPerRow;
+	_lightField_numberOfRows = (std::max)(numberOfRows, 1);
+	_numberOfShotsToTake = _lightField_numberOfColumns * _lightField_numberOfRows;
 	_typeOfShot = ScreenshotType::MultiShot;
+	if(_lightField_quiltMode != LightfieldQuiltMode::Off && !_isTestRun)
+	{
+		_quiltBuilder.configure(quiltViewIndex(_lightField_numberOfColumns - 1, 0) + 1, _lightField_quiltNumberOfColumns, _lightField_quiltWidth);
+	}
 
 	// tell the camera tools we're starting a session.
 	if(!startSession())
 	{
 		return;
 	}
+	startJournal();
 
 	// move to start
-	moveCameraForLightfield(-1, true);
+	moveCameraForLightfield(0, true);
 	// set convolution counter to its initial value
 	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
 	_state = ScreenshotControllerState::InSession;
@@ -265,20 +507,19 @@ void ScreenshotController::startLightfieldShot(float distancePerStep, int number
 }
 
 
-void ScreenshotController::startDebugGridShot()
+void ScreenshotController::startSupersamplingShot(int numberOfSamples, float referenceDistance, float currentFoVInDegrees, bool isTestRun)
 {
 	if(!_cameraToolsConnector.cameraToolsConnected())
 	{
 		return;
 	}
 
-	// debug grid is basically a 5 horizontal, 3 row grid where the camera is moved 10 positions to the right and then down, then to the left then down and to the right again.
-
 	reset();
-	_isTestRun = true;
-	_lightField_distancePerStep = 10;
-	_numberOfShotsToTake = 15;
-	_typeOfShot = ScreenshotType::DebugGrid;
+	_isTestRun = isTestRun;
+	_numberOfShotsToTake = (std::max)(numberOfSamples, 1);
+	_supersampling_referenceDistance = referenceDistance;
+	_supersampling_currentFoVRadians = IGCS::Utils::degreesToRadians(currentFoVInDegrees);
+	_typeOfShot = ScreenshotType::Supersampling;
 
 	// tell the camera tools we're starting a session.
 	if(!startSession())
@@ -286,8 +527,7 @@ void ScreenshotController::startDebugGridShot()
 		return;
 	}
 
-	// move to start
-	moveCameraForDebugGrid(-1, true);
+	// the first sample is at the start location, so there's no need to move the camera.
 	// set convolution counter to its initial value
 	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
 	_state = ScreenshotControllerState::InSession;
@@ -298,186 +538,1581 @@ void ScreenshotController::startDebugGridShot()
 }
 
 
-std::string ScreenshotController::createScreenshotFolder()
+void ScreenshotController::configureMotionBlur(MotionBlurMovementType movementType, float distanceRight, float distanceUp, float fovChangeDegrees, float angleDegrees, 
+											  ShutterShape shutterShape)
 {
-	time_t t = time(nullptr);
-	tm tm;
-	localtime_s(&tm, &t);
-	const std::string optionalBackslash = (_rootFolder.ends_with('\\')) ? "" : "\\";
-	std::string folderName = IGCS::Utils::formatString("%s%s%s-%.4d-%.2d-%.2d-%.2d-%.2d-%.2d", _rootFolder.c_str(), optionalBackslash.c_str(), typeOfShotAsString().c_str(), 
-													   (tm.tm_year + 1900), (tm.tm_mon + 1), tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
-	_mkdir(folderName.c_str());
-	return folderName;
+	if(_state != ScreenshotControllerState::Off)
+	{
+		return;
+	}
+	_motionBlur_movementType = movementType;
+	_motionBlur_distanceRight = distanceRight;
+	_motionBlur_distanceUp = distanceUp;
+	_motionBlur_fovChangeDegrees = fovChangeDegrees;
+	_motionBlur_angleRadians = IGCS::Utils::degreesToRadians(angleDegrees);
+	_motionBlur_shutterShape = shutterShape;
 }
 
 
-void ScreenshotController::modifyCamera()
+void ScreenshotController::startMotionBlurShot(int numberOfSamples, float currentFoVInDegrees, bool isTestRun)
 {
-	// based on the type of the shot, we'll either rotate or move.
-	switch (_typeOfShot)
+	if(!_cameraToolsConnector.cameraToolsConnected())
 	{
-	case ScreenshotType::HorizontalPanorama:
-		moveCameraForPanorama(1, false);
-		break;
-	case ScreenshotType::MultiShot:
-		moveCameraForLightfield(1, false);
-		break;
-#ifdef _DEBUG
-	case ScreenshotType::DebugGrid:
-		moveCameraForDebugGrid(_shotCounter, false);
-		break;
-#endif
+		return;
+	}
+
+	reset();
+	_isTestRun = isTestRun;
+	_numberOfShotsToTake = (std::max)(numberOfSamples, 1);
+	_motionBlur_currentFoVDegrees = currentFoVInDegrees;
+	_typeOfShot = ScreenshotType::MotionBlur;
 
+	// tell the camera tools we're starting a session.
+	if(!startSession())
+	{
+		return;
 	}
+
+	// move to start
+	moveCameraForMotionBlur(0, true);
+	// set convolution counter to its initial value
+	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+	_state = ScreenshotControllerState::InSession;
+
+	// Create a thread which will handle the end of the shot session as the shot taking is done by event handlers
+	std::thread t(&ScreenshotController::completeShotSession, this);
+	t.detach();
 }
 
 
-std::string ScreenshotController::typeOfShotAsString()
+void ScreenshotController::startTemporalDenoiseShot(int numberOfFrames, FrameStackingMethod stackingMethod, bool isTestRun)
 {
-	// based on the type of the shot, we'll either rotate or move.
-	switch(_typeOfShot)
+	if(!_cameraToolsConnector.cameraToolsConnected())
 	{
-	case ScreenshotType::HorizontalPanorama:
-		return "HorizontalPanorama";
-	case ScreenshotType::MultiShot:
-		return "Lightfield";
-#ifdef _DEBUG
-	case ScreenshotType::DebugGrid:
-		return "DebugGrid";
-#endif
-		
+		return;
 	}
-	return "";
-}
 
+	reset();
+	_isTestRun = isTestRun;
+	_numberOfShotsToTake = (std::max)(numberOfFrames, 1);
+	_temporalDenoise_stackingMethod = stackingMethod;
+	_typeOfShot = ScreenshotType::TemporalDenoise;
 
-void ScreenshotController::moveCameraForLightfield(int direction, bool end)
-{
-	float distance = direction * _lightField_distancePerStep;
-	if (end)
+	// tell the camera tools we're starting a session.
+	if(!startSession())
 	{
-		distance *= 0.5f * _numberOfShotsToTake;
+		return;
 	}
-	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
-	// we don't move up/down so we pass in 0. We don't change the fov and the step is relative to the current camera location.
-	_cameraToolsConnector.moveCameraMultishot(distance, 0.0f, 0.0f, false);
+
+	// set convolution counter to its initial value
+	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+	_state = ScreenshotControllerState::InSession;
+
+	// Create a thread which will handle the end of the shot session as the shot taking is done by event handlers
+	std::thread t(&ScreenshotController::completeShotSession, this);
+	t.detach();
 }
 
 
-void ScreenshotController::moveCameraForPanorama(int direction, bool end)
+void ScreenshotController::startOrbitShot(const OrbitLayout& layout, bool isTestRun)
 {
-	float distance = direction * _pano_anglePerStep;
-	if (end)
+	if(!_cameraToolsConnector.cameraToolsConnected())
 	{
-		distance *= 0.5f * _numberOfShotsToTake;
+		return;
 	}
-	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
-	_cameraToolsConnector.moveCameraPanorama(distance);
+	if(!_cameraToolsConnector.canSetCameraPose() || nullptr == _cameraToolsData)
+	{
+		// relative moves can't move the camera forward, so there's no fallback to orbit with.
+		OverlayControl::addNotification("Orbit sessions need camera tools which can set the camera pose.");
+		return;
+	}
+
+	reset();
+	_isTestRun = isTestRun;
+	_orbit_layout = layout;
+	CameraPose startPose;
+	startPose.obtainFromCameraToolsData(*_cameraToolsData);
+	_orbit_poses = IGCS::OrbitPlanner::planOrbit(startPose, layout);
+	_numberOfShotsToTake = (int)_orbit_poses.size();
+	_typeOfShot = ScreenshotType::Orbit;
+	if(_numberOfShotsToTake <= 0)
+	{
+		return;
+	}
+
+	// tell the camera tools we're starting a session.
+	if(!startSession())
+	{
+		return;
+	}
+	startJournal();
+
+	// move to start
+	moveCameraForOrbit(0);
+	// set convolution counter to its initial value
+	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+	_state = ScreenshotControllerState::InSession;
+
+	// Create a thread which will handle the end of the shot session as the shot taking is done by event handlers
+	std::thread t(&ScreenshotController::completeShotSession, this);
+	t.detach();
 }
 
 
-void ScreenshotController::moveCameraForDebugGrid(int shotCounter, bool end)
+void ScreenshotController::configureExposureBracketing(bool enabled, const std::string& effectName, const std::string& uniformName, bool uniformIsMultiplier, 
+													  int numberOfBrackets, float stopsBetweenBrackets)
 {
-	float horizontalStep = 0.0f;
-	float verticalStep = 0.0f;
-	if(end)
+	if(_state != ScreenshotControllerState::Off)
 	{
-		horizontalStep = -20.0f;
-		verticalStep = -20.0f;
+		return;
 	}
-	else
+	_bracketing_enabled = enabled && numberOfBrackets > 1;
+	_bracketing_effectName = effectName;
+	_bracketing_uniformName = uniformName;
+	_bracketing_uniformIsMultiplier = uniformIsMultiplier;
+	_bracketing_numberOfBrackets = (std::max)(numberOfBrackets, 1);
+	_bracketing_stopsBetweenBrackets = stopsBetweenBrackets;
+}
+
+
+void ScreenshotController::configureHighBitDepth(bool enabled, bool tenBitIsPq, HighBitDepthFiletype filetype)
+{
+	if(_state != ScreenshotControllerState::Off)
 	{
-		verticalStep = (shotCounter / 5);
-		verticalStep = (-20 + 10 * verticalStep);
-		horizontalStep = (shotCounter % 5);
-		horizontalStep = -20 + 10 * horizontalStep;
+		return;
 	}
-	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
-	// we don't move up/down so we pass in 0. We don't change the fov and the step is relative to the current camera location.
-	_cameraToolsConnector.moveCameraMultishot(horizontalStep, verticalStep, (shotCounter % 5) * 10.0f, true);
+	_highBitDepth_enabled = enabled;
+	_highBitDepth_tenBitIsPq = tenBitIsPq;
+	_highBitDepth_filetype = filetype;
 }
 
 
-void ScreenshotController::storeGrabbedShot(std::vector<uint8_t> grabbedShot)
+void ScreenshotController::configureAsynchronousCapture(bool enabled)
 {
-	if(grabbedShot.size() <= 0)
+	if(_state != ScreenshotControllerState::Off)
 	{
-		// failed
 		return;
 	}
+	_asynchronousCapture_enabled = enabled;
+}
 
-	_grabbedFrames.push_back(grabbedShot);
-	_shotCounter++;
-	if(_shotCounter >= _numberOfShotsToTake)
+
+void ScreenshotController::configureRegionOfInterest(bool enabled, float left, float top, float width, float height)
+{
+	if(_state != ScreenshotControllerState::Off)
 	{
-		// we're done. Move to the next state, which is saving shots. 
-		_state = ScreenshotControllerState::SavingShots;
-		// tell the waiting thread to wake up so the system can proceed as normal.
-		_waitCompletionHandle.notify_all();
+		return;
 	}
-	else
+	_regionOfInterest_enabled = enabled;
+	_regionOfInterest_left = std::clamp(left, 0.0f, 1.0f);
+	_regionOfInterest_top = std::clamp(top, 0.0f, 1.0f);
+	_regionOfInterest_width = std::clamp(width, 0.0f, 1.0f - _regionOfInterest_left);
+	_regionOfInterest_height = std::clamp(height, 0.0f, 1.0f - _regionOfInterest_top);
+}
+
+
+void ScreenshotController::configureDepthCapture(bool enabled, float nearPlane, float farPlane, bool isReversed, DepthFiletype filetype)
+{
+	if(_state != ScreenshotControllerState::Off)
 	{
-		modifyCamera();
-		_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+		return;
 	}
+	_depth_enabled = enabled;
+	// the far plane has to be beyond the near plane, or the linearization divides by zero.
+	_depth_nearPlane = (std::max)(nearPlane, 0.0001f);
+	_depth_farPlane = (std::max)(farPlane, _depth_nearPlane + 0.0001f);
+	_depth_isReversed = isReversed;
+	_depth_filetype = filetype;
 }
 
 
-void ScreenshotController::saveGrabbedShots()
+void ScreenshotController::configureArchivalRecompression(bool enabled)
 {
-	if(_grabbedFrames.size() <= 0)
+	if(_state != ScreenshotControllerState::Off)
 	{
 		return;
 	}
-	if(!_isTestRun)
+	_archivalRecompression_enabled = enabled;
+}
+
+
+void ScreenshotController::configureLightfieldRefocusing(bool writeRefocusedImages, float minimumDisparity, float maximumDisparity, int numberOfFocusPlanes)
+{
+	if(_state != ScreenshotControllerState::Off)
 	{
-		_state = ScreenshotControllerState::SavingShots;
-		const std::string destinationFolder = createScreenshotFolder();
-		int frameNumber = 0;
-		for(const std::vector<uint8_t>& frame : _grabbedFrames)
-		{
-			saveShotToFile(destinationFolder, frame, frameNumber);
-			frameNumber++;
-		}
+		return;
 	}
+	_lightField_writeRefocusedImages = writeRefocusedImages;
+	_lightField_refocusMinimumDisparity = (std::min)(minimumDisparity, maximumDisparity);
+	_lightField_refocusMaximumDisparity = (std::max)(minimumDisparity, maximumDisparity);
+	_lightField_refocusNumberOfFocusPlanes = (std::max)(numberOfFocusPlanes, 1);
 }
 
 
-void ScreenshotController::saveShotToFile(std::string destinationFolder, const std::vector<uint8_t>& data, int frameNumber)
+void ScreenshotController::configureLightfieldDisparityMap(bool writeDisparityMap, float maximumDisparity)
 {
-	std::string filename = "";
-
-	// The shot data is RGB as we packed the RGBA data as RGB as Alpha is 0 in the source. So we pass 3 as the comp
-	switch(_filetype)
+	if(_state != ScreenshotControllerState::Off)
 	{
-	case ScreenshotFiletype::Bmp:
-		filename = IGCS::Utils::formatString("%s\\%d.bmp", destinationFolder.c_str(), frameNumber);
-		stbi_write_bmp(filename.c_str(), _framebufferWidth, _framebufferHeight, 3, data.data()) != 0;
-		break;
-	case ScreenshotFiletype::Jpeg:
-		filename = IGCS::Utils::formatString("%s\\%d.jpg", destinationFolder.c_str(), frameNumber);
-		stbi_write_jpg(filename.c_str(), _framebufferWidth, _framebufferHeight, 3, data.data(), 98) != 0;
+		return;
+	}
+	_lightField_writeDisparityMap = writeDisparityMap;
+	_lightField_maximumDisparity = maximumDisparity;
+}
+
+
+void ScreenshotController::configureLightfieldInterpolation(int numberOfInterpolatedViews)
+{
+	if(_state != ScreenshotControllerState::Off)
+	{
+		return;
+	}
+	_lightField_numberOfInterpolatedViews = (std::max)(numberOfInterpolatedViews, 0);
+}
+
+
+void ScreenshotController::configureLightfieldWiggleAnimation(bool writeWiggleAnimation)
+{
+	if(_state != ScreenshotControllerState::Off)
+	{
+		return;
+	}
+	_lightField_writeWiggleAnimation = writeWiggleAnimation;
+}
+
+
+void ScreenshotController::configureLightfieldQuilt(LightfieldQuiltMode quiltMode, int numberOfColumns, int quiltWidth)
+{
+	if(_state != ScreenshotControllerState::Off)
+	{
+		return;
+	}
+	_lightField_quiltMode = quiltMode;
+	_lightField_quiltNumberOfColumns = numberOfColumns;
+	_lightField_quiltWidth = quiltWidth;
+}
+
+
+void ScreenshotController::startDebugGridShot()
+{
+	if(!_cameraToolsConnector.cameraToolsConnected())
+	{
+		return;
+	}
+
+	// debug grid is basically a 5 horizontal, 3 row grid where the camera is moved 10 positions to the right and then down, then to the left then down and to the right again.
+
+	reset();
+	_isTestRun = true;
+	_lightField_distancePerStep = 10;
+	_numberOfShotsToTake = 15;
+	_typeOfShot = ScreenshotType::DebugGrid;
+
+	// tell the camera tools we're starting a session.
+	if(!startSession())
+	{
+		return;
+	}
+
+	// move to start
+	moveCameraForDebugGrid(-1, true);
+	// set convolution counter to its initial value
+	_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+	_state = ScreenshotControllerState::InSession;
+
+	// Create a thread which will handle the end of the shot session as the shot taking is done by event handlers
+	std::thread t(&ScreenshotController::completeShotSession, this);
+	t.detach();
+}
+
+
+void ScreenshotController::resumeInterruptedSession()
+{
+	if(_state != ScreenshotControllerState::Off || !_cameraToolsConnector.cameraToolsConnected())
+	{
+		return;
+	}
+	const std::string sessionFolder = IGCS::SessionJournalReader::findLatestInterruptedSession(_rootFolder);
+	SessionJournalData journalData;
+	if(sessionFolder.empty() || !IGCS::SessionJournalReader::readJournal(sessionFolder, journalData))
+	{
+		OverlayControl::addNotification("No interrupted session found in the screenshot output directory.");
+		return;
+	}
+	if(!journalData.hasStartPose)
+	{
+		OverlayControl::addNotification("The interrupted session has no start pose, so it can't be resumed.");
+		return;
+	}
+	if(!_cameraToolsConnector.canSetCameraPose() && (ScreenshotType::Orbit == journalData.typeOfShot || !isCameraAtPose(journalData.startPose)))
+	{
+		// without absolute poses, the shots can only be found again from the start location of the session.
+		OverlayControl::addNotification("The camera tools can't set the camera pose: move the camera back to where the interrupted session started.");
+		return;
+	}
+
+	reset();
+	_typeOfShot = journalData.typeOfShot;
+	_filetype = journalData.filetype;
+	_numberOfShotsToTake = journalData.numberOfShotsToTake;
+	_pano_totalFoVRadians = journalData.pano_totalFoVRadians;
+	_pano_currentFoVRadians = journalData.pano_currentFoVRadians;
+	_pano_anglePerStep = journalData.pano_anglePerStep;
+	_overlapPercentagePerPanoShot = journalData.pano_overlapPercentage;
+	_lightField_distancePerStep = journalData.lightField_distancePerStep;
+	_lightField_numberOfColumns = journalData.lightField_numberOfColumns;
+	_lightField_distancePerRow = journalData.lightField_distancePerRow;
+	_lightField_numberOfRows = (std::max)(journalData.lightField_numberOfRows, 1);
+	// the quilt needs all shots, which aren't in memory anymore.
+	_lightField_quiltMode = LightfieldQuiltMode::Off;
+	_orbit_layout = journalData.orbitLayout;
+	if(ScreenshotType::Orbit == _typeOfShot)
+	{
+		_orbit_poses = IGCS::OrbitPlanner::planOrbit(journalData.startPose, _orbit_layout);
+	}
+	// the shots before the first missing shot are on disk: keep their metadata, so the files written at the end cover them too.
+	const int firstMissingShotIndex = journalData.firstMissingShotIndex();
+	for(int i = 0; i < firstMissingShotIndex; i++)
+	{
+		GrabbedFrame shotOnDisk;
+		shotOnDisk.shotIndex = i;
+		if(ScreenshotType::MultiShot == _typeOfShot)
+		{
+			lightfieldGridCellForShot(i, shotOnDisk.gridRow, shotOnDisk.gridColumn);
+		}
+		for(const JournaledShot& journaledShot : journalData.completedShots)
+		{
+			if(journaledShot.shotIndex == i)
+			{
+				shotOnDisk.hasPose = journaledShot.hasPose;
+				shotOnDisk.pose = journaledShot.pose;
+			}
+		}
+		_grabbedFrames.push_back(std::move(shotOnDisk));
+	}
+	_shotCounter = firstMissingShotIndex;
+	_destinationFolder = sessionFolder;
+	_isResumedSession = true;
+	if(_journal.reopen(sessionFolder))
+	{
+		// one writer thread, so the shots are journaled in the order they're taken.
+		_shotWriter.start(_filetype, 1, JournaledShotQueueCapacity);
+	}
+	else
+	{
+		OverlayControl::addNotification("The journal of the interrupted session can't be opened. The session is resumed without it.");
+	}
+	if(!_manifest.reopen(sessionFolder, typeOfShotAsString(), firstMissingShotIndex))
+	{
+		// a session from before manifests existed. Its manifest only lists the shots taken from here on.
+		_manifest.create(sessionFolder, _typeOfShot, typeOfShotAsString(), _filetype, _numberOfShotsToTake);
+	}
+	if(_shotCounter < _numberOfShotsToTake)
+	{
+		if(!startSession())
+		{
+			reset();
+			return;
+		}
+		if(_cameraToolsConnector.canSetCameraPose())
+		{
+			_cameraToolsConnector.setCameraPose(journalData.startPose.position, journalData.startPose.orientation, journalData.startPose.fovDegrees);
+		}
+		moveCameraToShot(_shotCounter);
+		_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+		_state = ScreenshotControllerState::InSession;
+		OverlayControl::addNotification(IGCS::Utils::formatString("Resuming the session at shot %d of %d", _shotCounter + 1, _numberOfShotsToTake));
+	}
+	else
+	{
+		// all shots are on disk, only the files made at the end of the session are missing.
+		_state = ScreenshotControllerState::SavingShots;
+	}
+
+	// Create a thread which will handle the end of the shot session as the shot taking is done by event handlers
+	std::thread t(&ScreenshotController::completeShotSession, this);
+	t.detach();
+}
+
+
+bool ScreenshotController::isJournaledSession()
+{
+	// only the session types which write their shots are journaled. A quilt only session doesn't write its shots.
+	if(_isTestRun)
+	{
+		return false;
+	}
+	return ScreenshotType::HorizontalPanorama == _typeOfShot || ScreenshotType::Orbit == _typeOfShot || 
+		   (ScreenshotType::MultiShot == _typeOfShot && LightfieldQuiltMode::QuiltOnly != _lightField_quiltMode);
+}
+
+
+void ScreenshotController::startJournal()
+{
+	if(!isJournaledSession())
+	{
+		return;
+	}
+	_destinationFolder = createScreenshotFolder();
+	SessionJournalData journalData;
+	journalData.typeOfShot = _typeOfShot;
+	journalData.filetype = _filetype;
+	journalData.numberOfShotsToTake = _numberOfShotsToTake;
+	journalData.pano_totalFoVRadians = _pano_totalFoVRadians;
+	journalData.pano_currentFoVRadians = _pano_currentFoVRadians;
+	journalData.pano_anglePerStep = _pano_anglePerStep;
+	journalData.pano_overlapPercentage = _overlapPercentagePerPanoShot;
+	journalData.lightField_distancePerStep = _lightField_distancePerStep;
+	journalData.lightField_numberOfColumns = _lightField_numberOfColumns;
+	journalData.lightField_distancePerRow = _lightField_distancePerRow;
+	journalData.lightField_numberOfRows = _lightField_numberOfRows;
+	journalData.orbitLayout = _orbit_layout;
+	if(nullptr != _cameraToolsData)
+	{
+		// the camera hasn't been moved yet.
+		journalData.hasStartPose = journalData.startPose.obtainFromCameraToolsData(*_cameraToolsData);
+	}
+	if(_journal.create(_destinationFolder, journalData))
+	{
+		// one writer thread, so the shots are journaled in the order they're taken.
+		_shotWriter.start(_filetype, 1, JournaledShotQueueCapacity);
+	}
+	else
+	{
+		OverlayControl::addNotification("The session journal can't be written. The session can't be resumed if it's interrupted.");
+	}
+	_manifest.create(_destinationFolder, _typeOfShot, typeOfShotAsString(), _filetype, _numberOfShotsToTake);
+}
+
+
+void ScreenshotController::writeJournaledShot(GrabbedFrame& shot, int frameNumber)
+{
+	if(shot.data.size() <= 0)
+	{
+		// a lightfield shot which is only kept for the quilt has no data to write. 
+		return;
+	}
+	// the filenames and the record are created here, as they read the grabbed frames, which are only used on this thread.
+	const std::string filename = createShotFilename(frameNumber);
+	const std::string filenameStem = createShotFilenameStem(frameNumber);
+	EncodeJob job;
+	job.filename = IGCS::Utils::formatString("%s\\%s", _destinationFolder.c_str(), filename.c_str()).c_str();
+	job.width = _framebufferWidth;
+	job.height = _framebufferHeight;
+	std::vector<float> radiance;
+	std::vector<float> depth;
+	if(ScreenshotType::MultiShot == _typeOfShot)
+	{
+		// lightfields create images from all shots at the end of the session, so they keep their shots.
+		job.data = shot.data;
+		radiance = shot.radiance;
+		depth = shot.depth;
+	}
+	else
+	{
+		// panorama and orbit shots aren't needed after they've been written.
+		job.data = std::move(shot.data);
+		radiance = std::move(shot.radiance);
+		depth = std::move(shot.depth);
+		shot.data = std::vector<uint8_t>();
+		shot.radiance = std::vector<float>();
+		shot.depth = std::vector<float>();
+	}
+	const int shotIndex = shot.shotIndex;
+	const bool hasPose = shot.hasPose;
+	const CameraPose pose = shot.pose;
+	job.onWritten = [this, record = createManifestRecord(shot, filename), filenameStem, radiance = std::move(radiance), depth = std::move(depth), shotIndex, hasPose, pose]
+					(const EncodedFrameRecord& writtenFrame, const std::vector<uint8_t>& encodedData) mutable
+	{
+		record.numberOfBytes = (uint32_t)writtenFrame.numberOfBytes;
+		record.encodeMilliseconds = (float)writtenFrame.encodeMilliseconds;
+		record.crc32 = fpng::fpng_crc32(encodedData.data(), encodedData.size());
+		_manifest.appendShot(record);
+		if(radiance.size() > 0)
+		{
+			saveRadianceToFile(_destinationFolder, radiance, filenameStem);
+		}
+		if(depth.size() > 0)
+		{
+			saveDepthToFile(_destinationFolder, depth, filenameStem);
+		}
+		// only now the shot is on disk, so a resumed session doesn't skip a shot which was still being written.
+		_journal.appendCompletedShot(shotIndex, hasPose ? &pose : nullptr);
+	};
+	// waits if the writer is behind, so the shots waiting to be written can't fill up memory.
+	if(!_shotWriter.enqueue(std::move(job)))
+	{
+		OverlayControl::addNotification(IGCS::Utils::formatString("Shot %d can't be written", shotIndex + 1));
+	}
+}
+
+
+bool ScreenshotController::isCameraAtPose(const CameraPose& pose)
+{
+	if(nullptr == _cameraToolsData)
+	{
+		return false;
+	}
+	CameraPose currentPose;
+	currentPose.obtainFromCameraToolsData(*_cameraToolsData);
+	float squaredDistance = 0.0f;
+	float orientationDot = 0.0f;
+	for(int i = 0; i < 3; i++)
+	{
+		squaredDistance += (currentPose.position[i] - pose.position[i]) * (currentPose.position[i] - pose.position[i]);
+	}
+	for(int i = 0; i < 4; i++)
+	{
+		orientationDot += currentPose.orientation[i] * pose.orientation[i];
+	}
+	// q and -q are the same orientation.
+	return squaredDistance <= StartPoseTolerance * StartPoseTolerance && fabsf(orientationDot) >= StartOrientationTolerance;
+}
+
+
+std::string ScreenshotController::createScreenshotFolder()
+{
+	time_t t = time(nullptr);
+	tm tm;
+	localtime_s(&tm, &t);
+	const std::string optionalBackslash = (_rootFolder.ends_with('\\')) ? "" : "\\";
+	std::string folderName = IGCS::Utils::formatString("%s%s%s-%.4d-%.2d-%.2d-%.2d-%.2d-%.2d", _rootFolder.c_str(), optionalBackslash.c_str(), typeOfShotAsString().c_str(), 
+													   (tm.tm_year + 1900), (tm.tm_mon + 1), tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+	_mkdir(folderName.c_str());
+	return folderName;
+}
+
+
+void ScreenshotController::modifyCamera()
+{
+	// based on the type of the shot, we'll either rotate or move.
+	switch (_typeOfShot)
+	{
+	case ScreenshotType::HorizontalPanorama:
+		moveCameraForPanorama(1, false);
 		break;
-	case ScreenshotFiletype::Png:
-		filename = IGCS::Utils::formatString("%s\\%d.png", destinationFolder.c_str(), frameNumber);
-		// 3 bytes per pixel!
-		//stbi_write_png(filename.c_str(), _framebufferWidth, _framebufferHeight, 3, data.data(), 3 * _framebufferWidth) != 0;
-		std::vector<uint8_t> encoded_data;
-		fpng::fpng_encode_image_to_memory(data.data(), _framebufferWidth, _framebufferHeight, 3, encoded_data);
-		FILE* pngFile;
-		if(fopen_s(&pngFile, filename.c_str(), "wb")==0)
+	case ScreenshotType::MultiShot:
+		moveCameraForLightfield(_shotCounter, false);
+		break;
+	case ScreenshotType::Supersampling:
+		moveCameraForSupersampling(_shotCounter);
+		break;
+	case ScreenshotType::MotionBlur:
+		moveCameraForMotionBlur(_shotCounter, false);
+		break;
+	case ScreenshotType::TemporalDenoise:
+		// the camera stays where it is.
+		break;
+	case ScreenshotType::Orbit:
+		moveCameraForOrbit(_shotCounter);
+		break;
+#ifdef _DEBUG
+	case ScreenshotType::DebugGrid:
+		moveCameraForDebugGrid(_shotCounter, false);
+		break;
+#endif
+
+	}
+}
+
+
+std::string ScreenshotController::typeOfShotAsString()
+{
+	// based on the type of the shot, we'll either rotate or move.
+	switch(_typeOfShot)
+	{
+	case ScreenshotType::HorizontalPanorama:
+		return "HorizontalPanorama";
+	case ScreenshotType::MultiShot:
+		return "Lightfield";
+	case ScreenshotType::Supersampling:
+		return "Supersampling";
+	case ScreenshotType::MotionBlur:
+		return "MotionBlur";
+	case ScreenshotType::TemporalDenoise:
+		return "TemporalDenoise";
+	case ScreenshotType::Orbit:
+		return "Orbit";
+#ifdef _DEBUG
+	case ScreenshotType::DebugGrid:
+		return "DebugGrid";
+#endif
+		
+	}
+	return "";
+}
+
+
+void ScreenshotController::moveCameraForLightfield(int shotIndex, bool start)
+{
+	float horizontalStep = 0.0f;
+	float verticalStep = 0.0f;
+	if(start)
+	{
+		// move to the top left of the grid. With 1 row there's no vertical movement.
+		horizontalStep = -_lightField_distancePerStep * 0.5f * _lightField_numberOfColumns;
+		verticalStep = _lightField_distancePerRow * 0.5f * (_lightField_numberOfRows - 1);
+	}
+	else
+	{
+		// the shot to move to is either next to the previous shot on the same row or right below it, as we walk the grid in serpentine order.
+		int row, column, previousRow, previousColumn;
+		lightfieldGridCellForShot(shotIndex, row, column);
+		lightfieldGridCellForShot(shotIndex - 1, previousRow, previousColumn);
+		if(row == previousRow)
+		{
+			horizontalStep = (column - previousColumn) * _lightField_distancePerStep;
+		}
+		else
+		{
+			verticalStep = -_lightField_distancePerRow;
+		}
+	}
+	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
+	// We don't change the fov and the step is relative to the current camera location.
+	_cameraToolsConnector.moveCameraMultishot(horizontalStep, verticalStep, 0.0f, false);
+}
+
+
+void ScreenshotController::moveCameraForSupersampling(int shotIndex)
+{
+	// The offsets follow a 2,3 Halton sequence, which is shifted over half a pixel (wrapping around) so the first sample is at the start location.
+	// The size of a pixel, in world units, at the reference distance follows from the fov and the width of the backbuffer (the fov applies to the whole
+	// backbuffer, also with a region of interest). The backbuffer size is known here as the first shot has been taken.
+	const float horizontalOffsetInPixels = fmodf(IGCS::Utils::halton(shotIndex, 2) + 0.5f, 1.0f) - 0.5f;
+	const float verticalOffsetInPixels = fmodf(IGCS::Utils::halton(shotIndex, 3) + 0.5f, 1.0f) - 0.5f;
+	const float worldUnitsPerPixel = _frameWidth > 0
+										? 2.0f * _supersampling_referenceDistance * tanf(0.5f * _supersampling_currentFoVRadians) / (float)_frameWidth
+										: 0.0f;
+	// offsets are relative to the start location, so errors don't add up.
+	_cameraToolsConnector.moveCameraMultishot(horizontalOffsetInPixels * worldUnitsPerPixel, verticalOffsetInPixels * worldUnitsPerPixel, 0.0f, true);
+}
+
+
+void ScreenshotController::moveCameraForMotionBlur(int shotIndex, bool start)
+{
+	const float time = motionBlurShotTime(shotIndex);
+	if(MotionBlurMovementType::Rotation == _motionBlur_movementType)
+	{
+		// rotations are relative to the current camera orientation.
+		const float previousTime = start ? 0.0f : motionBlurShotTime(shotIndex - 1);
+		_cameraToolsConnector.moveCameraPanorama((time - previousTime) * _motionBlur_angleRadians);
+		return;
+	}
+	// translations are relative to the start location, so errors don't add up. A fov of 0 leaves the fov untouched.
+	const float fovDegrees = _motionBlur_fovChangeDegrees != 0.0f ? (std::max)(_motionBlur_currentFoVDegrees + time * _motionBlur_fovChangeDegrees, 1.0f) : 0.0f;
+	_cameraToolsConnector.moveCameraMultishot(time * _motionBlur_distanceRight, time * _motionBlur_distanceUp, fovDegrees, true);
+}
+
+
+float ScreenshotController::motionBlurShotTime(int shotIndex)
+{
+	// every shot is in the middle of its slice of the time the shutter is open.
+	return ((float)shotIndex + 0.5f) / (float)_numberOfShotsToTake - 0.5f;
+}
+
+
+float ScreenshotController::motionBlurShotWeight(int shotIndex)
+{
+	const float time = motionBlurShotTime(shotIndex);
+	switch(_motionBlur_shutterShape)
+	{
+	case ShutterShape::Triangle:
+		return 1.0f - 2.0f * fabsf(time);
+	case ShutterShape::Cosine:
+		return 0.5f + 0.5f * cosf(2.0f * DirectX::XM_PI * time);
+	}
+	return 1.0f;
+}
+
+
+void ScreenshotController::lightfieldGridCellForShot(int shotIndex, int& row, int& column)
+{
+	if(_lightField_numberOfColumns <= 0)
+	{
+		row = 0;
+		column = 0;
+		return;
+	}
+	row = shotIndex / _lightField_numberOfColumns;
+	column = shotIndex % _lightField_numberOfColumns;
+	if((row % 2) == 1)
+	{
+		column = _lightField_numberOfColumns - 1 - column;
+	}
+}
+
+
+void ScreenshotController::moveCameraForPanorama(int direction, bool end)
+{
+	float distance = direction * _pano_anglePerStep;
+	if (end)
+	{
+		distance *= 0.5f * _numberOfShotsToTake;
+	}
+	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
+	_cameraToolsConnector.moveCameraPanorama(distance);
+}
+
+
+void ScreenshotController::moveCameraForOrbit(int shotIndex)
+{
+	if(shotIndex < 0 || shotIndex >= (int)_orbit_poses.size())
+	{
+		return;
+	}
+	const CameraPose& pose = _orbit_poses[shotIndex];
+	_cameraToolsConnector.setCameraPose(pose.position, pose.orientation, pose.fovDegrees);
+}
+
+
+void ScreenshotController::moveCameraToShot(int shotIndex)
+{
+	switch(_typeOfShot)
+	{
+	case ScreenshotType::HorizontalPanorama:
+		// the first shot is half the total angle to the left, see moveCameraForPanorama.
+		_cameraToolsConnector.moveCameraPanorama(_pano_anglePerStep * (shotIndex - 0.5f * _numberOfShotsToTake));
+		break;
+	case ScreenshotType::MultiShot:
+		{
+			// the first shot is at the top left of the grid, see moveCameraForLightfield.
+			int row, column;
+			lightfieldGridCellForShot(shotIndex, row, column);
+			const float horizontalStep = _lightField_distancePerStep * (column - 0.5f * _lightField_numberOfColumns);
+			const float verticalStep = _lightField_distancePerRow * (0.5f * (_lightField_numberOfRows - 1) - row);
+			_cameraToolsConnector.moveCameraMultishot(horizontalStep, verticalStep, 0.0f, false);
+		}
+		break;
+	case ScreenshotType::Orbit:
+		moveCameraForOrbit(shotIndex);
+		break;
+	}
+}
+
+
+void ScreenshotController::moveCameraForDebugGrid(int shotCounter, bool end)
+{
+	float horizontalStep = 0.0f;
+	float verticalStep = 0.0f;
+	if(end)
+	{
+		horizontalStep = -20.0f;
+		verticalStep = -20.0f;
+	}
+	else
+	{
+		verticalStep = (shotCounter / 5);
+		verticalStep = (-20 + 10 * verticalStep);
+		horizontalStep = (shotCounter % 5);
+		horizontalStep = -20 + 10 * horizontalStep;
+	}
+	// we don't know the movement speed, so we pass the distance to the camera, and the camere has to divide by movement speed so it's independent of movement speed.
+	// we don't move up/down so we pass in 0. We don't change the fov and the step is relative to the current camera location.
+	_cameraToolsConnector.moveCameraMultishot(horizontalStep, verticalStep, (shotCounter % 5) * 10.0f, true);
+}
+
+
+bool ScreenshotController::storeGrabbedShot(GrabbedFrame grabbedShot)
+{
+	if(grabbedShot.data.size() <= 0)
+	{
+		// failed
+		return false;
+	}
+
+	if(ScreenshotType::MultiShot == _typeOfShot)
+	{
+		lightfieldGridCellForShot(grabbedShot.shotIndex, grabbedShot.gridRow, grabbedShot.gridColumn);
+		// quilts are horizontal parallax only, so with a grid only the middle row goes into the quilt.
+		const bool isQuiltRow = grabbedShot.gridRow == (_lightField_numberOfRows - 1) / 2;
+		if(_lightField_quiltMode != LightfieldQuiltMode::Off && !_isTestRun && isQuiltRow)
+		{
+			_quiltBuilder.addView(quiltViewIndex(grabbedShot.gridColumn, 0), grabbedShot.data.data(), _framebufferWidth, _framebufferHeight);
+		}
+		if(LightfieldQuiltMode::QuiltOnly == _lightField_quiltMode && !(isQuiltRow && (_lightField_numberOfInterpolatedViews > 0 || _lightField_writeWiggleAnimation)))
+		{
+			// the shot isn't needed anymore, only keep its metadata. Shots in the quilt row are kept if views have to be interpolated between them or if
+			// they're needed for the wiggle animation.
+			grabbedShot.data.clear();
+			grabbedShot.data.shrink_to_fit();
+			grabbedShot.radiance.clear();
+			grabbedShot.radiance.shrink_to_fit();
+			grabbedShot.depth.clear();
+			grabbedShot.depth.shrink_to_fit();
+		}
+	}
+	// the mean doesn't need the frames themselves, so they're accumulated like the other averaging session types. 
+	const bool isMeanDenoise = ScreenshotType::TemporalDenoise == _typeOfShot && FrameStackingMethod::Mean == _temporalDenoise_stackingMethod;
+	if(ScreenshotType::Supersampling == _typeOfShot || ScreenshotType::MotionBlur == _typeOfShot || isMeanDenoise)
+	{
+		if(!_isTestRun)
+		{
+			if(!_frameAccumulator.isInitialized())
+			{
+				_frameAccumulator.initialize(_framebufferWidth, _framebufferHeight);
+			}
+			_frameAccumulator.addFrame(grabbedShot.data.data(), ScreenshotType::MotionBlur == _typeOfShot ? motionBlurShotWeight(grabbedShot.shotIndex) : 1.0f);
+		}
+		// the shot is in the accumulator, so only keep its metadata.
+		grabbedShot.data.clear();
+		grabbedShot.data.shrink_to_fit();
+	}
+	_grabbedFrames.push_back(std::move(grabbedShot));
+	if(_journal.isOpen())
+	{
+		writeJournaledShot(_grabbedFrames.back(), (int)_grabbedFrames.size() - 1);
+	}
+	return true;
+}
+
+
+void ScreenshotController::advanceToNextShot()
+{
+	_shotCounter++;
+	if(_shotCounter < _numberOfShotsToTake)
+	{
+		modifyCamera();
+		_convolutionFrameCounter = _numberOfFramesToWaitBetweenSteps;
+		return;
+	}
+	if(!_readbackRing.hasPendingReadbacks())
+	{
+		endShotTaking();
+	}
+}
+
+
+void ScreenshotController::endShotTaking()
+{
+	// we're done. Move to the next state, which is saving shots. 
+	_state = ScreenshotControllerState::SavingShots;
+	// tell the waiting thread to wake up so the system can proceed as normal.
+	_waitCompletionHandle.notify_all();
+}
+
+
+void ScreenshotController::storeGrabbedBracket(reshade::api::effect_runtime* runtime, GrabbedFrame grabbedBracket)
+{
+	if(grabbedBracket.data.size() <= 0)
+	{
+		// failed
+		return;
+	}
+	const int bracketIndex = _bracketing_currentBracket;
+	if(!_isTestRun)
+	{
+		if(0 == bracketIndex)
+		{
+			_hdrMerger.initialize(_framebufferWidth, _framebufferHeight);
+		}
+		_hdrMerger.addBracket(grabbedBracket.data.data(), bracketExposureStops(bracketIndex), 0 == bracketIndex, bracketIndex == _bracketing_numberOfBrackets - 1);
+	}
+	if(bracketIndex == (_bracketing_numberOfBrackets - 1) / 2)
+	{
+		_bracketing_referenceFrame = std::move(grabbedBracket);
+	}
+	_bracketing_currentBracket++;
+	if(_bracketing_currentBracket < _bracketing_numberOfBrackets)
+	{
+		// the camera doesn't move between brackets, so the uniform only has to be in effect, which takes a frame.
+		applyBracketExposure(runtime, _bracketing_currentBracket);
+		_convolutionFrameCounter = FramesToWaitBetweenBrackets;
+		return;
+	}
+	// all brackets of this shot have been taken. The next shot starts with the first bracket again, which is set while the camera moves.
+	_bracketing_currentBracket = 0;
+	applyBracketExposure(runtime, 0);
+	if(!_isTestRun)
+	{
+		_hdrMerger.resolve(_bracketing_referenceFrame.radiance);
+	}
+	storeGrabbedShot(std::move(_bracketing_referenceFrame));
+	_bracketing_referenceFrame = GrabbedFrame();
+	advanceToNextShot();
+}
+
+
+bool ScreenshotController::isBracketingSession()
+{
+	return _bracketing_enabled && (ScreenshotType::HorizontalPanorama == _typeOfShot || ScreenshotType::MultiShot == _typeOfShot || ScreenshotType::Orbit == _typeOfShot);
+}
+
+
+bool ScreenshotController::startBracketing(reshade::api::effect_runtime* runtime)
+{
+	_bracketing_stateAtStart = ReshadeStateSnapshot();
+	_bracketing_stateAtStart.obtainReshadeState(runtime);
+	if(!_bracketing_stateAtStart.getUniformFloatVariable(_bracketing_effectName, _bracketing_uniformName, _bracketing_referenceValue))
+	{
+		return false;
+	}
+	_bracketing_isActive = true;
+	_bracketing_currentBracket = 0;
+	applyBracketExposure(runtime, 0);
+	_convolutionFrameCounter = (std::max)(_convolutionFrameCounter, FramesToWaitBetweenBrackets);
+	return true;
+}
+
+
+void ScreenshotController::applyBracketExposure(reshade::api::effect_runtime* runtime, int bracketIndex)
+{
+	const float stops = bracketExposureStops(bracketIndex);
+	const float value = _bracketing_uniformIsMultiplier ? _bracketing_referenceValue * exp2f(stops) : _bracketing_referenceValue + stops;
+	_bracketing_stateAtStart.setUniformFloatVariable(runtime, _bracketing_effectName, _bracketing_uniformName, value);
+}
+
+
+float ScreenshotController::bracketExposureStops(int bracketIndex)
+{
+	return ((float)bracketIndex - 0.5f * (float)(_bracketing_numberOfBrackets - 1)) * _bracketing_stopsBetweenBrackets;
+}
+
+
+bool ScreenshotController::isDepthCaptureSession()
+{
+	// the other session types combine their shots into one image, for which there's no depth.
+	return _depth_enabled && !_isTestRun && (ScreenshotType::HorizontalPanorama == _typeOfShot || ScreenshotType::MultiShot == _typeOfShot || 
+											 ScreenshotType::Orbit == _typeOfShot);
+}
+
+
+bool ScreenshotController::isHighBitDepthSession()
+{
+	// merged brackets already have a high dynamic range, and test runs don't write anything.
+	return _highBitDepth_enabled && !_isTestRun && !isBracketingSession() && 
+		   (ScreenshotType::HorizontalPanorama == _typeOfShot || ScreenshotType::MultiShot == _typeOfShot || ScreenshotType::Orbit == _typeOfShot);
+}
+
+
+void ScreenshotController::saveRadianceToFile(const std::string& destinationFolder, const std::vector<float>& radiance, const std::string& shotFilenameStem)
+{
+	if(HighBitDepthFiletype::Png16Pq == _highBitDepth_filetype)
+	{
+		std::vector<uint16_t> pqData;
+		IGCS::HdrConversions::convertLinearToPq16(radiance, pqData);
+		IGCS::ImageFileWriters::writePng16(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), (shotFilenameStem + ".hdr.png").c_str()).c_str(), 
+										   pqData.data(), _framebufferWidth, _framebufferHeight, 3, true);
+		return;
+	}
+	IGCS::ImageFileWriters::writeExr(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), (shotFilenameStem + ".exr").c_str()).c_str(), 
+									 radiance.data(), _framebufferWidth, _framebufferHeight);
+}
+
+
+void ScreenshotController::saveDepthToFile(const std::string& destinationFolder, const std::vector<float>& rawDepth, const std::string& shotFilenameStem)
+{
+	std::vector<float> linearDepth(rawDepth.size());
+	IGCS::DepthBufferReader::linearizeDepth(rawDepth.data(), rawDepth.size(), _depth_nearPlane, _depth_farPlane, _depth_isReversed, linearDepth.data());
+	if(DepthFiletype::Png16 == _depth_filetype)
+	{
+		std::vector<uint16_t> depthValues;
+		IGCS::DepthBufferReader::linearDepthToUnorm16(linearDepth.data(), linearDepth.size(), _depth_nearPlane, _depth_farPlane, depthValues);
+		IGCS::ImageFileWriters::writePng16(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), (shotFilenameStem + ".depth.png").c_str()).c_str(), 
+										   depthValues.data(), _framebufferWidth, _framebufferHeight, 1);
+		return;
+	}
+	IGCS::ImageFileWriters::writeExrDepth(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), (shotFilenameStem + ".depth.exr").c_str()).c_str(), 
+										  linearDepth.data(), _framebufferWidth, _framebufferHeight);
+}
+
+
+void ScreenshotController::saveGrabbedShots()
+{
+	if(_grabbedFrames.size() <= 0)
+	{
+		return;
+	}
+	if(!_isTestRun)
+	{
+		_state = ScreenshotControllerState::SavingShots;
+		const std::string destinationFolder = _destinationFolder.empty() ? createScreenshotFolder() : _destinationFolder;
+		if(!_manifest.isOpen())
+		{
+			_manifest.create(destinationFolder, _typeOfShot, typeOfShotAsString(), _filetype, _numberOfShotsToTake);
+		}
+		// the shots of a journaled session have been written while they were taken, apart from the ones still queued at the writer.
+		const bool areShotsWritten = _journal.isOpen();
+		_shotWriter.stop();
+		int frameNumber = 0;
+		for(const GrabbedFrame& frame : _grabbedFrames)
+		{
+			// the frames of a temporal denoise session are only used for the stacked frame.
+			if(frame.data.size() > 0 && ScreenshotType::TemporalDenoise != _typeOfShot && !areShotsWritten)
+			{
+				saveShotWithManifestRecord(destinationFolder, frame, frameNumber);
+				if(frame.radiance.size() > 0)
+				{
+					saveRadianceToFile(destinationFolder, frame.radiance, createShotFilenameStem(frameNumber));
+				}
+				if(frame.depth.size() > 0)
+				{
+					saveDepthToFile(destinationFolder, frame.depth, createShotFilenameStem(frameNumber));
+				}
+			}
+			frameNumber++;
+		}
+		switch(_typeOfShot)
+		{
+		case ScreenshotType::HorizontalPanorama:
+			writePanoramaProjectFile(destinationFolder);
+			break;
+		case ScreenshotType::MultiShot:
+			if(LightfieldQuiltMode::QuiltOnly != _lightField_quiltMode)
+			{
+				writeLightfieldMetadataFile(destinationFolder);
+				writePoseDatasetFiles(destinationFolder);
+			}
+			if(_isResumedSession)
+			{
+				// the shots taken before the session was interrupted are only on disk, and everything below needs the shots themselves.
+				if(_lightField_writeRefocusedImages || _lightField_writeDisparityMap || _lightField_numberOfInterpolatedViews > 0 || 
+				   _lightField_writeWiggleAnimation || LightfieldQuiltMode::Off != _lightField_quiltMode)
+				{
+					OverlayControl::addNotification("The lightfield has been resumed, so the images made from all shots aren't created.");
+				}
+				break;
+			}
+			if(LightfieldQuiltMode::QuiltOnly != _lightField_quiltMode)
+			{
+				if(_lightField_writeRefocusedImages)
+				{
+					writeRefocusedImages(destinationFolder);
+				}
+				if(_lightField_writeDisparityMap)
+				{
+					writeDisparityMap(destinationFolder);
+				}
+			}
+			if(_lightField_numberOfInterpolatedViews > 0)
+			{
+				writeInterpolatedViews(destinationFolder);
+			}
+			if(_quiltBuilder.hasViews())
+			{
+				writeQuilt(destinationFolder);
+			}
+			if(_lightField_writeWiggleAnimation)
+			{
+				writeWiggleAnimation(destinationFolder);
+			}
+			break;
+		case ScreenshotType::Supersampling:
+			writeAccumulatedImage(destinationFolder, "supersampled");
+			break;
+		case ScreenshotType::MotionBlur:
+			writeAccumulatedImage(destinationFolder, "motionblur");
+			break;
+		case ScreenshotType::TemporalDenoise:
+			writeStackedImage(destinationFolder);
+			break;
+		case ScreenshotType::Orbit:
+			// the shots are taken for photogrammetry, so the exact poses are what matters.
+			writePoseDatasetFiles(destinationFolder);
+			break;
+		}
+		// everything has been written, so the session isn't offered for resuming anymore.
+		_journal.markComplete();
+		_manifest.close();
+		if(_archivalRecompression_enabled && ScreenshotFiletype::Png == _filetype)
+		{
+			_archivalRecompressor.enqueueFolder(destinationFolder, typeOfShotAsString());
+		}
+	}
+}
+
+
+void ScreenshotController::writePanoramaProjectFile(const std::string& destinationFolder)
+{
+	HuginProjectData projectData;
+	projectData.imageWidth = _framebufferWidth;
+	projectData.imageHeight = _framebufferHeight;
+	// with a region of interest, the shots are a part of the frame the fov applies to, with the optical axis outside their center. 
+	const float focalLength = focalLengthInPixels(_pano_currentFoVRadians);
+	projectData.horizontalFoVDegrees = 2.0f * atanf(0.5f * _framebufferWidth / focalLength) * (180.0f / DirectX::XM_PI);
+	projectData.imageShiftX = 0.5f * _frameWidth - (_captureRegion.left + 0.5f * _captureRegion.width);
+	projectData.imageShiftY = 0.5f * _frameHeight - (_captureRegion.top + 0.5f * _captureRegion.height);
+	projectData.totalFoVDegrees = _pano_totalFoVRadians * (180.0f / DirectX::XM_PI);
+	projectData.overlapPercentage = _overlapPercentagePerPanoShot;
+	// The first shot is taken after the camera has been rotated to the start position (see moveCameraForPanorama), every next shot is rotated one step to the right.
+	const float startAngleRadians = -_pano_anglePerStep * 0.5f * _numberOfShotsToTake;
+	for(int i = 0; i < _grabbedFrames.size(); i++)
+	{
+		projectData.imageFilenames.push_back(createShotFilename(i));
+		projectData.yawDegrees.push_back((startAngleRadians + (i * _pano_anglePerStep)) * (180.0f / DirectX::XM_PI));
+	}
+	const std::string projectFilename = IGCS::Utils::formatString("%s\\panorama.pto", destinationFolder.c_str());
+	if(!IGCS::HuginProjectWriter::writeProject(projectFilename, projectData))
+	{
+		OverlayControl::addNotification("Couldn't write the Hugin project file for the panorama.");
+	}
+}
+
+
+void ScreenshotController::writePoseDatasetFiles(const std::string& destinationFolder)
+{
+	PoseDatasetData datasetData;
+	datasetData.imageWidth = _framebufferWidth;
+	datasetData.imageHeight = _framebufferHeight;
+	if(_regionOfInterest_enabled)
+	{
+		datasetData.frameWidth = _frameWidth;
+		datasetData.frameHeight = _frameHeight;
+		datasetData.regionLeft = _captureRegion.left;
+		datasetData.regionTop = _captureRegion.top;
+	}
+	for(int i = 0; i < _grabbedFrames.size(); i++)
+	{
+		if(!_grabbedFrames[i].hasPose)
+		{
+			// no camera data available, so nothing to export.
+			return;
+		}
+		datasetData.imageFilenames.push_back(createShotFilename(i));
+		datasetData.poses.push_back(_grabbedFrames[i].pose);
+	}
+	if(!IGCS::PoseDatasetWriter::writeColmapModel(destinationFolder, datasetData) || !IGCS::PoseDatasetWriter::writeNerfTransforms(destinationFolder, datasetData))
+	{
+		OverlayControl::addNotification("Couldn't write the camera pose files for the session.");
+	}
+}
+
+
+void ScreenshotController::writeLightfieldMetadataFile(const std::string& destinationFolder)
+{
+	FILE* metadataFile = nullptr;
+	if(fopen_s(&metadataFile, IGCS::Utils::formatString("%s\\lightfield.json", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == metadataFile)
+	{
+		OverlayControl::addNotification("Couldn't write the lightfield metadata file for the session.");
+		return;
+	}
+	fprintf(metadataFile, "{\n");
+	fprintf(metadataFile, "\t\"rows\": %d,\n\t\"columns\": %d,\n", _lightField_numberOfRows, _lightField_numberOfColumns);
+	fprintf(metadataFile, "\t\"horizontalSpacing\": %.6f,\n\t\"verticalSpacing\": %.6f,\n", _lightField_distancePerStep, _lightField_distancePerRow);
+	fprintf(metadataFile, "\t\"captureOrder\": \"serpentine\",\n");
+	fprintf(metadataFile, "\t\"width\": %u,\n\t\"height\": %u,\n", _framebufferWidth, _framebufferHeight);
+	fprintf(metadataFile, "\t\"views\": [\n");
+	// views are written in row-major order, which is what most lightfield tools expect. Offsets are in world units relative to the camera location at the start
+	// of the session, positive x is to the right, positive y is up.
+	const std::vector<int> frameIndexPerGridCell = createFrameIndexPerGridCell();
+	bool isFirstView = true;
+	for(const int frameIndex : frameIndexPerGridCell)
+	{
+		if(frameIndex < 0)
+		{
+			continue;
+		}
+		const GrabbedFrame& frame = _grabbedFrames[frameIndex];
+		const float offsetX = (frame.gridColumn - 0.5f * _lightField_numberOfColumns) * _lightField_distancePerStep;
+		const float offsetY = (0.5f * (_lightField_numberOfRows - 1) - frame.gridRow) * _lightField_distancePerRow;
+		fprintf(metadataFile, "%s\t\t{ \"file\": \"%s\", \"row\": %d, \"column\": %d, \"captureIndex\": %d, \"offsetX\": %.6f, \"offsetY\": %.6f }",
+				isFirstView ? "" : ",\n", createShotFilename(frameIndex).c_str(), frame.gridRow, frame.gridColumn, frameIndex, offsetX, offsetY);
+		isFirstView = false;
+	}
+	fprintf(metadataFile, "\n\t]");
+	if(_lightField_numberOfInterpolatedViews > 0)
+	{
+		// column is fractional for interpolated views: the position between the shot at the column to the left and the one to the right.
+		fprintf(metadataFile, ",\n\t\"interpolatedViewsBetweenShots\": %d,\n\t\"interpolatedViews\": [\n", _lightField_numberOfInterpolatedViews);
+		isFirstView = true;
+		for(int row = 0; row < _lightField_numberOfRows; row++)
+		{
+			for(int column = 0; column < _lightField_numberOfColumns - 1; column++)
+			{
+				for(int viewIndex = 1; viewIndex <= _lightField_numberOfInterpolatedViews; viewIndex++)
+				{
+					const float position = column + (float)viewIndex / (_lightField_numberOfInterpolatedViews + 1);
+					const float offsetX = (position - 0.5f * _lightField_numberOfColumns) * _lightField_distancePerStep;
+					const float offsetY = (0.5f * (_lightField_numberOfRows - 1) - row) * _lightField_distancePerRow;
+					fprintf(metadataFile, "%s\t\t{ \"file\": \"%s\", \"row\": %d, \"column\": %.6f, \"offsetX\": %.6f, \"offsetY\": %.6f }",
+							isFirstView ? "" : ",\n", createInterpolatedViewFilename(row, column, viewIndex).c_str(), row, position, offsetX, offsetY);
+					isFirstView = false;
+				}
+			}
+		}
+		fprintf(metadataFile, "\n\t]");
+	}
+	fprintf(metadataFile, "\n}\n");
+	fclose(metadataFile);
+}
+
+
+std::vector<int> ScreenshotController::createFrameIndexPerGridCell()
+{
+	std::vector<int> frameIndexPerGridCell((size_t)_lightField_numberOfColumns * _lightField_numberOfRows, -1);
+	for(int i = 0; i < _grabbedFrames.size(); i++)
+	{
+		const int gridCellIndex = _grabbedFrames[i].gridRow * _lightField_numberOfColumns + _grabbedFrames[i].gridColumn;
+		if(gridCellIndex >= 0 && gridCellIndex < frameIndexPerGridCell.size())
+		{
+			frameIndexPerGridCell[gridCellIndex] = i;
+		}
+	}
+	return frameIndexPerGridCell;
+}
+
+
+void ScreenshotController::writeInterpolatedViews(const std::string& destinationFolder)
+{
+	const std::vector<int> frameIndexPerGridCell = createFrameIndexPerGridCell();
+	const bool writeFiles = LightfieldQuiltMode::QuiltOnly != _lightField_quiltMode;
+	const int quiltRow = (_lightField_numberOfRows - 1) / 2;
+	ViewInterpolator interpolator;
+	std::vector<uint8_t> interpolatedView;
+	for(int row = 0; row < _lightField_numberOfRows; row++)
+	{
+		if(!writeFiles && row != quiltRow)
+		{
+			continue;
+		}
+		for(int column = 0; column < _lightField_numberOfColumns - 1; column++)
+		{
+			const int leftFrameIndex = frameIndexPerGridCell[row * _lightField_numberOfColumns + column];
+			const int rightFrameIndex = frameIndexPerGridCell[row * _lightField_numberOfColumns + column + 1];
+			if(leftFrameIndex < 0 || rightFrameIndex < 0 || _grabbedFrames[leftFrameIndex].data.size() <= 0 || _grabbedFrames[rightFrameIndex].data.size() <= 0)
+			{
+				continue;
+			}
+			interpolator.prepare(_grabbedFrames[leftFrameIndex].data.data(), _grabbedFrames[rightFrameIndex].data.data(), _framebufferWidth, _framebufferHeight,
+								 _lightField_maximumDisparity);
+			for(int viewIndex = 1; viewIndex <= _lightField_numberOfInterpolatedViews; viewIndex++)
+			{
+				interpolator.synthesizeView((float)viewIndex / (_lightField_numberOfInterpolatedViews + 1), interpolatedView);
+				if(writeFiles)
+				{
+					saveShotToFile(destinationFolder, interpolatedView, createInterpolatedViewFilename(row, column, viewIndex));
+				}
+				if(_quiltBuilder.hasViews() && row == quiltRow)
+				{
+					_quiltBuilder.addView(quiltViewIndex(column, viewIndex), interpolatedView.data(), _framebufferWidth, _framebufferHeight);
+				}
+			}
+		}
+	}
+}
+
+
+std::string ScreenshotController::createInterpolatedViewFilename(int row, int column, int viewIndex)
+{
+	// the name starts with the name of the shot to the left, so the files sort in the order of the views.
+	const std::string extension = fileExtensionForFiletype();
+	if(_lightField_numberOfRows > 1)
+	{
+		return IGCS::Utils::formatString("%.2d_%.2d_%d.%s", row, column, viewIndex, extension.c_str()).c_str();
+	}
+	return IGCS::Utils::formatString("%d_%d.%s", column, viewIndex, extension.c_str()).c_str();
+}
+
+
+void ScreenshotController::writeRefocusedImages(const std::string& destinationFolder)
+{
+	if(_lightField_numberOfColumns <= 0)
+	{
+		return;
+	}
+	std::vector<int> frameIndexPerView;
+	const std::vector<LightfieldView> views = createLightfieldViews(frameIndexPerView);
+	if(views.size() <= 0)
+	{
+		return;
+	}
+	// one image at a time, so the memory needed doesn't grow with the number of focus planes.
+	std::vector<uint8_t> refocusedImage;
+	for(int i = 0; i < _lightField_refocusNumberOfFocusPlanes; i++)
+	{
+		const float disparity = _lightField_refocusNumberOfFocusPlanes > 1
+									? _lightField_refocusMinimumDisparity + (_lightField_refocusMaximumDisparity - _lightField_refocusMinimumDisparity) * i / (_lightField_refocusNumberOfFocusPlanes - 1)
+									: _lightField_refocusMinimumDisparity;
+		IGCS::LightfieldRefocuser::refocus(views, _framebufferWidth, _framebufferHeight, disparity, refocusedImage);
+		saveShotToFile(destinationFolder, refocusedImage, IGCS::Utils::formatString("refocused_%.2d_disparity_%.2f.%s", i, disparity, fileExtensionForFiletype().c_str()).c_str());
+	}
+}
+
+
+void ScreenshotController::writeDisparityMap(const std::string& destinationFolder)
+{
+	if(_lightField_numberOfColumns <= 0 || _lightField_maximumDisparity <= 0.0f)
+	{
+		return;
+	}
+	std::vector<int> frameIndexPerView;
+	const std::vector<LightfieldView> views = createLightfieldViews(frameIndexPerView);
+	if(views.size() < 2)
+	{
+		// the disparity is estimated from the differences between shots.
+		return;
+	}
+	// the reference is the shot closest to the center of the grid.
+	int referenceViewIndex = 0;
+	for(int i = 0; i < views.size(); i++)
+	{
+		if(fabsf(views[i].u) + fabsf(views[i].v) < fabsf(views[referenceViewIndex].u) + fabsf(views[referenceViewIndex].v))
+		{
+			referenceViewIndex = i;
+		}
+	}
+	const int referenceFrameIndex = frameIndexPerView[referenceViewIndex];
+	std::vector<float> disparities;
+	IGCS::LightfieldDepthEstimator::estimateDisparity(views, referenceViewIndex, _framebufferWidth, _framebufferHeight, _lightField_maximumDisparity, disparities);
+
+	const float valueScale = _lightField_maximumDisparity / 65535.0f;
+	std::vector<uint16_t> values(disparities.size());
+	for(size_t i = 0; i < disparities.size(); i++)
+	{
+		values[i] = (uint16_t)std::clamp(disparities[i] / valueScale + 0.5f, 0.0f, 65535.0f);
+	}
+	if(!IGCS::ImageFileWriters::writePng16(IGCS::Utils::formatString("%s\\disparity.png", destinationFolder.c_str()).c_str(), values.data(), _framebufferWidth, _framebufferHeight, 1))
+	{
+		OverlayControl::addNotification("Couldn't write the disparity map for the session.");
+		return;
+	}
+
+	FILE* metadataFile = nullptr;
+	if(fopen_s(&metadataFile, IGCS::Utils::formatString("%s\\disparity.json", destinationFolder.c_str()).c_str(), "w") != 0 || nullptr == metadataFile)
+	{
+		return;
+	}
+	fprintf(metadataFile, "{\n");
+	fprintf(metadataFile, "\t\"referenceImage\": \"%s\",\n", createShotFilename(referenceFrameIndex).c_str());
+	fprintf(metadataFile, "\t\"maximumDisparity\": %.6f,\n", _lightField_maximumDisparity);
+	// disparity in pixels between two neighbouring shots = value * valueScale.
+	fprintf(metadataFile, "\t\"valueScale\": %.9g", valueScale);
+	const GrabbedFrame& referenceFrame = _grabbedFrames[referenceFrameIndex];
+	if(referenceFrame.hasPose && referenceFrame.pose.fovDegrees > 0.0f)
+	{
+		// depth along the view direction, in world units = depthFactor / disparity. The fov is the horizontal fov, like in the pose dataset.
+		const float focalLength = focalLengthInPixels(IGCS::Utils::degreesToRadians(referenceFrame.pose.fovDegrees));
+		fprintf(metadataFile, ",\n\t\"depthFactor\": %.9g", _lightField_distancePerStep * focalLength);
+	}
+	fprintf(metadataFile, "\n}\n");
+	fclose(metadataFile);
+}
+
+
+void ScreenshotController::writeAccumulatedImage(const std::string& destinationFolder, const std::string& filename)
+{
+	std::vector<uint8_t> resolvedImage;
+	_frameAccumulator.resolve(resolvedImage);
+	if(resolvedImage.size() <= 0)
+	{
+		return;
+	}
+	saveImageToFile(IGCS::Utils::formatString("%s\\%s.%s", destinationFolder.c_str(), filename.c_str(), fileExtensionForFiletype().c_str()).c_str(), resolvedImage, 
+					_frameAccumulator.width(), _frameAccumulator.height());
+}
+
+
+void ScreenshotController::writeStackedImage(const std::string& destinationFolder)
+{
+	if(FrameStackingMethod::Mean == _temporalDenoise_stackingMethod)
+	{
+		writeAccumulatedImage(destinationFolder, "denoised");
+		return;
+	}
+	std::vector<const uint8_t*> frames;
+	for(const GrabbedFrame& frame : _grabbedFrames)
+	{
+		if(frame.data.size() > 0)
+		{
+			frames.push_back(frame.data.data());
+		}
+	}
+	if(frames.size() <= 0)
+	{
+		return;
+	}
+	std::vector<uint8_t> stackedImage;
+	IGCS::FrameStacker::stack(frames, (size_t)_framebufferWidth * _framebufferHeight * 3, _temporalDenoise_stackingMethod, stackedImage);
+	saveImageToFile(IGCS::Utils::formatString("%s\\denoised.%s", destinationFolder.c_str(), fileExtensionForFiletype().c_str()).c_str(), stackedImage, 
+					_framebufferWidth, _framebufferHeight);
+}
+
+
+void ScreenshotController::writeQuilt(const std::string& destinationFolder)
+{
+	const std::string filename = IGCS::Utils::formatString("%s\\quilt%s.%s", destinationFolder.c_str(), _quiltBuilder.createFilenameSuffix().c_str(), 
+															fileExtensionForFiletype().c_str());
+	saveImageToFile(filename, _quiltBuilder.data(), _quiltBuilder.width(), _quiltBuilder.height());
+}
+
+
+void ScreenshotController::writeWiggleAnimation(const std::string& destinationFolder)
+{
+	// the shots of the middle row, left to right and back again, without repeating the outer shots, so the animation loops smoothly.
+	const std::vector<int> frameIndexPerGridCell = createFrameIndexPerGridCell();
+	const int row = (_lightField_numberOfRows - 1) / 2;
+	std::vector<const uint8_t*> rowFrames;
+	for(int column = 0; column < _lightField_numberOfColumns; column++)
+	{
+		const int frameIndex = frameIndexPerGridCell[(size_t)row * _lightField_numberOfColumns + column];
+		if(frameIndex >= 0 && _grabbedFrames[frameIndex].data.size() > 0)
+		{
+			rowFrames.push_back(_grabbedFrames[frameIndex].data.data());
+		}
+	}
+	if(rowFrames.size() < 2)
+	{
+		return;
+	}
+	std::vector<const uint8_t*> animationFrames = rowFrames;
+	animationFrames.insert(animationFrames.end(), rowFrames.rbegin() + 1, rowFrames.rend() - 1);
+	ApngWriter writer;
+	if(!writer.open(IGCS::Utils::formatString("%s\\wiggle.png", destinationFolder.c_str()).c_str(), _framebufferWidth, _framebufferHeight, 1, 
+					WiggleAnimationFramesPerSecond, 0) || !writer.addFrames(animationFrames) || !writer.close())
+	{
+		OverlayControl::addNotification("Couldn't write the wiggle animation for the session.");
+	}
+}
+
+
+std::vector<LightfieldView> ScreenshotController::createLightfieldViews(std::vector<int>& frameIndexPerView)
+{
+	// disparities are specified in pixels per horizontal step, so the vertical positions are scaled with the ratio between the row and column spacing.
+	const float verticalScale = _lightField_distancePerStep > 0.0f ? _lightField_distancePerRow / _lightField_distancePerStep : 0.0f;
+	std::vector<LightfieldView> views;
+	views.reserve(_grabbedFrames.size());
+	frameIndexPerView.clear();
+	for(int i = 0; i < _grabbedFrames.size(); i++)
+	{
+		const GrabbedFrame& frame = _grabbedFrames[i];
+		if(frame.data.size() <= 0)
 		{
-			fwrite(encoded_data.data(), encoded_data.size(), 1, pngFile);
+			// a shot which couldn't be read back.
+			continue;
 		}
-		if(nullptr != pngFile)
+		frameIndexPerView.push_back(i);
+		LightfieldView view;
+		view.data = frame.data.data();
+		view.u = frame.gridColumn - 0.5f * (_lightField_numberOfColumns - 1);
+		view.v = (frame.gridRow - 0.5f * (_lightField_numberOfRows - 1)) * verticalScale;
+		views.push_back(view);
+	}
+	return views;
+}
+
+
+std::string ScreenshotController::createShotFilename(int frameNumber)
+{
+	return createShotFilename(frameNumber, fileExtensionForFiletype());
+}
+
+
+std::string ScreenshotController::createShotFilename(int frameNumber, const std::string& extension)
+{
+	return createShotFilenameStem(frameNumber) + "." + extension;
+}
+
+
+std::string ScreenshotController::createShotFilenameStem(int frameNumber)
+{
+	if(ScreenshotType::MultiShot == _typeOfShot && _lightField_numberOfRows > 1 && frameNumber < _grabbedFrames.size())
+	{
+		// grid: use row_column so the files sort in row-major order.
+		const GrabbedFrame& frame = _grabbedFrames[frameNumber];
+		return IGCS::Utils::formatString("%.2d_%.2d", frame.gridRow, frame.gridColumn).c_str();
+	}
+	return IGCS::Utils::formatString("%d", frameNumber).c_str();
+}
+
+
+std::string ScreenshotController::fileExtensionForFiletype()
+{
+	return IGCS::ImageFileWriters::fileExtension(_filetype);
+}
+
+
+void ScreenshotController::saveShotToFile(std::string destinationFolder, const std::vector<uint8_t>& data, const std::string& filenameWithoutFolder)
+{
+	saveImageToFile(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), filenameWithoutFolder.c_str()).c_str(), data, _framebufferWidth, _framebufferHeight);
+}
+
+
+void ScreenshotController::saveShotWithManifestRecord(const std::string& destinationFolder, const GrabbedFrame& shot, int frameNumber)
+{
+	const std::string filename = createShotFilename(frameNumber);
+	const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+	std::vector<uint8_t> encodedData;
+	if(!IGCS::ImageFileWriters::encodeImage(_filetype, shot.data.data(), _framebufferWidth, _framebufferHeight, encodedData))
+	{
+		return;
+	}
+	SessionManifestRecord record = createManifestRecord(shot, filename);
+	record.encodeMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - encodeStart).count();
+	record.numberOfBytes = (uint32_t)IGCS::ImageFileWriters::writeEncodedImage(IGCS::Utils::formatString("%s\\%s", destinationFolder.c_str(), filename.c_str()).c_str(), 
+																			  encodedData);
+	if(0 == record.numberOfBytes)
+	{
+		return;
+	}
+	record.crc32 = fpng::fpng_crc32(encodedData.data(), encodedData.size());
+	_manifest.appendShot(record);
+}
+
+
+SessionManifestRecord ScreenshotController::createManifestRecord(const GrabbedFrame& shot, const std::string& filename)
+{
+	SessionManifestRecord record = {};
+	record.shotIndex = shot.shotIndex;
+	record.width = _framebufferWidth;
+	record.height = _framebufferHeight;
+	if(shot.hasPose)
+	{
+		record.flags |= SessionManifestRecordFlags::HasPose;
+		memcpy(record.position, shot.pose.position, sizeof(record.position));
+		memcpy(record.orientation, shot.pose.orientation, sizeof(record.orientation));
+		record.fovDegrees = shot.pose.fovDegrees;
+	}
+	determineStepOffset(shot, record.stepOffset[0], record.stepOffset[1]);
+	record.captureTimeMicroseconds = shot.captureTimeMicroseconds;
+	record.numberOfFramesWaited = shot.numberOfFramesWaited;
+	memcpy(record.filename, filename.c_str(), (std::min)(filename.size(), sizeof(record.filename) - 1));
+	return record;
+}
+
+
+void ScreenshotController::determineStepOffset(const GrabbedFrame& shot, float& horizontalOffset, float& verticalOffset)
+{
+	horizontalOffset = 0.0f;
+	verticalOffset = 0.0f;
+	switch(_typeOfShot)
+	{
+	case ScreenshotType::HorizontalPanorama:
+		// the same angles as in the Hugin project file.
+		horizontalOffset = (-_pano_anglePerStep * 0.5f * _numberOfShotsToTake + shot.shotIndex * _pano_anglePerStep) * (180.0f / DirectX::XM_PI);
+		break;
+	case ScreenshotType::MultiShot:
+		// the same offsets as in lightfield.json.
+		horizontalOffset = (shot.gridColumn - 0.5f * _lightField_numberOfColumns) * _lightField_distancePerStep;
+		verticalOffset = (0.5f * (_lightField_numberOfRows - 1) - shot.gridRow) * _lightField_distancePerRow;
+		break;
+	case ScreenshotType::Orbit:
+		if(_orbit_layout.numberOfShotsPerRing > 0)
 		{
-			fclose(pngFile);
+			// the layout of OrbitPlanner::planOrbit: ring after ring, from the lowest elevation to the highest.
+			const int ring = shot.shotIndex / _orbit_layout.numberOfShotsPerRing;
+			const float ringFraction = _orbit_layout.numberOfRings > 1 ? (float)ring / (float)(_orbit_layout.numberOfRings - 1) : 0.5f;
+			horizontalOffset = 360.0f * (float)(shot.shotIndex % _orbit_layout.numberOfShotsPerRing) / (float)_orbit_layout.numberOfShotsPerRing;
+			verticalOffset = _orbit_layout.minimumElevationDegrees + ringFraction * (_orbit_layout.maximumElevationDegrees - _orbit_layout.minimumElevationDegrees);
 		}
 		break;
 	}
 }
 
 
+void ScreenshotController::stampShot(GrabbedFrame& shot)
+{
+	shot.captureTimeMicroseconds = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	shot.numberOfFramesWaited = _numberOfFramesSinceLastShot;
+	_numberOfFramesSinceLastShot = 0;
+}
+
+
+void ScreenshotController::saveImageToFile(const std::string& filename, const std::vector<uint8_t>& data, int width, int height)
+{
+	// The shot data is RGB as we packed the RGBA data as RGB as Alpha is 0 in the source.
+	IGCS::ImageFileWriters::writeImage(filename, _filetype, data.data(), width, height);
+}
+
+
 void ScreenshotController::waitForShots()
 {
 	std::unique_lock lock(_waitCompletionMutex);
@@ -497,11 +2132,30 @@ void ScreenshotController::reset()
 	_pano_totalFoVRadians = 0.0f;
 	_pano_currentFoVRadians = 0.0f;
 	_lightField_distancePerStep = 0.0f;
+	_lightField_distancePerRow = 0.0f;
+	_lightField_numberOfColumns = 0;
+	_lightField_numberOfRows = 1;
 	_pano_anglePerStep = 0.0f;
 	_numberOfShotsToTake = 0;
 	_convolutionFrameCounter = 0;
 	_shotCounter = 0;
 	_overlapPercentagePerPanoShot = 30.0f;
 	_isTestRun = false;
+	// the shots still queued are written and journaled first. An unfinished journal stays on disk, so the session can be resumed.
+	_shotWriter.stop();
+	_journal.close();
+	_manifest.close();
+	_destinationFolder.clear();
+	_isResumedSession = false;
 	_grabbedFrames.clear();
+	_quiltBuilder.reset();
+	_supersampling_referenceDistance = 0.0f;
+	_supersampling_currentFoVRadians = 0.0f;
+	_motionBlur_currentFoVDegrees = 0.0f;
+	_orbit_layout = OrbitLayout();
+	_orbit_poses.clear();
+	_frameAccumulator.reset();
+	_bracketing_currentBracket = 0;
+	_bracketing_referenceFrame = GrabbedFrame();
+	_hdrMerger.reset();
 }
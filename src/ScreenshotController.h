@@ -36,7 +36,20 @@
 #include <string>
 
 #include "CameraToolsConnector.h"
+#include "CameraToolsData.h"
 #include "ConstantsEnums.h"
+#include "GrabbedFrame.h"
+#include "OrbitPlanner.h"
+#include "LightfieldRefocuser.h"
+#include "QuiltBuilder.h"
+#include "FrameAccumulator.h"
+#include "HdrMerger.h"
+#include "AsyncReadbackRing.h"
+#include "ReshadeStateSnapshot.h"
+#include "SessionJournal.h"
+#include "SessionManifest.h"
+#include "ArchivalRecompressor.h"
+#include "StreamingEncoder.h"
 
 
 // Simple controller class which controls the screenshot session.
@@ -46,10 +59,117 @@ public:
 	ScreenshotController(CameraToolsConnector& connector);
 	~ScreenshotController() = default;
 
-	void configure(std::string rootFolder, int numberOfFramesToWaitBetweenSteps, ScreenshotFiletype filetype);
+	void configure(std::string rootFolder, int numberOfFramesToWaitBetweenSteps, ScreenshotFiletype filetype, CameraToolsData* cameraToolsData);
 	void startHorizontalPanoramaShot(float totalFoVInDegrees, float overlapPercentagePerPanoShot, float currentFoVInDegrees, bool isTestRun);
-	void startLightfieldShot(float distancePerStep, int numberOfShots, bool isTestRun);
+	/// <summary>
+	/// Starts a lightfield session. With more than 1 row, the camera walks a grid of numberOfShotsPerRow x numberOfRows positions in serpentine order
+	/// </summary>
+	void startLightfieldShot(float distancePerStep, int numberOfShotsPerRow, float distancePerRow, int numberOfRows, bool isTestRun);
+	/// <summary>
+	/// Configures the refocused images written after a lightfield session. Disparities are in pixels between two neighbouring shots. The focus planes are
+	/// spread evenly over the disparity range.
+	/// </summary>
+	void configureLightfieldRefocusing(bool writeRefocusedImages, float minimumDisparity, float maximumDisparity, int numberOfFocusPlanes);
+	/// <summary>
+	/// Configures the disparity map written after a lightfield session. The maximum disparity is in pixels between two neighbouring shots.
+	/// </summary>
+	void configureLightfieldDisparityMap(bool writeDisparityMap, float maximumDisparity);
+	/// <summary>
+	/// Configures the number of views synthesized between every two neighbouring shots in a row of a lightfield. 0 switches interpolation off. 
+	/// </summary>
+	void configureLightfieldInterpolation(int numberOfInterpolatedViews);
+	/// <summary>
+	/// Configures whether a wiggle animation is written after a lightfield session: an animated PNG which plays the shots of the middle row back and forth. 
+	/// </summary>
+	void configureLightfieldWiggleAnimation(bool writeWiggleAnimation);
+	/// <summary>
+	/// Configures the quilt assembled from the lightfield shots. With a grid, the quilt is made from the middle row.
+	/// </summary>
+	void configureLightfieldQuilt(LightfieldQuiltMode quiltMode, int numberOfColumns, int quiltWidth);
+	/// <summary>
+	/// Starts a supersampling session: the camera is moved in sub-pixel offsets following a Halton pattern and the shots are averaged into a single
+	/// anti-aliased image. The offsets are exact for objects at the reference distance from the camera.
+	/// </summary>
+	void startSupersamplingShot(int numberOfSamples, float referenceDistance, float currentFoVInDegrees, bool isTestRun);
+	/// <summary>
+	/// Configures the movement of the camera during a motion blur session. The movement is centered on the current camera location.
+	/// </summary>
+	/// <param name="movementType">translation moves the camera, rotation rotates the camera to the right</param>
+	/// <param name="distanceRight">translation: distance, in world units, the camera moves to the right while the shutter is open</param>
+	/// <param name="distanceUp">translation: distance, in world units, the camera moves up while the shutter is open</param>
+	/// <param name="fovChangeDegrees">translation: change of the field of view while the shutter is open, for zoom blur</param>
+	/// <param name="angleDegrees">rotation: angle the camera rotates to the right while the shutter is open</param>
+	/// <param name="shutterShape">how the shots are weighted over the time the shutter is open</param>
+	void configureMotionBlur(MotionBlurMovementType movementType, float distanceRight, float distanceUp, float fovChangeDegrees, float angleDegrees, ShutterShape shutterShape);
+	/// <summary>
+	/// Starts a motion blur session: the camera is stepped through the configured movement and the weighted shots are accumulated into a single image.
+	/// </summary>
+	void startMotionBlurShot(int numberOfSamples, float currentFoVInDegrees, bool isTestRun);
+	/// <summary>
+	/// Starts a temporal denoise session: the camera isn't moved, and the frames taken are combined into a single frame with the stacking method specified.
+	/// </summary>
+	void startTemporalDenoiseShot(int numberOfFrames, FrameStackingMethod stackingMethod, bool isTestRun);
+	/// <summary>
+	/// Starts an orbit session: the camera is placed at every pose of the orbit layout around the point in front of the camera, looking at that point. 
+	/// Every pose is absolute, so errors don't add up. Requires camera tools which can set the camera pose.
+	/// </summary>
+	void startOrbitShot(const OrbitLayout& layout, bool isTestRun);
 	void startDebugGridShot();
+	/// <summary>
+	/// Resumes the most recent panorama, lightfield or orbit session in the root folder which didn't complete, e.g. because the game crashed. The camera
+	/// is placed at the start pose of the session and moved to the first shot which isn't on disk, and the session continues from there. 
+	/// </summary>
+	void resumeInterruptedSession();
+	/// <summary>
+	/// Configures exposure bracketing for panorama, lightfield and orbit sessions: every shot is taken numberOfBrackets times, with the float uniform specified
+	/// changed to expose stopsBetweenBrackets stops apart, centered on its current value. The brackets are merged into an HDR image per shot.
+	/// </summary>
+	/// <param name="enabled"></param>
+	/// <param name="effectName">the effect file containing the uniform, e.g. Tonemap.fx</param>
+	/// <param name="uniformName">the uniform which controls the exposure</param>
+	/// <param name="uniformIsMultiplier">true if the uniform is multiplied with the color, false if it's in stops</param>
+	/// <param name="numberOfBrackets"></param>
+	/// <param name="stopsBetweenBrackets"></param>
+	void configureExposureBracketing(bool enabled, const std::string& effectName, const std::string& uniformName, bool uniformIsMultiplier, int numberOfBrackets, 
+									 float stopsBetweenBrackets);
+	/// <summary>
+	/// Configures high bit depth capture for panorama, lightfield and orbit sessions: if the backbuffer is a 10 bit or 16 bit float format, every shot is also read
+	/// at full precision and written as HDR image in the file type specified. The file type is also used for merged exposure brackets.
+	/// </summary>
+	/// <param name="enabled"></param>
+	/// <param name="tenBitIsPq">true if 10 bit backbuffers are HDR10 (PQ, BT.2020), false if they're SDR</param>
+	/// <param name="filetype"></param>
+	void configureHighBitDepth(bool enabled, bool tenBitIsPq, HighBitDepthFiletype filetype);
+	/// <summary>
+	/// Configures whether shots are read from the gpu asynchronously, through a ring of readback textures, instead of stalling the render thread per shot.
+	/// </summary>
+	void configureAsynchronousCapture(bool enabled);
+	/// <summary>
+	/// Configures the region of interest: if enabled, only the rectangle specified of every shot is captured, stored and written. The rectangle is specified
+	/// in fractions (0-1) of the backbuffer size.
+	/// </summary>
+	void configureRegionOfInterest(bool enabled, float left, float top, float width, float height);
+	/// <summary>
+	/// Configures depth capture for panorama, lightfield and orbit sessions: the depth buffer ReShade uses for its effects is read along with every shot, linearized
+	/// with the near and far plane specified and written next to the shot in the file type specified. With asynchronous capture, the depth buffer is read
+	/// asynchronously as well.
+	/// </summary>
+	/// <param name="enabled"></param>
+	/// <param name="nearPlane">the distance to the near plane of the game's projection</param>
+	/// <param name="farPlane">the distance to the far plane of the game's projection</param>
+	/// <param name="isReversed">true if the game uses reversed Z, where the near plane is 1 and the far plane is 0 in the depth buffer</param>
+	/// <param name="filetype"></param>
+	void configureDepthCapture(bool enabled, float nearPlane, float farPlane, bool isReversed, DepthFiletype filetype);
+	/// <summary>
+	/// Configures whether the PNG files of a session are recompressed in the background once the session has been written, which makes them 20-30%
+	/// smaller at the cost of a lot of cpu time. Only used if the file type is PNG.
+	/// </summary>
+	void configureArchivalRecompression(bool enabled);
+	ArchivalRecompressor& archivalRecompressor() { return _archivalRecompressor; }
+	/// <summary>
+	/// Returns true if the camera tools support the sessions which need absolute camera poses, like an orbit.
+	/// </summary>
+	bool canSetCameraPose() { return _cameraToolsConnector.canSetCameraPose(); }
 	ScreenshotControllerState getState() { return _state; }
 	void reset();
 	bool shouldTakeShot();		// returns true if a shot should be taken, false otherwise. 
@@ -67,11 +187,199 @@ private:
 	bool startSession();
 	void waitForShots();
 	void saveGrabbedShots();
-	void storeGrabbedShot(std::vector<uint8_t>);
-	void saveShotToFile(std::string destinationFolder, const std::vector<uint8_t>& data, int frameNumber);
+	/// <summary>
+	/// Processes and stores the shot specified. Returns false if the shot has no data, in which case it has to be taken again.
+	/// </summary>
+	bool storeGrabbedShot(GrabbedFrame grabbedShot);
+	/// <summary>
+	/// Moves the camera to the next shot, or ends the shot taking if all shots have been taken and received. 
+	/// </summary>
+	void advanceToNextShot();
+	/// <summary>
+	/// Moves to the saving state and wakes up the thread waiting for the shots.
+	/// </summary>
+	void endShotTaking();
+	/// <summary>
+	/// Grabs a shot synchronously with capture_screenshot and stores it.
+	/// </summary>
+	void grabShot(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Starts the asynchronous readback of a shot. Returns false if the ring can't be used, in which case the shot has to be grabbed synchronously.
+	/// </summary>
+	bool requestAsynchronousShot(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Stores the shots of which the asynchronous readback has been completed.
+	/// </summary>
+	void storeCompletedAsynchronousShots();
+	bool isAsynchronousCaptureSession();
+	/// <summary>
+	/// Determines the capture region in a backbuffer of the size specified, from the region of interest. 
+	/// </summary>
+	CaptureRegion determineCaptureRegion(int frameWidth, int frameHeight);
+	/// <summary>
+	/// Returns the focal length in pixels of the shots for the horizontal fov specified, which is the fov of the uncropped frame.
+	/// </summary>
+	float focalLengthInPixels(float horizontalFoVRadians);
+	/// <summary>
+	/// Merges the bracket grabbed into the HDR image of the current shot and sets the exposure of the next bracket. After the last bracket, the shot is stored
+	/// with storeGrabbedShot.
+	/// </summary>
+	void storeGrabbedBracket(reshade::api::effect_runtime* runtime, GrabbedFrame grabbedBracket);
+	/// <summary>
+	/// Returns true if the current session takes exposure brackets per shot.
+	/// </summary>
+	bool isBracketingSession();
+	/// <summary>
+	/// Obtains the current value of the exposure uniform and sets the exposure of the first bracket. Returns false if the uniform can't be found.
+	/// </summary>
+	bool startBracketing(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Sets the exposure uniform to the exposure of the bracket with the index specified.
+	/// </summary>
+	void applyBracketExposure(reshade::api::effect_runtime* runtime, int bracketIndex);
+	/// <summary>
+	/// Returns the exposure, in stops relative to the current exposure, of the bracket with the index specified. Brackets go from dark to bright.
+	/// </summary>
+	float bracketExposureStops(int bracketIndex);
+	/// <summary>
+	/// Returns true if the shots of the current session are read from the backbuffer at full precision as well.
+	/// </summary>
+	bool isHighBitDepthSession();
+	/// <summary>
+	/// Returns true if the depth buffer is read along with the shots of the current session.
+	/// </summary>
+	bool isDepthCaptureSession();
+	/// <summary>
+	/// Writes the linear RGB image specified in the configured HDR file type, next to the shot with the filename stem specified.
+	/// </summary>
+	void saveRadianceToFile(const std::string& destinationFolder, const std::vector<float>& radiance, const std::string& shotFilenameStem);
+	/// <summary>
+	/// Linearizes the raw depth specified and writes it in the configured depth file type, next to the shot with the filename stem specified.
+	/// </summary>
+	void saveDepthToFile(const std::string& destinationFolder, const std::vector<float>& rawDepth, const std::string& shotFilenameStem);
+	void saveShotToFile(std::string destinationFolder, const std::vector<uint8_t>& data, const std::string& filename);
+	/// <summary>
+	/// Writes the shot with the frame number specified and adds it to the manifest of the session, with its pose, timing and the hash of the file.
+	/// </summary>
+	void saveShotWithManifestRecord(const std::string& destinationFolder, const GrabbedFrame& shot, int frameNumber);
+	/// <summary>
+	/// Creates the manifest record of the shot specified, which is written to the file specified. The size, hash and encode time are set when it's written.
+	/// </summary>
+	SessionManifestRecord createManifestRecord(const GrabbedFrame& shot, const std::string& filename);	/// <summary>
+	/// Returns where the shot specified is in the session, in the units of its type. See SessionManifestRecord::stepOffset.
+	/// </summary>
+	void determineStepOffset(const GrabbedFrame& shot, float& horizontalOffset, float& verticalOffset);
+	/// <summary>
+	/// Sets the capture time of the shot specified and the number of frames waited for it.
+	/// </summary>
+	void stampShot(GrabbedFrame& shot);
+	/// <summary>
+	/// Writes the RGB image specified to the file specified, in the configured file type. 
+	/// </summary>
+	void saveImageToFile(const std::string& filename, const std::vector<uint8_t>& data, int width, int height);
+	/// <summary>
+	/// Creates the filename, without folder, for the grabbed frame with the index specified.
+	/// </summary>
+	std::string createShotFilename(int frameNumber);
+	std::string createShotFilename(int frameNumber, const std::string& extension);
+	std::string createShotFilenameStem(int frameNumber);
+	/// <summary>
+	/// Writes a Hugin project file for the horizontal panorama taken in the destination folder, so stitching doesn't have to find control points
+	/// </summary>
+	void writePanoramaProjectFile(const std::string& destinationFolder);
+	/// <summary>
+	/// Writes the exact per-shot camera poses of the session as a COLMAP text model and a NeRF transforms.json in the destination folder
+	/// </summary>
+	void writePoseDatasetFiles(const std::string& destinationFolder);
+	/// <summary>
+	/// Writes a json file with the layout of the lightfield and the grid cell of every shot in the destination folder
+	/// </summary>
+	void writeLightfieldMetadataFile(const std::string& destinationFolder);
+	/// <summary>
+	/// Refocuses the grabbed lightfield shots on every configured focus plane and writes the results to the destination folder
+	/// </summary>
+	void writeRefocusedImages(const std::string& destinationFolder);
+	/// <summary>
+	/// Estimates the disparity of the center shot of the lightfield and writes it as a 16 bit png, together with a json file with how to convert
+	/// the values to disparity and depth.
+	/// </summary>
+	void writeDisparityMap(const std::string& destinationFolder);
+	/// <summary>
+	/// Creates the views of the grabbed lightfield shots, with their position in the grid in horizontal steps. Shots without data, which couldn't be read
+	/// back, are left out. frameIndexPerView receives the index in _grabbedFrames of every view.
+	/// </summary>
+	std::vector<LightfieldView> createLightfieldViews(std::vector<int>& frameIndexPerView);
+	void writeQuilt(const std::string& destinationFolder);
+	/// <summary>
+	/// Synthesizes the configured number of views between every two neighbouring shots in a row. They're written to the destination folder and/or
+	/// added to the quilt, depending on the quilt mode.
+	/// </summary>
+	void writeInterpolatedViews(const std::string& destinationFolder);
+	void writeWiggleAnimation(const std::string& destinationFolder);
+	/// <summary>
+	/// Creates the filename, without folder, of the interpolated view with the index specified between the shot at row, column and the shot to its right.
+	/// </summary>
+	std::string createInterpolatedViewFilename(int row, int column, int viewIndex);
+	/// <summary>
+	/// Returns for every cell in the lightfield grid, in row-major order, the index of the grabbed frame taken there, or -1 if there's no frame for the cell.
+	/// </summary>
+	std::vector<int> createFrameIndexPerGridCell();
+	/// <summary>
+	/// Returns the index of the lightfield view in the quilt for the column and interpolated view specified. 
+	/// </summary>
+	int quiltViewIndex(int column, int interpolatedViewIndex) { return column * (_lightField_numberOfInterpolatedViews + 1) + interpolatedViewIndex; }
+	std::string fileExtensionForFiletype();
+	/// <summary>
+	/// Calculates the row and column of the lightfield shot with the index specified. Rows are walked in serpentine order: even rows left to right,
+	///	odd rows right to left, so the camera only has to step to a neighbouring grid cell between two shots.
+	/// </summary>
+	void lightfieldGridCellForShot(int shotIndex, int& row, int& column);
 	std::string createScreenshotFolder();
-	void moveCameraForLightfield(int direction, bool end);
+	void moveCameraForLightfield(int shotIndex, bool start);
+	void moveCameraForSupersampling(int shotIndex);
+	/// <summary>
+	/// Moves the camera to the position of the motion blur shot with the index specified. With start set to true, the camera is moved from the session start
+	/// location to the first shot, otherwise from the previous shot.
+	/// </summary>
+	void moveCameraForMotionBlur(int shotIndex, bool start);
+	/// <summary>
+	/// Returns the time, in [-0.5, 0.5], of the motion blur shot with the index specified, relative to the middle of the time the shutter is open.
+	/// </summary>
+	float motionBlurShotTime(int shotIndex);
+	/// <summary>
+	/// Returns the weight of the motion blur shot with the index specified, following the configured shutter shape.
+	/// </summary>
+	float motionBlurShotWeight(int shotIndex);
+	/// <summary>
+	/// Writes the image accumulated during a supersampling or motion blur session to the file specified, without extension
+	/// </summary>
+	void writeAccumulatedImage(const std::string& destinationFolder, const std::string& filename);
+	/// <summary>
+	/// Stacks the frames of a temporal denoise session and writes the result. With the mean, the frames have already been accumulated.
+	/// </summary>
+	void writeStackedImage(const std::string& destinationFolder);
 	void moveCameraForPanorama(int direction, bool end);
+	void moveCameraForOrbit(int shotIndex);
+	/// <summary>
+	/// Moves the camera from the start location of the session straight to the shot with the index specified, for resuming a session.
+	/// </summary>
+	void moveCameraToShot(int shotIndex);
+	/// <summary>
+	/// Returns true if the session writes every shot as soon as it's taken and keeps a journal of them, so it can be resumed.
+	/// </summary>
+	bool isJournaledSession();
+	/// <summary>
+	/// Creates the folder of the session and the journal in it, if the session is journaled.
+	/// </summary>
+	void startJournal();
+	/// <summary>
+	/// Hands the shot specified, which has just been stored, to the shot writer. The shot is recorded in the journal once its files have been written.
+	/// </summary>
+	void writeJournaledShot(GrabbedFrame& shot, int frameNumber);
+	/// <summary>
+	/// Returns true if the camera is at the pose specified, within a small tolerance.
+	/// </summary>
+	bool isCameraAtPose(const CameraPose& pose);
 	void moveCameraForDebugGrid(int shotCounter, bool end);
 	void modifyCamera();
 	std::string typeOfShotAsString();
@@ -81,20 +389,87 @@ private:
 	float _pano_currentFoVRadians = 0.0f;
 	float _pano_anglePerStep = 0.0f;
 	float _lightField_distancePerStep = 0.0f;
+	float _lightField_distancePerRow = 0.0f;
+	int _lightField_numberOfColumns = 0;
+	int _lightField_numberOfRows = 1;
+	bool _lightField_writeRefocusedImages = false;
+	float _lightField_refocusMinimumDisparity = 0.0f;
+	float _lightField_refocusMaximumDisparity = 0.0f;
+	int _lightField_refocusNumberOfFocusPlanes = 1;
+	bool _lightField_writeDisparityMap = false;
+	float _lightField_maximumDisparity = 0.0f;
+	int _lightField_numberOfInterpolatedViews = 0;
+	bool _lightField_writeWiggleAnimation = false;
+	LightfieldQuiltMode _lightField_quiltMode = LightfieldQuiltMode::Off;
+	int _lightField_quiltNumberOfColumns = 1;
+	int _lightField_quiltWidth = 0;
+	QuiltBuilder _quiltBuilder;
+	float _supersampling_referenceDistance = 0.0f;
+	float _supersampling_currentFoVRadians = 0.0f;
+	MotionBlurMovementType _motionBlur_movementType = MotionBlurMovementType::Translation;
+	float _motionBlur_distanceRight = 0.0f;
+	float _motionBlur_distanceUp = 0.0f;
+	float _motionBlur_fovChangeDegrees = 0.0f;
+	float _motionBlur_angleRadians = 0.0f;
+	float _motionBlur_currentFoVDegrees = 0.0f;
+	ShutterShape _motionBlur_shutterShape = ShutterShape::Box;
+	FrameStackingMethod _temporalDenoise_stackingMethod = FrameStackingMethod::Mean;
+	OrbitLayout _orbit_layout;
+	std::vector<CameraPose> _orbit_poses;	// the planned pose per shot
+	SessionJournal _journal;				// open while the shots of a journaled session are written as they're taken
+	SessionManifest _manifest;				// open from when the folder of the session has been created until the session ends
+	StreamingEncoder _shotWriter;			// writes the shots of a journaled session while it runs, so the render thread doesn't wait for the disk
+	std::string _destinationFolder;			// the folder of a journaled session. Empty otherwise, the folder is then created when the shots are saved.
+	bool _isResumedSession = false;			// true if the session continues an interrupted session. The shots taken before aren't in memory.
+	FrameAccumulator _frameAccumulator;		// used by the session types which average their shots into a single image.
+	bool _bracketing_enabled = false;
+	std::string _bracketing_effectName;
+	std::string _bracketing_uniformName;
+	bool _bracketing_uniformIsMultiplier = false;
+	int _bracketing_numberOfBrackets = 1;
+	float _bracketing_stopsBetweenBrackets = 0.0f;
+	ReshadeStateSnapshot _bracketing_stateAtStart;
+	float _bracketing_referenceValue = 0.0f;		// the value of the exposure uniform at the start of the session
+	bool _bracketing_isActive = false;				// true while the exposure uniform has been changed and has to be restored. Not reset by reset().
+	int _bracketing_currentBracket = 0;
+	GrabbedFrame _bracketing_referenceFrame;		// the bracket closest to the current exposure, which is stored as the shot itself
+	HdrMerger _hdrMerger;
+	bool _asynchronousCapture_enabled = false;
+	AsyncReadbackRing _readbackRing;				// only used on the render thread.
+	bool _highBitDepth_enabled = false;
+	bool _highBitDepth_tenBitIsPq = true;
+	HighBitDepthFiletype _highBitDepth_filetype = HighBitDepthFiletype::Exr;
+	bool _regionOfInterest_enabled = false;
+	float _regionOfInterest_left = 0.0f;			// fractions of the backbuffer size
+	float _regionOfInterest_top = 0.0f;
+	float _regionOfInterest_width = 1.0f;
+	float _regionOfInterest_height = 1.0f;
+	CaptureRegion _captureRegion;					// the region of interest in pixels. Covers the whole frame if no region of interest is used.
+	bool _depth_enabled = false;
+	float _depth_nearPlane = 0.1f;
+	float _depth_farPlane = 1000.0f;
+	bool _depth_isReversed = false;
+	DepthFiletype _depth_filetype = DepthFiletype::Png16;
+	bool _archivalRecompression_enabled = false;
+	ArchivalRecompressor _archivalRecompressor;
 	float _overlapPercentagePerPanoShot = 30.0f;
 	int _numberOfShotsToTake = 0;
 	int _convolutionFrameCounter = 0;		// counts down to 0 from _amountOfFramesToWaitBetweenSteps
+	int _numberOfFramesSinceLastShot = 0;
 	int _shotCounter = 0;
 	int _numberOfFramesToWaitBetweenSteps = 1;
-	uint32_t _framebufferWidth = 0;
+	uint32_t _framebufferWidth = 0;			// the size of the shots, which is the size of the capture region
 	uint32_t _framebufferHeight = 0;
+	uint32_t _frameWidth = 0;				// the size of the backbuffer
+	uint32_t _frameHeight = 0;
 	ScreenshotType _typeOfShot = ScreenshotType::HorizontalPanorama;
 	ScreenshotControllerState _state = ScreenshotControllerState::Off;
 	ScreenshotFiletype _filetype = ScreenshotFiletype::Jpeg;
 	bool _isTestRun = false;
 
 	std::string _rootFolder;
-	std::vector<std::vector<uint8_t>> _grabbedFrames;
+	std::vector<GrabbedFrame> _grabbedFrames;
+	CameraToolsData* _cameraToolsData = nullptr;		// the buffer shared with the camera tools, which contains the live camera data.
 
 	// Used together to make sure the main thread in System doesn't busy-wait and waits till the grabbing process has been completed.
 	std::mutex _waitCompletionMutex;
@@ -46,6 +46,67 @@ struct ScreenshotSettings
 	int numberOfFramesToWaitBetweenSteps = 1;
 	float lightField_distanceBetweenShots = 1.0f;
 	int lightField_numberOfShotsToTake = 45;
+	int lightField_numberOfRows = 1;
+	float lightField_distanceBetweenRows = 1.0f;
+	bool lightField_writeRefocusedImages = false;
+	float lightField_refocusMinimumDisparity = -2.0f;
+	float lightField_refocusMaximumDisparity = 2.0f;
+	int lightField_refocusNumberOfFocusPlanes = 9;
+	bool lightField_writeDisparityMap = false;
+	float lightField_maximumDisparity = 8.0f;
+	int lightField_numberOfInterpolatedViews = 0;
+	bool lightField_writeWiggleAnimation = false;
+	int lightField_quiltMode = (int)LightfieldQuiltMode::Off;
+	int lightField_quiltNumberOfColumns = 8;
+	int lightField_quiltWidth = 4096;
+	int supersampling_numberOfSamples = 16;
+	float supersampling_referenceDistance = 10.0f;
+	int motionBlur_numberOfSamples = 32;
+	int motionBlur_movementType = (int)MotionBlurMovementType::Translation;
+	float motionBlur_distanceRight = 1.0f;
+	float motionBlur_distanceUp = 0.0f;
+	float motionBlur_fovChangeDegrees = 0.0f;
+	float motionBlur_angleDegrees = 2.0f;
+	int motionBlur_shutterShape = (int)ShutterShape::Box;
+	int temporalDenoise_numberOfFrames = 16;
+	int temporalDenoise_stackingMethod = (int)FrameStackingMethod::SigmaClippedMean;
+	float orbit_distance = 10.0f;
+	int orbit_numberOfShotsPerRing = 24;
+	int orbit_numberOfRings = 3;
+	float orbit_minimumElevationDegrees = -15.0f;
+	float orbit_maximumElevationDegrees = 45.0f;
+	bool bracketing_enabled = false;
+	char bracketing_effectName[256] = "Tonemap.fx";
+	char bracketing_uniformName[256] = "Exposure";
+	bool bracketing_uniformIsMultiplier = false;
+	int bracketing_numberOfBrackets = 3;
+	float bracketing_stopsBetweenBrackets = 2.0f;
+	bool highBitDepth_enabled = false;
+	bool highBitDepth_tenBitIsPq = true;
+	int highBitDepth_fileType = (int)HighBitDepthFiletype::Exr;
+	bool asynchronousCapture = false;
+	bool regionOfInterest_enabled = false;
+	float regionOfInterest_left = 0.25f;		// fractions of the backbuffer size
+	float regionOfInterest_top = 0.25f;
+	float regionOfInterest_width = 0.5f;
+	float regionOfInterest_height = 0.5f;
+	bool depth_enabled = false;
+	float depth_nearPlane = 0.1f;
+	float depth_farPlane = 1000.0f;
+	bool depth_isReversed = false;
+	int depth_fileType = (int)DepthFiletype::Png16;
+	bool archivalRecompression_enabled = false;
+	int pathRecording_everyNthFrame = 1;
+	bool pathRecording_startWithPlayback = true;
+	bool pathRecording_pausePlaybackWhenBehind = true;
+	bool pathRecording_writeAnimation = false;
+	int pathRecording_animationFramesPerSecond = 30;
+	bool pathRecording_publishToFrameBus = false;
+	int pathRecording_frameBusFullPolicy = (int)FrameBusFullPolicy::DropFrame;
+	int pathRecording_encodingSelection = (int)EncodingSelection::Fixed;
+	int stereo_packing = (int)StereoPacking::SideBySide;
+	bool stereo_swapEyes = false;
+	int stereo_numberOfPairs = 1;
 	float pano_totalAngleDegrees = 110.0f;
 	float pano_overlapPercentagePerShot = 80.0f;
 	char screenshotFolder[_MAX_PATH + 1] = { 0 };
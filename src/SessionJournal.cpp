@@ -0,0 +1,299 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SessionJournal.h"
+#include "Utils.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr const char* JournalFilename = "session.journal";
+	constexpr const char* JournalHeader = "IgcsConnectorSessionJournal";
+	constexpr int JournalVersion = 1;
+
+	std::string journalPath(const std::string& sessionFolder)
+	{
+		return IGCS::Utils::formatString("%s\\%s", sessionFolder.c_str(), JournalFilename).c_str();
+	}
+
+
+	void writePose(FILE* file, const CameraPose& pose)
+	{
+		// %.9g round trips floats exactly.
+		fprintf(file, " %.9g %.9g %.9g", pose.position[0], pose.position[1], pose.position[2]);
+		fprintf(file, " %.9g %.9g %.9g %.9g", pose.orientation[0], pose.orientation[1], pose.orientation[2], pose.orientation[3]);
+		fprintf(file, " %.9g %.9g %.9g", pose.rightVector[0], pose.rightVector[1], pose.rightVector[2]);
+		fprintf(file, " %.9g %.9g %.9g", pose.upVector[0], pose.upVector[1], pose.upVector[2]);
+		fprintf(file, " %.9g %.9g %.9g", pose.forwardVector[0], pose.forwardVector[1], pose.forwardVector[2]);
+		fprintf(file, " %.9g", pose.fovDegrees);
+	}
+
+
+	bool readPose(std::istringstream& stream, CameraPose& pose)
+	{
+		stream >> pose.position[0] >> pose.position[1] >> pose.position[2];
+		stream >> pose.orientation[0] >> pose.orientation[1] >> pose.orientation[2] >> pose.orientation[3];
+		stream >> pose.rightVector[0] >> pose.rightVector[1] >> pose.rightVector[2];
+		stream >> pose.upVector[0] >> pose.upVector[1] >> pose.upVector[2];
+		stream >> pose.forwardVector[0] >> pose.forwardVector[1] >> pose.forwardVector[2];
+		stream >> pose.fovDegrees;
+		return !stream.fail();
+	}
+}
+
+
+int SessionJournalData::firstMissingShotIndex() const
+{
+	std::vector<bool> isShotWritten(numberOfShotsToTake, false);
+	for(const JournaledShot& shot : completedShots)
+	{
+		if(shot.shotIndex >= 0 && shot.shotIndex < numberOfShotsToTake)
+		{
+			isShotWritten[shot.shotIndex] = true;
+		}
+	}
+	for(int i = 0; i < numberOfShotsToTake; i++)
+	{
+		if(!isShotWritten[i])
+		{
+			return i;
+		}
+	}
+	return numberOfShotsToTake;
+}
+
+
+SessionJournal::~SessionJournal()
+{
+	close();
+}
+
+
+bool SessionJournal::create(const std::string& sessionFolder, const SessionJournalData& data)
+{
+	close();
+	if(fopen_s(&_journalFile, journalPath(sessionFolder).c_str(), "w") != 0 || nullptr == _journalFile)
+	{
+		_journalFile = nullptr;
+		return false;
+	}
+	fprintf(_journalFile, "%s %d\n", JournalHeader, JournalVersion);
+	fprintf(_journalFile, "type %d\nfiletype %d\nshots %d\n", (int)data.typeOfShot, (int)data.filetype, data.numberOfShotsToTake);
+	fprintf(_journalFile, "panorama %.9g %.9g %.9g %.9g\n", data.pano_totalFoVRadians, data.pano_currentFoVRadians, data.pano_anglePerStep, data.pano_overlapPercentage);
+	fprintf(_journalFile, "lightfield %.9g %d %.9g %d\n", data.lightField_distancePerStep, data.lightField_numberOfColumns, data.lightField_distancePerRow, 
+			data.lightField_numberOfRows);
+	fprintf(_journalFile, "orbit %.9g %d %d %.9g %.9g\n", data.orbitLayout.distance, data.orbitLayout.numberOfShotsPerRing, data.orbitLayout.numberOfRings, 
+			data.orbitLayout.minimumElevationDegrees, data.orbitLayout.maximumElevationDegrees);
+	if(data.hasStartPose)
+	{
+		fprintf(_journalFile, "startpose");
+		writePose(_journalFile, data.startPose);
+		fprintf(_journalFile, "\n");
+	}
+	fflush(_journalFile);
+	return true;
+}
+
+
+bool SessionJournal::reopen(const std::string& sessionFolder)
+{
+	close();
+	if(fopen_s(&_journalFile, journalPath(sessionFolder).c_str(), "a") != 0 || nullptr == _journalFile)
+	{
+		_journalFile = nullptr;
+		return false;
+	}
+	return true;
+}
+
+
+void SessionJournal::appendCompletedShot(int shotIndex, const CameraPose* pose)
+{
+	if(!isOpen())
+	{
+		return;
+	}
+	fprintf(_journalFile, "shot %d", shotIndex);
+	if(nullptr != pose)
+	{
+		writePose(_journalFile, *pose);
+	}
+	fprintf(_journalFile, "\n");
+	// the shot is on disk, so make sure the journal says so, even if the game crashes right after this.
+	fflush(_journalFile);
+}
+
+
+void SessionJournal::markComplete()
+{
+	if(!isOpen())
+	{
+		return;
+	}
+	fprintf(_journalFile, "complete\n");
+	close();
+}
+
+
+void SessionJournal::close()
+{
+	if(nullptr != _journalFile)
+	{
+		fclose(_journalFile);
+		_journalFile = nullptr;
+	}
+}
+
+
+namespace IGCS::SessionJournalReader
+{
+	bool readJournal(const std::string& sessionFolder, SessionJournalData& data)
+	{
+		std::ifstream journalFile(journalPath(sessionFolder));
+		if(!journalFile.is_open())
+		{
+			return false;
+		}
+		data = SessionJournalData();
+		std::string line;
+		if(!std::getline(journalFile, line))
+		{
+			return false;
+		}
+		std::istringstream headerStream(line);
+		std::string header;
+		int version = 0;
+		headerStream >> header >> version;
+		if(header != JournalHeader || version != JournalVersion)
+		{
+			return false;
+		}
+		while(std::getline(journalFile, line))
+		{
+			std::istringstream lineStream(line);
+			std::string key;
+			lineStream >> key;
+			if(key.empty())
+			{
+				continue;
+			}
+			if(key == "type" || key == "filetype")
+			{
+				int value = 0;
+				lineStream >> value;
+				if(key == "type")
+				{
+					data.typeOfShot = (ScreenshotType)value;
+				}
+				else
+				{
+					data.filetype = (ScreenshotFiletype)value;
+				}
+			}
+			else if(key == "shots")
+			{
+				lineStream >> data.numberOfShotsToTake;
+			}
+			else if(key == "panorama")
+			{
+				lineStream >> data.pano_totalFoVRadians >> data.pano_currentFoVRadians >> data.pano_anglePerStep >> data.pano_overlapPercentage;
+			}
+			else if(key == "lightfield")
+			{
+				lineStream >> data.lightField_distancePerStep >> data.lightField_numberOfColumns >> data.lightField_distancePerRow >> data.lightField_numberOfRows;
+			}
+			else if(key == "orbit")
+			{
+				lineStream >> data.orbitLayout.distance >> data.orbitLayout.numberOfShotsPerRing >> data.orbitLayout.numberOfRings 
+						   >> data.orbitLayout.minimumElevationDegrees >> data.orbitLayout.maximumElevationDegrees;
+			}
+			else if(key == "startpose")
+			{
+				data.hasStartPose = readPose(lineStream, data.startPose);
+			}
+			else if(key == "shot")
+			{
+				JournaledShot shot;
+				lineStream >> shot.shotIndex;
+				if(lineStream.fail())
+				{
+					// a line cut off by a crash. The shot is taken again.
+					continue;
+				}
+				shot.hasPose = readPose(lineStream, shot.pose);
+				data.completedShots.push_back(shot);
+			}
+			else if(key == "complete")
+			{
+				data.isComplete = true;
+			}
+			const bool isParameter = key != "startpose" && key != "shot" && key != "complete";
+			if(isParameter && lineStream.fail())
+			{
+				return false;
+			}
+		}
+		return data.numberOfShotsToTake > 0;
+	}
+
+
+	std::string findLatestInterruptedSession(const std::string& rootFolder)
+	{
+		std::string toReturn;
+		std::filesystem::file_time_type latestWriteTime;
+		std::error_code errorCode;
+		for(const auto& entry : std::filesystem::directory_iterator(rootFolder, errorCode))
+		{
+			if(!entry.is_directory(errorCode))
+			{
+				continue;
+			}
+			const std::filesystem::path journalFilePath = entry.path() / JournalFilename;
+			const auto writeTime = std::filesystem::last_write_time(journalFilePath, errorCode);
+			if(errorCode || (!toReturn.empty() && writeTime <= latestWriteTime))
+			{
+				errorCode.clear();
+				continue;
+			}
+			SessionJournalData data;
+			if(readJournal(entry.path().string(), data) && !data.isComplete)
+			{
+				toReturn = entry.path().string();
+				latestWriteTime = writeTime;
+			}
+		}
+		return toReturn;
+	}
+}
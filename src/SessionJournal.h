@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ConstantsEnums.h"
+#include "GrabbedFrame.h"
+#include "OrbitPlanner.h"
+
+/// <summary>
+/// A shot of a session which has been written to disk.
+/// </summary>
+struct JournaledShot
+{
+	int shotIndex = 0;
+	bool hasPose = false;
+	CameraPose pose;
+};
+
+
+/// <summary>
+/// Everything needed to resume a screenshot session: its parameters, the pose of the camera at the start and the shots which have been written.
+/// </summary>
+struct SessionJournalData
+{
+	ScreenshotType typeOfShot = ScreenshotType::HorizontalPanorama;
+	ScreenshotFiletype filetype = ScreenshotFiletype::Jpeg;
+	int numberOfShotsToTake = 0;
+	float pano_totalFoVRadians = 0.0f;
+	float pano_currentFoVRadians = 0.0f;
+	float pano_anglePerStep = 0.0f;
+	float pano_overlapPercentage = 0.0f;
+	float lightField_distancePerStep = 0.0f;
+	int lightField_numberOfColumns = 0;
+	float lightField_distancePerRow = 0.0f;
+	int lightField_numberOfRows = 1;
+	OrbitLayout orbitLayout;
+	bool hasStartPose = false;
+	CameraPose startPose;
+	std::vector<JournaledShot> completedShots;		// in the order they were written
+	bool isComplete = false;
+
+	/// <summary>
+	/// Returns the index of the first shot which hasn't been written. Equals numberOfShotsToTake if all shots have been written.
+	/// </summary>
+	int firstMissingShotIndex() const;
+};
+
+
+/// <summary>
+/// Writes the journal of a screenshot session in the session's folder. The journal is appended to and flushed after every shot written, so after a crash 
+/// it tells which shots are on disk and the session can be resumed from the first missing shot. 
+/// </summary>
+class SessionJournal
+{
+public:
+	SessionJournal() = default;
+	~SessionJournal();
+
+	/// <summary>
+	/// Creates the journal in the folder specified and writes the session parameters to it. 
+	/// </summary>
+	bool create(const std::string& sessionFolder, const SessionJournalData& data);
+	/// <summary>
+	/// Opens the existing journal in the folder specified, to append the shots of a resumed session to it.
+	/// </summary>
+	bool reopen(const std::string& sessionFolder);
+	/// <summary>
+	/// Records that the shot with the index specified has been written. pose can be nullptr.
+	/// </summary>
+	void appendCompletedShot(int shotIndex, const CameraPose* pose);
+	/// <summary>
+	/// Records that the session has been completed, so it's not offered for resuming, and closes the journal.
+	/// </summary>
+	void markComplete();
+	void close();
+
+	bool isOpen() { return nullptr != _journalFile; }
+
+private:
+	FILE* _journalFile = nullptr;
+};
+
+
+namespace IGCS::SessionJournalReader
+{
+	/// <summary>
+	/// Reads the journal in the session folder specified. Returns false if there's no journal or it can't be read.
+	/// </summary>
+	bool readJournal(const std::string& sessionFolder, SessionJournalData& data);
+	/// <summary>
+	/// Returns the folder of the most recent session in the root folder specified of which the journal isn't complete, or an empty string if there's none.
+	/// </summary>
+	std::string findLatestInterruptedSession(const std::string& rootFolder);
+}
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SessionManifest.h"
+#include "ImageFileWriters.h"
+#include "Utils.h"
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+	constexpr char ManifestMagic[8] = { 'I', 'G', 'C', 'S', 'M', 'N', 'F', 0 };
+	constexpr uint32_t ManifestVersion = 1;
+
+
+	std::string binaryFilename(const std::string& sessionFolder)
+	{
+		return IGCS::Utils::formatString("%s\\manifest.bin", sessionFolder.c_str()).c_str();
+	}
+
+
+	std::string jsonFilename(const std::string& sessionFolder)
+	{
+		return IGCS::Utils::formatString("%s\\manifest.json", sessionFolder.c_str()).c_str();
+	}
+}
+
+
+SessionManifest::~SessionManifest()
+{
+	close();
+}
+
+
+bool SessionManifest::create(const std::string& sessionFolder, ScreenshotType typeOfShot, const std::string& typeDescription, ScreenshotFiletype filetype, 
+							 int numberOfShotsToTake)
+{
+	close();
+	_sessionFolder = sessionFolder;
+	_typeDescription = typeDescription;
+	_header = {};
+	memcpy(_header.magic, ManifestMagic, sizeof(ManifestMagic));
+	_header.version = ManifestVersion;
+	_header.recordSize = sizeof(SessionManifestRecord);
+	_header.typeOfShot = (int32_t)typeOfShot;
+	_header.filetype = (int32_t)filetype;
+	_header.numberOfShotsToTake = numberOfShotsToTake;
+	_records.clear();
+	return writeHeaderAndRecords();
+}
+
+
+bool SessionManifest::reopen(const std::string& sessionFolder, const std::string& typeDescription, int firstShotIndexToRemove)
+{
+	close();
+	FILE* file = nullptr;
+	if(fopen_s(&file, binaryFilename(sessionFolder).c_str(), "rb") != 0 || nullptr == file)
+	{
+		return false;
+	}
+	SessionManifestHeader header = {};
+	const bool isHeaderValid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, ManifestMagic, sizeof(ManifestMagic)) == 0 &&
+							   header.recordSize == sizeof(SessionManifestRecord);
+	std::vector<SessionManifestRecord> records;
+	SessionManifestRecord record;
+	// a record which was only partly written when the session was interrupted is dropped.
+	while(isHeaderValid && fread(&record, sizeof(record), 1, file) == 1)
+	{
+		if(record.shotIndex < firstShotIndexToRemove)
+		{
+			records.push_back(record);
+		}
+	}
+	fclose(file);
+	if(!isHeaderValid)
+	{
+		return false;
+	}
+	_sessionFolder = sessionFolder;
+	_typeDescription = typeDescription;
+	_header = header;
+	_records = std::move(records);
+	// rewritten, so the shots which are taken again don't end up in it twice.
+	return writeHeaderAndRecords();
+}
+
+
+void SessionManifest::appendShot(const SessionManifestRecord& record)
+{
+	if(!isOpen())
+	{
+		return;
+	}
+	_records.push_back(record);
+	fwrite(&record, sizeof(record), 1, _binaryFile);
+	fflush(_binaryFile);
+}
+
+
+bool SessionManifest::updateShotFile(const std::string& filename, uint32_t numberOfBytes, uint32_t crc32)
+{
+	if(!isOpen())
+	{
+		return false;
+	}
+	for(size_t i = 0; i < _records.size(); i++)
+	{
+		SessionManifestRecord& record = _records[i];
+		if(filename != std::string(record.filename, strnlen(record.filename, sizeof(record.filename))))
+		{
+			continue;
+		}
+		record.numberOfBytes = numberOfBytes;
+		record.crc32 = crc32;
+		// the record is overwritten in place, after which appending continues at the end.
+		fseek(_binaryFile, (long)(sizeof(SessionManifestHeader) + i * sizeof(SessionManifestRecord)), SEEK_SET);
+		fwrite(&record, sizeof(record), 1, _binaryFile);
+		fseek(_binaryFile, 0, SEEK_END);
+		fflush(_binaryFile);
+		return true;
+	}
+	return false;
+}
+
+
+void SessionManifest::close()
+{
+	if(nullptr != _binaryFile)
+	{
+		fclose(_binaryFile);
+		_binaryFile = nullptr;
+		// written once, as rewriting it after every shot would make a large session quadratic.
+		writeJson();
+	}
+}
+
+
+bool SessionManifest::writeHeaderAndRecords()
+{
+	if(fopen_s(&_binaryFile, binaryFilename(_sessionFolder).c_str(), "wb") != 0 || nullptr == _binaryFile)
+	{
+		_binaryFile = nullptr;
+		return false;
+	}
+	fwrite(&_header, sizeof(_header), 1, _binaryFile);
+	if(!_records.empty())
+	{
+		fwrite(_records.data(), sizeof(SessionManifestRecord), _records.size(), _binaryFile);
+	}
+	fflush(_binaryFile);
+	return true;
+}
+
+
+void SessionManifest::writeJson()
+{
+	const std::string filename = jsonFilename(_sessionFolder);
+	const std::string temporaryFilename = filename + ".tmp";
+	FILE* jsonFile = nullptr;
+	if(fopen_s(&jsonFile, temporaryFilename.c_str(), "w") != 0 || nullptr == jsonFile)
+	{
+		return;
+	}
+	fprintf(jsonFile, "{\n");
+	fprintf(jsonFile, "\t\"version\": %u,\n", _header.version);
+	fprintf(jsonFile, "\t\"type\": \"%s\",\n", _typeDescription.c_str());
+	fprintf(jsonFile, "\t\"filetype\": \"%s\",\n", IGCS::ImageFileWriters::fileExtension((ScreenshotFiletype)_header.filetype).c_str());
+	fprintf(jsonFile, "\t\"numberOfShotsToTake\": %d,\n", _header.numberOfShotsToTake);
+	fprintf(jsonFile, "\t\"shots\": [\n");
+	for(size_t i = 0; i < _records.size(); i++)
+	{
+		const SessionManifestRecord& record = _records[i];
+		// the filename is always 0 terminated, but a record read from disk could be damaged.
+		const std::string shotFilename(record.filename, strnlen(record.filename, sizeof(record.filename)));
+		fprintf(jsonFile, "\t\t{ \"index\": %d, \"file\": \"%s\", \"width\": %u, \"height\": %u, ", record.shotIndex, shotFilename.c_str(), record.width, record.height);
+		if(record.flags & SessionManifestRecordFlags::HasPose)
+		{
+			fprintf(jsonFile, "\"position\": [%.6f, %.6f, %.6f], \"orientation\": [%.6f, %.6f, %.6f, %.6f], \"fov\": %.6f, ", record.position[0], record.position[1], 
+					record.position[2], record.orientation[0], record.orientation[1], record.orientation[2], record.orientation[3], record.fovDegrees);
+		}
+		else
+		{
+			fprintf(jsonFile, "\"position\": null, \"orientation\": null, \"fov\": null, ");
+		}
+		fprintf(jsonFile, "\"stepOffset\": [%.6f, %.6f], \"captureTimeMicroseconds\": %llu, \"framesWaited\": %d, \"encodeMilliseconds\": %.3f, \"bytes\": %u, \"crc32\": \"%.8x\" }%s\n",
+				record.stepOffset[0], record.stepOffset[1], (unsigned long long)record.captureTimeMicroseconds, record.numberOfFramesWaited, record.encodeMilliseconds,
+				record.numberOfBytes, record.crc32, (i + 1 < _records.size()) ? "," : "");
+	}
+	fprintf(jsonFile, "\t]\n}\n");
+	fclose(jsonFile);
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryFilename, filename, errorCode);
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ConstantsEnums.h"
+
+#pragma pack(push, 1)
+/// <summary>
+/// The header of manifest.bin. All values are little endian.
+/// </summary>
+struct SessionManifestHeader
+{
+	char magic[8];						// "IGCSMNF" followed by a 0
+	uint32_t version;
+	uint32_t recordSize;				// the size of a SessionManifestRecord, so readers can skip fields added in later versions
+	int32_t typeOfShot;					// ScreenshotType
+	int32_t filetype;					// ScreenshotFiletype
+	int32_t numberOfShotsToTake;
+	int32_t reserved;
+};
+
+
+/// <summary>
+/// A shot in manifest.bin, which follows the header with a record per shot written, in the order the shots were written.
+/// </summary>
+struct SessionManifestRecord
+{
+	int32_t shotIndex;					// the index of the shot in the session, which is also the order the shots were taken in
+	uint32_t flags;						// SessionManifestRecordFlags
+	uint32_t width;
+	uint32_t height;
+	float position[3];					// the camera pose as reported by the camera tools when the shot was taken, in world units
+	float orientation[4];				// look quaternion, qx, qy, qz, qw
+	float fovDegrees;
+	float stepOffset[2];				// panorama: yaw in degrees relative to the middle of the panorama, 0. Lightfield: the offset right and up from the
+										// middle of the grid in world units. Orbit: the azimuth and elevation in degrees. 0, 0 otherwise
+	uint64_t captureTimeMicroseconds;	// since 1970-01-01 UTC
+	int32_t numberOfFramesWaited;		// the number of frames presented between the previous shot and this one
+	float encodeMilliseconds;
+	uint32_t numberOfBytes;				// the size of the file
+	uint32_t crc32;						// of the complete file
+	char filename[64];					// relative to the session folder, 0 terminated
+};
+#pragma pack(pop)
+static_assert(sizeof(SessionManifestHeader) == 32, "manifest.bin layout changed");
+static_assert(sizeof(SessionManifestRecord) == 144, "manifest.bin layout changed");
+
+
+enum SessionManifestRecordFlags : uint32_t
+{
+	HasPose = 1,						// false if the camera tools didn't report a pose, in which case the pose and fov are 0
+};
+
+
+/// <summary>
+/// Writes the manifest of a screenshot session: a sidecar with per shot the file it was written to, the camera pose, where it is in the session, when it
+/// was taken and a hash of the file, so tools don't have to derive any of that from the filenames or the images. It's written twice: manifest.bin, a fixed
+/// size record per shot which is appended to and flushed after every shot, so it's complete at any moment, and manifest.json with the same data, which
+/// is written when the manifest is closed and replaces the previous one in one go.
+/// </summary>
+class SessionManifest
+{
+public:
+	SessionManifest() = default;
+	~SessionManifest();
+
+	/// <summary>
+	/// Creates the manifest in the session folder specified.
+	/// </summary>
+	/// <param name="sessionFolder"></param>
+	/// <param name="typeOfShot"></param>
+	/// <param name="typeDescription">the name of the type of shot, written in the JSON file</param>
+	/// <param name="filetype"></param>
+	/// <param name="numberOfShotsToTake"></param>
+	/// <returns>true if the manifest could be created, false otherwise</returns>
+	bool create(const std::string& sessionFolder, ScreenshotType typeOfShot, const std::string& typeDescription, ScreenshotFiletype filetype, int numberOfShotsToTake);
+	/// <summary>
+	/// Opens the existing manifest in the session folder specified, for a resumed session. The shots from the first shot index specified on are taken
+	/// again, so their records are removed.
+	/// </summary>
+	bool reopen(const std::string& sessionFolder, const std::string& typeDescription, int firstShotIndexToRemove);
+	/// <summary>
+	/// Adds the shot specified to manifest.bin. It's added to manifest.json when the manifest is closed.
+	/// </summary>
+	void appendShot(const SessionManifestRecord& record);
+	/// <summary>
+	/// Sets the size and hash of the shot written to the file specified, relative to the session folder, after the file has been replaced. Returns false if
+	/// the file isn't in the manifest.
+	/// </summary>
+	bool updateShotFile(const std::string& filename, uint32_t numberOfBytes, uint32_t crc32);
+	/// <summary>
+	/// Closes manifest.bin and writes manifest.json.
+	/// </summary>
+	void close();
+
+	bool isOpen() { return nullptr != _binaryFile; }
+
+private:
+	bool writeHeaderAndRecords();
+	void writeJson();
+
+	FILE* _binaryFile = nullptr;
+	std::string _sessionFolder;
+	std::string _typeDescription;
+	SessionManifestHeader _header = {};
+	std::vector<SessionManifestRecord> _records;
+};
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "SharedMemoryRegion.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	// Local\ keeps the name in the session of the user, so no privileges are needed to create it.
+	std::string toMappingName(const std::string& name)
+	{
+		return "Local\\" + name;
+	}
+#else
+	std::string toMappingName(const std::string& name)
+	{
+		return "/" + name;
+	}
+#endif
+}
+
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+	close();
+}
+
+
+#ifdef _WIN32
+bool SharedMemoryRegion::create(const std::string& name, size_t sizeInBytes)
+{
+	close();
+	const uint64_t size = (uint64_t)sizeInBytes;
+	HANDLE mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), 
+											  toMappingName(name).c_str());
+	if(nullptr == mappingHandle)
+	{
+		return false;
+	}
+	if(ERROR_ALREADY_EXISTS == GetLastError())
+	{
+		// another process still has the previous region mapped, which might have a different size.
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	// the pages of a new mapping are zero filled by the os.
+	_data = (uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeInBytes);
+	if(nullptr == _data)
+	{
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	_mappingHandle = mappingHandle;
+	_sizeInBytes = sizeInBytes;
+	return true;
+}
+
+
+bool SharedMemoryRegion::open(const std::string& name)
+{
+	close();
+	HANDLE mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, toMappingName(name).c_str());
+	if(nullptr == mappingHandle)
+	{
+		return false;
+	}
+	_data = (uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if(nullptr == _data)
+	{
+		CloseHandle(mappingHandle);
+		return false;
+	}
+	MEMORY_BASIC_INFORMATION memoryInfo = {};
+	VirtualQuery(_data, &memoryInfo, sizeof(memoryInfo));
+	_mappingHandle = mappingHandle;
+	_sizeInBytes = memoryInfo.RegionSize;
+	return true;
+}
+
+
+void SharedMemoryRegion::close()
+{
+	if(nullptr != _data)
+	{
+		UnmapViewOfFile(_data);
+		_data = nullptr;
+	}
+	if(nullptr != _mappingHandle)
+	{
+		CloseHandle(_mappingHandle);
+		_mappingHandle = nullptr;
+	}
+	_sizeInBytes = 0;
+}
+#else
+bool SharedMemoryRegion::create(const std::string& name, size_t sizeInBytes)
+{
+	close();
+	const std::string posixName = toMappingName(name);
+	// a region left behind by a crashed producer is replaced. Processes which still have it mapped keep their mapping.
+	shm_unlink(posixName.c_str());
+	const int fileDescriptor = shm_open(posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fileDescriptor < 0)
+	{
+		return false;
+	}
+	if(ftruncate(fileDescriptor, (off_t)sizeInBytes) != 0)
+	{
+		::close(fileDescriptor);
+		shm_unlink(posixName.c_str());
+		return false;
+	}
+	void* data = mmap(nullptr, sizeInBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	::close(fileDescriptor);
+	if(MAP_FAILED == data)
+	{
+		shm_unlink(posixName.c_str());
+		return false;
+	}
+	_data = (uint8_t*)data;
+	_sizeInBytes = sizeInBytes;
+	_posixName = posixName;
+	return true;
+}
+
+
+bool SharedMemoryRegion::open(const std::string& name)
+{
+	close();
+	const int fileDescriptor = shm_open(toMappingName(name).c_str(), O_RDWR, 0600);
+	if(fileDescriptor < 0)
+	{
+		return false;
+	}
+	struct stat fileStatus = {};
+	if(fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size <= 0)
+	{
+		::close(fileDescriptor);
+		return false;
+	}
+	void* data = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	::close(fileDescriptor);
+	if(MAP_FAILED == data)
+	{
+		return false;
+	}
+	_data = (uint8_t*)data;
+	_sizeInBytes = (size_t)fileStatus.st_size;
+	return true;
+}
+
+
+void SharedMemoryRegion::close()
+{
+	if(nullptr != _data)
+	{
+		munmap(_data, _sizeInBytes);
+		_data = nullptr;
+	}
+	if(!_posixName.empty())
+	{
+		shm_unlink(_posixName.c_str());
+		_posixName.clear();
+	}
+	_sizeInBytes = 0;
+}
+#endif
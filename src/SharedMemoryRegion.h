@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// A named block of memory which is shared between processes. Uses a file mapping backed by the page file on Windows and POSIX shared memory elsewhere, so
+/// code which uses it can be run on Linux as well. The memory stays alive as long as a process has it mapped.
+/// </summary>
+class SharedMemoryRegion
+{
+public:
+	SharedMemoryRegion() = default;
+	~SharedMemoryRegion();
+	SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+	SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+	/// <summary>
+	/// Creates the region with the name specified, zero filled. Fails if a region with that name is still mapped by another process on Windows. 
+	/// </summary>
+	bool create(const std::string& name, size_t sizeInBytes);
+	/// <summary>
+	/// Opens the existing region with the name specified. Fails if no region with that name exists.
+	/// </summary>
+	bool open(const std::string& name);
+	/// <summary>
+	/// Unmaps the region. If the region was created by this object, the name is released as well, so it can be created again.
+	/// </summary>
+	void close();
+
+	bool isOpen() { return nullptr != _data; }
+	uint8_t* data() { return _data; }
+	size_t size() { return _sizeInBytes; }
+
+private:
+	uint8_t* _data = nullptr;
+	size_t _sizeInBytes = 0;
+#ifdef _WIN32
+	void* _mappingHandle = nullptr;
+#else
+	std::string _posixName;			// only set if this object created the region
+#endif
+};
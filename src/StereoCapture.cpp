@@ -0,0 +1,367 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#define IMGUI_DISABLE_INCLUDE_IMCONFIG_H
+#include "stdafx.h"
+#include "StereoCapture.h"
+#include "ImageFileWriters.h"
+#include "OverlayControl.h"
+#include "Utils.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <direct.h>
+#include <emmintrin.h>
+#include <imgui.h>
+
+using namespace reshade::api;
+
+namespace
+{
+	// the pairs waiting to be encoded may use at most this much memory. The queue capacity follows from the pair size.
+	constexpr size_t QueueBudgetInBytes = 1024ull * 1024ull * 1024ull;
+	constexpr int MinimumQueueCapacity = 4;
+	// the rows of an eye are packed in bands of this many rows, so both eyes are packed by more than two workers.
+	constexpr int RowsPerBand = 64;
+
+	/// <summary>
+	/// Converts a row of RGBA pixels to RGB. Writes exactly 3 bytes per pixel, so rows of the two eyes can be written into the same image concurrently.
+	/// </summary>
+	void convertRgbaRowToRgb(const uint8_t* source, uint8_t* destination, uint32_t numberOfPixels)
+	{
+		const __m128i lowerPixelMask = _mm_set1_epi64x(0x0000000000FFFFFFll);
+		const __m128i upperPixelMask = _mm_set1_epi64x(0x0000FFFFFF000000ll);
+		uint32_t x = 0;
+		for(; x + 4 <= numberOfPixels; x += 4)
+		{
+			// per 64 bit lane: move the RGB of the second pixel right behind the RGB of the first, then move the 6 bytes of the upper lane right behind
+			// the 6 bytes of the lower lane.
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * x));
+			const __m128i pairs = _mm_or_si128(_mm_and_si128(pixels, lowerPixelMask), _mm_and_si128(_mm_srli_epi64(pixels, 8), upperPixelMask));
+			const __m128i packed = _mm_or_si128(_mm_move_epi64(pairs), _mm_slli_si128(_mm_srli_si128(pairs, 8), 6));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + 3 * x), packed);
+			const uint32_t lastFourBytes = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+			memcpy(destination + 3 * x + 8, &lastFourBytes, 4);
+		}
+		for(; x < numberOfPixels; ++x)
+		{
+			destination[3 * x] = source[4 * x];
+			destination[3 * x + 1] = source[4 * x + 1];
+			destination[3 * x + 2] = source[4 * x + 2];
+		}
+	}
+}
+
+
+void StereoCapture::registerRuntime(effect_runtime* runtime)
+{
+	if(nullptr == runtime || nullptr != findContext(runtime))
+	{
+		return;
+	}
+	RuntimeCaptureContext context;
+	context.runtime = runtime;
+	_contexts.push_back(std::move(context));
+}
+
+
+void StereoCapture::unregisterRuntime(effect_runtime* runtime)
+{
+	if(_isCapturing)
+	{
+		const bool isEye = (_leftEyeIndex >= 0 && _contexts[_leftEyeIndex].runtime == runtime) || (_rightEyeIndex >= 0 && _contexts[_rightEyeIndex].runtime == runtime);
+		if(isEye)
+		{
+			stop();
+		}
+	}
+	std::erase_if(_contexts, [runtime](const RuntimeCaptureContext& c) { return c.runtime == runtime; });
+	if(_isCapturing)
+	{
+		// indices have shifted, the eyes are still present.
+		selectEyes();
+	}
+}
+
+
+void StereoCapture::configure(const std::string& rootFolder, ScreenshotFiletype filetype, StereoPacking packing, bool swapEyes)
+{
+	if(_isCapturing)
+	{
+		return;
+	}
+	_rootFolder = rootFolder;
+	_filetype = filetype;
+	_packing = packing;
+	_swapEyes = swapEyes;
+}
+
+
+bool StereoCapture::start(int numberOfPairs)
+{
+	if(_isCapturing || numberOfPairs <= 0)
+	{
+		return false;
+	}
+	if(_encoder.isFinishing())
+	{
+		OverlayControl::addNotification("The previous stereo capture is still being written. Start the capture again when it's done.");
+		return false;
+	}
+	if(!selectEyes())
+	{
+		OverlayControl::addNotification("Stereo capture needs two ReShade runtimes with the same resolution, one per eye");
+		return false;
+	}
+	const RuntimeCaptureContext& leftEye = _contexts[_leftEyeIndex];
+	const size_t pairSizeInBytes = (size_t)leftEye.width * leftEye.height * 3 * 2;
+	_destinationFolder = createStereoFolder();
+	// leave a core for the game.
+	_encoder.start(_filetype, (std::max)(IGCS::WorkerPool::numberOfWorkers() - 1, 1), (std::max)((int)(QueueBudgetInBytes / pairSizeInBytes), MinimumQueueCapacity));
+	for(RuntimeCaptureContext& context : _contexts)
+	{
+		context.isCaptured = false;
+	}
+	_numberOfPairsToCapture = numberOfPairs;
+	_numberOfCapturedPairs = 0;
+	_numberOfDroppedPairs = 0;
+	_isCapturing = true;
+	OverlayControl::addNotification("Stereo capture started");
+	return true;
+}
+
+
+void StereoCapture::stop()
+{
+	if(!_isCapturing)
+	{
+		return;
+	}
+	_isCapturing = false;
+	for(RuntimeCaptureContext& context : _contexts)
+	{
+		// release the eye buffers, they're as large as the backbuffer.
+		context.isCaptured = false;
+		context.data.clear();
+		context.data.shrink_to_fit();
+	}
+	// the pairs still queued are written off the render thread. Progress is shown by renderOverlay.
+	_encoder.stopInBackground([this, destinationFolder = _destinationFolder]()
+	{
+		OverlayControl::addNotification(IGCS::Utils::formatString("Stereo capture done. %d pairs written to %s", _encoder.numberOfFramesWritten(), 
+																  destinationFolder.c_str()).c_str());
+	});
+}
+
+
+void StereoCapture::renderOverlay()
+{
+	if(!_encoder.isFinishing())
+	{
+		return;
+	}
+	const int numberOfPairsQueued = (std::max)(_encoder.numberOfFramesQueued(), 1);
+	const int numberOfPairsDone = _encoder.numberOfFramesWritten() + _encoder.numberOfFailedFrames();
+	ImGui::SetNextWindowBgAlpha(0.9f);
+	ImGui::SetNextWindowPos(ImVec2(10, 10));
+	if(ImGui::Begin("IgcsConnector_StereoCaptureProgress", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings))
+	{
+		ImGui::Text("Writing the stereo pairs");
+		ImGui::ProgressBar((float)numberOfPairsDone / (float)numberOfPairsQueued, ImVec2(0.f, 0.f), 
+						   IGCS::Utils::formatString("%d/%d", numberOfPairsDone, numberOfPairsQueued).c_str());
+	}
+	ImGui::End();
+}
+
+
+void StereoCapture::effectsRendered(effect_runtime* runtime)
+{
+	if(!_isCapturing)
+	{
+		return;
+	}
+	RuntimeCaptureContext* context = findContext(runtime);
+	if(nullptr == context || (context != &_contexts[_leftEyeIndex] && context != &_contexts[_rightEyeIndex]))
+	{
+		return;
+	}
+	RuntimeCaptureContext& otherEye = (context == &_contexts[_leftEyeIndex]) ? _contexts[_rightEyeIndex] : _contexts[_leftEyeIndex];
+	if(context->isCaptured)
+	{
+		// this eye is rendered again before the other eye was: the other eye missed a frame, so the eye captured before is stale. Start the pair over
+		// with this frame.
+		context->isCaptured = false;
+		_numberOfDroppedPairs++;
+	}
+	uint32_t width = 0;
+	uint32_t height = 0;
+	runtime->get_screenshot_width_and_height(&width, &height);
+	if(width != context->width || height != context->height)
+	{
+		// the resolution of the eye changed, the pair can't be packed anymore.
+		OverlayControl::addNotification("The resolution of an eye changed. Stereo capture stopped");
+		stop();
+		return;
+	}
+	context->data.resize((size_t)width * height * 4);
+	if(!runtime->capture_screenshot(context->data.data()))
+	{
+		// drop the half pair, the other eye will start a new one.
+		otherEye.isCaptured = false;
+		_numberOfDroppedPairs++;
+		return;
+	}
+	context->isCaptured = true;
+	if(!otherEye.isCaptured)
+	{
+		return;
+	}
+	queuePair();
+	_contexts[_leftEyeIndex].isCaptured = false;
+	_contexts[_rightEyeIndex].isCaptured = false;
+	if(_numberOfCapturedPairs >= _numberOfPairsToCapture)
+	{
+		stop();
+	}
+}
+
+
+bool StereoCapture::hasStereoRuntimes()
+{
+	for(size_t i = 0; i < _contexts.size(); ++i)
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		_contexts[i].runtime->get_screenshot_width_and_height(&width, &height);
+		for(size_t j = i + 1; j < _contexts.size(); ++j)
+		{
+			uint32_t otherWidth = 0;
+			uint32_t otherHeight = 0;
+			_contexts[j].runtime->get_screenshot_width_and_height(&otherWidth, &otherHeight);
+			if(width > 0 && height > 0 && width == otherWidth && height == otherHeight)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+RuntimeCaptureContext* StereoCapture::findContext(effect_runtime* runtime)
+{
+	for(RuntimeCaptureContext& context : _contexts)
+	{
+		if(context.runtime == runtime)
+		{
+			return &context;
+		}
+	}
+	return nullptr;
+}
+
+
+bool StereoCapture::selectEyes()
+{
+	_leftEyeIndex = -1;
+	_rightEyeIndex = -1;
+	for(RuntimeCaptureContext& context : _contexts)
+	{
+		context.runtime->get_screenshot_width_and_height(&context.width, &context.height);
+	}
+	for(int i = 0; i < (int)_contexts.size(); ++i)
+	{
+		for(int j = i + 1; j < (int)_contexts.size(); ++j)
+		{
+			if(_contexts[i].width > 0 && _contexts[i].height > 0 && _contexts[i].width == _contexts[j].width && _contexts[i].height == _contexts[j].height)
+			{
+				// runtimes are created in the order of the eyes, so the first runtime is the left eye unless the user says otherwise.
+				_leftEyeIndex = _swapEyes ? j : i;
+				_rightEyeIndex = _swapEyes ? i : j;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+void StereoCapture::queuePair()
+{
+	const RuntimeCaptureContext& leftEye = _contexts[_leftEyeIndex];
+	const RuntimeCaptureContext& rightEye = _contexts[_rightEyeIndex];
+	const uint32_t eyeWidth = leftEye.width;
+	const uint32_t eyeHeight = leftEye.height;
+	const bool isSideBySide = _packing == StereoPacking::SideBySide;
+	EncodeJob job;
+	job.width = (int)(isSideBySide ? eyeWidth * 2 : eyeWidth);
+	job.height = (int)(isSideBySide ? eyeHeight : eyeHeight * 2);
+	job.data.resize((size_t)job.width * job.height * 3);
+	job.filename = IGCS::Utils::formatString("%s\\stereo_%.4d.%s", _destinationFolder.c_str(), _numberOfCapturedPairs, 
+											 IGCS::ImageFileWriters::fileExtension(_filetype).c_str()).c_str();
+
+	// both eyes are packed in parallel, in bands of rows. Every band writes a disjoint part of the pair.
+	const int numberOfBandsPerEye = (int)((eyeHeight + RowsPerBand - 1) / RowsPerBand);
+	uint8_t* destination = job.data.data();
+	IGCS::WorkerPool::parallelFor(numberOfBandsPerEye * 2, [&](int bandIndex)
+	{
+		const int eye = bandIndex / numberOfBandsPerEye;
+		const uint8_t* source = (0 == eye ? leftEye : rightEye).data.data();
+		const uint32_t firstRow = (uint32_t)(bandIndex % numberOfBandsPerEye) * RowsPerBand;
+		const uint32_t endRow = (std::min)(firstRow + RowsPerBand, eyeHeight);
+		for(uint32_t y = firstRow; y < endRow; ++y)
+		{
+			const size_t destinationPixel = isSideBySide ? (size_t)y * eyeWidth * 2 + (size_t)eye * eyeWidth : ((size_t)eye * eyeHeight + y) * eyeWidth;
+			convertRgbaRowToRgb(source + (size_t)y * eyeWidth * 4, destination + destinationPixel * 3, eyeWidth);
+		}
+	});
+	if(_encoder.tryEnqueue(std::move(job)))
+	{
+		_numberOfCapturedPairs++;
+	}
+	else
+	{
+		_numberOfDroppedPairs++;
+	}
+}
+
+
+std::string StereoCapture::createStereoFolder()
+{
+	time_t t = time(nullptr);
+	tm tm;
+	localtime_s(&tm, &t);
+	const std::string optionalBackslash = (_rootFolder.ends_with('\\')) ? "" : "\\";
+	std::string folderName = IGCS::Utils::formatString("%s%sStereo-%.4d-%.2d-%.2d-%.2d-%.2d-%.2d", _rootFolder.c_str(), optionalBackslash.c_str(),
+													   (tm.tm_year + 1900), (tm.tm_mon + 1), tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+	_mkdir(folderName.c_str());
+	return folderName;
+}
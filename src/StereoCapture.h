@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <reshade.hpp>
+#include <string>
+#include <vector>
+#include "ConstantsEnums.h"
+#include "StreamingEncoder.h"
+
+/// <summary>
+/// The capture state of a single ReShade runtime. In VR every eye has its own runtime, so a stereo pair is captured from two of these.
+/// </summary>
+struct RuntimeCaptureContext
+{
+	reshade::api::effect_runtime* runtime = nullptr;
+	std::vector<uint8_t> data;		// RGBA, 4 bytes per pixel, as captured by the runtime
+	uint32_t width = 0;
+	uint32_t height = 0;
+	bool isCaptured = false;		// true if data contains the eye of the pair currently being captured
+};
+
+
+/// <summary>
+/// Captures stereo pairs from the two runtimes ReShade creates in VR, one per eye. Both eyes are grabbed from the same frame, packed side by side or over 
+/// under into one image and handed to a StreamingEncoder. Every runtime has its own capture context, so the runtimes can render in any order. All methods 
+/// are called on the render thread. The pairs still queued when a capture stops are written on a background thread.
+/// </summary>
+class StereoCapture
+{
+public:
+	StereoCapture() = default;
+	~StereoCapture() = default;
+
+	void registerRuntime(reshade::api::effect_runtime* runtime);
+	void unregisterRuntime(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Configures the next capture.
+	/// </summary>
+	/// <param name="rootFolder">the folder in which the folder for the pairs is created</param>
+	/// <param name="filetype"></param>
+	/// <param name="packing"></param>
+	/// <param name="swapEyes">if true the first runtime is the right eye instead of the left eye</param>
+	void configure(const std::string& rootFolder, ScreenshotFiletype filetype, StereoPacking packing, bool swapEyes);
+	/// <summary>
+	/// Starts capturing the number of pairs specified, from consecutive frames. Returns false if there are no two runtimes with the same resolution to
+	/// capture the eyes from.
+	/// </summary>
+	bool start(int numberOfPairs);
+	/// <summary>
+	/// Stops capturing. The pairs still queued are written on a background thread.
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// Shows the progress of writing the pairs left in the queue when the capture was stopped, if that's still going on.
+	/// </summary>
+	void renderOverlay();
+	/// <summary>
+	/// Captures the eye rendered by the runtime specified, if a capture is active. Once both eyes of a frame have been captured, they're packed and queued.
+	/// </summary>
+	void effectsRendered(reshade::api::effect_runtime* runtime);
+
+	bool isCapturing() { return _isCapturing; }
+	bool isWritingRemainingPairs() { return _encoder.isFinishing(); }
+	/// <summary>
+	/// Returns true if there are two runtimes with the same resolution, which are taken to be the eyes.
+	/// </summary>
+	bool hasStereoRuntimes();
+	int numberOfRuntimes() { return (int)_contexts.size(); }
+	int numberOfCapturedPairs() { return _numberOfCapturedPairs; }
+	int numberOfPairsToCapture() { return _numberOfPairsToCapture; }
+	int numberOfDroppedPairs() { return _numberOfDroppedPairs + _encoder.numberOfFailedFrames(); }
+
+private:
+	RuntimeCaptureContext* findContext(reshade::api::effect_runtime* runtime);
+	/// <summary>
+	/// Finds the first two runtimes with the same resolution and stores their indices in _leftEyeIndex and _rightEyeIndex.
+	/// </summary>
+	bool selectEyes();
+	/// <summary>
+	/// Packs the two captured eyes into one RGB image, both eyes in parallel, and queues it for encoding.
+	/// </summary>
+	void queuePair();
+	std::string createStereoFolder();
+
+	std::vector<RuntimeCaptureContext> _contexts;
+	std::string _rootFolder;
+	ScreenshotFiletype _filetype = ScreenshotFiletype::Png;
+	StereoPacking _packing = StereoPacking::SideBySide;
+	bool _swapEyes = false;
+
+	bool _isCapturing = false;
+	int _leftEyeIndex = -1;				// indices in _contexts
+	int _rightEyeIndex = -1;
+	std::string _destinationFolder;
+	StreamingEncoder _encoder;
+	int _numberOfPairsToCapture = 0;
+	int _numberOfCapturedPairs = 0;
+	int _numberOfDroppedPairs = 0;
+};
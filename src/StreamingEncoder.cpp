@@ -0,0 +1,340 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "StreamingEncoder.h"
+#include "ImageFileWriters.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+
+StreamingEncoder::~StreamingEncoder()
+{
+	stop();
+}
+
+
+void StreamingEncoder::start(ScreenshotFiletype filetype, int numberOfThreads, int queueCapacity, EncodingSelection selection)
+{
+	stop();
+	_filetype = filetype;
+	_governor.start(selection, (std::max)(numberOfThreads, 1));
+	resetCounters(queueCapacity);
+	for(int i = 0; i < (std::max)(numberOfThreads, 1); i++)
+	{
+		_encoderThreads.emplace_back(&StreamingEncoder::encodeJobs, this);
+	}
+}
+
+
+bool StreamingEncoder::startAnimation(const std::string& filename, int width, int height, int framesPerSecond, int queueCapacity)
+{
+	stop();
+	_governor.start(EncodingSelection::Fixed, 1);
+	if(!_animationWriter.open(filename, width, height, 1, (uint16_t)std::clamp(framesPerSecond, 1, 1000), 0))
+	{
+		return false;
+	}
+	resetCounters(queueCapacity);
+	// the frames are compressed in parallel by the writer, so one thread feeds it.
+	_encoderThreads.emplace_back(&StreamingEncoder::encodeAnimationJobs, this);
+	return true;
+}
+
+
+bool StreamingEncoder::tryEnqueue(EncodeJob job)
+{
+	{
+		std::scoped_lock lock(_queueMutex);
+		if(!isRunning() || _isStopping || _queue.size() >= (size_t)_queueCapacity)
+		{
+			return false;
+		}
+		_queue.push_back(std::move(job));
+	}
+	_numberOfFramesQueued++;
+	if(_governor.isActive())
+	{
+		_governor.frameQueued();
+	}
+	_queueNotEmpty.notify_one();
+	return true;
+}
+
+
+bool StreamingEncoder::enqueue(EncodeJob job)
+{
+	if(!isRunning())
+	{
+		return false;
+	}
+	{
+		std::unique_lock lock(_queueMutex);
+		_queueNotFull.wait(lock, [this] { return _isStopping || _queue.size() < (size_t)_queueCapacity; });
+		if(_isStopping)
+		{
+			return false;
+		}
+		_queue.push_back(std::move(job));
+	}
+	_numberOfFramesQueued++;
+	if(_governor.isActive())
+	{
+		_governor.frameQueued();
+	}
+	_queueNotEmpty.notify_one();
+	return true;
+}
+
+
+void StreamingEncoder::stop()
+{
+	waitForBackgroundStop();
+	if(!isRunning())
+	{
+		return;
+	}
+	{
+		std::scoped_lock lock(_queueMutex);
+		_isStopping = true;
+	}
+	_queueNotEmpty.notify_all();
+	_queueNotFull.notify_all();
+	for(std::thread& encoderThread : _encoderThreads)
+	{
+		encoderThread.join();
+	}
+	_encoderThreads.clear();
+}
+
+
+void StreamingEncoder::stopInBackground(std::function<void()> onStopped)
+{
+	waitForBackgroundStop();
+	if(!isRunning())
+	{
+		if(nullptr != onStopped)
+		{
+			onStopped();
+		}
+		return;
+	}
+	{
+		std::scoped_lock lock(_queueMutex);
+		_isStopping = true;
+	}
+	_queueNotEmpty.notify_all();
+	_queueNotFull.notify_all();
+	_isFinishing = true;
+	// the encoder threads are handed to the stop thread, so the encoder isn't running anymore from here on.
+	_stopThread = std::thread([this, encoderThreads = std::move(_encoderThreads), onStopped]() mutable
+	{
+		for(std::thread& encoderThread : encoderThreads)
+		{
+			encoderThread.join();
+		}
+		if(nullptr != onStopped)
+		{
+			onStopped();
+		}
+		_isFinishing = false;
+	});
+	_encoderThreads.clear();
+}
+
+
+void StreamingEncoder::waitForBackgroundStop()
+{
+	if(_stopThread.joinable())
+	{
+		_stopThread.join();
+	}
+}
+
+
+bool StreamingEncoder::writeReport(const std::string& filename)
+{
+	std::vector<EncodedFrameRecord> frameRecords;
+	{
+		std::scoped_lock lock(_frameRecordsMutex);
+		frameRecords = _frameRecords;
+	}
+	// the encoder threads finish frames out of order.
+	std::sort(frameRecords.begin(), frameRecords.end(), [](const EncodedFrameRecord& a, const EncodedFrameRecord& b) { return a.filename < b.filename; });
+	FILE* file = nullptr;
+	if(fopen_s(&file, filename.c_str(), "w") != 0 || nullptr == file)
+	{
+		return false;
+	}
+	fprintf(file, "file,filetype,bytes,encode ms,write ms\n");
+	for(const EncodedFrameRecord& record : frameRecords)
+	{
+		fprintf(file, "%s,%s,%zu,%.3f,%.3f\n", record.filename.c_str(), IGCS::ImageFileWriters::fileExtension(record.filetype).c_str(), record.numberOfBytes,
+				record.encodeMilliseconds, record.writeMilliseconds);
+	}
+	fclose(file);
+	return true;
+}
+
+
+int StreamingEncoder::queueLength()
+{
+	std::scoped_lock lock(_queueMutex);
+	return (int)_queue.size();
+}
+
+
+void StreamingEncoder::resetCounters(int queueCapacity)
+{
+	_queueCapacity = (std::max)(queueCapacity, 1);
+	_isStopping = false;
+	_numberOfFramesQueued = 0;
+	_numberOfFramesWritten = 0;
+	_numberOfFailedFrames = 0;
+	_numberOfBytesWritten = 0;
+	std::scoped_lock lock(_frameRecordsMutex);
+	_frameRecords.clear();
+}
+
+
+void StreamingEncoder::encodeJobs()
+{
+	for(;;)
+	{
+		EncodeJob job;
+		float queueFillFraction = 0.0f;
+		{
+			std::unique_lock lock(_queueMutex);
+			_queueNotEmpty.wait(lock, [this] { return _isStopping || !_queue.empty(); });
+			if(_queue.empty())
+			{
+				// stopping and everything has been written.
+				return;
+			}
+			queueFillFraction = (float)_queue.size() / (float)_queueCapacity;
+			job = std::move(_queue.front());
+			_queue.pop_front();
+		}
+		_queueNotFull.notify_one();
+		ScreenshotFiletype filetype = _filetype;
+		if(_governor.isActive())
+		{
+			filetype = _governor.chooseFiletype(job.width, job.height, queueFillFraction);
+			const size_t extensionStart = job.filename.find_last_of('.');
+			if(extensionStart != std::string::npos && job.filename.find_first_of("\\/", extensionStart) == std::string::npos)
+			{
+				job.filename.resize(extensionStart);
+			}
+			job.filename += "." + IGCS::ImageFileWriters::fileExtension(filetype);
+		}
+		// encoding and writing are timed separately, as the governor needs both to know which of the two is the bottleneck.
+		const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+		std::vector<uint8_t> encodedData;
+		const bool isEncoded = IGCS::ImageFileWriters::encodeImage(filetype, job.data.data(), job.width, job.height, encodedData);
+		// the frame isn't needed anymore, so free it before the write, which can take a while.
+		job.data = std::vector<uint8_t>();
+		const std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+		const size_t numberOfBytesWritten = isEncoded ? IGCS::ImageFileWriters::writeEncodedImage(job.filename, encodedData) : 0;
+		const std::chrono::steady_clock::time_point writeEnd = std::chrono::steady_clock::now();
+		if(numberOfBytesWritten > 0)
+		{
+			_numberOfBytesWritten += numberOfBytesWritten;
+			_numberOfFramesWritten++;
+			const double encodeSeconds = std::chrono::duration<double>(writeStart - encodeStart).count();
+			const double writeSeconds = std::chrono::duration<double>(writeEnd - writeStart).count();
+			if(_governor.isActive())
+			{
+				_governor.frameWritten(filetype, job.width, job.height, numberOfBytesWritten, encodeSeconds, writeSeconds);
+			}
+			EncodedFrameRecord record;
+			const size_t filenameStart = job.filename.find_last_of("\\/");
+			record.filename = (filenameStart == std::string::npos) ? job.filename : job.filename.substr(filenameStart + 1);
+			record.filetype = filetype;
+			record.numberOfBytes = numberOfBytesWritten;
+			record.encodeMilliseconds = encodeSeconds * 1000.0;
+			record.writeMilliseconds = writeSeconds * 1000.0;
+			if(nullptr != job.onWritten)
+			{
+				job.onWritten(record, encodedData);
+			}
+			std::scoped_lock lock(_frameRecordsMutex);
+			_frameRecords.push_back(std::move(record));
+		}
+		else
+		{
+			_numberOfFailedFrames++;
+		}
+	}
+}
+
+
+void StreamingEncoder::encodeAnimationJobs()
+{
+	// a batch has a frame per worker, so all cores compress a frame at the same time.
+	const size_t maximumBatchSize = (size_t)IGCS::WorkerPool::numberOfWorkers();
+	std::vector<EncodeJob> batch;
+	for(;;)
+	{
+		batch.clear();
+		{
+			std::unique_lock lock(_queueMutex);
+			_queueNotEmpty.wait(lock, [this] { return _isStopping || !_queue.empty(); });
+			while(!_queue.empty() && batch.size() < maximumBatchSize)
+			{
+				batch.push_back(std::move(_queue.front()));
+				_queue.pop_front();
+			}
+		}
+		_queueNotFull.notify_all();
+		if(batch.empty())
+		{
+			// stopping and everything has been written.
+			break;
+		}
+		std::vector<const uint8_t*> frames;
+		for(const EncodeJob& job : batch)
+		{
+			frames.push_back(job.data.data());
+		}
+		const uint64_t numberOfBytesWrittenBefore = _animationWriter.numberOfBytesWritten();
+		if(_animationWriter.addFrames(frames))
+		{
+			_numberOfFramesWritten += (int)batch.size();
+		}
+		else
+		{
+			_numberOfFailedFrames += (int)batch.size();
+		}
+		_numberOfBytesWritten += _animationWriter.numberOfBytesWritten() - numberOfBytesWrittenBefore;
+	}
+	_animationWriter.close();
+}
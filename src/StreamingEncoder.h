@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ApngWriter.h"
+#include "ConstantsEnums.h"
+#include "OutputGovernor.h"
+
+/// <summary>
+/// What was written for a frame by a StreamingEncoder, for the report of a session.
+/// </summary>
+struct EncodedFrameRecord
+{
+	std::string filename;
+	ScreenshotFiletype filetype = ScreenshotFiletype::Png;
+	size_t numberOfBytes = 0;
+	double encodeMilliseconds = 0.0;
+	double writeMilliseconds = 0.0;
+};
+
+
+/// <summary>
+/// A frame to encode and write by a StreamingEncoder.
+/// </summary>
+struct EncodeJob
+{
+	std::string filename;			// full path of the file to write
+	std::vector<uint8_t> data;		// RGB data, 3 bytes per pixel.
+	int width = 0;
+	int height = 0;
+	// if set, called on the encoder thread after the file has been written, with the encoded file. Not used for animations.
+	std::function<void(const EncodedFrameRecord& record, const std::vector<uint8_t>& encodedData)> onWritten;
+};
+
+
+/// <summary>
+/// Encodes and writes frames on a set of encoder threads while they're being captured. The queue between the render thread and the encoder threads is 
+/// bounded, so a capture which is faster than the encoders can't fill up memory: enqueueing fails if the queue is full, and the fill level of the queue
+/// tells the caller when the encoders fall behind. Frames are either written as separate files or appended to one animated PNG.
+/// </summary>
+class StreamingEncoder
+{
+public:
+	StreamingEncoder() = default;
+	~StreamingEncoder();
+
+	/// <summary>
+	/// Starts the encoder threads. Frames are written in the file type specified, or in the file type an OutputGovernor picks per frame if the
+	/// selection is automatic. The extension of the filename of a job is then replaced with the one of the file type picked.
+	/// </summary>
+	/// <param name="filetype"></param>
+	/// <param name="numberOfThreads">the number of encoder threads. Frames are written out of order if this is more than 1.</param>
+	/// <param name="queueCapacity">the maximum number of frames waiting to be encoded</param>
+	/// <param name="selection">how the file type of a frame is chosen</param>
+	void start(ScreenshotFiletype filetype, int numberOfThreads, int queueCapacity, EncodingSelection selection = EncodingSelection::Fixed);
+	/// <summary>
+	/// Starts an encoder thread which appends the frames to the animated PNG specified, in the order they're queued. The filenames of the jobs are ignored.
+	/// Frames are compressed in parallel in batches.
+	/// </summary>
+	/// <param name="filename">full path of the animated PNG to write</param>
+	/// <param name="width">the width of all frames</param>
+	/// <param name="height">the height of all frames</param>
+	/// <param name="framesPerSecond">the speed at which the animation plays</param>
+	/// <param name="queueCapacity">the maximum number of frames waiting to be encoded</param>
+	/// <returns>true if the file could be created, false otherwise</returns>
+	bool startAnimation(const std::string& filename, int width, int height, int framesPerSecond, int queueCapacity);
+	/// <summary>
+	/// Queues the job specified. Returns false if the queue is full or the encoder isn't running, in which case the job isn't written.
+	/// </summary>
+	bool tryEnqueue(EncodeJob job);
+	/// <summary>
+	/// Queues the job specified, waiting for room in the queue if it's full. Returns false if the encoder isn't running or is stopping, in which case
+	/// the job isn't written.
+	/// </summary>
+	bool enqueue(EncodeJob job);
+	/// <summary>
+	/// Writes the frames still in the queue and stops the encoder threads. Blocks until all frames have been written.
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// Like stop, but returns immediately: no more frames are accepted, and the frames still in the queue are written and the encoder threads joined
+	/// on a background thread. onStopped is then called on that thread, e.g. to write the report. A next start waits for this to finish.
+	/// </summary>
+	void stopInBackground(std::function<void()> onStopped);
+	/// <summary>
+	/// Writes a CSV file with a line per frame written since the last start with its file type, size and how long encoding and writing it took.
+	/// Call after stop.
+	/// </summary>
+	/// <returns>true if the file was written, false otherwise</returns>
+	bool writeReport(const std::string& filename);
+
+	bool isRunning() { return _encoderThreads.size() > 0; }
+	/// <summary>
+	/// Returns true while the frames left after stopInBackground are being written.
+	/// </summary>
+	bool isFinishing() { return _isFinishing; }
+	int numberOfFramesQueued() { return _numberOfFramesQueued; }
+	int queueLength();
+	int queueCapacity() { return _queueCapacity; }
+	int numberOfFramesWritten() { return _numberOfFramesWritten; }
+	int numberOfFailedFrames() { return _numberOfFailedFrames; }
+	uint64_t numberOfBytesWritten() { return _numberOfBytesWritten; }
+
+private:
+	void encodeJobs();
+	void encodeAnimationJobs();
+	void resetCounters(int queueCapacity);
+	void waitForBackgroundStop();
+
+	ScreenshotFiletype _filetype = ScreenshotFiletype::Png;
+	OutputGovernor _governor;
+	int _queueCapacity = 0;
+	std::deque<EncodeJob> _queue;
+	std::mutex _queueMutex;
+	std::condition_variable _queueNotEmpty;
+	std::condition_variable _queueNotFull;
+	bool _isStopping = false;						// guarded by _queueMutex
+	std::vector<std::thread> _encoderThreads;
+	std::thread _stopThread;						// joins the encoder threads after stopInBackground
+	std::atomic<bool> _isFinishing = false;
+	ApngWriter _animationWriter;					// only used by the animation encoder thread
+	std::vector<EncodedFrameRecord> _frameRecords;
+	std::mutex _frameRecordsMutex;
+	std::atomic<int> _numberOfFramesQueued = 0;
+	std::atomic<int> _numberOfFramesWritten = 0;
+	std::atomic<int> _numberOfFailedFrames = 0;
+	std::atomic<uint64_t> _numberOfBytesWritten = 0;
+};
@@ -52,6 +52,20 @@ namespace IGCS::Utils
 	}
 
 
+	float halton(int index, int base)
+	{
+		float fraction = 1.0f;
+		float toReturn = 0.0f;
+		while(index > 0)
+		{
+			fraction /= base;
+			toReturn += fraction * (index % base);
+			index /= base;
+		}
+		return toReturn;
+	}
+
+
 	string formatString(const char *fmt, ...)
 	{
 		va_list args;
@@ -33,6 +33,10 @@
 namespace IGCS::Utils
 {
 	float degreesToRadians(float angleInDegrees);
+	/// <summary>
+	/// Returns the element with the index specified of the Halton low discrepancy sequence with the base specified. Values are in [0, 1). 
+	/// </summary>
+	float halton(int index, int base);
 	std::string formatString(const char* fmt, ...);
 	std::string formatStringVa(const char* fmt, va_list args);
 	void logLineToReshade(const reshade::log_level logLevel, const char* fmt, ...);
@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "ViewInterpolator.h"
+#include "LightfieldDepthEstimator.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	// two disparities closer than this are considered the same surface.
+	constexpr float SameSurfaceThreshold = 1.0f;
+
+	/// <summary>
+	/// A row of a view warped to the position of the view to synthesize. 
+	/// </summary>
+	struct WarpedRow
+	{
+		std::vector<const uint8_t*> pixels;
+		std::vector<float> disparities;		// -FLT_MAX if no pixel was warped to this spot
+
+		void initialize(int width)
+		{
+			pixels.assign(width, nullptr);
+			disparities.assign(width, -FLT_MAX);
+		}
+	};
+
+
+	/// <summary>
+	/// Forward warps a row. Every pixel is written to the two destination pixels around its target location to avoid cracks, where the pixel with the
+	/// highest disparity (closest to the camera) wins.
+	/// </summary>
+	void warpRow(const uint8_t* sourceRow, const float* disparities, int width, float shiftPerDisparity, WarpedRow& warpedRow)
+	{
+		for(int x = 0; x < width; x++)
+		{
+			const float disparity = disparities[x];
+			const int targetX = (int)floorf(x + disparity * shiftPerDisparity);
+			for(int destinationX = targetX; destinationX <= targetX + 1; destinationX++)
+			{
+				if(destinationX < 0 || destinationX >= width || disparity <= warpedRow.disparities[destinationX])
+				{
+					continue;
+				}
+				warpedRow.disparities[destinationX] = disparity;
+				warpedRow.pixels[destinationX] = sourceRow + x * 3;
+			}
+		}
+	}
+}
+
+
+void ViewInterpolator::prepare(const uint8_t* leftView, const uint8_t* rightView, int width, int height, float maximumDisparity)
+{
+	_leftView = leftView;
+	_rightView = rightView;
+	_width = width;
+	_height = height;
+
+	std::vector<LightfieldView> views(2);
+	views[0].data = leftView;
+	views[0].u = 0.0f;
+	views[1].data = rightView;
+	views[1].u = 1.0f;
+	IGCS::LightfieldDepthEstimator::estimateDisparity(views, 0, width, height, maximumDisparity, _leftDisparities);
+	IGCS::LightfieldDepthEstimator::estimateDisparity(views, 1, width, height, maximumDisparity, _rightDisparities);
+	// both have to be corrected using the uncorrected disparities of the other view.
+	std::vector<float> originalLeftDisparities = _leftDisparities;
+	fillOccludedDisparities(_leftDisparities, _rightDisparities, -1);
+	fillOccludedDisparities(_rightDisparities, originalLeftDisparities, 1);
+}
+
+
+void ViewInterpolator::fillOccludedDisparities(std::vector<float>& disparities, const std::vector<float>& otherDisparities, int direction)
+{
+	IGCS::WorkerPool::parallelFor(_height, [&](int y)
+	{
+		float* row = disparities.data() + (size_t)y * _width;
+		const float* otherRow = otherDisparities.data() + (size_t)y * _width;
+		std::vector<bool> isConsistent(_width);
+		for(int x = 0; x < _width; x++)
+		{
+			const int otherX = (int)lroundf(x + direction * row[x]);
+			isConsistent[x] = otherX >= 0 && otherX < _width && fabsf(otherRow[otherX] - row[x]) <= SameSurfaceThreshold;
+		}
+		int x = 0;
+		while(x < _width)
+		{
+			if(isConsistent[x])
+			{
+				x++;
+				continue;
+			}
+			int runEnd = x;
+			while(runEnd < _width && !isConsistent[runEnd])
+			{
+				runEnd++;
+			}
+			// occluded areas are behind the surfaces next to them, so take the lowest disparity of the two sides.
+			float fillDisparity = FLT_MAX;
+			if(x > 0)
+			{
+				fillDisparity = row[x - 1];
+			}
+			if(runEnd < _width)
+			{
+				fillDisparity = (std::min)(fillDisparity, row[runEnd]);
+			}
+			if(fillDisparity != FLT_MAX)
+			{
+				std::fill(row + x, row + runEnd, fillDisparity);
+			}
+			x = runEnd;
+		}
+	});
+}
+
+
+void ViewInterpolator::synthesizeView(float position, std::vector<uint8_t>& destination)
+{
+	if(nullptr == _leftView || nullptr == _rightView)
+	{
+		return;
+	}
+	const size_t rowSizeInBytes = (size_t)_width * 3;
+	destination.resize(rowSizeInBytes * _height);
+	IGCS::WorkerPool::parallelFor(_height, [&](int y)
+	{
+		// a point at x in the left view is at x - disparity * position in the view to synthesize, a point at x in the right view is at
+		// x + disparity * (1 - position).
+		WarpedRow fromLeft;
+		WarpedRow fromRight;
+		fromLeft.initialize(_width);
+		fromRight.initialize(_width);
+		warpRow(_leftView + y * rowSizeInBytes, _leftDisparities.data() + (size_t)y * _width, _width, -position, fromLeft);
+		warpRow(_rightView + y * rowSizeInBytes, _rightDisparities.data() + (size_t)y * _width, _width, 1.0f - position, fromRight);
+
+		uint8_t* destinationRow = destination.data() + y * rowSizeInBytes;
+		std::vector<float> disparities(_width, -FLT_MAX);
+		for(int x = 0; x < _width; x++)
+		{
+			const uint8_t* leftPixel = fromLeft.pixels[x];
+			const uint8_t* rightPixel = fromRight.pixels[x];
+			if(nullptr != leftPixel && nullptr != rightPixel && fabsf(fromLeft.disparities[x] - fromRight.disparities[x]) <= SameSurfaceThreshold)
+			{
+				// same surface seen in both views: blend by distance to each view.
+				for(int channel = 0; channel < 3; channel++)
+				{
+					destinationRow[x * 3 + channel] = (uint8_t)(leftPixel[channel] * (1.0f - position) + rightPixel[channel] * position + 0.5f);
+				}
+				disparities[x] = fromLeft.disparities[x];
+				continue;
+			}
+			// otherwise the closest surface wins.
+			const bool useLeft = nullptr != leftPixel && (nullptr == rightPixel || fromLeft.disparities[x] > fromRight.disparities[x]);
+			const uint8_t* pixel = useLeft ? leftPixel : rightPixel;
+			if(nullptr != pixel)
+			{
+				memcpy(destinationRow + x * 3, pixel, 3);
+				disparities[x] = useLeft ? fromLeft.disparities[x] : fromRight.disparities[x];
+			}
+		}
+
+		// spots neither view covers are disoccluded background: extend the side with the lowest disparity into them.
+		int x = 0;
+		while(x < _width)
+		{
+			if(disparities[x] != -FLT_MAX)
+			{
+				x++;
+				continue;
+			}
+			int holeEnd = x;
+			while(holeEnd < _width && disparities[holeEnd] == -FLT_MAX)
+			{
+				holeEnd++;
+			}
+			int sourceX = -1;
+			if(x > 0 && (holeEnd >= _width || disparities[x - 1] <= disparities[holeEnd]))
+			{
+				sourceX = x - 1;
+			}
+			else if(holeEnd < _width)
+			{
+				sourceX = holeEnd;
+			}
+			for(int holeX = x; holeX < holeEnd; holeX++)
+			{
+				if(sourceX >= 0)
+				{
+					memcpy(destinationRow + holeX * 3, destinationRow + sourceX * 3, 3);
+				}
+				else
+				{
+					memset(destinationRow + holeX * 3, 0, 3);
+				}
+			}
+			x = holeEnd;
+		}
+	});
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Synthesizes views between two neighbouring lightfield shots. Lightfield shots are rectified by construction, so the flow between two neighbours is a
+/// purely horizontal disparity per pixel. The disparity of both shots is estimated with the pyramidal block matcher of the depth estimator and checked
+/// for left-right consistency: pixels which don't match are occluded in the other shot and get the disparity of the background next to them. A view in
+/// between is created by forward warping both shots to its position, where the closest surface wins, and blending them by distance.
+/// </summary>
+class ViewInterpolator
+{
+public:
+	ViewInterpolator() = default;
+	~ViewInterpolator() = default;
+
+	/// <summary>
+	/// Estimates the disparities between the two shots specified. The shots have to stay alive while views are synthesized.
+	/// </summary>
+	/// <param name="leftView">the shot on the left, RGB, 3 bytes per pixel</param>
+	/// <param name="rightView">the shot one step to the right of leftView</param>
+	/// <param name="width"></param>
+	/// <param name="height"></param>
+	/// <param name="maximumDisparity">the largest disparity, in pixels, to search for</param>
+	void prepare(const uint8_t* leftView, const uint8_t* rightView, int width, int height, float maximumDisparity);
+	/// <summary>
+	/// Synthesizes the view at the position specified. 
+	/// </summary>
+	/// <param name="position">0.0 is the left shot, 1.0 the right shot</param>
+	/// <param name="destination">receives the view, RGB, 3 bytes per pixel</param>
+	void synthesizeView(float position, std::vector<uint8_t>& destination);
+
+private:
+	/// <summary>
+	/// Replaces the disparity of pixels which don't have a matching pixel with the same disparity in the other view with the background disparity
+	/// next to them.
+	/// </summary>
+	/// <param name="disparities">the disparities to correct</param>
+	/// <param name="otherDisparities">the disparities of the other view</param>
+	/// <param name="direction">-1 if the other view is to the right, 1 if it's to the left</param>
+	void fillOccludedDisparities(std::vector<float>& disparities, const std::vector<float>& otherDisparities, int direction);
+
+	const uint8_t* _leftView = nullptr;
+	const uint8_t* _rightView = nullptr;
+	int _width = 0;
+	int _height = 0;
+	std::vector<float> _leftDisparities;
+	std::vector<float> _rightDisparities;
+};
@@ -0,0 +1,204 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#include "stdafx.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace IGCS::WorkerPool
+{
+	namespace
+	{
+		/// <summary>
+		/// A parallelFor call in progress. Lives on the stack of the calling thread, which doesn't return before all its items have been processed.
+		/// </summary>
+		struct Job
+		{
+			const std::function<void(int)>* itemProcessor = nullptr;
+			int numberOfItems = 0;
+			std::atomic<int> nextItem = 0;
+			std::atomic<int> numberOfItemsProcessed = 0;
+		};
+
+		/// <summary>
+		/// The worker threads, which are started on the first parallelFor call and wait for work in between calls. Allocated once and never destroyed, as
+		/// joining threads in a static destructor runs under the loader lock when the addon is unloaded. stop joins them outside of it instead.
+		/// </summary>
+		struct Pool
+		{
+			std::mutex mutex;
+			std::condition_variable workAvailable;
+			std::condition_variable jobFinished;
+			std::deque<Job*> jobs;						// the jobs which still have items to hand out, oldest first. Guarded by mutex
+			std::vector<std::thread> threads;			// guarded by mutex
+			bool isStopping = false;					// guarded by mutex
+		};
+
+		Pool& pool()
+		{
+			static Pool* instance = new Pool();
+			return *instance;
+		}
+
+
+		void removeJob(Pool& workerPool, Job* job)
+		{
+			// caller holds the mutex.
+			const auto position = std::find(workerPool.jobs.begin(), workerPool.jobs.end(), job);
+			if(position != workerPool.jobs.end())
+			{
+				workerPool.jobs.erase(position);
+			}
+		}
+
+
+		void finishItem(Pool& workerPool, Job& job)
+		{
+			const int numberOfItems = job.numberOfItems;
+			if(job.numberOfItemsProcessed.fetch_add(1) + 1 == numberOfItems)
+			{
+				// the job can be gone as soon as the count is complete, so only the pool is touched from here on.
+				std::scoped_lock lock(workerPool.mutex);
+				workerPool.jobFinished.notify_all();
+			}
+		}
+
+
+		void workerLoop()
+		{
+			Pool& workerPool = pool();
+			std::unique_lock lock(workerPool.mutex);
+			while(true)
+			{
+				workerPool.workAvailable.wait(lock, [&] { return workerPool.isStopping || !workerPool.jobs.empty(); });
+				if(workerPool.isStopping)
+				{
+					return;
+				}
+				// the item is taken while the mutex is held, so the job can't have returned yet: it waits for this item.
+				Job* job = workerPool.jobs.front();
+				const int item = job->nextItem++;
+				if(item >= job->numberOfItems)
+				{
+					removeJob(workerPool, job);
+					continue;
+				}
+				lock.unlock();
+				(*job->itemProcessor)(item);
+				finishItem(workerPool, *job);
+				lock.lock();
+			}
+		}
+	}
+
+
+	void parallelFor(int numberOfItems, const std::function<void(int)>& itemProcessor)
+	{
+		if(numberOfItems <= 0)
+		{
+			return;
+		}
+		Pool& workerPool = pool();
+		Job job;
+		job.itemProcessor = &itemProcessor;
+		job.numberOfItems = numberOfItems;
+		if(numberOfItems > 1)
+		{
+			std::scoped_lock lock(workerPool.mutex);
+			if(workerPool.threads.empty() && !workerPool.isStopping)
+			{
+				for(int i = 1; i < numberOfWorkers(); i++)
+				{
+					workerPool.threads.emplace_back(workerLoop);
+				}
+			}
+			if(!workerPool.threads.empty())
+			{
+				workerPool.jobs.push_back(&job);
+				workerPool.workAvailable.notify_all();
+			}
+		}
+
+		// the calling thread works on its own job, so a call from inside an item or while the workers are busy with other jobs still makes progress.
+		for(int item = job.nextItem++; item < numberOfItems; item = job.nextItem++)
+		{
+			itemProcessor(item);
+			job.numberOfItemsProcessed++;
+		}
+		std::unique_lock lock(workerPool.mutex);
+		removeJob(workerPool, &job);
+		workerPool.jobFinished.wait(lock, [&] { return job.numberOfItemsProcessed == numberOfItems; });
+	}
+
+
+	int numberOfWorkers()
+	{
+		// hardware_concurrency can return 0 if it can't determine the number of cores.
+		return (std::max)((int)std::thread::hardware_concurrency(), 1);
+	}
+
+
+	void stop()
+	{
+		Pool& workerPool = pool();
+		std::vector<std::thread> threads;
+		{
+			std::scoped_lock lock(workerPool.mutex);
+			workerPool.isStopping = true;
+			workerPool.threads.swap(threads);
+			workerPool.workAvailable.notify_all();
+		}
+		for(auto& thread : threads)
+		{
+			thread.join();
+		}
+		// the next parallelFor starts the workers again.
+		std::scoped_lock lock(workerPool.mutex);
+		workerPool.isStopping = false;
+	}
+
+
+	void requestStop()
+	{
+		Pool& workerPool = pool();
+		// the threads stay in the pool, which is never destroyed, so they don't have to be joined or detached.
+		std::scoped_lock lock(workerPool.mutex);
+		workerPool.isStopping = true;
+		workerPool.workAvailable.notify_all();
+	}
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////
+//
+// Part of IGCS Connector, an add on for Reshade 5+ which allows you
+// to connect IGCS built camera tools with reshade to exchange data and control
+// from Reshade.
+// 
+// (c) Frans 'Otis_Inf' Bouma.
+//
+// All rights reserved.
+// https://github.com/FransBouma/IgcsConnector
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met :
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+//	  list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and / or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <functional>
+
+namespace IGCS::WorkerPool
+{
+	/// <summary>
+	/// Calls itemProcessor for every index in [0, numberOfItems) spread over all cores of the machine and returns when all items have been processed.
+	/// Items are handed out one at a time to the worker threads, so items which take more time than others don't stall the other threads. The calling thread
+	/// is one of the workers. The worker threads are started on the first call and wait for work between calls, so a call doesn't create threads.
+	/// </summary>
+	/// <param name="numberOfItems"></param>
+	/// <param name="itemProcessor">the function to call per item. Has to be thread safe.</param>
+	void parallelFor(int numberOfItems, const std::function<void(int)>& itemProcessor);
+
+	/// <summary>
+	/// Returns the number of threads parallelFor will use at most.
+	/// </summary>
+	int numberOfWorkers();
+
+	/// <summary>
+	/// Stops and joins the worker threads. Blocks, so don't call it from DllMain: joining a thread under the loader lock deadlocks. The next parallelFor
+	/// starts them again.
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// Tells the worker threads to stop, without waiting for them. Safe to call from DllMain. parallelFor still works afterwards, but only on the calling thread.
+	/// </summary>
+	void requestStop();
+}